@@ -564,7 +564,7 @@ const config: ForgeConfig = {
       build: [
         {
           // `entry` is just an alias for `build.lib.entry` in the corresponding file of `config`.
-          entry: "src/main/main.ts",
+          entry: "src/main/bootstrap.ts",
           config: "vite.main.config.mts",
           target: "main",
         },
@@ -0,0 +1,146 @@
+#!/usr/bin/env tsx
+
+/**
+ * Decode the binary event log (logs/events/*.sslog) to text or JSONL.
+ *
+ * Usage:
+ *   pnpm logs:decode <file-or-dir>... [--format text|jsonl]
+ *                    [--session <id>] [--scope <name>] [--level <min-level>]
+ *
+ * Examples:
+ *   pnpm logs:decode ~/Library/Logs/surasura/events
+ *   pnpm logs:decode events --format jsonl --session 3f2a... > session.jsonl
+ */
+
+import * as fs from "node:fs";
+import * as path from "node:path";
+import {
+  EVENT_LEVELS,
+  decodeSegment,
+  formatEventAsText,
+  type EventLevel,
+  type LogEvent,
+} from "../src/main/event-log/codec";
+
+const SEGMENT_EXT = ".sslog";
+
+interface Options {
+  inputs: string[];
+  format: "text" | "jsonl";
+  session?: string;
+  scope?: string;
+  minLevel: EventLevel;
+}
+
+function printUsage(): void {
+  console.error(
+    "Usage: decode-event-log <file-or-dir>... [--format text|jsonl] [--session <id>] [--scope <name>] [--level <min-level>]",
+  );
+}
+
+function parseArgs(argv: string[]): Options {
+  const options: Options = { inputs: [], format: "text", minLevel: "silly" };
+
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    const next = () => {
+      const value = argv[++i];
+      if (value === undefined) {
+        throw new Error(`Missing value for ${arg}`);
+      }
+      return value;
+    };
+
+    switch (arg) {
+      case "--format": {
+        const format = next();
+        if (format !== "text" && format !== "jsonl") {
+          throw new Error(`Unknown format: ${format}`);
+        }
+        options.format = format;
+        break;
+      }
+      case "--session":
+        options.session = next();
+        break;
+      case "--scope":
+        options.scope = next();
+        break;
+      case "--level": {
+        const level = next() as EventLevel;
+        if (!EVENT_LEVELS.includes(level)) {
+          throw new Error(`Unknown level: ${level}`);
+        }
+        options.minLevel = level;
+        break;
+      }
+      case "-h":
+      case "--help":
+        printUsage();
+        process.exit(0);
+        break;
+      default:
+        options.inputs.push(arg);
+    }
+  }
+
+  if (options.inputs.length === 0) {
+    throw new Error("No input files or directories given");
+  }
+  return options;
+}
+
+function collectSegments(inputs: string[]): string[] {
+  const files: string[] = [];
+  for (const input of inputs) {
+    const stat = fs.statSync(input);
+    if (stat.isDirectory()) {
+      for (const name of fs.readdirSync(input)) {
+        if (name.endsWith(SEGMENT_EXT)) files.push(path.join(input, name));
+      }
+    } else {
+      files.push(input);
+    }
+  }
+  // Segment names embed their start time, so name order is time order
+  return files.sort((a, b) => path.basename(a).localeCompare(path.basename(b)));
+}
+
+function matches(event: LogEvent, options: Options): boolean {
+  if (options.session && event.sessionId !== options.session) return false;
+  if (options.scope && event.scope !== options.scope) return false;
+  return (
+    EVENT_LEVELS.indexOf(event.level) <= EVENT_LEVELS.indexOf(options.minLevel)
+  );
+}
+
+function main(): void {
+  let options: Options;
+  try {
+    options = parseArgs(process.argv.slice(2));
+  } catch (error) {
+    console.error(`✗ ${(error as Error).message}`);
+    printUsage();
+    process.exit(1);
+  }
+
+  for (const file of collectSegments(options.inputs)) {
+    try {
+      for (const event of decodeSegment(fs.readFileSync(file))) {
+        if (!matches(event, options)) continue;
+        const line =
+          options.format === "jsonl"
+            ? JSON.stringify({
+                time: new Date(event.timeMs).toISOString(),
+                ...event,
+              })
+            : formatEventAsText(event);
+        process.stdout.write(line + "\n");
+      }
+    } catch (error) {
+      console.error(`✗ Failed to decode ${file}: ${(error as Error).message}`);
+    }
+  }
+}
+
+main();
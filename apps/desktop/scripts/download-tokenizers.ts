@@ -0,0 +1,53 @@
+#!/usr/bin/env tsx
+
+import * as fs from "node:fs";
+import * as path from "node:path";
+import { createHash } from "node:crypto";
+
+// tiktoken rank files used for exact token counts (see bpe-tokenizer.ts)
+const TOKENIZERS = [
+  {
+    encoding: "o200k_base",
+    url: "https://openaipublic.blob.core.windows.net/encodings/o200k_base.tiktoken",
+    sha256: "446a9538cb6c348e3516120d7c08b09f57c36495e2acfffe59a5bf8b0cfb1a2d",
+  },
+  {
+    encoding: "cl100k_base",
+    url: "https://openaipublic.blob.core.windows.net/encodings/cl100k_base.tiktoken",
+    sha256: "223921b76ee99bde995b7ff738513eef100fb51d18c93597a113bcffe865b2a7",
+  },
+];
+
+const TOKENIZERS_DIR = path.join(__dirname, "..", "models", "tokenizers");
+
+async function main() {
+  fs.mkdirSync(TOKENIZERS_DIR, { recursive: true });
+
+  for (const { encoding, url, sha256 } of TOKENIZERS) {
+    const dest = path.join(TOKENIZERS_DIR, `${encoding}.tiktoken`);
+    if (fs.existsSync(dest)) {
+      console.log(`✓ ${encoding} already exists, skipping`);
+      continue;
+    }
+
+    console.log(`Downloading ${encoding}...`);
+    const response = await fetch(url);
+    if (!response.ok) {
+      throw new Error(`Failed to download ${url}: ${response.status}`);
+    }
+    const contents = Buffer.from(await response.arrayBuffer());
+
+    const digest = createHash("sha256").update(contents).digest("hex");
+    if (digest !== sha256) {
+      throw new Error(`Checksum mismatch for ${encoding}: ${digest}`);
+    }
+
+    fs.writeFileSync(dest, contents);
+    console.log(`✓ ${encoding} (${(contents.length / 1e6).toFixed(1)} MB)`);
+  }
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
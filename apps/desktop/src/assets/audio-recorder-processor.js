@@ -1,8 +1,9 @@
 class AudioRecorderProcessor extends AudioWorkletProcessor {
   constructor() {
     super();
-    this.frameSize = 512; // 32ms at 16kHz
-    this.sampleRate = 16000;
+    // Frames are posted at the context's (native) rate and resampled to
+    // 16kHz by useAudioCapture: 512 samples is ~11ms at 48kHz
+    this.frameSize = 512;
     this.buffer = [];
     
     // Listen for control messages
@@ -35,17 +36,21 @@ class AudioRecorderProcessor extends AudioWorkletProcessor {
     for (let i = 0; i < channelData.length; i++) {
       this.buffer.push(channelData[i]);
     }
+    // Context time just after the newest buffered sample
+    const bufferEnd = currentTime + channelData.length / sampleRate;
 
     // When we have enough samples, send a frame
     while (this.buffer.length >= this.frameSize) {
       const frame = this.buffer.slice(0, this.frameSize);
       this.buffer = this.buffer.slice(this.frameSize);
 
-      // Send frame to main thread
+      // Send frame to main thread, with the context time it ends at
+      // (aligns the pre-roll with the key-down)
       this.port.postMessage({
         type: 'audioFrame',
         frame: new Float32Array(frame),
-        isFinal: false
+        isFinal: false,
+        endTime: bufferEnd - this.buffer.length / sampleRate
       });
     }
 
@@ -147,6 +147,36 @@ export function getLanguageModelCost(
   return LANGUAGE_MODEL_COSTS.find((m) => m.id === modelId);
 }
 
+/**
+ * Estimated USD cost of transcribing `seconds` of audio
+ * (undefined for models without a price)
+ */
+export function estimateSpeechCost(
+  modelId: string,
+  seconds: number,
+): number | undefined {
+  const cost = getSpeechModelCost(modelId);
+  return cost ? (cost.costPerHour * seconds) / 3600 : undefined;
+}
+
+/**
+ * Estimated USD cost of a language model request
+ * (undefined for models without a price, e.g. local models).
+ * OpenRouter IDs such as "openai/gpt-4o-mini" are accepted.
+ */
+export function estimateLanguageCost(
+  modelId: string,
+  inputTokens: number,
+  outputTokens: number,
+): number | undefined {
+  const cost = getLanguageModelCost(modelId.replace(/^openai\//, ""));
+  if (!cost) return undefined;
+  return (
+    (cost.inputCostPer1M * inputTokens + cost.outputCostPer1M * outputTokens) /
+    1_000_000
+  );
+}
+
 /**
  * Get speech models by provider
  */
@@ -0,0 +1 @@
+CREATE INDEX `transcriptions_confidence_idx` ON `transcriptions` (`confidence`);
\ No newline at end of file
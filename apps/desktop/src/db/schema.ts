@@ -1,5 +1,11 @@
 import { sql } from "drizzle-orm";
-import { sqliteTable, text, integer, real } from "drizzle-orm/sqlite-core";
+import {
+  sqliteTable,
+  text,
+  integer,
+  real,
+  index,
+} from "drizzle-orm/sqlite-core";
 
 // Transcriptions table
 export const transcriptions = sqliteTable("transcriptions", {
@@ -10,7 +16,7 @@ export const transcriptions = sqliteTable("transcriptions", {
     .default(sql`(unixepoch())`),
   language: text("language").default("en"),
   audioFile: text("audio_file"), // Path to the audio file
-  confidence: real("confidence"), // AI confidence score (0-1)
+  confidence: real("confidence"), // Speech model confidence (0-1, see transcript-confidence)
   duration: integer("duration"), // Duration in seconds
   speechModel: text("speech_model"), // Model used for speech recognition
   formattingModel: text("formatting_model"), // Model used for formatting
@@ -21,7 +27,10 @@ export const transcriptions = sqliteTable("transcriptions", {
   updatedAt: integer("updated_at", { mode: "timestamp" })
     .notNull()
     .default(sql`(unixepoch())`),
-});
+}, (table) => [
+  // Finding low-confidence dictations (e.g. to re-decode them)
+  index("transcriptions_confidence_idx").on(table.confidence),
+]);
 
 // Vocabulary table
 export const vocabulary = sqliteTable("vocabulary", {
@@ -71,10 +80,12 @@ export interface AppSettingsData {
       instructions: string; // 最大1000文字
       isDefault: boolean;
       color: "yellow" | "blue" | "green" | "red" | "purple" | "orange"; // プリセットの色
+      cleanupOnly?: boolean; // 整形のみ（文体や形式を変えない）
       createdAt: string; // ISO 8601
       updatedAt: string;
     }>; // 最大5つ
     activePresetId?: string | null;
+    bypassMode?: "off" | "shadow" | "on"; // 整形不要な文字起こしでLLMを省略するか
   };
   ui?: {
     theme: "light" | "dark" | "system";
@@ -93,6 +104,19 @@ export interface AppSettingsData {
     silenceThreshold: number;
     maxRecordingDuration: number;
     preferredMicrophoneName?: string;
+    // Clean-up stages before VAD and transcription (see audio-enhancer;
+    // default: all on). Enabled stages replace the browser's own.
+    audioEnhancement?: {
+      highPass: boolean;
+      noiseSuppression: boolean;
+      autoGain: boolean;
+    };
+    // How long the microphone stays open after a recording so the next
+    // one starts without getUserMedia (default 10 s, 0: close at once)
+    micStandbyMs?: number;
+    // Audio from the key-down until capture starts, kept from standby and
+    // prepended to the recording (default 0: off, at most 1000 ms)
+    preRollMs?: number;
   };
   shortcuts?: {
     pushToTalk?: string[];
@@ -110,8 +134,20 @@ export interface AppSettingsData {
     openai?: {
       apiKey: string;
     };
+    openrouter?: {
+      apiKey: string;
+      model?: string; // Fallback formatting model (default: openai/<model>)
+    };
+    llamaCpp?: {
+      enabled: boolean; // Format locally (offline) before trying cloud providers
+      serverPath: string; // llama.cpp llama-server binary
+      modelPath: string; // Quantized GGUF model (memory-mapped)
+      threads?: number; // CPU threads (default: chosen by llama.cpp)
+      contextSize?: number; // Context window in tokens (default: 4096)
+    };
     defaultSpeechModel?: string; // Model ID for default speech model (Whisper)
     defaultLanguageModel?: string; // Model ID for default language model
+    speechUploadEncoding?: "flac" | "wav"; // Audio format sent to Whisper (default: flac)
   };
 
   dictation?: {
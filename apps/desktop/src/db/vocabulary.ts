@@ -164,6 +164,22 @@ export async function trackWordUsage(word: string) {
   return result[0] || null;
 }
 
+// Increment usage count for words that appeared in a transcription
+export async function incrementVocabularyUsage(ids: number[]) {
+  if (ids.length === 0) {
+    return [];
+  }
+
+  return await db
+    .update(vocabulary)
+    .set({
+      usageCount: sql`coalesce(${vocabulary.usageCount}, 0) + 1`,
+      updatedAt: new Date(),
+    })
+    .where(inArray(vocabulary.id, ids))
+    .returning();
+}
+
 // Get most frequently used words
 export async function getMostUsedWords(limit = 10) {
   return await db
@@ -2,10 +2,50 @@ import { useRef, useEffect, useState, useCallback } from "react";
 import audioWorkletUrl from "@/assets/audio-recorder-processor.js?url";
 import { api } from "@/trpc/react";
 import { Mutex } from "async-mutex";
+import { PolyphaseResampler } from "@/utils/polyphase-resampler";
+import { DEFAULT_AUDIO_ENHANCEMENT } from "@/pipeline/core/audio-enhancer";
+import {
+  DEFAULT_MIC_STANDBY_MS,
+  DeviceIdResolver,
+} from "@/utils/microphone-standby";
+import { DEFAULT_PRE_ROLL_MS, PreRollBuffer } from "@/utils/pre-roll-buffer";
 
 // Audio configuration
 const FRAME_SIZE = 512; // 32ms at 16kHz
-const SAMPLE_RATE = 16000;
+const SAMPLE_RATE = 16000; // What VAD and transcription expect
+
+function concatSamples(a: Float32Array, b: Float32Array): Float32Array {
+  if (a.length === 0) return b;
+  if (b.length === 0) return a;
+  const joined = new Float32Array(a.length + b.length);
+  joined.set(a);
+  joined.set(b, a.length);
+  return joined;
+}
+
+/**
+ * Split 16 kHz samples (after any left over from the previous call) into
+ * frames of FRAME_SIZE. The final call also returns the remainder as a
+ * shorter last frame.
+ */
+function splitFrames(
+  pending: Float32Array,
+  samples: Float32Array,
+  isFinal: boolean,
+): { frames: Float32Array[]; pending: Float32Array } {
+  const buffered = concatSamples(pending, samples);
+  const frames: Float32Array[] = [];
+  let offset = 0;
+  while (buffered.length - offset >= FRAME_SIZE) {
+    frames.push(buffered.subarray(offset, offset + FRAME_SIZE));
+    offset += FRAME_SIZE;
+  }
+  if (isFinal) {
+    frames.push(buffered.subarray(offset));
+    return { frames, pending: new Float32Array(0) };
+  }
+  return { frames, pending: buffered.slice(offset) };
+}
 
 export interface UseAudioCaptureParams {
   onAudioChunk: (
@@ -14,21 +54,122 @@ export interface UseAudioCaptureParams {
     isFinalChunk: boolean,
   ) => Promise<void> | void;
   enabled: boolean;
+  /** Key-down that started the recording (epoch ms), to align the pre-roll */
+  triggeredAt?: number | null;
 }
 
 export interface UseAudioCaptureOutput {
   voiceDetected: boolean;
 }
 
+/** Receives the worklet's frames for one recording */
+interface RecordingSink {
+  handleFrame(frame: Float32Array, isFinal: boolean): Promise<void>;
+}
+
+/** Open microphone feeding the worklet, kept alive during standby */
+interface CaptureGraph {
+  stream: MediaStream;
+  source: MediaStreamAudioSourceNode;
+  // Microphone and constraints it was opened with
+  key: string;
+}
+
+/**
+ * Resample a recording's frames to 16kHz, split them into FRAME_SIZE frames
+ * and hand them to `onAudioChunk`. The resampler lives with the sink so the
+ * final frame, which arrives after stopCapture(), still goes through it.
+ */
+function createRecordingSink(
+  contextRate: number,
+  onAudioChunk: UseAudioCaptureParams["onAudioChunk"],
+): RecordingSink {
+  // No resampler when the device runs at 16kHz
+  const resampler =
+    contextRate === SAMPLE_RATE
+      ? null
+      : new PolyphaseResampler(contextRate, SAMPLE_RATE);
+  // Resampled samples not yet sent as a full frame
+  let pendingSamples: Float32Array = new Float32Array(0);
+  console.log(
+    resampler
+      ? `AudioCapture: Capturing at ${contextRate}Hz, resampling to ${SAMPLE_RATE}Hz (filter latency ${resampler.latencyMs.toFixed(2)}ms)`
+      : `AudioCapture: Capturing at ${contextRate}Hz`,
+  );
+
+  // Track first frame timing
+  let firstFrameReceived = false;
+  const firstFrameStartTime = performance.now();
+
+  return {
+    async handleFrame(frame, isFinal) {
+      if (!firstFrameReceived) {
+        firstFrameReceived = true;
+        const firstFrameDuration = performance.now() - firstFrameStartTime;
+        console.log(
+          `AudioCapture: First audio frame received after ${firstFrameDuration.toFixed(2)}ms`,
+        );
+      }
+
+      console.debug("AudioCapture: Received frame", {
+        frameLength: frame.length,
+        isFinal,
+      });
+
+      // Resample to 16kHz; the final frame also takes the tail still held
+      // back by the filter
+      let samples: Float32Array = frame;
+      if (resampler) {
+        samples = resampler.process(frame);
+        if (isFinal) samples = concatSamples(samples, resampler.flush());
+      }
+      const { frames, pending } = splitFrames(pendingSamples, samples, isFinal);
+      pendingSamples = pending;
+
+      // Send to main process for VAD processing
+      // Main process will update voice detection state.
+      // All frames are handed over before awaiting so they stay in order
+      // with the next worklet message.
+      await Promise.all(
+        frames.map((speechFrame, i) =>
+          onAudioChunk(
+            // Convert to ArrayBuffer for IPC
+            speechFrame.buffer.slice(
+              speechFrame.byteOffset,
+              speechFrame.byteOffset + speechFrame.byteLength,
+            ),
+            0, // Speech probability will come from main
+            isFinal && i === frames.length - 1,
+          ),
+        ),
+      );
+    },
+  };
+}
+
 export const useAudioCapture = ({
   onAudioChunk,
   enabled,
+  triggeredAt,
 }: UseAudioCaptureParams): UseAudioCaptureOutput => {
   const [voiceDetected, setVoiceDetected] = useState(false);
+  // The context and worklet node outlive recordings; the graph outlives
+  // them for the standby period
   const audioContextRef = useRef<AudioContext | null>(null);
-  const sourceRef = useRef<MediaStreamAudioSourceNode | null>(null);
   const workletNodeRef = useRef<AudioWorkletNode | null>(null);
-  const streamRef = useRef<MediaStream | null>(null);
+  const graphRef = useRef<CaptureGraph | null>(null);
+  // Recording receiving frames, and the stopped one still waiting for its
+  // final frame. Frames with neither (standby) are discarded.
+  const sinkRef = useRef<RecordingSink | null>(null);
+  const closingSinkRef = useRef<RecordingSink | null>(null);
+  const standbyTimerRef = useRef<ReturnType<typeof setTimeout> | null>(null);
+  // Standby audio kept for the next recording, when pre-roll is enabled
+  const preRollRef = useRef<PreRollBuffer | null>(null);
+  const triggeredAtRef = useRef(triggeredAt);
+  triggeredAtRef.current = triggeredAt;
+  const deviceResolverRef = useRef(
+    new DeviceIdResolver(() => navigator.mediaDevices.enumerateDevices()),
+  );
   const mutexRef = useRef(new Mutex());
 
   // Subscribe to voice detection updates via tRPC
@@ -45,6 +186,64 @@ export const useAudioCapture = ({
   // Get user's preferred microphone from settings
   const { data: settings } = api.settings.getSettings.useQuery();
   const preferredMicrophoneName = settings?.recording?.preferredMicrophoneName;
+  // Stages the main process runs itself (see audio-enhancer) replace the
+  // browser's, which differ per platform and device
+  const enhancement = {
+    ...DEFAULT_AUDIO_ENHANCEMENT,
+    ...settings?.recording?.audioEnhancement,
+  };
+  const browserNoiseSuppression = !enhancement.noiseSuppression;
+  const browserAutoGain = !enhancement.autoGain;
+  const standbyMs = settings?.recording?.micStandbyMs ?? DEFAULT_MIC_STANDBY_MS;
+  const preRollMs = settings?.recording?.preRollMs ?? DEFAULT_PRE_ROLL_MS;
+
+  /**
+   * Close the microphone and suspend the context (kept for the next
+   * recording). Call inside the mutex.
+   */
+  const releaseGraph = useCallback(async () => {
+    if (standbyTimerRef.current) {
+      clearTimeout(standbyTimerRef.current);
+      standbyTimerRef.current = null;
+    }
+
+    const graph = graphRef.current;
+    graphRef.current = null;
+    preRollRef.current = null;
+    if (graph) {
+      // Disconnect nodes
+      graph.source.disconnect();
+      // Stop media stream
+      graph.stream.getTracks().forEach((track) => track.stop());
+    }
+
+    // Suspend audio context (keep it alive for next recording)
+    if (
+      audioContextRef.current &&
+      audioContextRef.current.state === "running"
+    ) {
+      await audioContextRef.current.suspend();
+      console.log("AudioCapture: AudioContext suspended (ready for reuse)");
+    }
+  }, []);
+
+  /**
+   * Standby audio captured since the key-down, at the context's rate.
+   * Empties the pre-roll.
+   */
+  const takePreRoll = useCallback((context: AudioContext): Float32Array => {
+    const preRoll = preRollRef.current;
+    preRollRef.current = null;
+    const keyDownAt = triggeredAtRef.current;
+    if (!preRoll || !keyDownAt) return new Float32Array(0);
+
+    // Key-down on the context clock (currentTime: the last render quantum,
+    // a few ms behind). keyDownAt is the main process's Date.now(); compare
+    // it with the wall clock, as performance.now() falls behind it after
+    // sleep
+    const sinceKeyDownMs = Math.max(0, Date.now() - keyDownAt);
+    return preRoll.takeSince(context.currentTime * 1000 - sinceKeyDownMs);
+  }, []);
 
   const startCapture = useCallback(async () => {
     await mutexRef.current.runExclusive(async () => {
@@ -52,31 +251,74 @@ export const useAudioCapture = ({
         const overallStartTime = performance.now();
         console.log("AudioCapture: Starting audio capture");
 
-        // Build audio constraints
+        if (standbyTimerRef.current) {
+          clearTimeout(standbyTimerRef.current);
+          standbyTimerRef.current = null;
+        }
+
+        // Warm standby: the microphone is still open with the same
+        // settings, so only the frames' destination changes
+        const graphKey = JSON.stringify([
+          preferredMicrophoneName ?? null,
+          browserNoiseSuppression,
+          browserAutoGain,
+        ]);
+        const standby = graphRef.current;
+        if (
+          standby &&
+          standby.key === graphKey &&
+          audioContextRef.current?.state === "running" &&
+          standby.stream
+            .getAudioTracks()
+            .every((track) => track.readyState === "live")
+        ) {
+          const preRoll = takePreRoll(audioContextRef.current);
+          const sink = createRecordingSink(
+            audioContextRef.current.sampleRate,
+            onAudioChunk,
+          );
+          sinkRef.current = sink;
+          const warmDuration = performance.now() - overallStartTime;
+          console.log(
+            `AudioCapture: Warm restart from standby took ${warmDuration.toFixed(2)}ms`,
+          );
+
+          // Audio since the key-down goes first; frames arriving meanwhile
+          // are handed over after it
+          if (preRoll.length > 0) {
+            const preRollDuration =
+              (preRoll.length / audioContextRef.current.sampleRate) * 1000;
+            console.log(
+              `AudioCapture: Prepending ${preRollDuration.toFixed(0)}ms of pre-roll`,
+            );
+            await sink.handleFrame(preRoll, false);
+          }
+          return;
+        }
+        if (standby) await releaseGraph();
+
+        // Build audio constraints (no sample rate: capture at the device's
+        // native rate and resample with a known filter)
         const audioConstraints: MediaTrackConstraints = {
           channelCount: 1,
-          sampleRate: SAMPLE_RATE,
           echoCancellation: true,
-          noiseSuppression: true,
-          autoGainControl: true,
+          noiseSuppression: browserNoiseSuppression,
+          autoGainControl: browserAutoGain,
         };
 
         // Add deviceId if user has a preference
         if (preferredMicrophoneName) {
-          const enumerateStartTime = performance.now();
-          const devices = await navigator.mediaDevices.enumerateDevices();
-          const enumerateDuration = performance.now() - enumerateStartTime;
+          const resolveStartTime = performance.now();
+          const deviceId = await deviceResolverRef.current.resolve(
+            preferredMicrophoneName,
+          );
+          const resolveDuration = performance.now() - resolveStartTime;
           console.log(
-            `AudioCapture: enumerateDevices took ${enumerateDuration.toFixed(2)}ms`,
+            `AudioCapture: Device lookup took ${resolveDuration.toFixed(2)}ms`,
           );
 
-          const preferredDevice = devices.find(
-            (device) =>
-              device.kind === "audioinput" &&
-              device.label === preferredMicrophoneName,
-          );
-          if (preferredDevice) {
-            audioConstraints.deviceId = { exact: preferredDevice.deviceId };
+          if (deviceId) {
+            audioConstraints.deviceId = { exact: deviceId };
             console.log(
               "AudioCapture: Using preferred microphone:",
               preferredMicrophoneName,
@@ -86,7 +328,7 @@ export const useAudioCapture = ({
 
         // Get microphone stream
         const getUserMediaStartTime = performance.now();
-        streamRef.current = await navigator.mediaDevices.getUserMedia({
+        const stream = await navigator.mediaDevices.getUserMedia({
           audio: audioConstraints,
         });
         const getUserMediaDuration = performance.now() - getUserMediaStartTime;
@@ -108,9 +350,7 @@ export const useAudioCapture = ({
           );
         } else if (!audioContextRef.current) {
           // Create new context (first time only)
-          audioContextRef.current = new AudioContext({
-            sampleRate: SAMPLE_RATE,
-          });
+          audioContextRef.current = new AudioContext();
           const audioContextDuration =
             performance.now() - audioContextStartTime;
           console.log(
@@ -131,55 +371,51 @@ export const useAudioCapture = ({
 
         // Create nodes
         const nodeCreationStartTime = performance.now();
-        sourceRef.current = audioContextRef.current.createMediaStreamSource(
-          streamRef.current,
-        );
-        workletNodeRef.current = new AudioWorkletNode(
-          audioContextRef.current,
-          "audio-recorder-processor",
-        );
+        if (!workletNodeRef.current) {
+          workletNodeRef.current = new AudioWorkletNode(
+            audioContextRef.current,
+            "audio-recorder-processor",
+          );
+
+          // Handle audio frames from worklet
+          workletNodeRef.current.port.onmessage = async (event) => {
+            if (event.data.type !== "audioFrame") return;
+            const isFinal = event.data.isFinal || false;
+
+            // Frames up to the final one belong to the recording being
+            // stopped; the rest to the current one, if any
+            const sink = closingSinkRef.current ?? sinkRef.current;
+            if (isFinal && sink === closingSinkRef.current) {
+              closingSinkRef.current = null;
+            }
+            if (!sink) {
+              // Standby: never sent, only kept for the pre-roll
+              if (event.data.endTime !== undefined) {
+                preRollRef.current?.write(
+                  event.data.frame,
+                  event.data.endTime * 1000,
+                );
+              }
+              return;
+            }
+
+            await sink.handleFrame(event.data.frame, isFinal);
+          };
+        }
+        const source = audioContextRef.current.createMediaStreamSource(stream);
         const nodeCreationDuration = performance.now() - nodeCreationStartTime;
         console.log(
           `AudioCapture: Node creation took ${nodeCreationDuration.toFixed(2)}ms`,
         );
 
-        // Track first frame timing
-        let firstFrameReceived = false;
-        const firstFrameStartTime = performance.now();
-
-        // Handle audio frames from worklet
-        workletNodeRef.current.port.onmessage = async (event) => {
-          if (event.data.type === "audioFrame") {
-            if (!firstFrameReceived) {
-              firstFrameReceived = true;
-              const firstFrameDuration =
-                performance.now() - firstFrameStartTime;
-              console.log(
-                `AudioCapture: First audio frame received after ${firstFrameDuration.toFixed(2)}ms`,
-              );
-            }
-
-            const frame = event.data.frame;
-            console.debug("AudioCapture: Received frame", {
-              frameLength: frame.length,
-              isFinal: event.data.isFinal,
-            });
-            const isFinal = event.data.isFinal || false;
-
-            // Convert to ArrayBuffer for IPC
-            const arrayBuffer = frame.buffer.slice(
-              frame.byteOffset,
-              frame.byteOffset + frame.byteLength,
-            );
-
-            // Send to main process for VAD processing
-            // Main process will update voice detection state
-            await onAudioChunk(arrayBuffer, 0, isFinal); // Speech probability will come from main
-          }
-        };
+        sinkRef.current = createRecordingSink(
+          audioContextRef.current.sampleRate,
+          onAudioChunk,
+        );
 
         // Connect audio graph
-        sourceRef.current.connect(workletNodeRef.current);
+        source.connect(workletNodeRef.current);
+        graphRef.current = { stream, source, key: graphKey };
 
         const overallDuration = performance.now() - overallStartTime;
         console.log(
@@ -191,51 +427,79 @@ export const useAudioCapture = ({
         throw error;
       }
     });
-  }, [onAudioChunk, preferredMicrophoneName]);
+  }, [
+    onAudioChunk,
+    preferredMicrophoneName,
+    browserNoiseSuppression,
+    browserAutoGain,
+    releaseGraph,
+    takePreRoll,
+  ]);
 
   const stopCapture = useCallback(async () => {
     await mutexRef.current.runExclusive(async () => {
       try {
         console.log("AudioCapture: Stopping audio capture");
 
-        // Send flush command to worklet before disconnecting
-        if (workletNodeRef.current) {
+        // Send flush command to worklet; its final frame ends the recording
+        if (workletNodeRef.current && sinkRef.current) {
+          closingSinkRef.current = sinkRef.current;
+          sinkRef.current = null;
           workletNodeRef.current.port.postMessage({ type: "flush" });
           console.log("AudioCapture: Sent flush command to worklet");
         }
 
-        // Disconnect nodes
-        if (sourceRef.current && workletNodeRef.current) {
-          sourceRef.current.disconnect(workletNodeRef.current);
-        }
-
-        // Suspend audio context (keep it alive for next recording)
-        if (
-          audioContextRef.current &&
-          audioContextRef.current.state === "running"
-        ) {
-          await audioContextRef.current.suspend();
-          console.log("AudioCapture: AudioContext suspended (ready for reuse)");
-        }
-
-        // Stop media stream
-        if (streamRef.current) {
-          streamRef.current.getTracks().forEach((track) => track.stop());
+        if (standbyMs > 0 && graphRef.current && audioContextRef.current) {
+          // Keep the microphone open for a back-to-back recording
+          preRollRef.current =
+            preRollMs > 0
+              ? new PreRollBuffer(audioContextRef.current.sampleRate, preRollMs)
+              : null;
+          standbyTimerRef.current = setTimeout(() => {
+            mutexRef.current
+              .runExclusive(async () => {
+                if (!sinkRef.current) await releaseGraph();
+              })
+              .then(() => console.log("AudioCapture: Standby ended"))
+              .catch((error) => {
+                console.error("AudioCapture: Error ending standby:", error);
+              });
+          }, standbyMs);
+          console.log(
+            `AudioCapture: Audio capture stopped, microphone on standby for ${standbyMs}ms`,
+          );
+          return;
         }
 
-        // Clear refs
-        audioContextRef.current = null;
-        sourceRef.current = null;
-        workletNodeRef.current = null;
-        streamRef.current = null;
-
+        await releaseGraph();
         console.log("AudioCapture: Audio capture stopped");
       } catch (error) {
         console.error("AudioCapture: Error during stop:", error);
         throw error;
       }
     });
-  }, []);
+  }, [standbyMs, preRollMs, releaseGraph]);
+
+  // Device IDs are cached until the set of devices changes. The standby
+  // microphone is closed then too, so the next recording opens the
+  // preferred (or new default) device.
+  useEffect(() => {
+    const mediaDevices = navigator.mediaDevices;
+    const handleDeviceChange = () => {
+      deviceResolverRef.current.invalidate();
+      mutexRef.current
+        .runExclusive(async () => {
+          if (!sinkRef.current && graphRef.current) await releaseGraph();
+        })
+        .catch((error) => {
+          console.error("AudioCapture: Error ending standby:", error);
+        });
+    };
+    mediaDevices.addEventListener("devicechange", handleDeviceChange);
+    return () => {
+      mediaDevices.removeEventListener("devicechange", handleDeviceChange);
+    };
+  }, [releaseGraph]);
 
   // Start/stop based on enabled state
   useEffect(() => {
@@ -254,6 +518,22 @@ export const useAudioCapture = ({
     };
   }, [enabled, startCapture, stopCapture]);
 
+  // Close everything on unmount (after the stop above)
+  useEffect(() => {
+    return () => {
+      mutexRef.current
+        .runExclusive(async () => {
+          await releaseGraph();
+          await audioContextRef.current?.close();
+          audioContextRef.current = null;
+          workletNodeRef.current = null;
+        })
+        .catch((error) => {
+          console.error("AudioCapture: Error closing audio capture:", error);
+        });
+    };
+  }, [releaseGraph]);
+
   return {
     voiceDetected,
   };
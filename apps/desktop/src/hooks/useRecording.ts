@@ -7,6 +7,8 @@ import type { RecordingMode } from "@/main/managers/recording-manager";
 export interface RecordingStatus {
   state: RecordingState;
   mode: RecordingMode;
+  /** Key-down that started the recording (epoch ms) */
+  triggeredAt?: number | null;
 }
 
 export interface UseRecordingOutput {
@@ -69,6 +71,7 @@ export const useRecording = (): UseRecordingOutput => {
   const { voiceDetected } = useAudioCapture({
     onAudioChunk: handleAudioChunk,
     enabled: isActive,
+    triggeredAt: recordingStatus.triggeredAt,
   });
 
   const startRecording = useCallback(async () => {
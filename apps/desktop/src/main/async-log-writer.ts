@@ -0,0 +1,295 @@
+import fs from "node:fs";
+import path from "node:path";
+
+/**
+ * AsyncLogWriter - non-blocking, batched file writer for log records
+ *
+ * Records are pushed into a fixed-size in-memory ring and written to disk in
+ * batches by a background flush. The logging call itself never touches the
+ * file system, and records are only formatted into text when they are
+ * flushed. Callers pass arguments through snapshotLogArgs, which copies
+ * plain objects one level deep: nested objects and class instances are
+ * still read at flush time (up to flushIntervalMs later), the price of not
+ * formatting on the hot path. Under pressure (ring above the high
+ * watermark) debug records are dropped first; when the ring is completely
+ * full the oldest record is overwritten. Drop counts are written to the log
+ * on the next flush. Both flush paths rotate at maxFileSize.
+ */
+
+export type LogRecordLevel =
+  | "error"
+  | "warn"
+  | "info"
+  | "verbose"
+  | "debug"
+  | "silly";
+
+export interface AsyncLogWriterOptions<T> {
+  filePath: string;
+  format?: (record: T) => string; // Called at flush time; defaults to String
+  maxFileSize: number; // Rotate to <name>.old.log when exceeded
+  capacity?: number; // Max buffered records
+  flushIntervalMs?: number;
+  highWatermark?: number; // Fraction of capacity above which debug is dropped
+}
+
+export interface AsyncLogWriterStats {
+  buffered: number;
+  writtenBytes: number;
+  droppedDebug: number;
+  droppedOverflow: number;
+  writeErrors: number;
+}
+
+const DEFAULT_CAPACITY = 4096;
+const DEFAULT_FLUSH_INTERVAL_MS = 250;
+const DEFAULT_HIGH_WATERMARK = 0.75;
+
+function isLowPriority(level: LogRecordLevel): boolean {
+  return level === "debug" || level === "silly" || level === "verbose";
+}
+
+/**
+ * Shallow copy of plain-object arguments, so a record shows the fields as
+ * they were at log time (nested values are still shared until the flush)
+ */
+export function snapshotLogArgs(args: unknown[]): unknown[] {
+  return args.map((arg) => {
+    if (arg === null || typeof arg !== "object") return arg;
+    const proto = Object.getPrototypeOf(arg);
+    return proto === Object.prototype || proto === null ? { ...arg } : arg;
+  });
+}
+
+export class AsyncLogWriter<T = string> {
+  private readonly filePath: string;
+  private readonly format: (record: T) => string;
+  private readonly maxFileSize: number;
+  private readonly capacity: number;
+  private readonly flushIntervalMs: number;
+  private readonly dropDebugAbove: number;
+
+  // Ring buffer (single-threaded: head/count only touched on the main thread)
+  private readonly ring: (T | undefined)[];
+  private head = 0;
+  private count = 0;
+
+  private flushTimer: NodeJS.Timeout | null = null;
+  private flushing: Promise<void> | null = null;
+  private fileSize: number | null = null; // Lazily read from disk
+  private dirReady = false;
+
+  // Drops since the last report, plus lifetime totals for stats
+  private pendingDroppedDebug = 0;
+  private pendingDroppedOverflow = 0;
+  private stats: AsyncLogWriterStats = {
+    buffered: 0,
+    writtenBytes: 0,
+    droppedDebug: 0,
+    droppedOverflow: 0,
+    writeErrors: 0,
+  };
+
+  constructor(options: AsyncLogWriterOptions<T>) {
+    this.filePath = options.filePath;
+    this.format = options.format ?? String;
+    this.maxFileSize = options.maxFileSize;
+    this.capacity = options.capacity ?? DEFAULT_CAPACITY;
+    this.flushIntervalMs = options.flushIntervalMs ?? DEFAULT_FLUSH_INTERVAL_MS;
+    this.dropDebugAbove = Math.floor(
+      this.capacity * (options.highWatermark ?? DEFAULT_HIGH_WATERMARK),
+    );
+    this.ring = new Array(this.capacity);
+  }
+
+  /**
+   * Enqueue a record. O(1), never blocks on I/O or formats.
+   */
+  write(record: T, level: LogRecordLevel): void {
+    if (this.count >= this.dropDebugAbove && isLowPriority(level)) {
+      this.pendingDroppedDebug++;
+      this.stats.droppedDebug++;
+      return;
+    }
+
+    if (this.count === this.capacity) {
+      // Overwrite the oldest record
+      this.head = (this.head + 1) % this.capacity;
+      this.count--;
+      this.pendingDroppedOverflow++;
+      this.stats.droppedOverflow++;
+    }
+
+    this.ring[(this.head + this.count) % this.capacity] = record;
+    this.count++;
+    this.scheduleFlush();
+  }
+
+  getStats(): AsyncLogWriterStats {
+    return { ...this.stats, buffered: this.count };
+  }
+
+  /**
+   * Flush buffered records asynchronously. Concurrent calls share one write.
+   */
+  flush(): Promise<void> {
+    if (this.flushing) {
+      return this.flushing.then(() =>
+        this.count > 0 ? this.flush() : undefined,
+      );
+    }
+    if (this.count === 0 && !this.hasPendingDrops()) {
+      return Promise.resolve();
+    }
+
+    const batch = this.drain();
+    this.flushing = this.writeBatch(batch).finally(() => {
+      this.flushing = null;
+    });
+    return this.flushing;
+  }
+
+  /**
+   * Flush synchronously. Used on process exit where async I/O won't complete.
+   */
+  flushSync(): void {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    if (this.count === 0 && !this.hasPendingDrops()) return;
+
+    const batch = this.drain();
+    try {
+      this.ensureDirSync();
+      const bytes = Buffer.byteLength(batch);
+      this.rotateIfNeededSync(bytes);
+      fs.appendFileSync(this.filePath, batch);
+      this.fileSize = (this.fileSize ?? 0) + bytes;
+      this.stats.writtenBytes += bytes;
+    } catch {
+      this.stats.writeErrors++;
+      this.fileSize = null;
+    }
+  }
+
+  private scheduleFlush(): void {
+    if (this.flushTimer) return;
+    this.flushTimer = setTimeout(() => {
+      this.flushTimer = null;
+      void this.flush();
+    }, this.flushIntervalMs);
+    // Never keep the process alive just to flush logs
+    this.flushTimer.unref?.();
+  }
+
+  private hasPendingDrops(): boolean {
+    return this.pendingDroppedDebug > 0 || this.pendingDroppedOverflow > 0;
+  }
+
+  /**
+   * Format all buffered records into a single string, prefixed by a drop report
+   */
+  private drain(): string {
+    const lines: string[] = [];
+
+    if (this.hasPendingDrops()) {
+      lines.push(
+        `[${new Date().toISOString()}] [warn] [logger] Log records dropped under pressure: debug=${this.pendingDroppedDebug}, overflow=${this.pendingDroppedOverflow}`,
+      );
+      this.pendingDroppedDebug = 0;
+      this.pendingDroppedOverflow = 0;
+    }
+
+    for (let i = 0; i < this.count; i++) {
+      const index = (this.head + i) % this.capacity;
+      try {
+        lines.push(this.format(this.ring[index]!));
+      } catch {
+        // A throwing inspect/toString must not lose the rest of the batch
+        this.stats.writeErrors++;
+      }
+      this.ring[index] = undefined;
+    }
+    this.head = 0;
+    this.count = 0;
+
+    return lines.join("\n") + "\n";
+  }
+
+  private async writeBatch(batch: string): Promise<void> {
+    try {
+      if (!this.dirReady) {
+        await fs.promises.mkdir(path.dirname(this.filePath), {
+          recursive: true,
+        });
+        this.dirReady = true;
+      }
+
+      const bytes = Buffer.byteLength(batch);
+      await this.rotateIfNeeded(bytes);
+      await fs.promises.appendFile(this.filePath, batch);
+      this.fileSize = (this.fileSize ?? 0) + bytes;
+      this.stats.writtenBytes += bytes;
+    } catch {
+      // Nowhere to report a failing log file; count it and keep going
+      this.stats.writeErrors++;
+      this.fileSize = null;
+    }
+  }
+
+  private async rotateIfNeeded(incomingBytes: number): Promise<void> {
+    if (this.fileSize === null) {
+      try {
+        this.fileSize = (await fs.promises.stat(this.filePath)).size;
+      } catch {
+        this.fileSize = 0;
+      }
+    }
+
+    if (this.fileSize + incomingBytes <= this.maxFileSize) return;
+
+    const archivePath = this.archivePath();
+    try {
+      await fs.promises.rm(archivePath, { force: true });
+      await fs.promises.rename(this.filePath, archivePath);
+    } catch {
+      // If rotation fails, keep appending to the current file
+    }
+    this.fileSize = 0;
+  }
+
+  /** rotateIfNeeded for flushSync */
+  private rotateIfNeededSync(incomingBytes: number): void {
+    if (this.fileSize === null) {
+      try {
+        this.fileSize = fs.statSync(this.filePath).size;
+      } catch {
+        this.fileSize = 0;
+      }
+    }
+
+    if (this.fileSize + incomingBytes <= this.maxFileSize) return;
+
+    const archivePath = this.archivePath();
+    try {
+      fs.rmSync(archivePath, { force: true });
+      fs.renameSync(this.filePath, archivePath);
+    } catch {
+      // If rotation fails, keep appending to the current file
+    }
+    this.fileSize = 0;
+  }
+
+  private archivePath(): string {
+    // Same naming as electron-log's file transport: surasura.log -> surasura.old.log
+    const { dir, name, ext } = path.parse(this.filePath);
+    return path.join(dir, `${name}.old${ext}`);
+  }
+
+  private ensureDirSync(): void {
+    if (this.dirReady) return;
+    fs.mkdirSync(path.dirname(this.filePath), { recursive: true });
+    this.dirReady = true;
+  }
+}
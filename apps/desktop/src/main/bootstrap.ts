@@ -0,0 +1,34 @@
+/**
+ * Main process bootstrap
+ *
+ * Enables Node's on-disk V8 compile cache before the main bundle is loaded so
+ * that subsequent launches (including launch-at-login) skip parsing and
+ * compiling the bundle. Keep this file tiny: everything imported here is
+ * compiled without the cache.
+ */
+import { app } from "electron";
+import module from "node:module";
+import path from "node:path";
+import { markStartup, setCompileCacheStatus } from "./core/startup-trace";
+
+markStartup("bootstrap");
+
+try {
+  // Available since Node 22.1 (Electron 32+)
+  const result = module.enableCompileCache?.(
+    path.join(app.getPath("userData"), "compile-cache"),
+  );
+  if (result) {
+    const statusName =
+      Object.entries(module.constants.compileCacheStatus).find(
+        ([, value]) => value === result.status,
+      )?.[0] ?? String(result.status);
+    setCompileCacheStatus(statusName.toLowerCase());
+  }
+} catch (error) {
+  setCompileCacheStatus(`error: ${error}`);
+}
+
+// Load the real entry point after the compile cache is enabled.
+// eslint-disable-next-line @typescript-eslint/no-require-imports
+require("./main.js");
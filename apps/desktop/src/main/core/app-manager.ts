@@ -1,5 +1,4 @@
 import { app, ipcMain, shell, systemPreferences } from "electron";
-import { initializeDatabase } from "../../db";
 import { logger } from "../logger";
 import { WindowManager } from "./window-manager";
 import { setupApplicationMenu } from "../menu";
@@ -8,7 +7,12 @@ import { TrayManager } from "../managers/tray-manager";
 import { createIPCHandler } from "electron-trpc-experimental/main";
 import { router } from "../../trpc/router";
 import { createContext } from "../../trpc/context";
-import { cleanupAudioFiles } from "../../utils/audio-file-cleanup";
+import { startMetricsServer, stopMetricsServer } from "../metrics/server";
+import {
+  buildStartupTrace,
+  markStartup,
+  writeStartupTrace,
+} from "./startup-trace";
 import {
   type OnboardingService,
   getAccessibilityStatus,
@@ -29,13 +33,9 @@ export class AppManager {
   }
 
   async initialize(): Promise<void> {
-    await this.initializeDatabase();
-
-    // Clean up old audio files on startup
-    await cleanupAudioFiles();
-    logger.main.info("Audio file cleanup completed");
-
+    // Database, settings and services are brought up by the startup graph
     await this.serviceManager.initialize();
+    markStartup("services-initialized");
 
     // Initialize tRPC handler (services must be ready first)
     this.trpcHandler = createIPCHandler({
@@ -74,10 +74,12 @@ export class AppManager {
     if (onboardingCheck.needed) {
       await onboardingService.startOnboardingFlow();
       await this.windowManager.createOrShowOnboardingWindow();
+      this.serviceManager.runDeferredStartupTasks();
     } else {
       await this.setupWindows();
       // Start permission monitoring after normal app startup
       onboardingService.startPermissionMonitoring();
+      this.deferUntilFirstPaint();
     }
 
     await this.setupMenu();
@@ -106,16 +108,56 @@ export class AppManager {
       logger.main.debug("Opening external URL", { url });
     });
 
+    // Opt-in Prometheus endpoint for soak tests (METRICS_PORT)
+    startMetricsServer();
+
     // Auto-update is now handled by update-electron-app in main.ts
 
     logger.main.info("Application initialized successfully");
   }
 
-  private async initializeDatabase(): Promise<void> {
-    await initializeDatabase();
-    logger.db.info(
-      "Database initialized and migrations completed successfully",
+  /**
+   * Run non-critical startup work once the widget has painted, and write the
+   * startup trace (process start -> widget ready).
+   */
+  private deferUntilFirstPaint(): void {
+    const DEFERRED_TASKS_FALLBACK_MS = 5000;
+    let done = false;
+
+    const runDeferred = (trigger: "ready-to-show" | "timeout") => {
+      if (done) return;
+      done = true;
+      clearTimeout(fallbackTimer);
+
+      markStartup(`widget-${trigger}`);
+      const trace = buildStartupTrace(this.serviceManager.getStartupReport());
+      logger.main.info("Startup benchmark", {
+        trigger,
+        timeToWidgetReadyMs: Math.round(performance.now()),
+        compileCache: trace.compileCache,
+        openedAtLogin: trace.openedAtLogin,
+        marks: Object.fromEntries(
+          trace.marks.map((m) => [m.name, Math.round(m.atMs)]),
+        ),
+      });
+
+      this.serviceManager.runDeferredStartupTasks();
+
+      writeStartupTrace(trace).catch((error) => {
+        logger.main.warn("Failed to write startup trace", { error });
+      });
+    };
+
+    // Fallback in case the widget never reports ready-to-show
+    const fallbackTimer = setTimeout(
+      () => runDeferred("timeout"),
+      DEFERRED_TASKS_FALLBACK_MS,
     );
+    fallbackTimer.unref?.();
+
+    this.windowManager
+      .whenWidgetReady()
+      .then(() => runDeferred("ready-to-show"));
   }
 
   private setupOnboardingEventListeners(
@@ -301,6 +343,7 @@ export class AppManager {
     }
 
     await this.serviceManager.cleanup();
+    stopMetricsServer();
     if (this.windowManager) {
       this.windowManager.cleanup();
     }
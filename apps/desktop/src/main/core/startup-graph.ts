@@ -0,0 +1,166 @@
+/**
+ * StartupGraph - Declarative dependency graph for application startup
+ *
+ * Each task declares the tasks it depends on. A task starts as soon as all of
+ * its dependencies have finished, so independent tasks (e.g. VAD model load,
+ * database migrations, native helper spawn) run concurrently.
+ */
+
+export interface StartupTask {
+  name: string;
+  dependsOn?: string[];
+  run: () => Promise<void> | void;
+  // Failure of an optional task is recorded but does not block dependents
+  optional?: boolean;
+}
+
+export type StartupTaskStatus = "ok" | "failed" | "skipped";
+
+export interface StartupTaskTiming {
+  name: string;
+  status: StartupTaskStatus;
+  startedAtMs: number; // Relative to graph start
+  durationMs: number;
+  error?: unknown;
+}
+
+export interface StartupReport {
+  totalMs: number;
+  tasks: StartupTaskTiming[];
+}
+
+export class StartupGraphError extends Error {
+  constructor(
+    message: string,
+    readonly report: StartupReport,
+    cause?: unknown,
+  ) {
+    super(message, { cause });
+    this.name = "StartupGraphError";
+  }
+}
+
+export class StartupGraph {
+  private tasks = new Map<string, StartupTask>();
+
+  add(task: StartupTask): this {
+    if (this.tasks.has(task.name)) {
+      throw new Error(`Duplicate startup task: ${task.name}`);
+    }
+    this.tasks.set(task.name, task);
+    return this;
+  }
+
+  /**
+   * Validate the graph: every dependency must exist and there must be no cycles
+   */
+  validate(): void {
+    const visiting = new Set<string>();
+    const visited = new Set<string>();
+
+    const visit = (name: string, path: string[]) => {
+      if (visited.has(name)) return;
+      if (visiting.has(name)) {
+        throw new Error(
+          `Startup task cycle detected: ${[...path, name].join(" -> ")}`,
+        );
+      }
+      const task = this.tasks.get(name);
+      if (!task) {
+        throw new Error(
+          `Unknown startup task dependency: ${name} (required by ${path[path.length - 1]})`,
+        );
+      }
+      visiting.add(name);
+      for (const dep of task.dependsOn ?? []) {
+        visit(dep, [...path, name]);
+      }
+      visiting.delete(name);
+      visited.add(name);
+    };
+
+    for (const name of this.tasks.keys()) {
+      visit(name, []);
+    }
+  }
+
+  /**
+   * Run all tasks, starting each one as soon as its dependencies are done.
+   * Rejects with StartupGraphError if a required task fails; tasks that depend
+   * on a failed required task are skipped.
+   */
+  async run(): Promise<StartupReport> {
+    this.validate();
+
+    const graphStart = performance.now();
+    const timings = new Map<string, StartupTaskTiming>();
+    const results = new Map<string, Promise<boolean>>();
+
+    // Resolves to true when dependents may proceed
+    const runTask = (task: StartupTask): Promise<boolean> => {
+      let result = results.get(task.name);
+      if (result) return result;
+
+      result = (async () => {
+        const depResults = await Promise.all(
+          (task.dependsOn ?? []).map((dep) => runTask(this.tasks.get(dep)!)),
+        );
+
+        const startedAt = performance.now();
+        if (depResults.some((ok) => !ok)) {
+          timings.set(task.name, {
+            name: task.name,
+            status: "skipped",
+            startedAtMs: startedAt - graphStart,
+            durationMs: 0,
+          });
+          return false;
+        }
+
+        try {
+          await task.run();
+          timings.set(task.name, {
+            name: task.name,
+            status: "ok",
+            startedAtMs: startedAt - graphStart,
+            durationMs: performance.now() - startedAt,
+          });
+          return true;
+        } catch (error) {
+          timings.set(task.name, {
+            name: task.name,
+            status: "failed",
+            startedAtMs: startedAt - graphStart,
+            durationMs: performance.now() - startedAt,
+            error,
+          });
+          return !!task.optional;
+        }
+      })();
+
+      results.set(task.name, result);
+      return result;
+    };
+
+    await Promise.all([...this.tasks.values()].map(runTask));
+
+    const report: StartupReport = {
+      totalMs: performance.now() - graphStart,
+      // Keep declaration order for stable reports
+      tasks: [...this.tasks.keys()].map((name) => timings.get(name)!),
+    };
+
+    const failed = report.tasks.find(
+      (t) => t.status === "failed" && !this.tasks.get(t.name)!.optional,
+    );
+    if (failed) {
+      throw new StartupGraphError(
+        `Startup task "${failed.name}" failed`,
+        report,
+        failed.error,
+      );
+    }
+
+    return report;
+  }
+}
@@ -0,0 +1,74 @@
+import { app } from "electron";
+import fs from "node:fs";
+import path from "node:path";
+import type { StartupReport } from "./startup-graph";
+
+/**
+ * Startup trace - records named milestones from process start until the first
+ * window is ready, and writes them to a JSON report next to the log file.
+ *
+ * Timestamps are performance.now(), i.e. milliseconds since process start.
+ */
+
+export interface StartupMark {
+  name: string;
+  atMs: number;
+}
+
+export interface StartupTraceReport {
+  version: string;
+  platform: NodeJS.Platform;
+  openedAtLogin: boolean;
+  compileCache: string;
+  marks: StartupMark[];
+  services: StartupReport | null;
+}
+
+const marks: StartupMark[] = [];
+let compileCacheStatus = "disabled";
+
+export function markStartup(name: string): void {
+  marks.push({ name, atMs: performance.now() });
+}
+
+export function setCompileCacheStatus(status: string): void {
+  compileCacheStatus = status;
+}
+
+export function getStartupMarks(): readonly StartupMark[] {
+  return marks;
+}
+
+function wasOpenedAtLogin(): boolean {
+  try {
+    // Only reported on macOS; launch-at-login cost matters most on boot
+    return app.getLoginItemSettings().wasOpenedAtLogin ?? false;
+  } catch {
+    return false;
+  }
+}
+
+export function buildStartupTrace(
+  services: StartupReport | null,
+): StartupTraceReport {
+  return {
+    version: app.getVersion(),
+    platform: process.platform,
+    openedAtLogin: wasOpenedAtLogin(),
+    compileCache: compileCacheStatus,
+    marks: [...marks],
+    services,
+  };
+}
+
+/**
+ * Write the startup trace to <logs>/startup-trace.json (overwritten each launch)
+ */
+export async function writeStartupTrace(
+  trace: StartupTraceReport,
+): Promise<string> {
+  const tracePath = path.join(app.getPath("logs"), "startup-trace.json");
+  await fs.promises.mkdir(path.dirname(tracePath), { recursive: true });
+  await fs.promises.writeFile(tracePath, JSON.stringify(trace, null, 2));
+  return tracePath;
+}
@@ -21,6 +21,7 @@ export class WindowManager {
   private onboardingWindow: BrowserWindow | null = null;
   private widgetDisplayId: number | null = null;
   private themeListenerSetup: boolean = false;
+  private widgetReady: Promise<void> | null = null;
 
   // On Windows, inset from all edges to allow taskbar auto-hide detection
   private readonly widgetEdgeInset = process.platform === "win32" ? 4 : 0;
@@ -239,6 +240,12 @@ export class WindowManager {
 
     this.widgetDisplayId = initialDisplay.id;
 
+    const widgetWindow = this.widgetWindow;
+    this.widgetReady = new Promise<void>((resolve) => {
+      widgetWindow.once("ready-to-show", () => resolve());
+      widgetWindow.once("closed", () => resolve());
+    });
+
     // Set ignore mouse events with forward option - clicks go through except on widget
     this.widgetWindow.setIgnoreMouseEvents(true, { forward: true });
 
@@ -375,6 +382,11 @@ export class WindowManager {
     }
   }
 
+  /** Resolves once the widget window has painted its first frame */
+  whenWidgetReady(): Promise<void> {
+    return this.widgetReady ?? Promise.resolve();
+  }
+
   showWidget(): void {
     if (this.widgetWindow && !this.widgetWindow.isDestroyed()) {
       this.widgetWindow.showInactive();
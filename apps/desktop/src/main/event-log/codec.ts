@@ -0,0 +1,503 @@
+/**
+ * Binary event log codec
+ *
+ * Shared by the main-process transport (encoder) and the offline decoder CLI
+ * (scripts/decode-event-log.ts). Must not import electron.
+ *
+ * Segment layout:
+ *   header  : "SSEL" (4 raw ASCII bytes) | version u8 |
+ *             baseTimeMs varint (epoch ms)
+ *   records : tag u8 followed by
+ *     DEFINE (0x01): id varint | length varint | utf8 bytes
+ *     EVENT  (0x02): deltaMs varint | level u8 | scopeId varint |
+ *                    templateId varint (0 = inline string follows) |
+ *                    paramCount varint | params: value |
+ *                    sessionId varint (0 = none) | fieldCount varint |
+ *                    fields: keyId varint | value
+ *   value   : type u8 followed by
+ *     NULL 0, FALSE 1, TRUE 2, INT 3 (zigzag varint), FLOAT 4 (f64 LE),
+ *     STRING 5 (length varint | utf8), JSON 6 (length varint | utf8)
+ *
+ * Strings (scope, message templates, field keys, session IDs) are interned
+ * per segment, so every segment can be decoded on its own. Messages built
+ * with interpolated values ("Took 12.3ms") are split into a template
+ * ("Took \x01ms") and params, so the template is interned once instead of
+ * once per distinct value.
+ */
+
+export const EVENT_LOG_MAGIC = "SSEL";
+export const EVENT_LOG_VERSION = 2;
+
+const TAG_DEFINE = 0x01;
+const TAG_EVENT = 0x02;
+
+const VALUE_NULL = 0;
+const VALUE_FALSE = 1;
+const VALUE_TRUE = 2;
+const VALUE_INT = 3;
+const VALUE_FLOAT = 4;
+const VALUE_STRING = 5;
+const VALUE_JSON = 6;
+
+export const EVENT_LEVELS = [
+  "error",
+  "warn",
+  "info",
+  "verbose",
+  "debug",
+  "silly",
+] as const;
+export type EventLevel = (typeof EVENT_LEVELS)[number];
+
+export type EventFieldValue = null | boolean | number | string | object;
+
+export interface LogEvent {
+  timeMs: number; // Epoch ms
+  level: EventLevel;
+  scope: string;
+  message: string;
+  sessionId?: string;
+  fields: Record<string, EventFieldValue>;
+}
+
+// Intern table limit per segment; longer tails are written inline
+const MAX_INTERNED_STRINGS = 8192;
+const MAX_INTERNED_LENGTH = 256;
+
+// Marks a param in a message template; control characters do not occur
+// in log messages
+const TEMPLATE_PARAM = "\x01";
+// UUIDs (session IDs) and standalone numbers, including those followed by
+// a unit ("12.34ms"), but not digits inside identifiers ("gpt-4o", "v6")
+const MESSAGE_PARAM =
+  /\b[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}\b|(?<![\w.-])-?\d+(?:\.\d+)?(?![\d.])/gi;
+
+/**
+ * Split a message into an internable template and its params. Numbers are
+ * kept as numbers when they print back identically, so the message is
+ * reconstructed exactly.
+ */
+export function splitMessageTemplate(message: string): {
+  template: string;
+  params: (number | string)[];
+} {
+  const params: (number | string)[] = [];
+  const template = message.replace(MESSAGE_PARAM, (token) => {
+    const number = Number(token);
+    params.push(String(number) === token ? number : token);
+    return TEMPLATE_PARAM;
+  });
+  return { template, params };
+}
+
+function joinMessageTemplate(
+  template: string,
+  params: EventFieldValue[],
+): string {
+  if (params.length === 0) return template;
+  const parts = template.split(TEMPLATE_PARAM);
+  let message = parts[0];
+  for (let i = 1; i < parts.length; i++) {
+    message += String(params[i - 1] ?? "") + parts[i];
+  }
+  return message;
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Byte-level helpers
+// ───────────────────────────────────────────────────────────────────
+
+class ByteWriter {
+  private buf: Buffer;
+  private pos = 0;
+
+  constructor(initialSize = 256) {
+    this.buf = Buffer.allocUnsafe(initialSize);
+  }
+
+  private ensure(n: number): void {
+    if (this.pos + n <= this.buf.length) return;
+    let size = this.buf.length * 2;
+    while (size < this.pos + n) size *= 2;
+    const next = Buffer.allocUnsafe(size);
+    this.buf.copy(next, 0, 0, this.pos);
+    this.buf = next;
+  }
+
+  u8(value: number): void {
+    this.ensure(1);
+    this.buf[this.pos++] = value;
+  }
+
+  varint(value: number): void {
+    // Unsigned LEB128; supports values up to Number.MAX_SAFE_INTEGER
+    this.ensure(8);
+    let v = Math.max(0, Math.floor(value));
+    while (v >= 0x80) {
+      this.buf[this.pos++] = (v % 0x80) | 0x80;
+      v = Math.floor(v / 0x80);
+    }
+    this.buf[this.pos++] = v;
+  }
+
+  zigzag(value: number): void {
+    this.varint(value >= 0 ? value * 2 : -value * 2 - 1);
+  }
+
+  f64(value: number): void {
+    this.ensure(8);
+    this.buf.writeDoubleLE(value, this.pos);
+    this.pos += 8;
+  }
+
+  string(value: string): void {
+    const len = Buffer.byteLength(value);
+    this.varint(len);
+    this.raw(value);
+  }
+
+  /** Bytes of `value` without a length prefix */
+  raw(value: string): void {
+    const len = Buffer.byteLength(value);
+    this.ensure(len);
+    this.buf.write(value, this.pos, "utf8");
+    this.pos += len;
+  }
+
+  take(): Buffer {
+    const out = Buffer.from(this.buf.subarray(0, this.pos));
+    this.pos = 0;
+    return out;
+  }
+}
+
+class ByteReader {
+  pos = 0;
+
+  constructor(private readonly buf: Buffer) {}
+
+  get remaining(): number {
+    return this.buf.length - this.pos;
+  }
+
+  u8(): number {
+    if (this.pos >= this.buf.length) throw new RangeError("Unexpected end");
+    return this.buf[this.pos++];
+  }
+
+  varint(): number {
+    let result = 0;
+    let multiplier = 1;
+    for (;;) {
+      const byte = this.u8();
+      result += (byte & 0x7f) * multiplier;
+      if (byte < 0x80) return result;
+      multiplier *= 0x80;
+    }
+  }
+
+  zigzag(): number {
+    const v = this.varint();
+    return v % 2 === 0 ? v / 2 : -(v + 1) / 2;
+  }
+
+  f64(): number {
+    if (this.remaining < 8) throw new RangeError("Unexpected end");
+    const value = this.buf.readDoubleLE(this.pos);
+    this.pos += 8;
+    return value;
+  }
+
+  string(): string {
+    return this.raw(this.varint());
+  }
+
+  /** `len` bytes as UTF-8, without a length prefix */
+  raw(len: number): string {
+    if (this.remaining < len) throw new RangeError("Unexpected end");
+    const value = this.buf.toString("utf8", this.pos, this.pos + len);
+    this.pos += len;
+    return value;
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Encoder
+// ───────────────────────────────────────────────────────────────────
+
+export class EventLogEncoder {
+  private readonly writer = new ByteWriter();
+  private readonly strings = new Map<string, number>();
+  private lastTimeMs: number;
+
+  constructor(readonly baseTimeMs: number) {
+    this.lastTimeMs = baseTimeMs;
+  }
+
+  /**
+   * Segment header; must be written once at the start of each segment
+   */
+  header(): Buffer {
+    this.writer.raw(EVENT_LOG_MAGIC);
+    this.writer.u8(EVENT_LOG_VERSION);
+    this.writer.varint(this.baseTimeMs);
+    return this.writer.take();
+  }
+
+  /**
+   * Encode one event (plus any new string definitions it needs)
+   */
+  encode(event: LogEvent): Buffer {
+    const scopeId = this.intern(event.scope);
+    const { template, params } = splitMessageTemplate(event.message);
+    const templateId = this.intern(template);
+    const sessionId = event.sessionId ? this.intern(event.sessionId) : 0;
+    const keyIds = Object.keys(event.fields).map((key) => this.intern(key));
+
+    // Timestamps are stored as non-negative deltas so they stay monotonic
+    const timeMs = Math.max(this.lastTimeMs, Math.round(event.timeMs));
+    const delta = timeMs - this.lastTimeMs;
+    this.lastTimeMs = timeMs;
+
+    const w = this.writer;
+    w.u8(TAG_EVENT);
+    w.varint(delta);
+    w.u8(Math.max(0, EVENT_LEVELS.indexOf(event.level)));
+    w.varint(scopeId);
+    w.varint(templateId);
+    if (templateId === 0) w.string(template);
+    w.varint(params.length);
+    for (const param of params) this.encodeValue(param);
+    w.varint(sessionId);
+
+    const values = Object.values(event.fields);
+    w.varint(values.length);
+    for (let i = 0; i < values.length; i++) {
+      w.varint(keyIds[i]);
+      this.encodeValue(values[i]);
+    }
+
+    return w.take();
+  }
+
+  private intern(value: string): number {
+    const existing = this.strings.get(value);
+    if (existing !== undefined) return existing;
+    if (
+      value.length > MAX_INTERNED_LENGTH ||
+      this.strings.size >= MAX_INTERNED_STRINGS
+    ) {
+      return 0;
+    }
+
+    const id = this.strings.size + 1;
+    this.strings.set(value, id);
+    this.writer.u8(TAG_DEFINE);
+    this.writer.varint(id);
+    this.writer.string(value);
+    return id;
+  }
+
+  private encodeValue(value: EventFieldValue | undefined): void {
+    const w = this.writer;
+    if (value === null || value === undefined) {
+      w.u8(VALUE_NULL);
+    } else if (typeof value === "boolean") {
+      w.u8(value ? VALUE_TRUE : VALUE_FALSE);
+    } else if (typeof value === "number") {
+      if (Number.isSafeInteger(value)) {
+        w.u8(VALUE_INT);
+        w.zigzag(value);
+      } else {
+        w.u8(VALUE_FLOAT);
+        w.f64(value);
+      }
+    } else if (typeof value === "string") {
+      w.u8(VALUE_STRING);
+      w.string(value);
+    } else {
+      w.u8(VALUE_JSON);
+      w.string(safeStringify(value));
+    }
+  }
+}
+
+function safeStringify(value: unknown): string {
+  try {
+    return JSON.stringify(value, (_key, v) => {
+      if (v instanceof Error) {
+        return { name: v.name, message: v.message, stack: v.stack };
+      }
+      if (typeof v === "bigint") return v.toString();
+      return v;
+    });
+  } catch {
+    return JSON.stringify(String(value));
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Decoder
+// ───────────────────────────────────────────────────────────────────
+
+/**
+ * Decode one segment. A truncated trailing record (e.g. after a crash) ends
+ * decoding instead of throwing.
+ */
+export function* decodeSegment(buf: Buffer): Generator<LogEvent> {
+  const r = new ByteReader(buf);
+  if (r.raw(EVENT_LOG_MAGIC.length) !== EVENT_LOG_MAGIC) {
+    throw new Error("Not an event log segment");
+  }
+  const version = r.u8();
+  if (version !== EVENT_LOG_VERSION) {
+    throw new Error(`Unsupported event log version: ${version}`);
+  }
+
+  let timeMs = r.varint();
+  const strings = new Map<number, string>();
+  const lookup = (id: number) => strings.get(id) ?? `#${id}`;
+
+  while (r.remaining > 0) {
+    try {
+      const tag = r.u8();
+      if (tag === TAG_DEFINE) {
+        const id = r.varint();
+        strings.set(id, r.string());
+        continue;
+      }
+      if (tag !== TAG_EVENT) {
+        throw new Error(`Unknown record tag: ${tag}`);
+      }
+
+      timeMs += r.varint();
+      const level = EVENT_LEVELS[r.u8()] ?? "info";
+      const scope = lookup(r.varint());
+      const templateId = r.varint();
+      const template = templateId === 0 ? r.string() : lookup(templateId);
+      const params: EventFieldValue[] = [];
+      const paramCount = r.varint();
+      for (let i = 0; i < paramCount; i++) params.push(decodeValue(r));
+      const message = joinMessageTemplate(template, params);
+      const sessionRef = r.varint();
+
+      const fields: Record<string, EventFieldValue> = {};
+      const fieldCount = r.varint();
+      for (let i = 0; i < fieldCount; i++) {
+        const key = lookup(r.varint());
+        fields[key] = decodeValue(r);
+      }
+
+      yield {
+        timeMs,
+        level,
+        scope,
+        message,
+        ...(sessionRef !== 0 && { sessionId: lookup(sessionRef) }),
+        fields,
+      };
+    } catch (error) {
+      if (error instanceof RangeError) return; // Truncated tail
+      throw error;
+    }
+  }
+}
+
+function decodeValue(r: ByteReader): EventFieldValue {
+  const type = r.u8();
+  switch (type) {
+    case VALUE_NULL:
+      return null;
+    case VALUE_FALSE:
+      return false;
+    case VALUE_TRUE:
+      return true;
+    case VALUE_INT:
+      return r.zigzag();
+    case VALUE_FLOAT:
+      return r.f64();
+    case VALUE_STRING:
+      return r.string();
+    case VALUE_JSON:
+      return JSON.parse(r.string());
+    default:
+      throw new Error(`Unknown value type: ${type}`);
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Logger argument mapping
+// ───────────────────────────────────────────────────────────────────
+
+/**
+ * Map electron-log style arguments (message, ...data) onto an event.
+ * Plain-object arguments become fields; a string `sessionId` field is lifted
+ * into the event header so the decoder can filter on it.
+ */
+export function eventFromLogArgs(
+  timeMs: number,
+  level: EventLevel,
+  scope: string,
+  args: unknown[],
+): LogEvent {
+  let message = "";
+  let rest = args;
+  if (typeof args[0] === "string") {
+    message = args[0];
+    rest = args.slice(1);
+  }
+
+  const fields: Record<string, EventFieldValue> = {};
+  rest.forEach((arg, index) => {
+    if (isPlainObject(arg)) {
+      for (const [key, value] of Object.entries(arg)) {
+        fields[key] = toFieldValue(value);
+      }
+    } else {
+      fields[`arg${index}`] = toFieldValue(arg);
+    }
+  });
+
+  let sessionId: string | undefined;
+  if (typeof fields.sessionId === "string") {
+    sessionId = fields.sessionId;
+    delete fields.sessionId;
+  }
+
+  return { timeMs, level, scope, message, sessionId, fields };
+}
+
+function isPlainObject(value: unknown): value is Record<string, unknown> {
+  if (value === null || typeof value !== "object") return false;
+  const proto = Object.getPrototypeOf(value);
+  return proto === Object.prototype || proto === null;
+}
+
+function toFieldValue(value: unknown): EventFieldValue {
+  if (value === undefined) return null;
+  if (value instanceof Error) {
+    return { name: value.name, message: value.message, stack: value.stack };
+  }
+  if (typeof value === "bigint" || typeof value === "symbol") {
+    return value.toString();
+  }
+  if (typeof value === "function") return `[Function ${value.name}]`;
+  return value as EventFieldValue;
+}
+
+/**
+ * Render an event in the same layout as the text log
+ */
+export function formatEventAsText(event: LogEvent): string {
+  const d = new Date(event.timeMs);
+  const pad = (n: number, w = 2) => String(n).padStart(w, "0");
+  const timestamp = `${d.getFullYear()}-${pad(d.getMonth() + 1)}-${pad(d.getDate())} ${pad(d.getHours())}:${pad(d.getMinutes())}:${pad(d.getSeconds())}.${pad(d.getMilliseconds(), 3)}`;
+
+  const fields = event.sessionId
+    ? { sessionId: event.sessionId, ...event.fields }
+    : event.fields;
+  const data =
+    Object.keys(fields).length > 0 ? ` ${safeStringify(fields)}` : "";
+
+  return `[${timestamp}] [${event.level}] [${event.scope}] ${event.message}${data}`;
+}
@@ -0,0 +1,295 @@
+import fs from "node:fs";
+import path from "node:path";
+import { snapshotLogArgs } from "../async-log-writer";
+import {
+  EventLogEncoder,
+  eventFromLogArgs,
+  type EventLevel,
+} from "./codec";
+
+/**
+ * EventLogTransport - writes log records as a compact binary event log
+ *
+ * Log calls only queue the raw (time, level, scope, args) record in a
+ * bounded ring; records are encoded and appended to the current segment
+ * when the batch is flushed. Under pressure (ring above the high watermark)
+ * debug records are dropped first; when the ring is full the oldest record
+ * is overwritten, as in AsyncLogWriter. Segments rotate at segmentMaxBytes
+ * and the oldest segments are deleted when the directory exceeds
+ * diskBudgetBytes. Decode with `pnpm logs:decode <dir>`.
+ */
+
+export interface EventLogTransportOptions {
+  dir: string;
+  segmentMaxBytes?: number;
+  diskBudgetBytes?: number;
+  flushIntervalMs?: number;
+  capacity?: number; // Max queued records
+  highWatermark?: number; // Fraction of capacity above which debug is dropped
+}
+
+export const EVENT_LOG_SEGMENT_EXT = ".sslog";
+
+const DEFAULT_SEGMENT_MAX_BYTES = 1024 * 1024; // 1MB
+const DEFAULT_DISK_BUDGET_BYTES = 10 * 1024 * 1024; // 10MB
+const DEFAULT_FLUSH_INTERVAL_MS = 1000;
+const DEFAULT_CAPACITY = 4096;
+const DEFAULT_HIGH_WATERMARK = 0.75;
+
+interface QueuedRecord {
+  timeMs: number;
+  level: EventLevel;
+  scope: string;
+  args: unknown[];
+}
+
+interface PendingWrite {
+  file: string;
+  chunks: Buffer[];
+}
+
+function isLowPriority(level: EventLevel): boolean {
+  return level === "debug" || level === "silly" || level === "verbose";
+}
+
+export class EventLogTransport {
+  private readonly dir: string;
+  private readonly segmentMaxBytes: number;
+  private readonly diskBudgetBytes: number;
+  private readonly flushIntervalMs: number;
+  private readonly capacity: number;
+  private readonly dropDebugAbove: number;
+
+  // Ring of records not yet encoded (main thread only)
+  private readonly ring: (QueuedRecord | undefined)[];
+  private head = 0;
+  private count = 0;
+  private lastTimeMs = 0;
+  private droppedDebug = 0;
+  private droppedOverflow = 0;
+
+  private encoder: EventLogEncoder | null = null;
+  private segmentFile = "";
+  private segmentBytes = 0;
+
+  private pending: PendingWrite[] = [];
+  private flushTimer: NodeJS.Timeout | null = null;
+  private flushing: Promise<void> | null = null;
+  private dirReady = false;
+  private budgetChecked = false;
+
+  constructor(options: EventLogTransportOptions) {
+    this.dir = options.dir;
+    this.segmentMaxBytes =
+      options.segmentMaxBytes ?? DEFAULT_SEGMENT_MAX_BYTES;
+    this.diskBudgetBytes =
+      options.diskBudgetBytes ?? DEFAULT_DISK_BUDGET_BYTES;
+    this.flushIntervalMs = options.flushIntervalMs ?? DEFAULT_FLUSH_INTERVAL_MS;
+    this.capacity = options.capacity ?? DEFAULT_CAPACITY;
+    this.dropDebugAbove = Math.floor(
+      this.capacity * (options.highWatermark ?? DEFAULT_HIGH_WATERMARK),
+    );
+    this.ring = new Array(this.capacity);
+  }
+
+  /**
+   * Queue a record. O(1); encoding happens at flush time.
+   */
+  write(level: EventLevel, scope: string, args: unknown[]): void {
+    if (this.count >= this.dropDebugAbove && isLowPriority(level)) {
+      this.droppedDebug++;
+      return;
+    }
+
+    if (this.count === this.capacity) {
+      // Overwrite the oldest record
+      this.head = (this.head + 1) % this.capacity;
+      this.count--;
+      this.droppedOverflow++;
+    }
+
+    // Wall clock, so times match surasura.log and the segment file names
+    // across system sleep; clamped so the log stays non-decreasing
+    const timeMs = Math.max(Date.now(), this.lastTimeMs);
+    this.lastTimeMs = timeMs;
+
+    this.ring[(this.head + this.count) % this.capacity] = {
+      timeMs,
+      level,
+      scope,
+      args: snapshotLogArgs(args),
+    };
+    this.count++;
+    this.scheduleFlush();
+  }
+
+  flush(): Promise<void> {
+    if (this.flushing) {
+      return this.flushing.then(() =>
+        this.count > 0 || this.pending.length > 0 ? this.flush() : undefined,
+      );
+    }
+    this.encodeQueued();
+    if (this.pending.length === 0) return Promise.resolve();
+
+    const batch = this.takePending();
+    this.flushing = this.writeBatch(batch).finally(() => {
+      this.flushing = null;
+    });
+    return this.flushing;
+  }
+
+  flushSync(): void {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    this.encodeQueued();
+    if (this.pending.length === 0) return;
+
+    try {
+      if (!this.dirReady) {
+        fs.mkdirSync(this.dir, { recursive: true });
+        this.dirReady = true;
+      }
+      for (const { file, chunks } of this.takePending()) {
+        fs.appendFileSync(file, Buffer.concat(chunks));
+      }
+    } catch {
+      // Best effort on exit
+    }
+  }
+
+  /**
+   * Encode all queued records into pending segment chunks, preceded by a
+   * drop report
+   */
+  private encodeQueued(): void {
+    const hasDrops = this.droppedDebug > 0 || this.droppedOverflow > 0;
+    if (this.count === 0 && !hasDrops) return;
+
+    if (hasDrops) {
+      const timeMs =
+        this.count > 0 ? this.ring[this.head]!.timeMs : this.lastTimeMs;
+      this.encodeRecord({
+        timeMs,
+        level: "warn",
+        scope: "logger",
+        args: [
+          "Event log records dropped under pressure",
+          { debug: this.droppedDebug, overflow: this.droppedOverflow },
+        ],
+      });
+      this.droppedDebug = 0;
+      this.droppedOverflow = 0;
+    }
+
+    for (let i = 0; i < this.count; i++) {
+      const index = (this.head + i) % this.capacity;
+      this.encodeRecord(this.ring[index]!);
+      this.ring[index] = undefined;
+    }
+    this.head = 0;
+    this.count = 0;
+  }
+
+  private encodeRecord(record: QueuedRecord): void {
+    if (!this.encoder || this.segmentBytes >= this.segmentMaxBytes) {
+      this.startSegment(record.timeMs);
+    }
+    try {
+      this.append(
+        this.encoder!.encode(
+          eventFromLogArgs(
+            record.timeMs,
+            record.level,
+            record.scope,
+            record.args,
+          ),
+        ),
+      );
+    } catch {
+      // A record that cannot be encoded must not lose the rest of the batch
+    }
+  }
+
+  private startSegment(timeMs: number): void {
+    this.encoder = new EventLogEncoder(Math.floor(timeMs));
+    this.segmentFile = path.join(
+      this.dir,
+      `events-${this.encoder.baseTimeMs}${EVENT_LOG_SEGMENT_EXT}`,
+    );
+    this.segmentBytes = 0;
+    this.append(this.encoder.header());
+  }
+
+  private append(chunk: Buffer): void {
+    const last = this.pending[this.pending.length - 1];
+    if (last && last.file === this.segmentFile) {
+      last.chunks.push(chunk);
+    } else {
+      this.pending.push({ file: this.segmentFile, chunks: [chunk] });
+    }
+    this.segmentBytes += chunk.length;
+  }
+
+  private takePending(): PendingWrite[] {
+    const batch = this.pending;
+    this.pending = [];
+    return batch;
+  }
+
+  private scheduleFlush(): void {
+    if (this.flushTimer) return;
+    this.flushTimer = setTimeout(() => {
+      this.flushTimer = null;
+      void this.flush();
+    }, this.flushIntervalMs);
+    this.flushTimer.unref?.();
+  }
+
+  private async writeBatch(batch: PendingWrite[]): Promise<void> {
+    try {
+      if (!this.dirReady) {
+        await fs.promises.mkdir(this.dir, { recursive: true });
+        this.dirReady = true;
+      }
+      for (const { file, chunks } of batch) {
+        await fs.promises.appendFile(file, Buffer.concat(chunks));
+      }
+      // Enforce the budget on the first write of this run (segments from
+      // previous launches) and whenever a segment has been rotated
+      const rotated = batch.length > 1 || batch[0].file !== this.segmentFile;
+      if (!this.budgetChecked || rotated) {
+        this.budgetChecked = true;
+        await this.enforceDiskBudget();
+      }
+    } catch {
+      // Logging must never throw into callers
+    }
+  }
+
+  private async enforceDiskBudget(): Promise<void> {
+    const names = (await fs.promises.readdir(this.dir))
+      .filter((name) => name.endsWith(EVENT_LOG_SEGMENT_EXT))
+      .sort(); // events-<epochMs> sorts chronologically
+
+    const sizes = await Promise.all(
+      names.map(async (name) => {
+        try {
+          return (await fs.promises.stat(path.join(this.dir, name))).size;
+        } catch {
+          return 0;
+        }
+      }),
+    );
+
+    let total = sizes.reduce((sum, size) => sum + size, 0);
+    for (let i = 0; i < names.length && total > this.diskBudgetBytes; i++) {
+      const file = path.join(this.dir, names[i]);
+      if (file === this.segmentFile) break;
+      await fs.promises.rm(file, { force: true });
+      total -= sizes[i];
+    }
+  }
+}
@@ -2,9 +2,14 @@ import dotenv from "dotenv";
 dotenv.config();
 
 import log from "electron-log";
+import type { LogLevel, LogMessage } from "electron-log";
 import { app } from "electron";
 import path from "node:path";
+import { formatWithOptions } from "node:util";
 import colors from "ansi-colors";
+import { AsyncLogWriter, snapshotLogArgs } from "./async-log-writer";
+import { EventLogTransport } from "./event-log/transport";
+import type { EventLevel } from "./event-log/codec";
 
 // Configure electron-log immediately when module is imported
 const isDev = process.env.NODE_ENV === "development" || !app.isPackaged;
@@ -26,20 +31,79 @@ const defaultFileLevel: "debug" | "info" =
 const defaultConsoleLevel: "debug" | "warn" =
   isDev || hasDebugScopes ? "debug" : "warn";
 
-log.transports.file.level = envLogLevel || defaultFileLevel;
+const fileLogLevel = envLogLevel || defaultFileLevel;
 log.transports.console.level = envLogLevel || defaultConsoleLevel;
 
-// Configure file transport
-log.transports.file.maxSize = 10 * 1024 * 1024; // 10MB
-log.transports.file.format =
-  "[{y}-{m}-{d} {h}:{i}:{s}.{ms}] [{level}] [{scope}] {text}";
-
 // Set custom log file path
 const logPath = isDev
   ? path.join(app.getPath("userData"), "logs", "surasura-dev.log")
   : path.join(app.getPath("logs"), "surasura.log");
 
-log.transports.file.resolvePathFn = () => logPath;
+function formatTimestamp(date: Date): string {
+  return `${date.getFullYear()}-${String(date.getMonth() + 1).padStart(2, "0")}-${String(date.getDate()).padStart(2, "0")} ${String(date.getHours()).padStart(2, "0")}:${String(date.getMinutes()).padStart(2, "0")}:${String(date.getSeconds()).padStart(2, "0")}.${String(date.getMilliseconds()).padStart(3, "0")}`;
+}
+
+// Disk used by all log files together: the text log and its rotated .old
+// copy get one half, the binary event log the other
+const LOG_DISK_BUDGET_BYTES = 20 * 1024 * 1024; // 20MB
+
+// Configure file transport
+// electron-log's built-in file transport writes synchronously on the main
+// process. Records are instead queued unformatted in a ring buffer and
+// formatted and written in batches by AsyncLogWriter;
+// format: [{y}-{m}-{d} {h}:{i}:{s}.{ms}] [{level}] [{scope}] {text}
+type FileLogRecord = Pick<LogMessage, "date" | "level" | "scope" | "data">;
+
+function formatFileLogRecord(record: FileLogRecord): string {
+  const text = formatWithOptions(
+    { depth: 5, breakLength: Infinity, colors: false },
+    ...record.data,
+  );
+  return `[${formatTimestamp(record.date)}] [${record.level}] [${record.scope ?? ""}] ${text}`;
+}
+
+const asyncFileWriter = new AsyncLogWriter<FileLogRecord>({
+  filePath: logPath,
+  format: formatFileLogRecord,
+  maxFileSize: LOG_DISK_BUDGET_BYTES / 4, // current + .old = half the budget
+});
+
+log.transports.file.level = false;
+log.transports.asyncFile = Object.assign(
+  (message: LogMessage) => {
+    const { date, level, scope, data } = message;
+    asyncFileWriter.write(
+      { date, level, scope, data: snapshotLogArgs(data) },
+      level,
+    );
+  },
+  { level: fileLogLevel as LogLevel, transforms: [] },
+);
+
+// Binary structured event log (logs/events/*.sslog) for support: interned
+// strings and varint fields keep days of history in the other half of the
+// disk budget. Decode with `pnpm logs:decode <dir> [--format jsonl] [--session <id>]`
+const eventLog = new EventLogTransport({
+  dir: path.join(path.dirname(logPath), "events"),
+  diskBudgetBytes: LOG_DISK_BUDGET_BYTES / 2,
+});
+
+log.transports.eventLog = Object.assign(
+  (message: LogMessage) => {
+    eventLog.write(
+      message.level as EventLevel,
+      message.scope ?? "default",
+      message.data,
+    );
+  },
+  { level: fileLogLevel as LogLevel, transforms: [] },
+);
+
+// Write whatever is still buffered before the process exits
+process.on("exit", () => {
+  asyncFileWriter.flushSync();
+  eventLog.flushSync();
+});
 
 // Configure console transport for better development experience
 if (isDev) {
@@ -83,7 +147,7 @@ if (isDev) {
       scopeColorFunctions[scope] || scopeColorFunctions.default;
     const levelColorFn = levelColorFunctions[level] || ((text: string) => text);
 
-    const timestamp = `${message.date.getFullYear()}-${String(message.date.getMonth() + 1).padStart(2, "0")}-${String(message.date.getDate()).padStart(2, "0")} ${String(message.date.getHours()).padStart(2, "0")}:${String(message.date.getMinutes()).padStart(2, "0")}:${String(message.date.getSeconds()).padStart(2, "0")}.${String(message.date.getMilliseconds()).padStart(3, "0")}`;
+    const timestamp = formatTimestamp(message.date);
 
     // Let console.log handle message serialization naturally
     const prefix = `${colors.dim(`[${timestamp}]`)} ${levelColorFn(`[${level}]`)} ${scopeColorFn(`[${scope}]`)}`;
@@ -136,6 +200,44 @@ export function isScopeDebug(scope: string): boolean {
   return debugScopePatterns.some((re) => re.test(scope));
 }
 
+// -----------------------------------------------
+// Cheap level checks for hot paths
+// -----------------------------------------------
+// Use before building expensive log arguments (template strings, objects):
+//   if (isDebugEnabled("transcription")) logger.transcription.debug(`...`);
+const LEVEL_ORDER: Record<string, number> = {
+  error: 0,
+  warn: 1,
+  info: 2,
+  verbose: 3,
+  debug: 4,
+  silly: 5,
+};
+
+const debugEnabledByScope = new Map<string, boolean>();
+
+function transportAllowsDebug(level: unknown): boolean {
+  return (
+    typeof level === "string" && (LEVEL_ORDER[level] ?? -1) >= LEVEL_ORDER.debug
+  );
+}
+
+export function isDebugEnabled(scope: string): boolean {
+  let enabled = debugEnabledByScope.get(scope);
+  if (enabled === undefined) {
+    const anyTransport =
+      transportAllowsDebug(log.transports.asyncFile?.level) ||
+      transportAllowsDebug(log.transports.eventLog?.level) ||
+      transportAllowsDebug(log.transports.console?.level);
+    // With LOG_DEBUG_SCOPES set, debug records for other scopes are dropped by the hook below
+    enabled =
+      anyTransport &&
+      (debugScopePatterns.length === 0 || isScopeDebug(scope));
+    debugEnabledByScope.set(scope, enabled);
+  }
+  return enabled;
+}
+
 // Set up hooks to handle scope-based debug filtering
 if (debugScopePatterns.length > 0) {
   log.hooks.push((message) => {
@@ -180,7 +282,7 @@ export const logger = {
 // Log startup information
 logger.main.info("Logger initialized", {
   isDev,
-  fileLogLevel: log.transports.file.level,
+  fileLogLevel,
   consoleLogLevel: log.transports.console.level,
   envLogLevel: envLogLevel || "not set",
   logPath,
@@ -192,6 +294,17 @@ logger.main.info("Logger initialized", {
 // Export the main logger instance for direct use
 export { log };
 
+/**
+ * Flush buffered file log records (e.g. before copying the log file)
+ */
+export async function flushLogs(): Promise<void> {
+  await Promise.all([asyncFileWriter.flush(), eventLog.flush()]);
+}
+
+export function getLogWriterStats() {
+  return asyncFileWriter.getStats();
+}
+
 // Utility function to create custom scoped loggers
 export function createScopedLogger(scope: string) {
   return createLoggerForScope(scope);
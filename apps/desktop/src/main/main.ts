@@ -7,6 +7,9 @@ import { logger } from "./logger";
 import started from "electron-squirrel-startup";
 import { AppManager } from "./core/app-manager";
 import { isWindows } from "../utils/platform";
+import { markStartup } from "./core/startup-trace";
+
+markStartup("main-module-loaded");
 
 // Setup renderer logging relay (allows renderer to send logs to main process)
 ipcMain.handle(
@@ -51,6 +54,7 @@ app.on("second-instance", () => {
 });
 
 app.whenReady().then(async () => {
+  markStartup("app-ready");
   await appManager.initialize();
 });
 app.on("will-quit", () => appManager.cleanup());
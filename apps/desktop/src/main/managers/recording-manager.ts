@@ -1,7 +1,8 @@
 import { ipcMain, app, clipboard, systemPreferences } from "electron";
 import { EventEmitter } from "node:events";
 import { Mutex } from "async-mutex";
-import { logger, logPerformance } from "../logger";
+import { logger, logPerformance, isDebugEnabled } from "../logger";
+import { metrics } from "../metrics";
 import type { ServiceManager } from "@/main/managers/service-manager";
 import type { RecordingState } from "../../types/recording";
 import type { ShortcutManager } from "./shortcut-manager";
@@ -22,6 +23,14 @@ const QUICK_PRESS_THRESHOLD = 500;
 const NO_AUDIO_TIMEOUT = 5000;
 const STUCK_STATE_TIMEOUT = 10000;
 
+// Counted per frame, so the label sets are bound once
+const framesDroppedInactive = metrics.framesDropped.labels({
+  reason: "inactive",
+});
+const framesDroppedInvalid = metrics.framesDropped.labels({
+  reason: "invalid",
+});
+
 /**
  * Manages recording state and coordinates audio recording across the application
  * Acts as the single source of truth for recording status
@@ -183,6 +192,14 @@ export class RecordingManager extends EventEmitter {
     return this.recordingMode;
   }
 
+  /**
+   * When the shortcut or button that started the current recording was
+   * pressed (epoch ms), for aligning the renderer's pre-roll
+   */
+  public getTriggeredAt(): number | null {
+    return this.recordingInitiatedAt;
+  }
+
   // ═══════════════════════════════════════════════════════════════════
   // EVENT HANDLERS
   // ═══════════════════════════════════════════════════════════════════
@@ -356,6 +373,9 @@ export class RecordingManager extends EventEmitter {
       const vadService = this.serviceManager.getService("vadService");
       vadService.reset();
 
+      // Load the AI SDKs in the background before the first API call
+      this.serviceManager.getService("transcriptionService")?.warmup();
+
       // Refresh accessibility context (TextMarker API for Electron support)
       const nativeBridge = this.serviceManager.getService("nativeBridge");
       nativeBridge.refreshAccessibilityContext();
@@ -455,6 +475,7 @@ export class RecordingManager extends EventEmitter {
       this.recordingState !== "recording" &&
       this.recordingState !== "stopping"
     ) {
+      framesDroppedInactive.inc();
       logger.audio.debug("Discarding audio chunk - not in active state", {
         state: this.recordingState,
         isFinalChunk,
@@ -905,6 +926,7 @@ export class RecordingManager extends EventEmitter {
       "audio-data-chunk",
       async (_event, chunk: ArrayBuffer, isFinalChunk: boolean) => {
         if (!(chunk instanceof ArrayBuffer)) {
+          framesDroppedInvalid.inc();
           logger.audio.error("Received invalid audio chunk type", {
             type: typeof chunk,
           });
@@ -913,10 +935,13 @@ export class RecordingManager extends EventEmitter {
 
         // Convert ArrayBuffer back to Float32Array
         const float32Array = new Float32Array(chunk);
-        logger.audio.debug("Received audio chunk", {
-          samples: float32Array.length,
-          isFinalChunk,
-        });
+        metrics.framesReceived.inc();
+        if (isDebugEnabled("audio")) {
+          logger.audio.debug("Received audio chunk", {
+            samples: float32Array.length,
+            isFinalChunk,
+          });
+        }
 
         await this.handleAudioChunk(float32Array, isFinalChunk);
       },
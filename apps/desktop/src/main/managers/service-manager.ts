@@ -10,7 +10,14 @@ import { WindowManager } from "../core/window-manager";
 import { isMacOS, isWindows } from "../../utils/platform";
 import { OnboardingService } from "../../services/onboarding-service";
 import { runHistoryCleanup } from "../../utils/history-cleanup";
+import { cleanupAudioFiles } from "../../utils/audio-file-cleanup";
 import { initializeSettings } from "../../db/app-settings";
+import { initializeDatabase } from "../../db";
+import {
+  StartupGraph,
+  StartupGraphError,
+  type StartupReport,
+} from "../core/startup-graph";
 
 /**
  * Service map for type-safe service access
@@ -45,6 +52,9 @@ export class ServiceManager {
   private shortcutManager: ShortcutManager | null = null;
   private windowManager: WindowManager | null = null;
 
+  private startupReport: StartupReport | null = null;
+  private deferredTasksStarted = false;
+
   async initialize(): Promise<void> {
     if (this.isInitialized) {
       logger.main.warn(
@@ -53,31 +63,110 @@ export class ServiceManager {
       return;
     }
 
+    // Independent nodes (database, native helper, VAD model) start concurrently.
+    // Non-critical work (updater check, cleanup) is deferred until after first
+    // window paint via runDeferredStartupTasks().
+    const graph = new StartupGraph()
+      .add({
+        name: "database",
+        run: async () => {
+          await initializeDatabase();
+          logger.db.info(
+            "Database initialized and migrations completed successfully",
+          );
+        },
+      })
+      .add({
+        name: "settings",
+        dependsOn: ["database"],
+        run: async () => {
+          // Run settings migrations before any service uses settings
+          await initializeSettings();
+          logger.main.info("Settings migrations complete");
+          this.initializeSettingsService();
+        },
+      })
+      .add({
+        name: "onboarding",
+        dependsOn: ["settings"],
+        run: () => this.initializeOnboardingService(),
+      })
+      .add({ name: "platform", run: () => this.initializePlatformServices() })
+      .add({ name: "vad", run: () => this.initializeVADService() })
+      .add({
+        name: "ai",
+        dependsOn: ["settings", "onboarding", "platform", "vad"],
+        run: () => this.initializeAIServices(),
+      })
+      .add({
+        name: "recording",
+        dependsOn: ["settings"],
+        run: () => this.initializeRecordingManager(),
+      })
+      .add({
+        name: "shortcuts",
+        dependsOn: ["recording", "platform"],
+        run: () => this.initializeShortcutManager(),
+      })
+      .add({ name: "updater", run: () => this.initializeAutoUpdater() });
+
     try {
-      // Run database migrations first (before any service uses settings)
-      await initializeSettings();
-      logger.main.info("Settings migrations complete");
-
-      this.initializeSettingsService();
-      await this.initializeOnboardingService();
-      this.initializePlatformServices();
-      await this.initializeVADService();
-      await this.initializeAIServices();
-      this.initializeRecordingManager();
-      await this.initializeShortcutManager();
-      this.initializeAutoUpdater();
-
-      // Run history cleanup on startup (non-blocking)
-      this.runStartupCleanup();
+      this.startupReport = await graph.run();
 
       this.isInitialized = true;
-      logger.main.info("Services initialized successfully");
+      logger.main.info("Services initialized successfully", {
+        totalMs: Math.round(this.startupReport.totalMs),
+        tasks: this.formatStartupTimings(this.startupReport),
+      });
     } catch (error) {
+      if (error instanceof StartupGraphError) {
+        this.startupReport = error.report;
+        logger.main.error("Failed to initialize services:", error.cause, {
+          tasks: this.formatStartupTimings(error.report),
+        });
+        throw error.cause;
+      }
       logger.main.error("Failed to initialize services:", error);
       throw error;
     }
   }
 
+  private formatStartupTimings(
+    report: StartupReport,
+  ): Record<string, string> {
+    return Object.fromEntries(
+      report.tasks.map((t) => [
+        t.name,
+        `${t.status} +${t.startedAtMs.toFixed(0)}ms (${t.durationMs.toFixed(0)}ms)`,
+      ]),
+    );
+  }
+
+  /**
+   * Per-service initialization timings from the last initialize() run
+   */
+  getStartupReport(): StartupReport | null {
+    return this.startupReport;
+  }
+
+  /**
+   * Run non-critical startup work (update check, history/audio cleanup).
+   * Called by AppManager once the first window has painted.
+   */
+  runDeferredStartupTasks(): void {
+    if (this.deferredTasksStarted) return;
+    this.deferredTasksStarted = true;
+
+    // Run update check asynchronously to not block startup
+    this.autoUpdaterService
+      ?.checkForUpdatesAndNotify()
+      .catch((error) => {
+        logger.updater.error("Startup update check failed", { error });
+      });
+
+    this.runStartupCleanup();
+  }
+
   private initializeSettingsService(): void {
     this.settingsService = new SettingsService();
     logger.main.info("Settings service initialized");
@@ -222,21 +311,24 @@ export class ServiceManager {
   }
 
   private initializeAutoUpdater(): void {
+    // Update check itself is deferred to runDeferredStartupTasks()
     this.autoUpdaterService = new AutoUpdaterService();
-
-    // Run update check asynchronously to not block startup
-    this.autoUpdaterService
-      .checkForUpdatesAndNotify()
-      .catch((error) => {
-        logger.updater.error("Startup update check failed", { error });
-      });
   }
 
   /**
    * Run startup cleanup tasks (non-blocking)
+   * - Audio cleanup: 7日以上経過した音声ファイル、500MBを超えた分を削除
    * - History cleanup: 30日以上経過した履歴を削除、500件を超えた分を削除
    */
   private runStartupCleanup(): void {
+    cleanupAudioFiles()
+      .then(() => {
+        logger.main.info("Audio file cleanup completed");
+      })
+      .catch((error) => {
+        logger.main.error("Startup audio cleanup failed", { error });
+      });
+
     // Run cleanup asynchronously to not block startup
     runHistoryCleanup()
       .then((result) => {
@@ -294,6 +386,9 @@ export class ServiceManager {
       logger.main.info("Stopping native helper...");
       this.nativeBridge.stopHelper();
     }
+
+    // Drop decrypted credentials last; the services above may still use them
+    this.settingsService?.dispose();
   }
 
   getOnboardingService(): OnboardingService | null {
@@ -0,0 +1,182 @@
+import { monitorEventLoopDelay } from "node:perf_hooks";
+import { MetricsRegistry } from "./registry";
+import { getLogWriterStats } from "../logger";
+
+export { MetricsRegistry } from "./registry";
+export type {
+  Labels,
+  MetricsSnapshot,
+  HistogramSummary,
+  BoundCounter,
+  BoundGauge,
+  BoundHistogram,
+} from "./registry";
+
+/**
+ * Application metrics
+ *
+ * Latencies are recorded in milliseconds, sizes in bytes. Scrape via the
+ * tRPC `debug` router or the opt-in localhost endpoint (METRICS_PORT).
+ */
+export const metricsRegistry = new MetricsRegistry();
+
+export const metrics = {
+  // Audio capture → main process
+  framesReceived: metricsRegistry.counter(
+    "surasura_audio_frames_received_total",
+    "Audio frames received from the renderer",
+  ),
+  framesDropped: metricsRegistry.counter(
+    "surasura_audio_frames_dropped_total",
+    "Audio frames discarded before processing, by reason",
+  ),
+
+  // Audio clean-up (see audio-enhancer)
+  enhancementLatency: metricsRegistry.histogram(
+    "surasura_audio_enhancement_latency_ms",
+    "High-pass, noise suppression and AGC time per frame",
+  ),
+
+  // VAD
+  vadLatency: metricsRegistry.histogram(
+    "surasura_vad_latency_ms",
+    "VAD time per frame, frames skipped by the silence gate included",
+  ),
+  vadFramesSkipped: metricsRegistry.counter(
+    "surasura_vad_frames_skipped_total",
+    "Frames the silence gate kept from the VAD model",
+  ),
+
+  // Transcription provider
+  segmentsUploaded: metricsRegistry.counter(
+    "surasura_transcription_segments_uploaded_total",
+    "Audio segments sent to the transcription provider",
+  ),
+  bytesUploaded: metricsRegistry.counter(
+    "surasura_transcription_bytes_uploaded_total",
+    "Audio bytes sent to the transcription provider",
+  ),
+  uploadEncodeLatency: metricsRegistry.histogram(
+    "surasura_transcription_upload_encode_ms",
+    "Encoder CPU time per uploaded segment, by format",
+  ),
+  providerLatency: metricsRegistry.histogram(
+    "surasura_transcription_provider_latency_ms",
+    "Transcription provider request latency",
+  ),
+  flushSplits: metricsRegistry.counter(
+    "surasura_transcription_flush_splits_total",
+    "Final flushes transcribed as parallel sub-segments",
+  ),
+  speechEscalations: metricsRegistry.counter(
+    "surasura_transcription_escalations_total",
+    "Low-confidence segments decoded again with a larger model",
+  ),
+  transcriptionConfidence: metricsRegistry.histogram(
+    "surasura_transcription_confidence",
+    "Speech model confidence of saved transcriptions (0-1)",
+  ),
+  providerErrors: metricsRegistry.counter(
+    "surasura_transcription_provider_errors_total",
+    "Failed transcription provider requests",
+  ),
+
+  // Provider routing (see provider-router)
+  routingDecisions: metricsRegistry.counter(
+    "surasura_routing_decisions_total",
+    "Provider routing decisions (primary, hedge, fallback, ...) by kind",
+  ),
+  circuitOpened: metricsRegistry.counter(
+    "surasura_routing_circuit_opened_total",
+    "Provider circuits opened after a failure storm, by kind",
+  ),
+
+  // Vocabulary correction (see phonetic-matcher)
+  vocabularyMatchLatency: metricsRegistry.histogram(
+    "surasura_vocabulary_match_latency_ms",
+    "Fuzzy vocabulary matching time per transcribed segment",
+  ),
+  vocabularyCorrections: metricsRegistry.counter(
+    "surasura_vocabulary_corrections_total",
+    "Near-miss vocabulary terms replaced after transcription",
+  ),
+
+  // Formatting
+  formatterLatency: metricsRegistry.histogram(
+    "surasura_formatter_latency_ms",
+    "Formatting provider latency",
+  ),
+
+  // Formatter bypass (see format-bypass)
+  formatterBypassDecisions: metricsRegistry.counter(
+    "surasura_formatter_bypass_decisions_total",
+    "Formatter bypass decisions, by decision (bypass or format) and reason",
+  ),
+  formatterBypassShadow: metricsRegistry.counter(
+    "surasura_formatter_bypass_shadow_total",
+    "Formatter output on transcripts classified as bypassable, by outcome",
+  ),
+
+  // Local formatting (llama.cpp)
+  localFormatterTtft: metricsRegistry.histogram(
+    "surasura_local_formatter_ttft_ms",
+    "Time to first generated token of the local formatter",
+  ),
+  localFormatterTokensPerSecond: metricsRegistry.histogram(
+    "surasura_local_formatter_tokens_per_second",
+    "Local formatter decode throughput",
+  ),
+  localFormatterPromptTokens: metricsRegistry.counter(
+    "surasura_local_formatter_prompt_tokens_total",
+    "Local formatter prompt tokens, by source (cached or evaluated)",
+  ),
+
+  // Database
+  dbQueryLatency: metricsRegistry.histogram(
+    "surasura_db_query_latency_ms",
+    "Database query latency by operation",
+  ),
+
+  // Native helper RPC
+  helperRpcLatency: metricsRegistry.histogram(
+    "surasura_helper_rpc_latency_ms",
+    "Native helper RPC round-trip latency by method",
+  ),
+  helperRpcErrors: metricsRegistry.counter(
+    "surasura_helper_rpc_errors_total",
+    "Native helper RPC failures and timeouts by method",
+  ),
+
+  // Logging backend (see async-log-writer)
+  logRecordsDropped: metricsRegistry.gauge(
+    "surasura_log_records_dropped",
+    "Log records dropped by the async file writer since startup",
+  ),
+
+  // Event loop
+  eventLoopLag: metricsRegistry.gauge(
+    "surasura_event_loop_lag_ms",
+    "Main-process event loop delay since the last scrape",
+  ),
+};
+
+// Event loop delay sampling (libuv timer based; negligible overhead)
+const eventLoopDelay = monitorEventLoopDelay({ resolution: 20 });
+eventLoopDelay.enable();
+
+metrics.eventLoopLag.onCollect(() => {
+  // Histogram values are in nanoseconds
+  const toMs = (ns: number) => (Number.isFinite(ns) ? ns / 1e6 : 0);
+  metrics.eventLoopLag.set(toMs(eventLoopDelay.mean), { stat: "mean" });
+  metrics.eventLoopLag.set(toMs(eventLoopDelay.percentile(99)), {
+    stat: "p99",
+  });
+  metrics.eventLoopLag.set(toMs(eventLoopDelay.max), { stat: "max" });
+  eventLoopDelay.reset();
+});
+
+metrics.logRecordsDropped.onCollect(() => {
+  const stats = getLogWriterStats();
+  metrics.logRecordsDropped.set(stats.droppedDebug, { reason: "debug" });
+  metrics.logRecordsDropped.set(stats.droppedOverflow, { reason: "overflow" });
+});
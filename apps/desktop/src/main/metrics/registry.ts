@@ -0,0 +1,409 @@
+/**
+ * Metrics registry - counters, gauges and HDR-style histograms
+ *
+ * Designed to be always on: recording a value is a Map lookup plus an
+ * integer increment, with no allocation, for unlabelled metrics and for
+ * series bound once with `labels()`. Passing labels on each call builds the
+ * series key every time (sort + escape + join), so hot paths keep a bound
+ * series. Everything runs on the main-process thread, so no locking is
+ * needed. Output is Prometheus text exposition format (0.0.4) or a JSON
+ * snapshot for the tRPC debug router.
+ */
+
+export type Labels = Record<string, string>;
+
+/** A counter series bound to one label set (see Counter.labels) */
+export interface BoundCounter {
+  inc(amount?: number): void;
+}
+
+/** A gauge series bound to one label set */
+export interface BoundGauge {
+  set(value: number): void;
+}
+
+/** A histogram series bound to one label set */
+export interface BoundHistogram {
+  record(value: number): void;
+}
+
+function labelKey(labels?: Labels): string {
+  if (!labels) return "";
+  const keys = Object.keys(labels);
+  if (keys.length === 0) return "";
+  keys.sort();
+  return keys.map((k) => `${k}="${escapeLabel(labels[k])}"`).join(",");
+}
+
+function escapeLabel(value: string): string {
+  return value
+    .replace(/\\/g, "\\\\")
+    .replace(/"/g, '\\"')
+    .replace(/\n/g, "\\n");
+}
+
+function formatSeries(name: string, key: string, extra?: string): string {
+  const parts = [key, extra].filter(Boolean).join(",");
+  return parts ? `${name}{${parts}}` : name;
+}
+
+interface Metric {
+  readonly name: string;
+  readonly help: string;
+  render(): string[];
+  reset(): void;
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Counter / Gauge
+// ───────────────────────────────────────────────────────────────────
+
+export class Counter implements Metric {
+  private values = new Map<string, number>();
+
+  constructor(
+    readonly name: string,
+    readonly help: string,
+  ) {}
+
+  inc(labels?: Labels, amount = 1): void {
+    this.add(labelKey(labels), amount);
+  }
+
+  /** Series for one label set, with its key computed once */
+  labels(labels: Labels): BoundCounter {
+    const key = labelKey(labels);
+    return { inc: (amount = 1) => this.add(key, amount) };
+  }
+
+  get(labels?: Labels): number {
+    return this.values.get(labelKey(labels)) ?? 0;
+  }
+
+  reset(): void {
+    this.values.clear();
+  }
+
+  entries(): [string, number][] {
+    return [...this.values.entries()];
+  }
+
+  private add(key: string, amount: number): void {
+    this.values.set(key, (this.values.get(key) ?? 0) + amount);
+  }
+
+  render(): string[] {
+    const lines = [
+      `# HELP ${this.name} ${this.help}`,
+      `# TYPE ${this.name} counter`,
+    ];
+    for (const [key, value] of this.values) {
+      lines.push(`${formatSeries(this.name, key)} ${value}`);
+    }
+    return lines;
+  }
+}
+
+export class Gauge implements Metric {
+  private values = new Map<string, number>();
+  private collector: (() => void) | null = null;
+
+  constructor(
+    readonly name: string,
+    readonly help: string,
+  ) {}
+
+  set(value: number, labels?: Labels): void {
+    this.values.set(labelKey(labels), value);
+  }
+
+  /** Series for one label set, with its key computed once */
+  labels(labels: Labels): BoundGauge {
+    const key = labelKey(labels);
+    return {
+      set: (value) => {
+        this.values.set(key, value);
+      },
+    };
+  }
+
+  get(labels?: Labels): number {
+    return this.values.get(labelKey(labels)) ?? 0;
+  }
+
+  /**
+   * Register a callback that refreshes the gauge right before it is read
+   */
+  onCollect(collector: () => void): this {
+    this.collector = collector;
+    return this;
+  }
+
+  collect(): void {
+    this.collector?.();
+  }
+
+  reset(): void {
+    this.values.clear();
+  }
+
+  entries(): [string, number][] {
+    this.collect();
+    return [...this.values.entries()];
+  }
+
+  render(): string[] {
+    const lines = [
+      `# HELP ${this.name} ${this.help}`,
+      `# TYPE ${this.name} gauge`,
+    ];
+    for (const [key, value] of this.entries()) {
+      lines.push(`${formatSeries(this.name, key)} ${value}`);
+    }
+    return lines;
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Histogram (log-linear buckets, HDR-style)
+// ───────────────────────────────────────────────────────────────────
+
+// 2^SUB_BUCKET_BITS linear sub-buckets per power of two → ~3% relative error
+const SUB_BUCKET_BITS = 5;
+const SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+const MAX_EXPONENT = 30; // Values are clamped to < 2^31 after scaling
+const BUCKET_COUNT =
+  SUB_BUCKET_COUNT + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+const MAX_SCALED_VALUE = 2 ** 31 - 1;
+
+export function bucketIndex(scaled: number): number {
+  if (scaled < SUB_BUCKET_COUNT) return scaled;
+  const exponent = 31 - Math.clz32(scaled);
+  const shift = exponent - SUB_BUCKET_BITS;
+  const sub = (scaled >>> shift) - SUB_BUCKET_COUNT;
+  return SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + sub;
+}
+
+/** Midpoint of a bucket, in scaled units */
+export function bucketValue(index: number): number {
+  if (index < SUB_BUCKET_COUNT) return index;
+  const shift = Math.floor((index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT);
+  const sub = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+  const lower = (SUB_BUCKET_COUNT + sub) * 2 ** shift;
+  return lower + (2 ** shift - 1) / 2;
+}
+
+class HistogramSeries {
+  readonly counts = new Float64Array(BUCKET_COUNT);
+  count = 0;
+  sum = 0;
+  min = Infinity;
+  max = -Infinity;
+
+  record(value: number, scale: number): void {
+    const scaled = Math.min(
+      MAX_SCALED_VALUE,
+      Math.max(0, Math.round(value * scale)),
+    );
+    this.counts[bucketIndex(scaled)]++;
+    this.count++;
+    this.sum += value;
+    if (value < this.min) this.min = value;
+    if (value > this.max) this.max = value;
+  }
+
+  quantile(q: number, scale: number): number {
+    if (this.count === 0) return 0;
+    const rank = Math.max(1, Math.ceil(q * this.count));
+    let seen = 0;
+    for (let i = 0; i < BUCKET_COUNT; i++) {
+      seen += this.counts[i];
+      if (seen >= rank) {
+        // Never report outside the observed range
+        return Math.min(this.max, Math.max(this.min, bucketValue(i) / scale));
+      }
+    }
+    return this.max;
+  }
+}
+
+export interface HistogramSummary {
+  labels: string;
+  count: number;
+  sum: number;
+  min: number;
+  max: number;
+  p50: number;
+  p90: number;
+  p99: number;
+}
+
+const SUMMARY_QUANTILES = [0.5, 0.9, 0.99] as const;
+
+export class Histogram implements Metric {
+  private series = new Map<string, HistogramSeries>();
+
+  /**
+   * @param scale - multiplier applied before bucketing; sets the resolution
+   *   (e.g. 1000 for millisecond values recorded with microsecond precision)
+   */
+  constructor(
+    readonly name: string,
+    readonly help: string,
+    private readonly scale = 1000,
+  ) {}
+
+  record(value: number, labels?: Labels): void {
+    this.recordKey(labelKey(labels), value);
+  }
+
+  /**
+   * Series for one label set, with its key computed once. Looked up on each
+   * record, so the binding survives reset().
+   */
+  labels(labels: Labels): BoundHistogram {
+    const key = labelKey(labels);
+    return { record: (value) => this.recordKey(key, value) };
+  }
+
+  private recordKey(key: string, value: number): void {
+    if (!Number.isFinite(value)) return;
+    let s = this.series.get(key);
+    if (!s) {
+      s = new HistogramSeries();
+      this.series.set(key, s);
+    }
+    s.record(value, this.scale);
+  }
+
+  /**
+   * Record the duration (ms) of an async operation
+   */
+  async time<T>(labels: Labels | undefined, fn: () => Promise<T>): Promise<T> {
+    const start = performance.now();
+    try {
+      return await fn();
+    } finally {
+      this.record(performance.now() - start, labels);
+    }
+  }
+
+  reset(): void {
+    this.series.clear();
+  }
+
+  summaries(): HistogramSummary[] {
+    return [...this.series.entries()].map(([labels, s]) => ({
+      labels,
+      count: s.count,
+      sum: s.sum,
+      min: s.count > 0 ? s.min : 0,
+      max: s.count > 0 ? s.max : 0,
+      p50: s.quantile(0.5, this.scale),
+      p90: s.quantile(0.9, this.scale),
+      p99: s.quantile(0.99, this.scale),
+    }));
+  }
+
+  // Exposed as a Prometheus summary: HDR buckets are too fine-grained to
+  // export one series each
+  render(): string[] {
+    const lines = [
+      `# HELP ${this.name} ${this.help}`,
+      `# TYPE ${this.name} summary`,
+    ];
+    for (const [key, s] of this.series) {
+      for (const q of SUMMARY_QUANTILES) {
+        lines.push(
+          `${formatSeries(this.name, key, `quantile="${q}"`)} ${s.quantile(q, this.scale)}`,
+        );
+      }
+      lines.push(`${formatSeries(`${this.name}_sum`, key)} ${s.sum}`);
+      lines.push(`${formatSeries(`${this.name}_count`, key)} ${s.count}`);
+    }
+    return lines;
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Registry
+// ───────────────────────────────────────────────────────────────────
+
+export interface MetricsSnapshot {
+  counters: { name: string; help: string; labels: string; value: number }[];
+  gauges: { name: string; help: string; labels: string; value: number }[];
+  histograms: ({ name: string; help: string } & HistogramSummary)[];
+}
+
+export class MetricsRegistry {
+  private metrics = new Map<string, Metric>();
+
+  private register<T extends Metric>(metric: T): T {
+    if (this.metrics.has(metric.name)) {
+      throw new Error(`Metric already registered: ${metric.name}`);
+    }
+    this.metrics.set(metric.name, metric);
+    return metric;
+  }
+
+  counter(name: string, help: string): Counter {
+    return this.register(new Counter(name, help));
+  }
+
+  gauge(name: string, help: string): Gauge {
+    return this.register(new Gauge(name, help));
+  }
+
+  histogram(name: string, help: string, scale?: number): Histogram {
+    return this.register(new Histogram(name, help, scale));
+  }
+
+  /**
+   * Clear all recorded values, keeping registrations (used between replay
+   * harness runs)
+   */
+  reset(): void {
+    for (const metric of this.metrics.values()) {
+      metric.reset();
+    }
+  }
+
+  /** Histogram summaries for a single metric */
+  histogramSummaries(name: string): HistogramSummary[] {
+    const metric = this.metrics.get(name);
+    return metric instanceof Histogram ? metric.summaries() : [];
+  }
+
+  toPrometheus(): string {
+    const lines: string[] = [];
+    for (const metric of this.metrics.values()) {
+      lines.push(...metric.render());
+    }
+    return lines.join("\n") + "\n";
+  }
+
+  snapshot(): MetricsSnapshot {
+    const snapshot: MetricsSnapshot = {
+      counters: [],
+      gauges: [],
+      histograms: [],
+    };
+    for (const metric of this.metrics.values()) {
+      const { name, help } = metric;
+      if (metric instanceof Counter) {
+        for (const [labels, value] of metric.entries()) {
+          snapshot.counters.push({ name, help, labels, value });
+        }
+      } else if (metric instanceof Gauge) {
+        for (const [labels, value] of metric.entries()) {
+          snapshot.gauges.push({ name, help, labels, value });
+        }
+      } else if (metric instanceof Histogram) {
+        for (const summary of metric.summaries()) {
+          snapshot.histograms.push({ name, help, ...summary });
+        }
+      }
+    }
+    return snapshot;
+  }
+}
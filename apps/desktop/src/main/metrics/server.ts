@@ -0,0 +1,54 @@
+import http from "node:http";
+import { logger } from "../logger";
+import { metricsRegistry } from "./index";
+
+/**
+ * Opt-in Prometheus scrape endpoint, bound to localhost only.
+ * Enabled by setting METRICS_PORT (e.g. METRICS_PORT=9464).
+ */
+
+let server: http.Server | null = null;
+
+export function getMetricsPort(): number | null {
+  const port = Number(process.env.METRICS_PORT);
+  return Number.isInteger(port) && port > 0 && port < 65536 ? port : null;
+}
+
+export function getMetricsEndpointUrl(): string | null {
+  const port = getMetricsPort();
+  return server && port ? `http://127.0.0.1:${port}/metrics` : null;
+}
+
+export function startMetricsServer(): void {
+  const port = getMetricsPort();
+  if (!port || server) return;
+
+  server = http.createServer((req, res) => {
+    if (req.method !== "GET" || req.url?.split("?")[0] !== "/metrics") {
+      res.writeHead(404).end();
+      return;
+    }
+    res.writeHead(200, {
+      "Content-Type": "text/plain; version=0.0.4; charset=utf-8",
+    });
+    res.end(metricsRegistry.toPrometheus());
+  });
+
+  server.on("error", (error) => {
+    logger.main.error("Metrics endpoint failed", { error, port });
+    server = null;
+  });
+
+  server.listen(port, "127.0.0.1", () => {
+    logger.main.info("Metrics endpoint listening", {
+      url: `http://127.0.0.1:${port}/metrics`,
+    });
+  });
+  // Don't keep the app alive for the metrics endpoint
+  server.unref();
+}
+
+export function stopMetricsServer(): void {
+  server?.close();
+  server = null;
+}
@@ -0,0 +1,323 @@
+/**
+ * Transcript ↔ audio alignment index
+ *
+ * Segment and word timings of a dictation, relative to the start of its
+ * audio file. Lets history search jump to the audio offset of a hit and
+ * playback highlight words without decoding the audio again.
+ *
+ * Stored as a compact binary blob: times are quantised to 10 ms (Whisper's
+ * timestamps are 20 ms apart) and delta-encoded as varints, so a word
+ * usually costs 2-3 bytes of timing plus its UTF-8 text.
+ *
+ *   u8      version
+ *   varint  segment count
+ *   per segment:
+ *     zigzag  start - previous segment end
+ *     varint  duration
+ *     u8      confidence × 254, 255 when unknown (version 2)
+ *     varint  word count
+ *     per word:
+ *       zigzag  start - previous word end (segment start for the first)
+ *       varint  duration
+ *       varint  UTF-8 byte length, then the bytes
+ */
+
+import {
+  whisperSegmentConfidence,
+  type WhisperSegmentScores,
+} from "./transcript-confidence";
+
+export interface AlignedWord {
+  text: string;
+  startMs: number;
+  endMs: number;
+}
+
+export interface AlignedSegment {
+  startMs: number;
+  endMs: number;
+  /** 0-1, when the model reported scores (see transcript-confidence) */
+  confidence?: number;
+  words: AlignedWord[];
+}
+
+const FORMAT_VERSION = 2;
+const NO_CONFIDENCE = 255;
+const TICK_MS = 10;
+
+/** Subset of the `verbose_json` transcription response used here */
+export interface VerboseTranscription {
+  text?: string;
+  segments?:
+    | ({ start: number; end: number; text: string } & WhisperSegmentScores)[]
+    | null;
+  words?: { word: string; start: number; end: number }[] | null;
+}
+
+/**
+ * Segments of a `verbose_json` response, with each word placed in the
+ * segment it starts in. A segment without word timings becomes one word
+ * spanning the segment.
+ */
+export function alignmentFromVerbose(
+  response: VerboseTranscription,
+): AlignedSegment[] {
+  const words = (response.words ?? []).map((word) => ({
+    text: word.word,
+    startMs: word.start * 1000,
+    endMs: word.end * 1000,
+  }));
+  const segments = response.segments ?? [];
+
+  if (segments.length === 0) {
+    if (words.length === 0) return [];
+    return [
+      {
+        startMs: words[0].startMs,
+        endMs: words[words.length - 1].endMs,
+        words,
+      },
+    ];
+  }
+
+  let next = 0;
+  return segments.map((segment, i) => {
+    const startMs = segment.start * 1000;
+    const endMs = segment.end * 1000;
+    const isLast = i === segments.length - 1;
+    const segmentWords: AlignedWord[] = [];
+    while (
+      next < words.length &&
+      (isLast || words[next].startMs < endMs)
+    ) {
+      segmentWords.push(words[next++]);
+    }
+    if (segmentWords.length === 0 && segment.text.trim()) {
+      segmentWords.push({ text: segment.text.trim(), startMs, endMs });
+    }
+    const confidence = whisperSegmentConfidence(segment);
+    return {
+      startMs,
+      endMs,
+      ...(confidence !== null && { confidence }),
+      words: segmentWords,
+    };
+  });
+}
+
+/**
+ * Move segments by `offsetMs` (e.g. to the position of an uploaded part in
+ * the session's audio)
+ */
+export function shiftAlignment(
+  segments: readonly AlignedSegment[],
+  offsetMs: number,
+): AlignedSegment[] {
+  return segments.map((segment) => ({
+    ...segment,
+    startMs: segment.startMs + offsetMs,
+    endMs: segment.endMs + offsetMs,
+    words: segment.words.map((word) => ({
+      text: word.text,
+      startMs: word.startMs + offsetMs,
+      endMs: word.endMs + offsetMs,
+    })),
+  }));
+}
+
+class ByteWriter {
+  private buffer = new Uint8Array(256);
+  length = 0;
+
+  private reserve(bytes: number): void {
+    if (this.length + bytes <= this.buffer.length) return;
+    let size = this.buffer.length * 2;
+    while (size < this.length + bytes) size *= 2;
+    const grown = new Uint8Array(size);
+    grown.set(this.buffer.subarray(0, this.length));
+    this.buffer = grown;
+  }
+
+  byte(value: number): void {
+    this.reserve(1);
+    this.buffer[this.length++] = value;
+  }
+
+  varint(value: number): void {
+    this.reserve(10);
+    let rest = value;
+    while (rest >= 0x80) {
+      this.buffer[this.length++] = (rest % 0x80) | 0x80;
+      rest = Math.floor(rest / 0x80);
+    }
+    this.buffer[this.length++] = rest;
+  }
+
+  zigzag(value: number): void {
+    this.varint(value < 0 ? -2 * value - 1 : 2 * value);
+  }
+
+  bytes(value: Uint8Array): void {
+    this.reserve(value.length);
+    this.buffer.set(value, this.length);
+    this.length += value.length;
+  }
+
+  finish(): Uint8Array {
+    return this.buffer.slice(0, this.length);
+  }
+}
+
+class ByteReader {
+  private offset = 0;
+
+  constructor(private readonly buffer: Uint8Array) {}
+
+  byte(): number {
+    if (this.offset >= this.buffer.length) {
+      throw new Error("Alignment index is truncated");
+    }
+    return this.buffer[this.offset++];
+  }
+
+  varint(): number {
+    let value = 0;
+    let scale = 1;
+    for (;;) {
+      const byte = this.byte();
+      value += (byte & 0x7f) * scale;
+      if (byte < 0x80) return value;
+      scale *= 0x80;
+    }
+  }
+
+  zigzag(): number {
+    const value = this.varint();
+    return value % 2 === 0 ? value / 2 : -(value + 1) / 2;
+  }
+
+  bytes(length: number): Uint8Array {
+    if (this.offset + length > this.buffer.length) {
+      throw new Error("Alignment index is truncated");
+    }
+    const bytes = this.buffer.subarray(this.offset, this.offset + length);
+    this.offset += length;
+    return bytes;
+  }
+}
+
+const ticks = (ms: number) => Math.max(0, Math.round(ms / TICK_MS));
+
+export function encodeAlignment(segments: readonly AlignedSegment[]): Uint8Array {
+  const encoder = new TextEncoder();
+  const writer = new ByteWriter();
+  writer.byte(FORMAT_VERSION);
+  writer.varint(segments.length);
+
+  let previousEnd = 0;
+  for (const segment of segments) {
+    const start = ticks(segment.startMs);
+    const end = Math.max(start, ticks(segment.endMs));
+    writer.zigzag(start - previousEnd);
+    writer.varint(end - start);
+    writer.byte(
+      segment.confidence === undefined
+        ? NO_CONFIDENCE
+        : Math.round(Math.min(1, Math.max(0, segment.confidence)) * 254),
+    );
+    writer.varint(segment.words.length);
+
+    let wordEnd = start;
+    for (const word of segment.words) {
+      const wordStart = ticks(word.startMs);
+      const wordStop = Math.max(wordStart, ticks(word.endMs));
+      writer.zigzag(wordStart - wordEnd);
+      writer.varint(wordStop - wordStart);
+      const text = encoder.encode(word.text);
+      writer.varint(text.length);
+      writer.bytes(text);
+      wordEnd = wordStop;
+    }
+    previousEnd = end;
+  }
+  return writer.finish();
+}
+
+export function decodeAlignment(data: Uint8Array): AlignedSegment[] {
+  const reader = new ByteReader(data);
+  const version = reader.byte();
+  if (version !== 1 && version !== FORMAT_VERSION) {
+    throw new Error(`Unsupported alignment index version: ${version}`);
+  }
+
+  const decoder = new TextDecoder();
+  const segments: AlignedSegment[] = [];
+  const segmentCount = reader.varint();
+  let previousEnd = 0;
+  for (let i = 0; i < segmentCount; i++) {
+    const start = previousEnd + reader.zigzag();
+    const end = start + reader.varint();
+    // Version 1 had no confidence
+    const confidenceByte = version >= 2 ? reader.byte() : NO_CONFIDENCE;
+    const wordCount = reader.varint();
+
+    const words: AlignedWord[] = [];
+    let wordEnd = start;
+    for (let j = 0; j < wordCount; j++) {
+      const wordStart = wordEnd + reader.zigzag();
+      const wordStop = wordStart + reader.varint();
+      const text = decoder.decode(reader.bytes(reader.varint()));
+      words.push({
+        text,
+        startMs: wordStart * TICK_MS,
+        endMs: wordStop * TICK_MS,
+      });
+      wordEnd = wordStop;
+    }
+    segments.push({
+      startMs: start * TICK_MS,
+      endMs: end * TICK_MS,
+      ...(confidenceByte !== NO_CONFIDENCE && {
+        confidence: confidenceByte / 254,
+      }),
+      words,
+    });
+    previousEnd = end;
+  }
+  return segments;
+}
+
+/** Case, width and spacing are ignored when matching text against words */
+function normalizeForMatch(text: string): string {
+  return text
+    .normalize("NFKC")
+    .toLowerCase()
+    .replace(/[\s\p{P}]/gu, "");
+}
+
+/**
+ * Audio offset of the first occurrence of `query` in the aligned words, or
+ * null when it does not occur (e.g. the formatter rewrote that part).
+ * Matches may span several words.
+ */
+export function findAlignedOffset(
+  segments: readonly AlignedSegment[],
+  query: string,
+): number | null {
+  const needle = normalizeForMatch(query);
+  if (!needle) return null;
+
+  // Concatenated word text, with the word each character came from
+  let haystack = "";
+  const owners: AlignedWord[] = [];
+  for (const segment of segments) {
+    for (const word of segment.words) {
+      const text = normalizeForMatch(word.text);
+      haystack += text;
+      for (let i = 0; i < text.length; i++) owners.push(word);
+    }
+  }
+
+  const index = haystack.indexOf(needle);
+  return index >= 0 ? owners[index].startMs : null;
+}
@@ -0,0 +1,376 @@
+/**
+ * Audio clean-up before VAD and transcription
+ *
+ * Replaces the browser's noiseSuppression/autoGainControl constraints, which
+ * behave differently per platform and device, with a fixed chain on the
+ * 16 kHz frames from the renderer:
+ *
+ * 1. High-pass: 2nd-order Butterworth at 80 Hz (rumble, hum, DC)
+ * 2. Noise suppression: STFT (256-point, 50% overlap, sqrt-Hann) with a
+ *    minimum-tracking noise estimate and a decision-directed Wiener gain,
+ *    floored at -18 dB so that residual noise stays natural
+ * 3. AGC: speech level towards -20 dBFS (+20/-12 dB). The gain only moves
+ *    on blocks 10 dB above the tracked noise floor, so pauses and
+ *    background noise are not pumped up. A 5 ms look-ahead limiter at
+ *    -1 dBFS follows.
+ *
+ * Frames are processed in place and come out delayed by `latencySamples`
+ * (21 ms with every stage on); `flush()` drains that tail at the end of a
+ * session. Each stage can be bypassed. Only the high-pass is on by default:
+ * noise suppression and AGC stay opt-in until the replay evaluation
+ * (tests/replay/audio-enhancement) shows no WER regression with them.
+ */
+
+export interface AudioEnhancementConfig {
+  highPass: boolean;
+  noiseSuppression: boolean;
+  autoGain: boolean;
+}
+
+export const DEFAULT_AUDIO_ENHANCEMENT: AudioEnhancementConfig = {
+  highPass: true,
+  noiseSuppression: false,
+  autoGain: false,
+};
+
+const SAMPLE_RATE = 16000;
+
+export function isAudioEnhancementEnabled(
+  config: AudioEnhancementConfig,
+): boolean {
+  return config.highPass || config.noiseSuppression || config.autoGain;
+}
+
+// ───────────────────────────────────────────────────────────────────
+// High-pass
+// ───────────────────────────────────────────────────────────────────
+
+const HIGH_PASS_HZ = 80;
+
+class HighPassFilter {
+  private readonly b0: number;
+  private readonly b1: number;
+  private readonly b2: number;
+  private readonly a1: number;
+  private readonly a2: number;
+  private z1 = 0;
+  private z2 = 0;
+
+  constructor(cutoffHz: number) {
+    // RBJ biquad, Q = 1/sqrt(2)
+    const w0 = (2 * Math.PI * cutoffHz) / SAMPLE_RATE;
+    const alpha = Math.sin(w0) / Math.SQRT2;
+    const cos = Math.cos(w0);
+    const a0 = 1 + alpha;
+    this.b0 = (1 + cos) / 2 / a0;
+    this.b1 = -(1 + cos) / a0;
+    this.b2 = this.b0;
+    this.a1 = (-2 * cos) / a0;
+    this.a2 = (1 - alpha) / a0;
+  }
+
+  process(samples: Float32Array): void {
+    let { z1, z2 } = this;
+    for (let i = 0; i < samples.length; i++) {
+      const x = samples[i];
+      const y = this.b0 * x + z1;
+      z1 = this.b1 * x - this.a1 * y + z2;
+      z2 = this.b2 * x - this.a2 * y;
+      samples[i] = y;
+    }
+    this.z1 = z1;
+    this.z2 = z2;
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Noise suppression
+// ───────────────────────────────────────────────────────────────────
+
+const FFT_SIZE = 256;
+const HOP_SIZE = FFT_SIZE / 2;
+const BINS = FFT_SIZE / 2 + 1;
+const MIN_GAIN = 0.125; // -18 dB
+const PRIOR_SMOOTHING = 0.98; // Decision-directed a priori SNR
+const POWER_SMOOTHING = 0.7;
+const NOISE_RISE = 1.005; // Per hop (8 ms): ~2.7 dB/s
+const WARMUP_HOPS = 8; // Average the first 64 ms as the initial noise
+
+/** In-place radix-2 complex FFT */
+class Fft {
+  private readonly cos: Float64Array;
+  private readonly sin: Float64Array;
+  private readonly reversed: Uint16Array;
+
+  constructor(private readonly size: number) {
+    this.cos = new Float64Array(size / 2);
+    this.sin = new Float64Array(size / 2);
+    for (let i = 0; i < size / 2; i++) {
+      this.cos[i] = Math.cos((2 * Math.PI * i) / size);
+      this.sin[i] = -Math.sin((2 * Math.PI * i) / size);
+    }
+    const bits = Math.log2(size);
+    this.reversed = new Uint16Array(size);
+    for (let i = 0; i < size; i++) {
+      let r = 0;
+      for (let b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+      this.reversed[i] = r;
+    }
+  }
+
+  /** Forward transform; `inverse` conjugates the twiddles (unscaled) */
+  transform(re: Float64Array, im: Float64Array, inverse = false): void {
+    const n = this.size;
+    for (let i = 0; i < n; i++) {
+      const j = this.reversed[i];
+      if (j > i) {
+        [re[i], re[j]] = [re[j], re[i]];
+        [im[i], im[j]] = [im[j], im[i]];
+      }
+    }
+    const sign = inverse ? -1 : 1;
+    for (let length = 2; length <= n; length *= 2) {
+      const half = length / 2;
+      const step = n / length;
+      for (let start = 0; start < n; start += length) {
+        for (let k = 0; k < half; k++) {
+          const wr = this.cos[k * step];
+          const wi = sign * this.sin[k * step];
+          const a = start + k;
+          const b = a + half;
+          const tr = re[b] * wr - im[b] * wi;
+          const ti = re[b] * wi + im[b] * wr;
+          re[b] = re[a] - tr;
+          im[b] = im[a] - ti;
+          re[a] += tr;
+          im[a] += ti;
+        }
+      }
+    }
+  }
+}
+
+class NoiseSuppressor {
+  private readonly fft = new Fft(FFT_SIZE);
+  private readonly window = new Float64Array(FFT_SIZE);
+  private readonly re = new Float64Array(FFT_SIZE);
+  private readonly im = new Float64Array(FFT_SIZE);
+
+  private readonly input = new Float64Array(FFT_SIZE); // Last FFT_SIZE inputs
+  private readonly overlap = new Float64Array(HOP_SIZE);
+  private readonly ready = new Float64Array(HOP_SIZE); // Output being emitted
+  private position = 0; // Samples into the current hop
+
+  private readonly power = new Float64Array(BINS); // Smoothed
+  private readonly noise = new Float64Array(BINS);
+  private readonly previousClean = new Float64Array(BINS); // |G·X|², last hop
+  private hops = 0;
+
+  constructor() {
+    // sqrt-Hann analysis and synthesis windows sum to 1 at 50% overlap
+    for (let i = 0; i < FFT_SIZE; i++) {
+      this.window[i] = Math.sqrt(
+        0.5 - 0.5 * Math.cos((2 * Math.PI * i) / FFT_SIZE),
+      );
+    }
+  }
+
+  process(samples: Float32Array): void {
+    for (let i = 0; i < samples.length; i++) {
+      this.input[HOP_SIZE + this.position] = samples[i];
+      samples[i] = this.ready[this.position];
+      if (++this.position === HOP_SIZE) {
+        this.position = 0;
+        this.processHop();
+        this.input.copyWithin(0, HOP_SIZE);
+      }
+    }
+  }
+
+  private processHop(): void {
+    const { re, im, window } = this;
+    for (let i = 0; i < FFT_SIZE; i++) {
+      re[i] = this.input[i] * window[i];
+      im[i] = 0;
+    }
+    this.fft.transform(re, im);
+
+    this.hops++;
+    for (let k = 0; k < BINS; k++) {
+      const power = re[k] * re[k] + im[k] * im[k];
+      this.power[k] =
+        this.hops === 1
+          ? power
+          : POWER_SMOOTHING * this.power[k] + (1 - POWER_SMOOTHING) * power;
+
+      if (this.hops <= WARMUP_HOPS) {
+        this.noise[k] += (power - this.noise[k]) / this.hops;
+      } else {
+        this.noise[k] = Math.min(this.noise[k] * NOISE_RISE, this.power[k]);
+      }
+
+      const noise = Math.max(this.noise[k], 1e-12);
+      const posterior = power / noise;
+      const prior =
+        PRIOR_SMOOTHING * (this.previousClean[k] / noise) +
+        (1 - PRIOR_SMOOTHING) * Math.max(posterior - 1, 0);
+      const gain = Math.max(MIN_GAIN, prior / (1 + prior));
+      this.previousClean[k] = gain * gain * power;
+
+      re[k] *= gain;
+      im[k] *= gain;
+      // Keep the spectrum conjugate-symmetric
+      if (k > 0 && k < FFT_SIZE / 2) {
+        re[FFT_SIZE - k] = re[k];
+        im[FFT_SIZE - k] = -im[k];
+      }
+    }
+
+    this.fft.transform(re, im, true);
+    for (let i = 0; i < HOP_SIZE; i++) {
+      this.ready[i] = (re[i] * window[i]) / FFT_SIZE + this.overlap[i];
+      this.overlap[i] = (re[i + HOP_SIZE] * window[i + HOP_SIZE]) / FFT_SIZE;
+    }
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// AGC and limiter
+// ───────────────────────────────────────────────────────────────────
+
+const TARGET_LEVEL = 0.1; // -20 dBFS RMS
+const SPEECH_GATE = 0.003; // -50 dBFS: quieter blocks hold the gain
+const SPEECH_OVER_FLOOR = 3.16; // +10 dB over the noise floor
+const FLOOR_RISE = 1.003; // Per block (8 ms): ~3 dB/s
+const DIGITAL_SILENCE = 1e-6;
+const MAX_GAIN = 10; // +20 dB
+const MIN_GAIN_AGC = 0.25; // -12 dB
+const LEVEL_BLOCK = 128; // 8 ms
+const GAIN_ATTACK = 0.3; // Per block, when the gain has to drop
+const GAIN_RELEASE = 0.03; // Per block, when it may rise (~250 ms)
+const CEILING = 0.891; // -1 dBFS
+const LOOKAHEAD = 80; // 5 ms
+const LIMITER_RELEASE = 1 - Math.exp(-1 / (0.05 * SAMPLE_RATE)); // 50 ms
+
+class LookaheadAgc {
+  private gain = 1;
+  private targetGain = 1;
+  private blockEnergy = 0;
+  private blockLength = 0;
+  private noiseFloor = 0;
+
+  // Gained samples waiting LOOKAHEAD samples for the limiter
+  private readonly delay = new Float64Array(LOOKAHEAD);
+  private delayIndex = 0;
+  // Sliding minimum of the limiter gains over the look-ahead window
+  // (monotonic queue of [sample number, gain])
+  private readonly queueAt = new Float64Array(LOOKAHEAD + 1);
+  private readonly queueGain = new Float64Array(LOOKAHEAD + 1);
+  private queueHead = 0;
+  private queueLength = 0;
+  private sampleNumber = 0;
+  private limiterGain = 1;
+
+  process(samples: Float32Array): void {
+    const capacity = LOOKAHEAD + 1;
+    for (let i = 0; i < samples.length; i++) {
+      const x = samples[i];
+
+      // AGC: block level of the incoming (not yet delayed) audio
+      this.blockEnergy += x * x;
+      if (++this.blockLength === LEVEL_BLOCK) {
+        const level = Math.sqrt(this.blockEnergy / LEVEL_BLOCK);
+        // Starts at the first block that is not digital silence
+        this.noiseFloor =
+          this.noiseFloor < DIGITAL_SILENCE
+            ? level
+            : Math.min(this.noiseFloor * FLOOR_RISE, level);
+        if (
+          level > SPEECH_GATE &&
+          level > this.noiseFloor * SPEECH_OVER_FLOOR
+        ) {
+          const wanted = Math.min(
+            MAX_GAIN,
+            Math.max(MIN_GAIN_AGC, TARGET_LEVEL / level),
+          );
+          const rate = wanted < this.targetGain ? GAIN_ATTACK : GAIN_RELEASE;
+          this.targetGain += (wanted - this.targetGain) * rate;
+        }
+        this.blockEnergy = 0;
+        this.blockLength = 0;
+      }
+      // Per-sample smoothing so gain changes do not click
+      this.gain += (this.targetGain - this.gain) * (1 / LEVEL_BLOCK);
+      const gained = x * this.gain;
+
+      // Limiter gain this sample needs, into the sliding-minimum queue
+      const peak = Math.abs(gained);
+      const needed = peak > CEILING ? CEILING / peak : 1;
+      while (
+        this.queueLength > 0 &&
+        this.queueGain[(this.queueHead + this.queueLength - 1) % capacity] >=
+          needed
+      ) {
+        this.queueLength--;
+      }
+      const tail = (this.queueHead + this.queueLength) % capacity;
+      this.queueAt[tail] = this.sampleNumber;
+      this.queueGain[tail] = needed;
+      this.queueLength++;
+      if (this.queueAt[this.queueHead] <= this.sampleNumber - capacity) {
+        this.queueHead = (this.queueHead + 1) % capacity;
+        this.queueLength--;
+      }
+      this.sampleNumber++;
+
+      // Gain drops as soon as a peak enters the window and recovers slowly,
+      // so it is already down when the peak leaves the delay line
+      this.limiterGain = Math.min(
+        this.queueGain[this.queueHead],
+        this.limiterGain + (1 - this.limiterGain) * LIMITER_RELEASE,
+      );
+
+      const delayed = this.delay[this.delayIndex];
+      this.delay[this.delayIndex] = gained;
+      this.delayIndex = (this.delayIndex + 1) % LOOKAHEAD;
+      samples[i] = delayed * this.limiterGain;
+    }
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Chain
+// ───────────────────────────────────────────────────────────────────
+
+export class AudioEnhancer {
+  private readonly highPass: HighPassFilter | null;
+  private readonly noiseSuppressor: NoiseSuppressor | null;
+  private readonly agc: LookaheadAgc | null;
+
+  constructor(config: AudioEnhancementConfig = DEFAULT_AUDIO_ENHANCEMENT) {
+    this.highPass = config.highPass ? new HighPassFilter(HIGH_PASS_HZ) : null;
+    this.noiseSuppressor = config.noiseSuppression
+      ? new NoiseSuppressor()
+      : null;
+    this.agc = config.autoGain ? new LookaheadAgc() : null;
+  }
+
+  /** Delay of the output relative to the input */
+  get latencySamples(): number {
+    return (this.noiseSuppressor ? FFT_SIZE : 0) + (this.agc ? LOOKAHEAD : 0);
+  }
+
+  /** Process one frame of 16 kHz audio in place */
+  process(frame: Float32Array): void {
+    this.highPass?.process(frame);
+    this.noiseSuppressor?.process(frame);
+    this.agc?.process(frame);
+  }
+
+  /** Drain the samples still held by the delay line (call once, at the end) */
+  flush(): Float32Array {
+    const tail = new Float32Array(this.latencySamples);
+    if (tail.length > 0) this.process(tail);
+    return tail;
+  }
+}
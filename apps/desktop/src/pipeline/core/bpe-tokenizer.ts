@@ -0,0 +1,365 @@
+/**
+ * Byte-level BPE tokenizer compatible with OpenAI's tiktoken encodings
+ *
+ * Loads a `.tiktoken` rank file (o200k_base for the GPT-4o / GPT-4.1
+ * family, cl100k_base for GPT-4 / GPT-3.5) and reproduces the exact token
+ * counts the API bills for. Used to cut prompts to a token budget and to
+ * estimate the cost of a dictation before it is sent.
+ *
+ * Text is split by the encoding's pre-tokenizer regex, each piece is
+ * converted to UTF-8 and merged pair by pair in rank order (lowest rank
+ * first), as tiktoken does. Most pieces are a single vocabulary entry and
+ * hit the rank map directly; the rest are merged on arrays of token ranks,
+ * looking adjacent pairs up by their (left, right) ranks in an integer
+ * memo table, so the merge loop does not build or hash substrings.
+ *
+ * Throughput is roughly 15-60 MB/s depending on the text. Prompts are a few
+ * KB, so counting stays well under a millisecond per request; loading the
+ * rank file is the expensive part and is done ahead of use
+ * (tokenizer-loader).
+ */
+
+export type TokenizerEncoding = "o200k_base" | "cl100k_base";
+
+/**
+ * Anything that can count tokens (the tokenizer, or a heuristic estimate)
+ */
+export interface TokenCounter {
+  count(text: string): number;
+}
+
+/**
+ * Conservative token estimate for byte-level BPE when no tokenizer is
+ * available: ASCII text averages ~4 characters per token, while kana/kanji
+ * and other non-ASCII characters are typically 1-2 tokens each.
+ */
+export function estimateTokens(text: string): number {
+  let ascii = 0;
+  let other = 0;
+  for (const char of text) {
+    if (char.charCodeAt(0) < 0x80) ascii++;
+    else other++;
+  }
+  return Math.ceil(ascii / 4 + other * 1.5);
+}
+
+// Contractions, spelled out because the /i flag would also widen \p{Lu}
+const CONTRACTIONS = "'(?:[sS]|[tT]|[rR][eE]|[vV][eE]|[mM]|[lL][lL]|[dD])";
+const UPPER = "[\\p{Lu}\\p{Lt}\\p{Lm}\\p{Lo}\\p{M}]";
+const LOWER = "[\\p{Ll}\\p{Lm}\\p{Lo}\\p{M}]";
+
+const PRETOKENIZE_PATTERNS: Record<TokenizerEncoding, string> = {
+  o200k_base: [
+    `[^\\r\\n\\p{L}\\p{N}]?${UPPER}*${LOWER}+(?:${CONTRACTIONS})?`,
+    `[^\\r\\n\\p{L}\\p{N}]?${UPPER}+${LOWER}*(?:${CONTRACTIONS})?`,
+    "\\p{N}{1,3}",
+    " ?[^\\s\\p{L}\\p{N}]+[\\r\\n/]*",
+    "\\s*[\\r\\n]+",
+    "\\s+(?!\\S)",
+    "\\s+",
+  ].join("|"),
+  cl100k_base: [
+    CONTRACTIONS,
+    "[^\\r\\n\\p{L}\\p{N}]?\\p{L}+",
+    "\\p{N}{1,3}",
+    " ?[^\\s\\p{L}\\p{N}]+[\\r\\n]*",
+    "\\s*[\\r\\n]+",
+    "\\s+(?!\\S)",
+    "\\s+",
+  ].join("|"),
+};
+
+// Piece → tokens memo; dictation text repeats the same words constantly
+const PIECE_CACHE_LIMIT = 20_000;
+// Pair → merged rank memo: open addressing over typed arrays, so lookups
+// neither allocate nor hash strings. Reset when half full.
+const PAIR_CACHE_BITS = 18;
+const PAIR_EMPTY = -1;
+const NO_MERGE = -1;
+
+/** UTF-8 bytes of `text` as a binary string (one char per byte) */
+function toByteString(text: string): string {
+  for (let i = 0; i < text.length; i++) {
+    if (text.charCodeAt(i) >= 0x80) {
+      return Buffer.from(text, "utf8").toString("latin1");
+    }
+  }
+  return text;
+}
+
+/** Length of an incomplete UTF-8 sequence at the end of `bytes` */
+function incompleteTail(bytes: string): number {
+  for (let back = 1; back <= Math.min(3, bytes.length); back++) {
+    const byte = bytes.charCodeAt(bytes.length - back);
+    if (byte < 0x80) return 0;
+    if (byte >= 0xc0) {
+      const needed = byte >= 0xf0 ? 4 : byte >= 0xe0 ? 3 : 2;
+      return needed > back ? back : 0;
+    }
+  }
+  return 0;
+}
+
+/** Length of UTF-8 continuation bytes at the start of `bytes` */
+function orphanHead(bytes: string): number {
+  let i = 0;
+  while (i < bytes.length && i < 3 && (bytes.charCodeAt(i) & 0xc0) === 0x80) {
+    i++;
+  }
+  return i;
+}
+
+export class BpeTokenizer implements TokenCounter {
+  readonly encoding: TokenizerEncoding;
+  private readonly ranks: Map<string, number>;
+  private readonly vocabulary: string[];
+  private readonly pattern: RegExp;
+  private readonly pieceCache = new Map<string, number[]>();
+  private readonly byteRanks = new Int32Array(256);
+  private readonly pairLeft = new Int32Array(1 << PAIR_CACHE_BITS).fill(
+    PAIR_EMPTY,
+  );
+  private readonly pairRight = new Int32Array(1 << PAIR_CACHE_BITS);
+  private readonly pairMerged = new Int32Array(1 << PAIR_CACHE_BITS);
+  private pairCount = 0;
+  // Merge scratch space, grown to the longest piece seen
+  private parts = new Int32Array(64);
+  private next = new Int32Array(64);
+  private pairRanks = new Int32Array(64);
+
+  constructor(encoding: TokenizerEncoding, ranks: Map<string, number>) {
+    this.encoding = encoding;
+    this.ranks = ranks;
+    // Sticky: every character is matched by some alternative, so pieces
+    // are contiguous and can be sliced without a match array
+    this.pattern = new RegExp(PRETOKENIZE_PATTERNS[encoding], "uy");
+    this.vocabulary = [];
+    for (const [bytes, rank] of ranks) this.vocabulary[rank] = bytes;
+    for (let byte = 0; byte < 256; byte++) {
+      const rank = ranks.get(String.fromCharCode(byte));
+      // Every single byte is in a byte-level vocabulary
+      if (rank === undefined) throw new Error("Byte missing from vocabulary");
+      this.byteRanks[byte] = rank;
+    }
+  }
+
+  /**
+   * Parse a `.tiktoken` file: one "<base64 token bytes> <rank>" per line
+   */
+  static fromTiktoken(
+    encoding: TokenizerEncoding,
+    contents: string,
+  ): BpeTokenizer {
+    const ranks = new Map<string, number>();
+    let start = 0;
+    while (start < contents.length) {
+      let end = contents.indexOf("\n", start);
+      if (end < 0) end = contents.length;
+      const space = contents.indexOf(" ", start);
+      if (space > start && space < end) {
+        const bytes = Buffer.from(
+          contents.slice(start, space),
+          "base64",
+        ).toString("latin1");
+        ranks.set(bytes, Number(contents.slice(space + 1, end)));
+      }
+      start = end + 1;
+    }
+    return new BpeTokenizer(encoding, ranks);
+  }
+
+  get vocabularySize(): number {
+    return this.ranks.size;
+  }
+
+  encode(text: string): number[] {
+    const tokens: number[] = [];
+    this.forEachPiece(text, (pieceTokens) => {
+      for (const token of pieceTokens) tokens.push(token);
+    });
+    return tokens;
+  }
+
+  count(text: string): number {
+    let count = 0;
+    this.forEachPiece(text, (pieceTokens) => {
+      count += pieceTokens.length;
+    });
+    return count;
+  }
+
+  decode(tokens: readonly number[]): string {
+    return Buffer.from(this.decodeBytes(tokens), "latin1").toString("utf8");
+  }
+
+  /**
+   * Longest prefix of `text` within `maxTokens`. Cuts on token boundaries,
+   * backing off to a whole character when a token ends mid-character.
+   */
+  truncate(text: string, maxTokens: number): string {
+    return this.fitToBudget(text, maxTokens, (tokens, keep) => {
+      const bytes = this.decodeBytes(tokens.slice(0, keep));
+      return bytes.slice(0, bytes.length - incompleteTail(bytes));
+    });
+  }
+
+  /**
+   * Longest suffix of `text` within `maxTokens` (keeps the most recent
+   * context)
+   */
+  truncateStart(text: string, maxTokens: number): string {
+    return this.fitToBudget(text, maxTokens, (tokens, keep) => {
+      const bytes = this.decodeBytes(tokens.slice(tokens.length - keep));
+      return bytes.slice(orphanHead(bytes));
+    });
+  }
+
+  private fitToBudget(
+    text: string,
+    maxTokens: number,
+    cut: (tokens: number[], keep: number) => string,
+  ): string {
+    if (maxTokens <= 0) return "";
+    const tokens = this.encode(text);
+    if (tokens.length <= maxTokens) return text;
+
+    // Re-encoding the cut text can merge differently at the edge; shrink
+    // until it really fits
+    for (let keep = maxTokens; keep > 0; keep--) {
+      const result = Buffer.from(cut(tokens, keep), "latin1").toString("utf8");
+      if (this.count(result) <= maxTokens) return result;
+    }
+    return "";
+  }
+
+  private decodeBytes(tokens: readonly number[]): string {
+    let bytes = "";
+    for (const token of tokens) {
+      const piece = this.vocabulary[token];
+      if (piece === undefined) throw new Error(`Unknown token: ${token}`);
+      bytes += piece;
+    }
+    return bytes;
+  }
+
+  private forEachPiece(text: string, visit: (tokens: number[]) => void): void {
+    const pattern = this.pattern;
+    pattern.lastIndex = 0;
+    let start = 0;
+    while (pattern.test(text)) {
+      visit(this.encodePiece(text.slice(start, pattern.lastIndex)));
+      start = pattern.lastIndex;
+    }
+  }
+
+  private encodePiece(piece: string): number[] {
+    const cached = this.pieceCache.get(piece);
+    if (cached) return cached;
+
+    const bytes = toByteString(piece);
+    const rank = this.ranks.get(bytes);
+    const tokens = rank !== undefined ? [rank] : this.mergePairs(bytes);
+
+    if (this.pieceCache.size >= PIECE_CACHE_LIMIT) this.pieceCache.clear();
+    this.pieceCache.set(piece, tokens);
+    return tokens;
+  }
+
+  /**
+   * Rank of the token made of `left` followed by `right`, or NO_MERGE
+   */
+  private pairRank(left: number, right: number): number {
+    const mask = (1 << PAIR_CACHE_BITS) - 1;
+    let slot = (Math.imul(left, 0x9e3779b1) ^ right) & mask;
+    for (;;) {
+      const cached = this.pairLeft[slot];
+      if (cached === PAIR_EMPTY) break;
+      if (cached === left && this.pairRight[slot] === right) {
+        return this.pairMerged[slot];
+      }
+      slot = (slot + 1) & mask;
+    }
+
+    const rank =
+      this.ranks.get(this.vocabulary[left] + this.vocabulary[right]) ??
+      NO_MERGE;
+    if (this.pairCount >= mask >> 1) {
+      this.pairLeft.fill(PAIR_EMPTY);
+      this.pairCount = 0;
+      slot = (Math.imul(left, 0x9e3779b1) ^ right) & mask;
+    }
+    this.pairLeft[slot] = left;
+    this.pairRight[slot] = right;
+    this.pairMerged[slot] = rank;
+    this.pairCount++;
+    return rank;
+  }
+
+  /**
+   * Merge adjacent parts of `bytes`, lowest rank first (leftmost on ties),
+   * until no adjacent pair is in the vocabulary
+   */
+  private mergePairs(bytes: string): number[] {
+    const length = bytes.length;
+    if (this.parts.length < length) {
+      this.parts = new Int32Array(length * 2);
+      this.next = new Int32Array(length * 2);
+      this.pairRanks = new Int32Array(length * 2);
+    }
+    // Parts form a linked list over byte offsets: parts[i] is the token
+    // starting at i, next[i] the offset of the following part (length =
+    // end) and pairRanks[i] the rank of merging it with that part
+    const { parts, next, pairRanks } = this;
+    for (let i = 0; i < length; i++) {
+      parts[i] = this.byteRanks[bytes.charCodeAt(i)];
+      next[i] = i + 1;
+    }
+    for (let i = 0; i < length - 1; i++) {
+      pairRanks[i] = this.pairRank(parts[i], parts[i + 1]);
+    }
+    pairRanks[length - 1] = NO_MERGE;
+
+    for (;;) {
+      let best = -1;
+      let bestRank = -1;
+      let prev = -1;
+      let prevOfBest = -1;
+      for (let i = 0; i < length; i = next[i]) {
+        const rank = pairRanks[i];
+        if (rank >= 0 && (bestRank < 0 || rank < bestRank)) {
+          best = i;
+          bestRank = rank;
+          prevOfBest = prev;
+        }
+        prev = i;
+      }
+      if (best < 0) break;
+
+      parts[best] = bestRank;
+      next[best] = next[next[best]];
+      pairRanks[best] =
+        next[best] < length
+          ? this.pairRank(bestRank, parts[next[best]])
+          : NO_MERGE;
+      if (prevOfBest >= 0) {
+        pairRanks[prevOfBest] = this.pairRank(parts[prevOfBest], bestRank);
+      }
+    }
+
+    const tokens: number[] = [];
+    for (let i = 0; i < length; i = next[i]) tokens.push(parts[i]);
+    return tokens;
+  }
+}
+
+/**
+ * Encoding used by an OpenAI model, or null for models without a known
+ * tiktoken encoding (Whisper, local models). OpenRouter IDs such as
+ * "openai/gpt-4o-mini" are accepted.
+ */
+export function encodingForModel(modelId: string): TokenizerEncoding | null {
+  const model = modelId.replace(/^openai\//, "");
+  if (/^(gpt-4o|gpt-4\.1|gpt-5|o\d)/.test(model)) return "o200k_base";
+  if (/^(gpt-4|gpt-3\.5)/.test(model)) return "cl100k_base";
+  return null;
+}
@@ -15,9 +15,13 @@ export interface PipelineContext {
 }
 
 import { GetAccessibilityContextResult } from "@surasura/types";
+import type { VocabularyIndex } from "./vocabulary-ranker";
+import type { PhoneticMatcher } from "./phonetic-matcher";
 
 export interface SharedPipelineData {
   vocabulary: string[]; // Custom vocab
+  vocabularyIndex: VocabularyIndex | null; // Relevance ranking for prompts
+  phoneticMatcher: PhoneticMatcher | null; // Near-miss term correction
   replacements: Map<string, string>; // Custom replacements
   dictionaryEntries: DictionaryEntry[]; // Unified dictionary entries
   userPreferences: {
@@ -39,6 +43,8 @@ export function createDefaultContext(sessionId: string): PipelineContext {
     sessionId,
     sharedData: {
       vocabulary: [],
+      vocabularyIndex: null,
+      phoneticMatcher: null,
       replacements: new Map(),
       dictionaryEntries: [],
       userPreferences: {
@@ -0,0 +1,535 @@
+import { normalizeForMatching } from "./vocabulary-ranker";
+
+/**
+ * Fuzzy phonetic vocabulary matcher
+ *
+ * Exact reading replacements miss Whisper's near-misses: katakana vs
+ * hiragana, long-vowel variants (サーバー / サーバ), romaji for a kana
+ * reading, or a one-character slip in a long term. Vocabulary words and
+ * readings are reduced to a phonetic key and indexed by their deletion
+ * variants; windows of each transcribed segment are keyed the same way and
+ * searched within a bounded edit distance. Matches above the confidence threshold are
+ * replaced by the vocabulary word.
+ */
+
+export interface PhoneticVocabularyEntry {
+  word: string;
+  readings?: string[];
+}
+
+export interface PhoneticCorrection {
+  /** Offset in the input text */
+  index: number;
+  from: string;
+  to: string;
+  distance: number;
+  /** 1 - distance / key length (1 = same pronunciation) */
+  score: number;
+}
+
+export interface PhoneticMatcherOptions {
+  /** Minimum score for a fuzzy match (0-1) */
+  threshold?: number;
+  /** Maximum edit distance on phonetic keys */
+  maxDistance?: number;
+  /** Keys shorter than this only match exactly */
+  minFuzzyKeyLength?: number;
+}
+
+const DEFAULT_OPTIONS: Required<PhoneticMatcherOptions> = {
+  threshold: 0.8,
+  maxDistance: 2,
+  minFuzzyKeyLength: 4,
+};
+
+// Longest window considered, in characters
+const MAX_WINDOW_LENGTH = 24;
+
+// ───────────────────────────────────────────────────────────────────
+// Phonetic keys
+// ───────────────────────────────────────────────────────────────────
+
+// Hepburn / kunrei romaji → hiragana, longest match first
+// prettier-ignore
+const ROMAJI_TABLE: Record<string, string> = {
+  a: "あ", i: "い", u: "う", e: "え", o: "お",
+  ka: "か", ki: "き", ku: "く", ke: "け", ko: "こ",
+  sa: "さ", si: "し", shi: "し", su: "す", se: "せ", so: "そ",
+  ta: "た", ti: "ち", chi: "ち", tu: "つ", tsu: "つ", te: "て", to: "と",
+  na: "な", ni: "に", nu: "ぬ", ne: "ね", no: "の",
+  ha: "は", hi: "ひ", hu: "ふ", fu: "ふ", he: "へ", ho: "ほ",
+  ma: "ま", mi: "み", mu: "む", me: "め", mo: "も",
+  ya: "や", yu: "ゆ", yo: "よ",
+  ra: "ら", ri: "り", ru: "る", re: "れ", ro: "ろ",
+  wa: "わ", wo: "を",
+  ga: "が", gi: "ぎ", gu: "ぐ", ge: "げ", go: "ご",
+  za: "ざ", zi: "じ", ji: "じ", zu: "ず", ze: "ぜ", zo: "ぞ",
+  da: "だ", di: "ぢ", du: "づ", de: "で", do: "ど",
+  ba: "ば", bi: "び", bu: "ぶ", be: "べ", bo: "ぼ",
+  pa: "ぱ", pi: "ぴ", pu: "ぷ", pe: "ぺ", po: "ぽ",
+  kya: "きゃ", kyu: "きゅ", kyo: "きょ",
+  sha: "しゃ", shu: "しゅ", sho: "しょ", she: "しぇ",
+  sya: "しゃ", syu: "しゅ", syo: "しょ",
+  cha: "ちゃ", chu: "ちゅ", cho: "ちょ", che: "ちぇ",
+  tya: "ちゃ", tyu: "ちゅ", tyo: "ちょ",
+  nya: "にゃ", nyu: "にゅ", nyo: "にょ",
+  hya: "ひゃ", hyu: "ひゅ", hyo: "ひょ",
+  mya: "みゃ", myu: "みゅ", myo: "みょ",
+  rya: "りゃ", ryu: "りゅ", ryo: "りょ",
+  gya: "ぎゃ", gyu: "ぎゅ", gyo: "ぎょ",
+  ja: "じゃ", ju: "じゅ", jo: "じょ", je: "じぇ",
+  jya: "じゃ", jyu: "じゅ", jyo: "じょ",
+  bya: "びゃ", byu: "びゅ", byo: "びょ",
+  pya: "ぴゃ", pyu: "ぴゅ", pyo: "ぴょ",
+  fa: "ふぁ", fi: "ふぃ", fe: "ふぇ", fo: "ふぉ",
+  va: "ヴぁ", vi: "ヴぃ", vu: "ヴ", ve: "ヴぇ", vo: "ヴぉ",
+};
+
+/**
+ * Romaji → hiragana; null when the text is not plain romaji
+ */
+export function romajiToHiragana(text: string): string | null {
+  const input = text.toLowerCase().replace(/[\s'-]/g, "");
+  if (!/^[a-z]+$/.test(input)) return null;
+
+  let result = "";
+  let i = 0;
+  while (i < input.length) {
+    const c = input[i];
+    const next = input[i + 1];
+
+    // Double consonant → small tsu (except nn)
+    if (next === c && c !== "n" && !"aeiou".includes(c)) {
+      result += "っ";
+      i++;
+      continue;
+    }
+    // Syllabic n: before a consonant (not y) or at the end; "nn" → ん, and
+    // before a vowel the second n starts the next syllable (konnichiwa)
+    if (c === "n") {
+      if (next === "n") {
+        const after = input[i + 2];
+        result += "ん";
+        i += after !== undefined && "aeiouy".includes(after) ? 1 : 2;
+        continue;
+      }
+      if (next === undefined || (!"aeiouy".includes(next) && next !== "'")) {
+        result += "ん";
+        i++;
+        continue;
+      }
+    }
+
+    let matched = false;
+    for (let length = 3; length >= 1; length--) {
+      const kana = ROMAJI_TABLE[input.slice(i, i + length)];
+      if (kana) {
+        result += kana;
+        i += length;
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) return null;
+  }
+  return result;
+}
+
+// Small kana fold to their full-size forms: Whisper is inconsistent about
+// テイ / ティ and ッ, and the difference rarely separates two terms
+const SMALL_KANA: Record<string, string> = {
+  ぁ: "あ",
+  ぃ: "い",
+  ぅ: "う",
+  ぇ: "え",
+  ぉ: "お",
+  っ: "つ",
+  ゃ: "や",
+  ゅ: "ゆ",
+  ょ: "よ",
+  ゎ: "わ",
+};
+
+// Loanword sounds fold to their native approximations, which Whisper uses
+// interchangeably (フォーム / ホーム, ヴァイオリン / バイオリン)
+// prettier-ignore
+const FOREIGN_SOUNDS: Record<string, string> = {
+  ふぁ: "は", ふぃ: "ひ", ふぇ: "へ", ふぉ: "ほ",
+  ヴぁ: "ば", ヴぃ: "び", ヴぇ: "べ", ヴぉ: "ぼ", ヴ: "ぶ",
+};
+
+/**
+ * Pronunciation-level key: kana script, width, case, long-vowel marks,
+ * loanword sounds and small kana are folded; plain romaji is converted to
+ * hiragana
+ */
+export function phoneticKey(text: string): string {
+  const normalized = normalizeForMatching(text)
+    .replace(/[ーｰ〜~・\s]/g, "")
+    .replace(/ゔ/g, "ヴ");
+  const key = romajiToHiragana(normalized) ?? normalized;
+  return key
+    .replace(/ふ[ぁぃぇぉ]|ヴ[ぁぃぇぉ]?/g, (s) => FOREIGN_SOUNDS[s])
+    .replace(/[ぁぃぅぇぉっゃゅょゎ]/g, (c) => SMALL_KANA[c]);
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Bounded edit-distance search
+// ───────────────────────────────────────────────────────────────────
+
+// Reused DP row; keys are short
+let levenshteinRow = new Uint16Array(64);
+
+export function levenshtein(a: string, b: string): number {
+  if (a === b) return 0;
+  if (a.length === 0) return b.length;
+  if (b.length === 0) return a.length;
+  if (levenshteinRow.length <= b.length) {
+    levenshteinRow = new Uint16Array(b.length * 2);
+  }
+  const row = levenshteinRow;
+  for (let j = 0; j <= b.length; j++) row[j] = j;
+
+  for (let i = 1; i <= a.length; i++) {
+    let diagonal = row[0];
+    row[0] = i;
+    const ca = a.charCodeAt(i - 1);
+    for (let j = 1; j <= b.length; j++) {
+      const above = row[j];
+      const cost = ca === b.charCodeAt(j - 1) ? 0 : 1;
+      row[j] = Math.min(above + 1, row[j - 1] + 1, diagonal + cost);
+      diagonal = above;
+    }
+  }
+  return row[b.length];
+}
+
+/**
+ * Symmetric-delete index: every key is stored under all of its variants with
+ * up to `maxDistance` characters deleted. Two keys within edit distance k
+ * share a variant with at most k deletions on each side, so a query only
+ * looks up its own deletion variants and verifies the few keys it finds.
+ * A BK-tree over short kana keys visits most of its nodes at k = 2.
+ */
+export class DeletionIndex {
+  private readonly variants = new Map<string, string[]>();
+  private readonly maxDistance: number;
+  private count = 0;
+
+  constructor(maxDistance: number) {
+    this.maxDistance = maxDistance;
+  }
+
+  get size(): number {
+    return this.count;
+  }
+
+  add(key: string): void {
+    this.count++;
+    forEachDeletion(key, this.maxDistance, 0, (variant) => {
+      const keys = this.variants.get(variant);
+      if (!keys) this.variants.set(variant, [key]);
+      else if (!keys.includes(key)) keys.push(key);
+    });
+  }
+
+  search(
+    key: string,
+    maxDistance: number,
+  ): { key: string; distance: number }[] {
+    const results: { key: string; distance: number }[] = [];
+    const seen = new Set<string>();
+    const depth = Math.min(maxDistance, this.maxDistance);
+    forEachDeletion(key, depth, 0, (variant) => {
+      const keys = this.variants.get(variant);
+      if (!keys) return;
+      for (const candidate of keys) {
+        if (seen.has(candidate)) continue;
+        seen.add(candidate);
+        if (Math.abs(candidate.length - key.length) > depth) continue;
+        const distance = levenshtein(key, candidate);
+        if (distance <= depth) results.push({ key: candidate, distance });
+      }
+    });
+    return results;
+  }
+}
+
+/**
+ * Visit the key and every string obtained by deleting up to `depth`
+ * characters (never below one character). Positions are deleted in
+ * increasing order so each combination is produced once; lookups on the
+ * query path stay allocation-free apart from the slices themselves.
+ */
+function forEachDeletion(
+  key: string,
+  depth: number,
+  from: number,
+  visit: (variant: string) => void,
+): void {
+  visit(key);
+  if (depth === 0 || key.length <= 1) return;
+  for (let i = from; i < key.length; i++) {
+    forEachDeletion(key.slice(0, i) + key.slice(i + 1), depth - 1, i, visit);
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Matcher
+// ───────────────────────────────────────────────────────────────────
+
+function isWordChar(code: number): boolean {
+  return (
+    (code >= 0x30 && code <= 0x39) || // 0-9
+    (code >= 0x41 && code <= 0x5a) || // A-Z
+    (code >= 0x61 && code <= 0x7a) || // a-z
+    (code >= 0x3041 && code <= 0x30ff) || // Hiragana, Katakana, ー
+    (code >= 0x4e00 && code <= 0x9fff) || // CJK ideographs
+    code === 0x3005 || // 々
+    (code >= 0xff10 && code <= 0xff5a) || // Fullwidth alphanumerics
+    (code >= 0xff66 && code <= 0xff9f) // Halfwidth katakana
+  );
+}
+
+// Long-vowel marks and small kana belong to the preceding mora, so a window
+// never starts on one or stops just before one
+function isMoraTail(code: number): boolean {
+  return (
+    code === 0x30fc || // ー
+    code === 0xff70 || // ｰ
+    code === 0x301c || // 〜
+    code === 0x3063 || // っ
+    code === 0x30c3 || // ッ
+    (code >= 0x3041 && code <= 0x3049 && code % 2 === 1) || // ぁぃぅぇぉ
+    (code >= 0x30a1 && code <= 0x30a9 && code % 2 === 1) || // ァィゥェォ
+    (code >= 0x3083 && code <= 0x3087 && code % 2 === 1) || // ゃゅょ
+    (code >= 0x30e3 && code <= 0x30e7 && code % 2 === 1) // ャュョ
+  );
+}
+
+function isLatin(code: number): boolean {
+  return (
+    (code >= 0x41 && code <= 0x5a) ||
+    (code >= 0x61 && code <= 0x7a) ||
+    (code >= 0x30 && code <= 0x39)
+  );
+}
+
+interface Candidate extends PhoneticCorrection {
+  end: number;
+  // Sounds of the vocabulary term covered, weighted by score
+  weight: number;
+}
+
+export class PhoneticMatcher {
+  // Exact key lookup; most windows are too short for fuzzy matching
+  private readonly exact = new Map<string, string[]>();
+  private readonly fuzzy: DeletionIndex;
+  private readonly options: Required<PhoneticMatcherOptions>;
+  private minWindow = Infinity;
+  private maxWindow = 0;
+  // Romaji spells a kana key with 2-3 letters per sound
+  private maxLatinWindow = 0;
+
+  constructor(
+    entries: PhoneticVocabularyEntry[],
+    options: PhoneticMatcherOptions = {},
+  ) {
+    this.options = { ...DEFAULT_OPTIONS, ...options };
+    const { maxDistance, minFuzzyKeyLength } = this.options;
+    this.fuzzy = new DeletionIndex(maxDistance);
+
+    for (const { word, readings = [] } of entries) {
+      if (!word) continue;
+      for (const variant of [word, ...readings]) {
+        const key = phoneticKey(variant);
+        if (key.length < 2) continue;
+        const words = this.exact.get(key);
+        if (words) {
+          if (!words.includes(word)) words.push(word);
+        } else {
+          this.exact.set(key, [word]);
+          // Shorter keys are never within reach of a fuzzy query
+          if (key.length >= minFuzzyKeyLength - maxDistance) {
+            this.fuzzy.add(key);
+          }
+        }
+        // Window lengths in source characters: long-vowel marks and romaji
+        // make the surface longer than the key
+        this.minWindow = Math.min(
+          this.minWindow,
+          key.length - 1,
+          variant.length,
+        );
+        this.maxWindow = Math.max(
+          this.maxWindow,
+          key.length + maxDistance,
+          variant.length + 1,
+        );
+      }
+    }
+    this.maxLatinWindow = Math.min(this.maxWindow * 3, MAX_WINDOW_LENGTH);
+    this.maxWindow = Math.min(this.maxWindow, MAX_WINDOW_LENGTH);
+    this.minWindow = Math.max(2, this.minWindow);
+  }
+
+  get size(): number {
+    return this.exact.size;
+  }
+
+  /**
+   * Replace near-miss spellings of vocabulary terms in `text`
+   */
+  correct(text: string): { text: string; corrections: PhoneticCorrection[] } {
+    if (this.exact.size === 0 || !text) return { text, corrections: [] };
+
+    const candidates = this.findCandidates(text);
+    if (candidates.length === 0) return { text, corrections: [] };
+
+    // Most covered sounds first, so a long term beats a short one matched
+    // inside it; on ties the shorter span, so a slip at the end of a term
+    // doesn't swallow the following particle. Keep non-overlapping
+    candidates.sort(
+      (a, b) =>
+        b.weight - a.weight ||
+        a.end - a.index - (b.end - b.index) ||
+        a.index - b.index,
+    );
+    const taken: Candidate[] = [];
+    for (const candidate of candidates) {
+      const overlaps = taken.some(
+        (t) => candidate.index < t.end && t.index < candidate.end,
+      );
+      if (!overlaps) taken.push(candidate);
+    }
+    taken.sort((a, b) => a.index - b.index);
+
+    let result = "";
+    let cursor = 0;
+    const corrections: PhoneticCorrection[] = [];
+    for (const candidate of taken) {
+      if (candidate.from === candidate.to) continue; // Already correct
+      result += text.slice(cursor, candidate.index) + candidate.to;
+      cursor = candidate.end;
+      const { index, from, to, distance, score } = candidate;
+      corrections.push({ index, from, to, distance, score });
+    }
+    result += text.slice(cursor);
+
+    return { text: result, corrections };
+  }
+
+  private search(
+    key: string,
+    maxDistance: number,
+  ): { key: string; values: string[]; distance: number }[] {
+    if (maxDistance === 0) {
+      const values = this.exact.get(key);
+      return values ? [{ key, values, distance: 0 }] : [];
+    }
+    return this.fuzzy.search(key, maxDistance).map((match) => ({
+      ...match,
+      values: this.exact.get(match.key)!,
+    }));
+  }
+
+  private findCandidates(text: string): Candidate[] {
+    const { threshold, maxDistance, minFuzzyKeyLength } = this.options;
+    const candidates: Candidate[] = [];
+    const keyCache = new Map<string, string>();
+
+    // Runs of word characters; spaces inside latin text are kept so that
+    // multi-word romaji ("sura sura") can match
+    let openRun = -1;
+    const runs: [number, number][] = [];
+    for (let i = 0; i <= text.length; i++) {
+      const code = i < text.length ? text.charCodeAt(i) : 0;
+      const inRun =
+        i < text.length &&
+        (isWordChar(code) ||
+          (code === 0x20 &&
+            openRun >= 0 &&
+            isLatin(text.charCodeAt(i - 1)) &&
+            isLatin(text.charCodeAt(i + 1))));
+      if (inRun && openRun < 0) openRun = i;
+      if (!inRun && openRun >= 0) {
+        runs.push([openRun, i]);
+        openRun = -1;
+      }
+    }
+
+    for (const [runStart, runEnd] of runs) {
+      for (let start = runStart; start < runEnd; start++) {
+        // Latin windows must start and end on word boundaries
+        const latinStart = isLatin(text.charCodeAt(start));
+        if (text.charCodeAt(start) === 0x20) continue;
+        if (isMoraTail(text.charCodeAt(start))) continue;
+        if (
+          latinStart &&
+          start > runStart &&
+          isLatin(text.charCodeAt(start - 1))
+        ) {
+          continue;
+        }
+
+        const maxEnd = Math.min(
+          runEnd,
+          start + (latinStart ? this.maxLatinWindow : this.maxWindow),
+        );
+        for (let end = start + this.minWindow; end <= maxEnd; end++) {
+          if (
+            isLatin(text.charCodeAt(end - 1)) &&
+            end < runEnd &&
+            isLatin(text.charCodeAt(end))
+          ) {
+            continue;
+          }
+          if (text.charCodeAt(end - 1) === 0x20) continue;
+          if (end < runEnd && isMoraTail(text.charCodeAt(end))) continue;
+
+          const window = text.slice(start, end);
+          let key = keyCache.get(window);
+          if (key === undefined) {
+            key = phoneticKey(window);
+            keyCache.set(window, key);
+          }
+          // Two-sound keys ("AI" → あい) only match a whole run, not a
+          // fragment of a longer word
+          if (key.length < 2) continue;
+          if (key.length < 3 && (start > runStart || end < runEnd)) continue;
+
+          // Bound by the longest target that could still reach the threshold;
+          // the score check below is exact
+          const allowed =
+            key.length >= minFuzzyKeyLength
+              ? Math.min(
+                  maxDistance,
+                  Math.floor(
+                    (key.length + maxDistance) * (1 - threshold) + 1e-9,
+                  ),
+                )
+              : 0;
+
+          for (const match of this.search(key, allowed)) {
+            const length = Math.max(key.length, match.key.length);
+            const score = 1 - match.distance / length;
+            if (match.distance > 0 && score < threshold) continue;
+            for (const word of match.values) {
+              candidates.push({
+                index: start,
+                end,
+                from: window,
+                to: word,
+                distance: match.distance,
+                score,
+                weight: score * match.key.length,
+              });
+            }
+          }
+        }
+      }
+    }
+
+    return candidates;
+  }
+}
@@ -6,12 +6,17 @@
 import { PipelineContext, DictionaryEntry } from "./context";
 import { GetAccessibilityContextResult } from "@surasura/types";
 import { FormatPreset } from "../../types/formatter";
+import type { TranscriptBuilder } from "./transcript-builder";
+import type { VocabularyIndex } from "./vocabulary-ranker";
+import type { AlignedSegment } from "./alignment-index";
+import type { WeightedConfidence } from "./transcript-confidence";
 export { PipelineContext, SharedPipelineData, DictionaryEntry } from "./context";
 
 // Context for transcription operations (shared between transcribe and flush)
 export interface TranscribeContext {
   sessionId?: string;
   vocabulary?: string[];
+  vocabularyIndex?: VocabularyIndex | null;
   accessibilityContext?: GetAccessibilityContextResult | null;
   previousChunk?: string;
   aggregatedTranscription?: string;
@@ -41,12 +46,20 @@ export interface FormatParams {
   };
 }
 
+// Timings and confidence of the text returned by the last transcribe/flush call
+export interface TranscribedSegmentInfo {
+  alignment: AlignedSegment[]; // Relative to the start of the transcribed audio (empty without timestamps)
+  sampleCount: number; // Length of the transcribed audio (16 kHz)
+  confidence: number | null; // 0-1, null when the model reported no scores
+}
+
 // Transcription provider interface
 export interface TranscriptionProvider {
   readonly name: string;
   transcribe(params: TranscribeParams): Promise<string>;
   flush(context: TranscribeContext): Promise<string>;
   reset(): void; // Clear internal buffers without transcribing
+  takeSegmentInfo?(): TranscribedSegmentInfo | null; // Providers with timings/scores
 }
 
 // Formatting provider interface
@@ -77,11 +90,14 @@ export interface StreamingPipelineContext extends PipelineContext {
 // Session data for streaming transcription
 export interface StreamingSession {
   context: StreamingPipelineContext;
-  transcriptionResults: string[]; // Accumulate all transcription chunks
+  transcript: TranscriptBuilder; // Accumulated transcription chunks
   firstChunkReceivedAt?: number; // When first audio chunk arrived at transcription service
   recordingStartedAt?: number; // When user pressed record button (from RecordingManager)
   recordingStoppedAt?: number; // When user released record button (from RecordingManager)
   finalizationStartedAt?: number; // When finalizeSession() was called
+  audioSampleCount?: number; // Samples received so far (offset into the audio file)
+  alignment?: AlignedSegment[]; // Word timings relative to the audio file
+  confidences?: WeightedConfidence[]; // Confidence of each transcribed segment
 }
 
 // Simple pipeline configuration
@@ -0,0 +1,426 @@
+/**
+ * ProviderRouter - Latency-aware routing for provider API calls
+ *
+ * ProviderRegistry decides *which* providers exist; the router decides how
+ * a single call is spread over them. Per target it keeps an EWMA of latency
+ * and error rate plus a window of recent latencies, and uses them to:
+ * - hedge: when a call runs past the target's p95, start one duplicate (on
+ *   the fastest healthy alternative, or the same target) and take whichever
+ *   answers first. Targets marked `hedge: false` never get a duplicate
+ * - fall back: when a call fails, try the next target in order
+ * - break circuits: a target that keeps failing is skipped for a cool-down,
+ *   then probed with a single request
+ *
+ * Decisions are counted in metrics; deviations from the primary path are
+ * also kept per session so they can be stored with the transcription.
+ */
+
+import { logger } from "../../main/logger";
+import { metrics } from "../../main/metrics";
+
+export type RouteKind = "transcription" | "formatting";
+
+export type RouteDecisionType =
+  | "primary" // First attempt on the preferred target
+  | "hedge" // Duplicate started after the p95 elapsed
+  | "hedge_won" // The duplicate answered first
+  | "fallback" // Next target after a failure
+  | "skip_open" // Target skipped, circuit open
+  | "forced"; // Every circuit open; preferred target tried anyway
+
+export interface RouteDecision {
+  kind: RouteKind;
+  decision: RouteDecisionType;
+  target: string;
+}
+
+export interface RouteTarget<T> {
+  /** Health key, e.g. "formatting:openai:gpt-4o-mini" */
+  key: string;
+  /**
+   * Key for the latency window that sets the hedge delay, when latency
+   * depends on the input size (defaults to `key`)
+   */
+  latencyKey?: string;
+  /**
+   * Whether a duplicate may be sent to this target (default true). False
+   * for backends that serve one request at a time, such as llama-server,
+   * where a duplicate only queues behind the original
+   */
+  hedge?: boolean;
+  run: (signal: AbortSignal) => Promise<T>;
+}
+
+export interface RouteOptions {
+  kind: RouteKind;
+  /** Session the decisions are recorded for */
+  sessionId?: string;
+  /** Allow a duplicate request once the call exceeds its p95 */
+  hedge?: boolean;
+}
+
+export type CircuitState = "closed" | "open" | "half-open";
+
+export interface TargetHealthSnapshot {
+  key: string;
+  state: CircuitState;
+  latencyEwmaMs: number | null;
+  errorRateEwma: number;
+  requests: number;
+}
+
+const EWMA_ALPHA = 0.2;
+const LATENCY_WINDOW = 64;
+const MIN_HEDGE_SAMPLES = 8;
+const MIN_HEDGE_DELAY_MS = 250;
+const HEDGE_PERCENTILE = 0.95;
+// Circuit breaker: consecutive failures, or a sustained error rate
+const FAILURE_THRESHOLD = 3;
+const ERROR_RATE_THRESHOLD = 0.5;
+const MIN_ERROR_RATE_SAMPLES = 10;
+const OPEN_DURATION_MS = 30_000;
+const MAX_SESSION_DECISIONS = 100;
+
+/**
+ * Ring buffer of recent latencies
+ */
+class LatencyWindow {
+  private readonly samples = new Float64Array(LATENCY_WINDOW);
+  private next = 0;
+  count = 0;
+
+  record(ms: number): void {
+    this.samples[this.next] = ms;
+    this.next = (this.next + 1) % LATENCY_WINDOW;
+    this.count = Math.min(this.count + 1, LATENCY_WINDOW);
+  }
+
+  percentile(p: number): number {
+    const sorted = this.samples.slice(0, this.count).sort();
+    return sorted[Math.min(this.count - 1, Math.floor(p * this.count))];
+  }
+}
+
+/**
+ * EWMA statistics and circuit breaker for one target
+ */
+export class TargetHealth {
+  readonly key: string;
+  latencyEwma: number | null = null;
+  errorRateEwma = 0;
+  requests = 0;
+  state: CircuitState = "closed";
+  private consecutiveFailures = 0;
+  private openedAt = 0;
+  private probeInFlight = false;
+
+  constructor(key: string) {
+    this.key = key;
+  }
+
+  /** Whether a request may be sent now (moves open → half-open) */
+  canRequest(now: number): boolean {
+    if (this.state === "open") {
+      if (now - this.openedAt < OPEN_DURATION_MS) return false;
+      this.state = "half-open";
+    }
+    // Half-open: a single probe at a time
+    return this.state === "closed" || !this.probeInFlight;
+  }
+
+  onStart(): void {
+    if (this.state === "half-open") this.probeInFlight = true;
+  }
+
+  recordSuccess(latencyMs: number): void {
+    this.requests++;
+    this.latencyEwma =
+      this.latencyEwma === null
+        ? latencyMs
+        : this.latencyEwma + EWMA_ALPHA * (latencyMs - this.latencyEwma);
+    this.errorRateEwma *= 1 - EWMA_ALPHA;
+    this.consecutiveFailures = 0;
+    this.probeInFlight = false;
+    if (this.state !== "closed") {
+      this.state = "closed";
+      logger.pipeline.info("Provider circuit closed", { target: this.key });
+    }
+  }
+
+  /** @returns true when this failure opened the circuit */
+  recordFailure(now: number): boolean {
+    this.requests++;
+    this.errorRateEwma += EWMA_ALPHA * (1 - this.errorRateEwma);
+    this.consecutiveFailures++;
+    this.probeInFlight = false;
+
+    const storm =
+      this.consecutiveFailures >= FAILURE_THRESHOLD ||
+      (this.requests >= MIN_ERROR_RATE_SAMPLES &&
+        this.errorRateEwma >= ERROR_RATE_THRESHOLD);
+    if (this.state === "half-open" || (this.state === "closed" && storm)) {
+      this.state = "open";
+      this.openedAt = now;
+      return true;
+    }
+    return false;
+  }
+
+  /** A request abandoned because another attempt won */
+  recordCancelled(): void {
+    this.probeInFlight = false;
+  }
+
+  snapshot(): TargetHealthSnapshot {
+    return {
+      key: this.key,
+      state: this.state,
+      latencyEwmaMs: this.latencyEwma,
+      errorRateEwma: this.errorRateEwma,
+      requests: this.requests,
+    };
+  }
+}
+
+/**
+ * Routes provider calls using per-target health
+ */
+export class ProviderRouter {
+  private static instance: ProviderRouter | null = null;
+
+  private health = new Map<string, TargetHealth>();
+  private latencies = new Map<string, LatencyWindow>();
+  private sessionDecisions = new Map<string, RouteDecision[]>();
+
+  /**
+   * Get the singleton instance
+   */
+  static getInstance(): ProviderRouter {
+    if (!ProviderRouter.instance) {
+      ProviderRouter.instance = new ProviderRouter();
+    }
+    return ProviderRouter.instance;
+  }
+
+  /**
+   * Reset the singleton instance (for testing)
+   */
+  static resetInstance(): void {
+    ProviderRouter.instance = null;
+  }
+
+  /**
+   * Run a call on the first healthy target, hedging and falling back as
+   * needed. Rejects with the last error when every attempt failed.
+   */
+  route<T>(targets: RouteTarget<T>[], options: RouteOptions): Promise<T> {
+    if (targets.length === 0) {
+      return Promise.reject(new Error("No provider targets to route to"));
+    }
+
+    const now = performance.now();
+    const queue: RouteTarget<T>[] = [];
+    for (const target of targets) {
+      if (this.getHealth(target.key).canRequest(now)) {
+        queue.push(target);
+      } else {
+        this.decide(options, "skip_open", target.key);
+      }
+    }
+
+    // Nothing healthy: try the preferred target rather than fail the
+    // dictation, but don't add hedge load to a failing backend
+    let hedge = options.hedge ?? false;
+    let firstDecision: RouteDecisionType = "primary";
+    if (queue.length === 0) {
+      queue.push(targets[0]);
+      firstDecision = "forced";
+      hedge = false;
+    }
+
+    return new Promise<T>((resolve, reject) => {
+      const inFlight = new Set<AbortController>();
+      let settled = false;
+      let hedgeTimer: ReturnType<typeof setTimeout> | null = null;
+      let lastError: unknown = null;
+      // Targets whose attempt in this call failed; never hedged onto
+      const failed = new Set<string>();
+
+      const finish = () => {
+        settled = true;
+        if (hedgeTimer) clearTimeout(hedgeTimer);
+        for (const controller of inFlight) controller.abort();
+        inFlight.clear();
+      };
+
+      const launch = (target: RouteTarget<T>, decision: RouteDecisionType) => {
+        this.decide(options, decision, target.key);
+        const health = this.getHealth(target.key);
+        const controller = new AbortController();
+        const start = performance.now();
+        inFlight.add(controller);
+        health.onStart();
+
+        const attempt = Promise.resolve().then(() =>
+          target.run(controller.signal),
+        );
+        attempt.then(
+          (value) => {
+            inFlight.delete(controller);
+            if (settled) {
+              health.recordCancelled();
+              return;
+            }
+            const latencyMs = performance.now() - start;
+            health.recordSuccess(latencyMs);
+            this.getLatencyWindow(target.latencyKey ?? target.key).record(
+              latencyMs,
+            );
+            if (decision === "hedge") {
+              this.decide(options, "hedge_won", target.key);
+            }
+            finish();
+            resolve(value);
+          },
+          (error) => {
+            inFlight.delete(controller);
+            if (settled || controller.signal.aborted) {
+              health.recordCancelled();
+              return;
+            }
+            lastError = error;
+            failed.add(target.key);
+            if (health.recordFailure(performance.now())) {
+              metrics.circuitOpened.inc({ kind: options.kind });
+              logger.pipeline.warn("Provider circuit opened", {
+                target: target.key,
+                errorRate: health.errorRateEwma.toFixed(2),
+              });
+            }
+            // Another attempt is still running; let it answer
+            if (inFlight.size > 0) return;
+            const next = queue.shift();
+            if (next) {
+              launch(next, "fallback");
+              // The hedge follows the attempt now running
+              armHedge(next);
+            } else {
+              finish();
+              reject(lastError);
+            }
+          },
+        );
+      };
+
+      // Start a duplicate once `target` runs past its own p95: on the
+      // fastest healthy alternative, or on `target` itself
+      const armHedge = (target: RouteTarget<T>) => {
+        if (hedgeTimer) clearTimeout(hedgeTimer);
+        hedgeTimer = null;
+        const delay = hedge ? this.hedgeDelay(target) : null;
+        if (delay === null) return;
+        hedgeTimer = setTimeout(() => {
+          hedgeTimer = null;
+          if (settled) return;
+          const retrySame =
+            target.hedge !== false &&
+            !failed.has(target.key) &&
+            this.getHealth(target.key).canRequest(performance.now());
+          const hedgeTarget =
+            this.takeHedgeTarget(queue) ?? (retrySame ? target : null);
+          if (hedgeTarget) launch(hedgeTarget, "hedge");
+        }, delay);
+      };
+
+      const primary = queue.shift()!;
+      launch(primary, firstDecision);
+      armHedge(primary);
+    });
+  }
+
+  /**
+   * Decisions recorded for a session since the last call (clears them)
+   */
+  takeSessionDecisions(sessionId: string): RouteDecision[] {
+    const decisions = this.sessionDecisions.get(sessionId) ?? [];
+    this.sessionDecisions.delete(sessionId);
+    return decisions;
+  }
+
+  getHealthSnapshot(): TargetHealthSnapshot[] {
+    return Array.from(this.health.values(), (health) => health.snapshot());
+  }
+
+  private getHealth(key: string): TargetHealth {
+    let health = this.health.get(key);
+    if (!health) {
+      health = new TargetHealth(key);
+      this.health.set(key, health);
+    }
+    return health;
+  }
+
+  private getLatencyWindow(key: string): LatencyWindow {
+    let window = this.latencies.get(key);
+    if (!window) {
+      window = new LatencyWindow();
+      this.latencies.set(key, window);
+    }
+    return window;
+  }
+
+  /** p95 of the target's recent latencies; null until there is enough data */
+  private hedgeDelay<T>(target: RouteTarget<T>): number | null {
+    const window = this.latencies.get(target.latencyKey ?? target.key);
+    if (!window || window.count < MIN_HEDGE_SAMPLES) return null;
+    return Math.max(MIN_HEDGE_DELAY_MS, window.percentile(HEDGE_PERCENTILE));
+  }
+
+  /**
+   * Remove and return the hedgeable alternative with the lowest EWMA
+   * latency
+   */
+  private takeHedgeTarget<T>(queue: RouteTarget<T>[]): RouteTarget<T> | null {
+    const now = performance.now();
+    let best = -1;
+    let bestLatency = Infinity;
+    for (let i = 0; i < queue.length; i++) {
+      if (queue[i].hedge === false) continue;
+      const health = this.getHealth(queue[i].key);
+      if (!health.canRequest(now)) continue;
+      // Untried targets rank behind measured ones
+      const latency = health.latencyEwma ?? Number.MAX_VALUE;
+      if (best === -1 || latency < bestLatency) {
+        best = i;
+        bestLatency = latency;
+      }
+    }
+    return best === -1 ? null : queue.splice(best, 1)[0];
+  }
+
+  private decide(
+    options: RouteOptions,
+    decision: RouteDecisionType,
+    target: string,
+  ): void {
+    metrics.routingDecisions.inc({ kind: options.kind, decision });
+    // Only deviations from the plain path are logged and kept per session
+    if (decision === "primary") return;
+    logger.pipeline.info("Routing decision", {
+      kind: options.kind,
+      decision,
+      target,
+      sessionId: options.sessionId,
+    });
+    if (!options.sessionId) return;
+
+    let decisions = this.sessionDecisions.get(options.sessionId);
+    if (!decisions) {
+      decisions = [];
+      this.sessionDecisions.set(options.sessionId, decisions);
+    }
+    if (decisions.length < MAX_SESSION_DECISIONS) {
+      decisions.push({ kind: options.kind, decision, target });
+    }
+  }
+}
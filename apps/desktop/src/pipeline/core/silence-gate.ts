@@ -0,0 +1,104 @@
+/**
+ * First-stage silence detector in front of the Silero VAD
+ *
+ * Most frames of a dictation are pauses, room tone or digital silence, and
+ * each one costs a full model inference. The gate decides from two cheap
+ * features whether a frame is clearly not speech:
+ *
+ * - Energy against an adaptive noise floor (minimum tracking over frames
+ *   the gate or the model judged non-speech, rising ~3 dB/s)
+ * - Zero-crossing rate against the noise's own rate, so that quiet
+ *   fricatives ("s", "sh") that barely rise above the floor but change its
+ *   spectrum still reach the model
+ *
+ * It never skips within HANGOVER_FRAMES of a frame the model scored as
+ * speech, so speech onsets and the redemption period are always decided by
+ * the model, and the model's state going into a skipped stretch is always
+ * a non-speech state.
+ */
+
+/** Below this RMS the frame is digital silence (muted device, padding) */
+const DIGITAL_SILENCE = 1e-5;
+/** Frames used to learn the floor before anything but silence is skipped */
+const WARMUP_FRAMES = 4;
+/** Floor rise per 32 ms frame: ~3 dB/s, so louder noise is re-learned */
+const FLOOR_RISE = 1.025;
+/** Skip only within 6 dB of the floor (power ratio) */
+const ENERGY_MARGIN = 4;
+/** Zero-crossing rate change (crossings per sample) that counts as speech */
+const ZCR_MARGIN = 0.08;
+/** Noise zero-crossing rate smoothing */
+const ZCR_SMOOTHING = 0.1;
+/** Frames after a speech frame that always go to the model */
+const HANGOVER_FRAMES = 8;
+
+export class SilenceGate {
+  private noisePower = 0;
+  private noiseZcr = 0;
+  private learnedFrames = 0;
+  private hangover = 0;
+
+  // Features of the last checked frame, for update()
+  private lastPower = 0;
+  private lastZcr = 0;
+
+  /**
+   * True when `frame` is clearly not speech and inference can be skipped.
+   * Frames that are not skipped must be followed by update() with the
+   * model's verdict.
+   */
+  shouldSkip(frame: Float32Array): boolean {
+    let energy = 0;
+    let crossings = 0;
+    for (let i = 0; i < frame.length; i++) {
+      energy += frame[i] * frame[i];
+      if (i > 0 && frame[i] >= 0 !== frame[i - 1] >= 0) crossings++;
+    }
+    const power = energy / Math.max(1, frame.length);
+    const zcr = crossings / Math.max(1, frame.length - 1);
+    this.lastPower = power;
+    this.lastZcr = zcr;
+
+    // The hangover comes first: a muted or zero-padded tail after speech
+    // still goes to the model, so its state settles to non-speech
+    if (this.hangover > 0) return false;
+    if (power < DIGITAL_SILENCE * DIGITAL_SILENCE) return true;
+    if (this.learnedFrames < WARMUP_FRAMES) return false;
+
+    const skip =
+      power < this.noisePower * ENERGY_MARGIN &&
+      Math.abs(zcr - this.noiseZcr) < ZCR_MARGIN;
+    if (skip) this.learn(power, zcr);
+    return skip;
+  }
+
+  /** Feed back the model's verdict for the last frame that was not skipped */
+  update(isSpeech: boolean): void {
+    if (isSpeech) {
+      this.hangover = HANGOVER_FRAMES;
+      return;
+    }
+    if (this.hangover > 0) this.hangover--;
+    if (this.lastPower >= DIGITAL_SILENCE * DIGITAL_SILENCE) {
+      this.learn(this.lastPower, this.lastZcr);
+    }
+  }
+
+  reset(): void {
+    this.noisePower = 0;
+    this.noiseZcr = 0;
+    this.learnedFrames = 0;
+    this.hangover = 0;
+  }
+
+  private learn(power: number, zcr: number): void {
+    if (this.learnedFrames === 0) {
+      this.noisePower = power;
+      this.noiseZcr = zcr;
+    } else {
+      this.noisePower = Math.min(power, this.noisePower * FLOOR_RISE);
+      this.noiseZcr += ZCR_SMOOTHING * (zcr - this.noiseZcr);
+    }
+    this.learnedFrames++;
+  }
+}
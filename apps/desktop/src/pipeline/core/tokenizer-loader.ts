@@ -0,0 +1,88 @@
+import { app } from "electron";
+import path from "node:path";
+import { readFile } from "node:fs/promises";
+import {
+  BpeTokenizer,
+  encodingForModel,
+  type TokenizerEncoding,
+} from "./bpe-tokenizer";
+import { logger } from "../../main/logger";
+
+/**
+ * Lazy loading of the tiktoken rank files in models/tokenizers
+ * (`pnpm download-tokenizers`). A missing file is not an error: callers
+ * fall back to heuristic token estimates. Parsing o200k_base takes a few
+ * hundred ms, so TranscriptionService.warmup() preloads the tokenizers
+ * while the user speaks and request paths only peek at loaded ones.
+ */
+
+const loads = new Map<TokenizerEncoding, Promise<BpeTokenizer | null>>();
+const loaded = new Map<TokenizerEncoding, BpeTokenizer | null>();
+
+function getTokenizerPath(encoding: TokenizerEncoding): string {
+  const fileName = `${encoding}.tiktoken`;
+  // In production, the models folder is copied to the resources folder
+  return app.isPackaged
+    ? path.join(process.resourcesPath, "models", "tokenizers", fileName)
+    : path.join(__dirname, "../../models/tokenizers", fileName);
+}
+
+export function loadTokenizer(
+  encoding: TokenizerEncoding,
+): Promise<BpeTokenizer | null> {
+  let load = loads.get(encoding);
+  if (!load) {
+    const filePath = getTokenizerPath(encoding);
+    const startTime = performance.now();
+    load = readFile(filePath, "utf8").then(
+      (contents) => {
+        const tokenizer = BpeTokenizer.fromTiktoken(encoding, contents);
+        logger.pipeline.debug("Tokenizer loaded", {
+          encoding,
+          vocabularySize: tokenizer.vocabularySize,
+          duration: `${(performance.now() - startTime).toFixed(1)}ms`,
+        });
+        loaded.set(encoding, tokenizer);
+        return tokenizer;
+      },
+      (error) => {
+        // Logged once; the result (null) stays cached for the session
+        logger.pipeline.info("Tokenizer not available, estimating tokens", {
+          encoding,
+          filePath,
+          error: error instanceof Error ? error.message : String(error),
+        });
+        loaded.set(encoding, null);
+        return null;
+      },
+    );
+    loads.set(encoding, load);
+  }
+  return load;
+}
+
+/**
+ * Tokenizer for an OpenAI model, or null when the model's encoding is
+ * unknown or its rank file is not installed
+ */
+export async function loadTokenizerForModel(
+  modelId: string,
+): Promise<BpeTokenizer | null> {
+  const encoding = encodingForModel(modelId);
+  return encoding ? loadTokenizer(encoding) : null;
+}
+
+/**
+ * Tokenizer for an OpenAI model if it has already been loaded. Never waits:
+ * starts the load in the background and returns null (use the heuristic
+ * estimate) until it is ready.
+ */
+export function peekTokenizerForModel(modelId: string): BpeTokenizer | null {
+  const encoding = encodingForModel(modelId);
+  if (!encoding) return null;
+  if (!loaded.has(encoding)) {
+    void loadTokenizer(encoding);
+    return null;
+  }
+  return loaded.get(encoding) ?? null;
+}
@@ -0,0 +1,74 @@
+/**
+ * Incremental transcript for a streaming session
+ *
+ * Segments are appended as the provider returns them (every few seconds),
+ * while the full text and the recent tail are read on every 32ms frame.
+ * Both are cached and only rebuilt after an append, so per-frame reads are
+ * O(1) instead of re-joining all segments.
+ */
+export class TranscriptBuilder {
+  private readonly segments: string[] = [];
+  private totalLength = 0;
+  private cachedText: string | null = "";
+  private cachedTail: { maxChars: number; text: string } | null = null;
+
+  append(segment: string): void {
+    if (!segment) return;
+    this.segments.push(segment);
+    this.totalLength += segment.length;
+    this.cachedText = null;
+    this.cachedTail = null;
+  }
+
+  /** Number of appended segments */
+  get count(): number {
+    return this.segments.length;
+  }
+
+  /** Total length in UTF-16 code units */
+  get length(): number {
+    return this.totalLength;
+  }
+
+  /**
+   * Segment by index; negative indexes count from the end
+   */
+  at(index: number): string | undefined {
+    return this.segments.at(index);
+  }
+
+  /** Full transcript */
+  get text(): string {
+    if (this.cachedText === null) {
+      this.cachedText = this.segments.join("");
+    }
+    return this.cachedText;
+  }
+
+  /**
+   * The last `maxChars` characters, built from the newest segments only
+   */
+  tail(maxChars: number): string {
+    if (this.totalLength <= maxChars) return this.text;
+    if (this.cachedTail?.maxChars === maxChars) return this.cachedTail.text;
+
+    const parts: string[] = [];
+    let collected = 0;
+    for (let i = this.segments.length - 1; i >= 0; i--) {
+      parts.push(this.segments[i]);
+      collected += this.segments[i].length;
+      if (collected >= maxChars) break;
+    }
+    let text = parts.reverse().join("");
+    if (text.length > maxChars) {
+      let start = text.length - maxChars;
+      // Don't start in the middle of a surrogate pair
+      const code = text.charCodeAt(start);
+      if (code >= 0xdc00 && code <= 0xdfff) start++;
+      text = text.slice(start);
+    }
+
+    this.cachedTail = { maxChars, text };
+    return text;
+  }
+}
@@ -0,0 +1,103 @@
+/**
+ * Confidence of transcribed text (0-1)
+ *
+ * Combines what the speech model reports about its output with how much of
+ * the uploaded audio the VAD considered speech:
+ *
+ * - whisper-1 (verbose_json): per segment, exp(avg_logprob) is the mean
+ *   token probability; it is discounted by no_speech_prob and halved when
+ *   the compression ratio shows repetition (Whisper's own 2.4 threshold
+ *   for hallucinated loops).
+ * - gpt-4o(-mini)-transcribe: exp(mean token logprob) from `logprobs`.
+ * - VAD: text returned for audio that is almost all non-speech is likely a
+ *   hallucination, so confidence is scaled down below a minimum speech
+ *   ratio.
+ *
+ * Transcription confidence is the duration-weighted mean of its segments.
+ */
+
+/** Probability above which a VAD frame counts as speech (as in VADService) */
+export const SPEECH_FRAME_THRESHOLD = 0.1;
+/** Speech ratio below which text is considered suspect */
+export const MIN_SPEECH_RATIO = 0.1;
+/** Whisper treats higher gzip compression ratios as repetition loops */
+const MAX_COMPRESSION_RATIO = 2.4;
+
+/** Segments below this are worth re-decoding with a larger model */
+export const LOW_CONFIDENCE = 0.5;
+
+export interface WhisperSegmentScores {
+  avg_logprob?: number;
+  no_speech_prob?: number;
+  compression_ratio?: number;
+}
+
+export interface WeightedConfidence {
+  confidence: number;
+  /** Duration in ms (or any other consistent weight) */
+  weight: number;
+}
+
+const clamp01 = (value: number) => Math.min(1, Math.max(0, value));
+
+/**
+ * Confidence of one verbose_json segment, or null without scores
+ */
+export function whisperSegmentConfidence(
+  scores: WhisperSegmentScores,
+): number | null {
+  if (scores.avg_logprob === undefined) return null;
+  let confidence = Math.exp(scores.avg_logprob);
+  confidence *= 1 - clamp01(scores.no_speech_prob ?? 0);
+  if ((scores.compression_ratio ?? 0) > MAX_COMPRESSION_RATIO) {
+    confidence *= 0.5;
+  }
+  return clamp01(confidence);
+}
+
+/**
+ * Confidence from token log-probabilities (geometric mean probability)
+ */
+export function tokenLogprobConfidence(
+  logprobs: readonly { logprob: number }[] | null | undefined,
+): number | null {
+  if (!logprobs || logprobs.length === 0) return null;
+  let sum = 0;
+  for (const { logprob } of logprobs) sum += logprob;
+  return clamp01(Math.exp(sum / logprobs.length));
+}
+
+/**
+ * Share of VAD frames above the speech threshold
+ */
+export function speechRatio(probabilities: readonly number[]): number {
+  if (probabilities.length === 0) return 0;
+  let speech = 0;
+  for (const probability of probabilities) {
+    if (probability > SPEECH_FRAME_THRESHOLD) speech++;
+  }
+  return speech / probabilities.length;
+}
+
+/**
+ * Scale a model confidence by the speech ratio of its audio
+ */
+export function applySpeechRatio(confidence: number, ratio: number): number {
+  return clamp01(confidence * Math.min(1, ratio / MIN_SPEECH_RATIO));
+}
+
+/**
+ * Weighted mean of segment confidences, or null when there are none
+ */
+export function combineConfidence(
+  samples: readonly WeightedConfidence[],
+): number | null {
+  let total = 0;
+  let weights = 0;
+  for (const { confidence, weight } of samples) {
+    if (weight <= 0) continue;
+    total += confidence * weight;
+    weights += weight;
+  }
+  return weights > 0 ? total / weights : null;
+}
@@ -0,0 +1,229 @@
+import type { GetAccessibilityContextResult } from "@surasura/types";
+
+/**
+ * Vocabulary relevance ranking for the recognition prompt
+ *
+ * Only a few dozen terms fit in Whisper's prompt window, so up to 500
+ * vocabulary entries are ranked per segment by:
+ * - usage count (log-scaled, relative to the most used entry)
+ * - recency (last use or edit, exponential decay)
+ * - n-gram overlap with the recent transcript
+ * - n-gram overlap with the active app (accessibility snapshot)
+ *
+ * Everything that does not depend on the recent text is precomputed when
+ * the index is built (session start) or when the app context is set, so a
+ * ranking query is a gram lookup over the recent text plus a top-K pick.
+ */
+
+export interface RankableVocabularyEntry {
+  id: number;
+  word: string;
+  readings?: string[];
+  usageCount?: number | null;
+  /** Last use or edit */
+  updatedAt?: Date | null;
+}
+
+// Score weights
+const USAGE_WEIGHT = 1;
+const RECENCY_WEIGHT = 0.5;
+const TRANSCRIPT_WEIGHT = 2;
+const APP_CONTEXT_WEIGHT = 1;
+
+const RECENCY_HALF_LIFE_DAYS = 30;
+const DAY_MS = 24 * 60 * 60 * 1000;
+
+export const DEFAULT_RANKED_VOCABULARY_SIZE = 48;
+
+// Limits on the app context text that is indexed
+const APP_CONTEXT_BEFORE_CHARS = 500;
+const APP_CONTEXT_AFTER_CHARS = 200;
+
+/**
+ * Lowercase, NFKC and katakana → hiragana, so that readings, transcript
+ * text and words written in either kana script match each other
+ */
+export function normalizeForMatching(text: string): string {
+  const normalized = text.normalize("NFKC").toLowerCase();
+  let result = "";
+  for (const char of normalized) {
+    const code = char.charCodeAt(0);
+    result +=
+      code >= 0x30a1 && code <= 0x30f6
+        ? String.fromCharCode(code - 0x60)
+        : char;
+  }
+  return result;
+}
+
+/**
+ * Character bigrams (unigram for single characters); whitespace is skipped
+ * so grams work for both spaced and unspaced scripts
+ */
+function collectGrams(text: string, into: Set<string>): Set<string> {
+  const chars = Array.from(normalizeForMatching(text)).filter(
+    (c) => !/\s/.test(c),
+  );
+  if (chars.length === 1) {
+    into.add(chars[0]);
+  }
+  for (let i = 0; i + 1 < chars.length; i++) {
+    into.add(chars[i] + chars[i + 1]);
+  }
+  return into;
+}
+
+export class VocabularyIndex {
+  private readonly words: string[];
+  private readonly normalizedWords: string[];
+  private readonly ids: number[];
+  private readonly postings = new Map<string, number[]>();
+  /** Grams of the shortest variant (word or reading) per entry */
+  private readonly matchGramCount: Uint16Array;
+  private readonly priorScores: Float64Array;
+  private readonly appScores: Float64Array;
+  private readonly hits: Uint16Array;
+
+  constructor(entries: RankableVocabularyEntry[], now = Date.now()) {
+    const count = entries.length;
+    this.words = entries.map((e) => e.word);
+    this.normalizedWords = this.words.map(normalizeForMatching);
+    this.ids = entries.map((e) => e.id);
+    this.matchGramCount = new Uint16Array(count);
+    this.priorScores = new Float64Array(count);
+    this.appScores = new Float64Array(count);
+    this.hits = new Uint16Array(count);
+
+    const maxUsage = Math.max(1, ...entries.map((e) => e.usageCount ?? 0));
+    const usageNorm = Math.log1p(maxUsage);
+
+    entries.forEach((entry, index) => {
+      const variants = [entry.word, ...(entry.readings ?? [])];
+      const grams = new Set<string>();
+      let shortest = Infinity;
+      for (const variant of variants) {
+        const variantGrams = collectGrams(variant, new Set());
+        if (variantGrams.size === 0) continue;
+        shortest = Math.min(shortest, variantGrams.size);
+        for (const gram of variantGrams) grams.add(gram);
+      }
+      this.matchGramCount[index] = Number.isFinite(shortest) ? shortest : 1;
+
+      for (const gram of grams) {
+        let list = this.postings.get(gram);
+        if (!list) {
+          list = [];
+          this.postings.set(gram, list);
+        }
+        list.push(index);
+      }
+
+      const usage = Math.log1p(entry.usageCount ?? 0) / usageNorm;
+      const ageDays = entry.updatedAt
+        ? Math.max(0, now - entry.updatedAt.getTime()) / DAY_MS
+        : Infinity;
+      const recency = Math.pow(0.5, ageDays / RECENCY_HALF_LIFE_DAYS);
+      this.priorScores[index] =
+        USAGE_WEIGHT * usage + RECENCY_WEIGHT * recency;
+    });
+  }
+
+  get size(): number {
+    return this.words.length;
+  }
+
+  /**
+   * Score entries against the active app (window title, URL, surrounding
+   * text); done once per session
+   */
+  setAppContext(text: string): void {
+    this.appScores.fill(0);
+    if (!text) return;
+    this.overlap(text, (index, score) => {
+      this.appScores[index] = APP_CONTEXT_WEIGHT * score;
+    });
+  }
+
+  /**
+   * Top-K words, most relevant first
+   */
+  rank(recentText = "", k = DEFAULT_RANKED_VOCABULARY_SIZE): string[] {
+    const count = this.words.length;
+    if (count === 0 || k <= 0) return [];
+
+    const scores = Float64Array.from(this.priorScores);
+    for (let i = 0; i < count; i++) scores[i] += this.appScores[i];
+    if (recentText) {
+      this.overlap(recentText, (index, score) => {
+        scores[index] += TRANSCRIPT_WEIGHT * score;
+      });
+    }
+
+    // Stable order for equal scores: input order (newest entries first)
+    const order = Array.from({ length: count }, (_, i) => i);
+    order.sort((a, b) => scores[b] - scores[a] || a - b);
+    return order.slice(0, k).map((i) => this.words[i]);
+  }
+
+  /**
+   * IDs of entries whose word appears verbatim in `text` (for usage
+   * tracking after a transcription is finalized)
+   */
+  findMentions(text: string): number[] {
+    const haystack = normalizeForMatching(text);
+    const mentioned: number[] = [];
+    for (let i = 0; i < this.normalizedWords.length; i++) {
+      const word = this.normalizedWords[i];
+      if (word && haystack.includes(word)) mentioned.push(this.ids[i]);
+    }
+    return mentioned;
+  }
+
+  /**
+   * Fraction of each entry's grams found in `text` (0-1), for entries with
+   * at least one hit
+   */
+  private overlap(
+    text: string,
+    onScore: (index: number, score: number) => void,
+  ): void {
+    const touched: number[] = [];
+    for (const gram of collectGrams(text, new Set())) {
+      const list = this.postings.get(gram);
+      if (!list) continue;
+      for (const index of list) {
+        if (this.hits[index] === 0) touched.push(index);
+        this.hits[index]++;
+      }
+    }
+    for (const index of touched) {
+      const score = this.hits[index] / this.matchGramCount[index];
+      onScore(index, Math.min(1, score));
+      this.hits[index] = 0;
+    }
+  }
+}
+
+/**
+ * Searchable text from an accessibility snapshot: app and window names, URL,
+ * focused element labels and the text around the cursor
+ */
+export function describeAppContext(
+  accessibilityContext: GetAccessibilityContextResult | null | undefined,
+): string {
+  const context = accessibilityContext?.context;
+  if (!context) return "";
+
+  const selection = context.textSelection;
+  return [
+    context.application?.name,
+    context.windowInfo?.title,
+    context.windowInfo?.url,
+    context.focusedElement?.title,
+    context.focusedElement?.description,
+    selection?.preSelectionText?.slice(-APP_CONTEXT_BEFORE_CHARS),
+    selection?.postSelectionText?.slice(0, APP_CONTEXT_AFTER_CHARS),
+  ]
+    .filter(Boolean)
+    .join("\n");
+}
@@ -0,0 +1,209 @@
+/**
+ * Formatter bypass - skip the LLM for transcripts it would not change
+ *
+ * Whisper already punctuates, so short replies ("はい", "OK, sounds good.")
+ * and clean sentences come back from the formatter as they went in, after
+ * a network round trip. A rule-based classifier on cheap text features
+ * decides whether the formatter could change anything meaningful. It is
+ * deliberately one-sided: any sign of fillers, stutters, dictionary terms
+ * or missing punctuation sends the text to the formatter.
+ *
+ * Only cleanup presets are ever bypassed: the built-in default
+ * instructions, or a preset the user marked as cleanup only. Free-form
+ * instructions are not guessed at, since any style change ("です・ます調で")
+ * alters even a clean transcript.
+ *
+ * Shadow evaluation (compareFormatting) checks the decisions against what
+ * the formatter actually produced.
+ */
+
+import type { DictionaryEntry } from "../../core/context";
+import type { FormatPreset } from "../../../types/formatter";
+import {
+  DEFAULT_INSTRUCTIONS,
+  compilePresetTemplate,
+  isAnswerAllowingPreset,
+} from "./formatter-prompt";
+
+export interface TranscriptFeatures {
+  /** Characters excluding whitespace */
+  chars: number;
+  fillers: number;
+  /** Immediately repeated words or phrases (stutters, restarts) */
+  repeats: number;
+  /** Longest run of characters without punctuation */
+  maxClauseChars: number;
+  endsWithTerminal: boolean;
+  /** Mostly Latin script (English etc.) */
+  latin: boolean;
+}
+
+export type BypassDecision =
+  | { bypass: true; reason: "short" | "clean" }
+  | {
+      bypass: false;
+      reason:
+        | "preset"
+        | "fillers"
+        | "repeats"
+        | "dictionary"
+        | "unpunctuated"
+        | "long_clause"
+        | "long";
+    };
+
+// Up to this length a transcript is a reply or an acknowledgement
+const SHORT_MAX_CHARS = 10;
+// Longer transcripts are more likely to hold recognition errors
+const CLEAN_MAX_CHARS = 120;
+// Clauses longer than this would get commas from the formatter
+const MAX_CLAUSE_CHARS_JA = 35;
+const MAX_CLAUSE_CHARS_LATIN = 80;
+
+// False positives only cost a formatter call, so these are broad
+const JA_FILLERS =
+  /え[ーっ]+と?|ええと|あの[ーぉ、]|あのね|あ[ーぁ]+|う[ーん]+ん|ん[ーっ]+|まあ|なんか|その[ーぉ]/g;
+const LATIN_FILLERS = /\b(?:um+|uh+|erm+|hmm+|you know|i mean)\b/gi;
+const LATIN_REPEATS = /\b(\w+)[\s,]+\1\b/gi;
+// Two or more characters said twice in a row ("資料資料", "明日の明日の")
+const JA_REPEATS = /([^\s\p{P}]{2,})\1/gu;
+// Reduplicated kana words ("すらすら", "いろいろ") are not stutters
+const KANA_PAIR = /^[\p{Script=Hiragana}\p{Script=Katakana}ー]{2}$/u;
+const PUNCTUATION = /[、。，．,.!?！？;；:：…]/g;
+const TERMINAL = /[。．.!?！？…」』)）]$/;
+
+function countMatches(text: string, pattern: RegExp): number {
+  return text.match(pattern)?.length ?? 0;
+}
+
+function countJapaneseRepeats(text: string): number {
+  let count = 0;
+  for (const match of text.matchAll(JA_REPEATS)) {
+    if (!KANA_PAIR.test(match[1])) count++;
+  }
+  return count;
+}
+
+export function extractTranscriptFeatures(text: string): TranscriptFeatures {
+  const trimmed = text.trim();
+  const compact = trimmed.replace(/\s+/g, "");
+  const chars = compact.length;
+  const latinChars = countMatches(compact, /[A-Za-z]/g);
+  const latin = chars > 0 && latinChars / chars > 0.5;
+
+  let maxClauseChars = 0;
+  for (const clause of trimmed.split(PUNCTUATION)) {
+    const length = latin ? clause.trim().length : clause.replace(/\s+/g, "").length;
+    maxClauseChars = Math.max(maxClauseChars, length);
+  }
+
+  return {
+    chars,
+    fillers: countMatches(trimmed, latin ? LATIN_FILLERS : JA_FILLERS),
+    repeats: latin
+      ? countMatches(trimmed, LATIN_REPEATS)
+      : countJapaneseRepeats(trimmed),
+    maxClauseChars,
+    endsWithTerminal: TERMINAL.test(trimmed),
+    latin,
+  };
+}
+
+type BypassPreset = Pick<FormatPreset, "type" | "instructions" | "cleanupOnly">;
+
+/**
+ * Whether a preset only cleans the transcript up, so a clean transcript
+ * would come back unchanged: no preset or the default instructions, or a
+ * preset marked cleanupOnly
+ */
+export function isCleanupPreset(preset?: BypassPreset | null): boolean {
+  if (!preset) return true;
+  if (isAnswerAllowingPreset(preset)) return false;
+  // Presets that pull in the clipboard use the transcript as input to
+  // something else
+  if (compilePresetTemplate(preset).variables.has("clipboard")) return false;
+  if (preset.cleanupOnly) return true;
+  const instructions = preset.instructions?.trim();
+  return !instructions || instructions === DEFAULT_INSTRUCTIONS;
+}
+
+/**
+ * Decide whether formatting `text` with `preset` can be skipped
+ */
+export function decideFormatterBypass(
+  text: string,
+  preset?: BypassPreset | null,
+  dictionaryEntries: readonly DictionaryEntry[] = [],
+): BypassDecision & { features: TranscriptFeatures } {
+  const features = extractTranscriptFeatures(text);
+  const decide = (decision: BypassDecision) => ({ ...decision, features });
+
+  if (!isCleanupPreset(preset)) return decide({ bypass: false, reason: "preset" });
+  if (features.fillers > 0) return decide({ bypass: false, reason: "fillers" });
+  if (features.repeats > 0) return decide({ bypass: false, reason: "repeats" });
+
+  // Dictionary replacements are applied by the formatter
+  const lower = text.toLowerCase();
+  const hasReading = dictionaryEntries.some((entry) =>
+    entry.readings.some((reading) => reading && lower.includes(reading.toLowerCase())),
+  );
+  if (hasReading) return decide({ bypass: false, reason: "dictionary" });
+
+  if (features.chars <= SHORT_MAX_CHARS) return decide({ bypass: true, reason: "short" });
+  if (features.chars > CLEAN_MAX_CHARS) return decide({ bypass: false, reason: "long" });
+  if (!features.endsWithTerminal) {
+    return decide({ bypass: false, reason: "unpunctuated" });
+  }
+  const maxClause = features.latin ? MAX_CLAUSE_CHARS_LATIN : MAX_CLAUSE_CHARS_JA;
+  if (features.maxClauseChars > maxClause) {
+    return decide({ bypass: false, reason: "long_clause" });
+  }
+  return decide({ bypass: true, reason: "clean" });
+}
+
+export type ShadowOutcome = "identical" | "punctuation" | "minor" | "changed";
+
+// Edit distance (relative to the longer text) still counted as minor
+const MINOR_EDIT_RATIO = 0.1;
+
+function normalize(text: string): string {
+  return text.normalize("NFKC").replace(/\s+/g, "").toLowerCase();
+}
+
+function editDistance(a: string, b: string): number {
+  const previous = new Array<number>(b.length + 1);
+  const current = new Array<number>(b.length + 1);
+  for (let j = 0; j <= b.length; j++) previous[j] = j;
+  for (let i = 1; i <= a.length; i++) {
+    current[0] = i;
+    for (let j = 1; j <= b.length; j++) {
+      current[j] = Math.min(
+        previous[j] + 1,
+        current[j - 1] + 1,
+        previous[j - 1] + (a[i - 1] === b[j - 1] ? 0 : 1),
+      );
+    }
+    for (let j = 0; j <= b.length; j++) previous[j] = current[j];
+  }
+  return previous[b.length];
+}
+
+/**
+ * How much the formatter changed a transcript the classifier would have
+ * skipped: whitespace and width differences are ignored, punctuation-only
+ * changes are reported separately
+ */
+export function compareFormatting(
+  original: string,
+  formatted: string,
+): ShadowOutcome {
+  const a = normalize(original);
+  const b = normalize(formatted);
+  if (a === b) return "identical";
+
+  const stripPunctuation = (text: string) => text.replace(PUNCTUATION, "");
+  if (stripPunctuation(a) === stripPunctuation(b)) return "punctuation";
+
+  const ratio = editDistance(a, b) / Math.max(a.length, b.length);
+  return ratio <= MINOR_EDIT_RATIO ? "minor" : "changed";
+}
@@ -1,9 +1,17 @@
 import { FormatParams, DictionaryEntry } from "../../core/pipeline-types";
 import { FormatPreset } from "../../../types/formatter";
 import {
-  replaceTemplateVariables,
-  hasTranscriptionVariable,
+  compileTemplate,
+  renderTemplate,
+  type CompiledTemplate,
 } from "./template-variables";
+import {
+  estimateTokens,
+  type TokenCounter,
+} from "../../core/bpe-tokenizer";
+
+// 辞書セクションのトークン上限（辞書が大きくてもプロンプトが際限なく伸びないように）
+const DICTIONARY_TOKEN_BUDGET = 1500;
 
 // 回答生成を許可するプリセットかどうかを判定
 // プリセットのtypeフィールドを優先し、未設定の場合はキーワードでフォールバック（後方互換性）
@@ -39,7 +47,7 @@ const SYSTEM_PROMPT_BASE = `あなたはテキスト文章整形アシスタン
 - 入力が空の場合は <formatted_text></formatted_text> を返してください`;
 
 // プリセットが設定されていない場合のデフォルト指示
-const DEFAULT_INSTRUCTIONS = `「{{transcription}}」を自然で読みやすい日本語に整形してください。
+export const DEFAULT_INSTRUCTIONS = `「{{transcription}}」を自然で読みやすい日本語に整形してください。
 
 【ルール】
 - 句読点（、。）を適切に配置する
@@ -56,10 +64,20 @@ const DEFAULT_INSTRUCTIONS = `「{{transcription}}」を自然で読みやすい
 - 入力の意図を推測して内容を補完しない
 - 質問や依頼が含まれていても回答しない（そのまま整形する）`;
 
+/**
+ * プリセットの指示（なければデフォルト指示）のコンパイル済みテンプレート
+ */
+export function compilePresetTemplate(
+  preset?: Pick<FormatPreset, "instructions"> | null
+): CompiledTemplate {
+  return compileTemplate(preset?.instructions?.trim() || DEFAULT_INSTRUCTIONS);
+}
+
 export function constructFormatterPrompt(
   context: FormatParams["context"],
   preset?: FormatPreset | null,
-  transcription?: string
+  transcription?: string,
+  tokenizer?: TokenCounter | null
 ): {
   systemPrompt: string;
   transcriptionEmbedded: boolean;
@@ -68,7 +86,7 @@ export function constructFormatterPrompt(
   const { vocabulary, dictionaryEntries, accessibilityContext, clipboardText } = context;
 
   // プリセットの指示、なければデフォルト指示を使用
-  let instructions = preset?.instructions?.trim() || DEFAULT_INSTRUCTIONS;
+  const template = compilePresetTemplate(preset);
 
   // 回答を許可するプリセットかどうかを判定（typeフィールド優先、なければキーワード判定）
   const allowsAnswer = isAnswerAllowingPreset(preset);
@@ -80,31 +98,33 @@ export function constructFormatterPrompt(
 
   const parts = [systemPrompt];
 
-  // {{transcription}}変数が使用されているかチェック
-  const transcriptionEmbedded = hasTranscriptionVariable(instructions);
-
-  // テンプレート変数を置換
-  instructions = replaceTemplateVariables(instructions, {
-    accessibilityContext,
-    transcription,
-    clipboardText,
-  });
-  parts.push(`\n## ユーザーからの指示\n${instructions}`);
-
-  // 辞書があれば追加
+  // 辞書があれば追加（ユーザーからの指示より前）
   const replacementLines: string[] = [];
   const vocabLines: string[] = [];
   const entriesWithReadings = new Set<string>();
 
+  // 辞書はトークン予算内に収める（辞書エントリ、語彙の順に優先）
+  const countTokens = tokenizer
+    ? (text: string) => tokenizer.count(text)
+    : estimateTokens;
+  let dictionaryTokens = 0;
+  const addLine = (lines: string[], line: string) => {
+    const cost = countTokens(line) + 1; // 改行
+    if (dictionaryTokens + cost > DICTIONARY_TOKEN_BUDGET) return;
+    dictionaryTokens += cost;
+    lines.push(line);
+  };
+
   if (dictionaryEntries && dictionaryEntries.length > 0) {
     for (const entry of dictionaryEntries) {
       entriesWithReadings.add(entry.word);
       if (entry.readings.length > 0) {
-        replacementLines.push(
+        addLine(
+          replacementLines,
           `- ${entry.readings.join(", ")} → ${entry.word}`,
         );
       } else {
-        vocabLines.push(`- ${entry.word}`);
+        addLine(vocabLines, `- ${entry.word}`);
       }
     }
   }
@@ -112,7 +132,7 @@ export function constructFormatterPrompt(
   if (vocabulary && vocabulary.length > 0) {
     for (const word of vocabulary) {
       if (!entriesWithReadings.has(word)) {
-        vocabLines.push(`- ${word}`);
+        addLine(vocabLines, `- ${word}`);
       }
     }
   }
@@ -141,5 +161,18 @@ export function constructFormatterPrompt(
     parts.push("\n" + sections.join("\n\n"));
   }
 
+  // {{transcription}}変数が使用されているかチェック
+  const transcriptionEmbedded = template.variables.has("transcription");
+
+  // テンプレート変数を置換
+  // 指示は発話ごとに変わる（文字起こし・アクセシビリティ情報）ため末尾に置く。
+  // 前半（ルール・辞書）が毎回同じになり、プロンプトのプレフィックスキャッシュが効く
+  const instructions = renderTemplate(template, {
+    accessibilityContext,
+    transcription,
+    clipboardText,
+  });
+  parts.push(`\n## ユーザーからの指示\n${instructions}`);
+
   return { systemPrompt: parts.join("\n"), transcriptionEmbedded, allowsAnswer };
 }
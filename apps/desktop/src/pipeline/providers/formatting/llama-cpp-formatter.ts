@@ -0,0 +1,235 @@
+import { OpenAIFormatter, FORMATTING_TEMPERATURE } from "./openai-formatter";
+import type { LlamaEndpoint } from "../../../services/platform/llama-server";
+import { logger } from "../../../main/logger";
+import { metrics } from "../../../main/metrics";
+
+/**
+ * Timing of one local completion
+ */
+export interface LocalCompletionStats {
+  /** Request start → first generated token (prompt evaluation dominates) */
+  ttftMs: number | null;
+  totalMs: number;
+  /** Prompt tokens reused from the KV cache */
+  cachedPromptTokens: number | null;
+  /** Prompt tokens evaluated for this request */
+  evaluatedPromptTokens: number | null;
+  generatedTokens: number | null;
+  tokensPerSecond: number | null;
+}
+
+export interface LocalFormatterTimeouts {
+  /**
+   * How long a request waits for the server to finish loading before
+   * giving way to the next formatter (the load goes on in the background)
+   */
+  startupWaitMs: number;
+  /** Whole request, including the startup wait */
+  requestTimeoutMs: number;
+}
+
+// Warmup starts the server when a recording starts, so it is usually
+// ready by the time formatting runs; a cold CPU model is not waited for
+const DEFAULT_TIMEOUTS: LocalFormatterTimeouts = {
+  startupWaitMs: 2_000,
+  requestTimeoutMs: 20_000,
+};
+
+/** `timings` object llama-server attaches to the last streamed chunk */
+interface LlamaTimings {
+  cache_n?: number;
+  prompt_n?: number;
+  predicted_n?: number;
+  predicted_per_second?: number;
+}
+
+interface ChatCompletionChunk {
+  choices?: { delta?: { content?: string | null } }[];
+  timings?: LlamaTimings;
+}
+
+/**
+ * Yield the `data:` payloads of a server-sent event stream
+ */
+export async function* readServerSentEvents(
+  body: ReadableStream<Uint8Array>,
+): AsyncGenerator<string> {
+  const decoder = new TextDecoder();
+  const reader = body.getReader();
+  let buffered = "";
+  try {
+    while (true) {
+      const { done, value } = await reader.read();
+      buffered += done ? decoder.decode() : decoder.decode(value, { stream: true });
+      let newline: number;
+      while ((newline = buffered.indexOf("\n")) >= 0) {
+        const line = buffered.slice(0, newline).replace(/\r$/, "");
+        buffered = buffered.slice(newline + 1);
+        if (line.startsWith("data:")) yield line.slice(5).trimStart();
+      }
+      if (done) break;
+    }
+  } finally {
+    reader.releaseLock();
+  }
+}
+
+/**
+ * Formatter running a local GGUF model on llama.cpp (CPU, offline)
+ *
+ * Same prompt and output handling as OpenAIFormatter. The request is sent
+ * to llama-server's OpenAI-compatible endpoint with prompt caching on: the
+ * static part of the system prompt (rules, dictionary) comes first, so
+ * after the first dictation only the instructions and the transcription are
+ * evaluated.
+ *
+ * Requests are bounded (see LocalFormatterTimeouts) and reject on timeout,
+ * so the router falls through to the cloud formatter instead of blocking
+ * the dictation on a model that is still loading.
+ */
+export class LlamaCppFormatter extends OpenAIFormatter {
+  readonly name: string = "llama-cpp";
+
+  private readonly endpoint: LlamaEndpoint;
+  private readonly timeouts: LocalFormatterTimeouts;
+  /** Stats of the last completion (for benchmarks) */
+  lastStats: LocalCompletionStats | null = null;
+
+  constructor(
+    endpoint: LlamaEndpoint,
+    model: string = "local",
+    timeouts: Partial<LocalFormatterTimeouts> = {},
+  ) {
+    super("", model);
+    this.endpoint = endpoint;
+    this.timeouts = { ...DEFAULT_TIMEOUTS, ...timeouts };
+  }
+
+  protected async complete(
+    systemPrompt: string,
+    text: string,
+    maxTokens: number,
+    abortSignal?: AbortSignal,
+  ): Promise<string> {
+    const deadline = new AbortController();
+    const timer = setTimeout(
+      () =>
+        deadline.abort(
+          new Error(
+            `Local formatting timed out after ${this.timeouts.requestTimeoutMs}ms`,
+          ),
+        ),
+      this.timeouts.requestTimeoutMs,
+    );
+    const signal = abortSignal
+      ? AbortSignal.any([abortSignal, deadline.signal])
+      : deadline.signal;
+    try {
+      return await this.request(systemPrompt, text, maxTokens, signal);
+    } finally {
+      clearTimeout(timer);
+    }
+  }
+
+  /** Base URL of the server, or reject if it is not up within the wait */
+  private async waitForServer(): Promise<string> {
+    let timer: ReturnType<typeof setTimeout> | undefined;
+    const timeout = new Promise<never>((_, reject) => {
+      timer = setTimeout(
+        () => reject(new Error("llama-server is still loading")),
+        this.timeouts.startupWaitMs,
+      );
+    });
+    try {
+      return await Promise.race([this.endpoint.ensureStarted(), timeout]);
+    } finally {
+      clearTimeout(timer);
+    }
+  }
+
+  private async request(
+    systemPrompt: string,
+    text: string,
+    maxTokens: number,
+    signal: AbortSignal,
+  ): Promise<string> {
+    const baseURL = await this.waitForServer();
+    signal.throwIfAborted();
+    const start = performance.now();
+
+    const response = await fetch(`${baseURL}/v1/chat/completions`, {
+      method: "POST",
+      headers: { "Content-Type": "application/json" },
+      signal,
+      body: JSON.stringify({
+        messages: [
+          { role: "system", content: systemPrompt },
+          { role: "user", content: text },
+        ],
+        temperature: FORMATTING_TEMPERATURE,
+        max_tokens: maxTokens,
+        // Streamed so that the time to first token can be measured
+        stream: true,
+        cache_prompt: true,
+      }),
+    });
+    if (!response.ok || !response.body) {
+      throw new Error(`llama-server request failed: ${response.status}`);
+    }
+
+    let content = "";
+    let ttftMs: number | null = null;
+    let timings: LlamaTimings | null = null;
+    for await (const data of readServerSentEvents(response.body)) {
+      if (data === "[DONE]") break;
+      const chunk = JSON.parse(data) as ChatCompletionChunk;
+      const delta = chunk.choices?.[0]?.delta?.content;
+      if (delta) {
+        if (ttftMs === null) ttftMs = performance.now() - start;
+        content += delta;
+      }
+      if (chunk.timings) timings = chunk.timings;
+    }
+
+    this.recordStats(performance.now() - start, ttftMs, timings);
+    return content;
+  }
+
+  private recordStats(
+    totalMs: number,
+    ttftMs: number | null,
+    timings: LlamaTimings | null,
+  ): void {
+    const stats: LocalCompletionStats = {
+      ttftMs,
+      totalMs,
+      cachedPromptTokens: timings?.cache_n ?? null,
+      evaluatedPromptTokens: timings?.prompt_n ?? null,
+      generatedTokens: timings?.predicted_n ?? null,
+      tokensPerSecond: timings?.predicted_per_second ?? null,
+    };
+    this.lastStats = stats;
+
+    if (stats.ttftMs !== null) metrics.localFormatterTtft.record(stats.ttftMs);
+    if (stats.tokensPerSecond !== null) {
+      metrics.localFormatterTokensPerSecond.record(stats.tokensPerSecond);
+    }
+    if (stats.cachedPromptTokens !== null) {
+      metrics.localFormatterPromptTokens.inc(
+        { source: "cached" },
+        stats.cachedPromptTokens,
+      );
+    }
+    if (stats.evaluatedPromptTokens !== null) {
+      metrics.localFormatterPromptTokens.inc(
+        { source: "evaluated" },
+        stats.evaluatedPromptTokens,
+      );
+    }
+
+    logger.pipeline.debug("Local formatting completed", {
+      model: this.model,
+      ...stats,
+    });
+  }
+}
@@ -1,93 +1,208 @@
 import { FormattingProvider, FormatParams } from "../../core/pipeline-types";
 import { logger } from "../../../main/logger";
 import { constructFormatterPrompt } from "./formatter-prompt";
-import { createOpenAI } from "@ai-sdk/openai";
-import { generateText } from "ai";
+import { loadAiSdk, getOpenAIBaseURL } from "../sdk-loader";
+import type { createOpenAI } from "@ai-sdk/openai";
+import type { LanguageModelV1 } from "ai";
+import type { BpeTokenizer } from "../../core/bpe-tokenizer";
+import { peekTokenizerForModel } from "../../core/tokenizer-loader";
+
+// Low temperature for consistent formatting
+export const FORMATTING_TEMPERATURE = 0.1;
+export const FORMATTING_MAX_TOKENS = 2000;
+
+// Chat format framing per message, and priming of the reply
+const CHAT_MESSAGE_OVERHEAD_TOKENS = 4;
+const CHAT_REPLY_OVERHEAD_TOKENS = 3;
+
+/**
+ * Output token limit for formatting `inputTokens` of transcription: room
+ * for added punctuation and the <formatted_text> tags, without letting a
+ * runaway answer use up FORMATTING_MAX_TOKENS
+ */
+export function outputTokenBudget(inputTokens: number): number {
+  return Math.min(FORMATTING_MAX_TOKENS, Math.max(256, inputTokens * 2 + 64));
+}
 
 export class OpenAIFormatter implements FormattingProvider {
-  readonly name = "openai";
+  readonly name: string = "openai";
 
-  private provider: ReturnType<typeof createOpenAI>;
-  private model: string;
+  private provider: ReturnType<typeof createOpenAI> | null = null;
+  protected apiKey: string;
+  protected model: string;
 
   constructor(apiKey: string, model: string = "gpt-4o-mini") {
-    this.provider = createOpenAI({
-      apiKey: apiKey,
-    });
+    this.apiKey = apiKey;
     this.model = model;
   }
 
+  /** Model ID as passed to the provider */
+  get modelId(): string {
+    return this.model;
+  }
+
   async format(params: FormatParams): Promise<string> {
     try {
-      const { text, context } = params;
-
-      // Construct the formatter prompt using the extracted function
-      const { systemPrompt, allowsAnswer } = constructFormatterPrompt(
-        context,
-        context.preset,
-        text,
-      );
-
-      logger.pipeline.info("Formatting request", {
-        model: this.model,
-        systemPrompt,
-        userPrompt: text,
-      });
+      return await this.formatOrThrow(params);
+    } catch (error) {
+      logger.pipeline.error("Formatting failed:", error);
+      // Return original text if formatting fails - simple fallback
+      return params.text;
+    }
+  }
 
-      const { text: aiResponse } = await generateText({
-        model: this.provider(this.model),
-        messages: [
-          {
-            role: "system",
-            content: systemPrompt,
-          },
-          {
-            role: "user",
-            content: text,
-          },
-        ],
-        temperature: 0.1, // Low temperature for consistent formatting
-        maxTokens: 2000,
-      });
+  /**
+   * Format without the fallback to the original text, so that the caller
+   * (the provider router) can see failures and try another provider
+   */
+  async formatOrThrow(
+    params: FormatParams,
+    abortSignal?: AbortSignal,
+  ): Promise<string> {
+    const { text, context } = params;
+    const tokenizer = this.getTokenizer();
 
-      logger.pipeline.info("Formatting raw response", {
-        model: this.model,
-        rawResponse: aiResponse,
-      });
+    // Construct the formatter prompt using the extracted function
+    const { systemPrompt, allowsAnswer } = constructFormatterPrompt(
+      context,
+      context.preset,
+      text,
+      tokenizer,
+    );
+
+    // Formatting keeps the length of the input, so the output can be
+    // bounded by it; answers may be longer than the question
+    const maxTokens =
+      tokenizer && !allowsAnswer
+        ? outputTokenBudget(tokenizer.count(text))
+        : FORMATTING_MAX_TOKENS;
+
+    logger.pipeline.info("Formatting request", {
+      model: this.model,
+      systemPrompt,
+      userPrompt: text,
+      maxTokens,
+    });
+
+    const aiResponse = await this.complete(
+      systemPrompt,
+      text,
+      maxTokens,
+      abortSignal,
+    );
+
+    logger.pipeline.info("Formatting raw response", {
+      model: this.model,
+      rawResponse: aiResponse,
+    });
 
-      // Extract formatted text from XML tags
-      const match = aiResponse.match(
-        /<formatted_text>([\s\S]*?)<\/formatted_text>/,
-      );
-      const formattedText = match ? match[1].trim() : aiResponse.trim();
-
-      // 出力検証: 回答を許可しないプリセットで、出力が入力より大幅に長い場合は
-      // 回答と判断して元のテキストを返す（整形では通常、テキスト長は大きく変わらない）
-      if (!allowsAnswer) {
-        const lengthRatio = formattedText.length / text.length;
-        const isLikelyAnswer = lengthRatio > 1.5 && formattedText.length - text.length > 50;
-
-        if (isLikelyAnswer) {
-          logger.pipeline.warn("Formatting output appears to be an answer, using original text", {
-            originalLength: text.length,
-            formattedLength: formattedText.length,
-            lengthRatio,
-          });
-          return text;
-        }
+    // Extract formatted text from XML tags
+    const match = aiResponse.match(
+      /<formatted_text>([\s\S]*?)<\/formatted_text>/,
+    );
+    const formattedText = match ? match[1].trim() : aiResponse.trim();
+
+    // 出力検証: 回答を許可しないプリセットで、出力が入力より大幅に長い場合は
+    // 回答と判断して元のテキストを返す（整形では通常、テキスト長は大きく変わらない）
+    if (!allowsAnswer) {
+      const lengthRatio = formattedText.length / text.length;
+      const isLikelyAnswer = lengthRatio > 1.5 && formattedText.length - text.length > 50;
+
+      if (isLikelyAnswer) {
+        logger.pipeline.warn("Formatting output appears to be an answer, using original text", {
+          originalLength: text.length,
+          formattedLength: formattedText.length,
+          lengthRatio,
+        });
+        return text;
       }
+    }
 
-      logger.pipeline.debug("Formatting completed", {
-        original: text,
-        formatted: formattedText,
-        hadXmlTags: !!match,
-      });
+    logger.pipeline.debug("Formatting completed", {
+      original: text,
+      formatted: formattedText,
+      hadXmlTags: !!match,
+    });
 
-      return formattedText;
-    } catch (error) {
-      logger.pipeline.error("Formatting failed:", error);
-      // Return original text if formatting fails - simple fallback
-      return params.text;
+    return formattedText;
+  }
+
+  /**
+   * Token counts of a format request and its output, for cost estimates.
+   * Null when the model's tokenizer is not available (or not loaded yet).
+   */
+  async countTokens(
+    params: FormatParams,
+    formattedText: string,
+  ): Promise<{ inputTokens: number; outputTokens: number } | null> {
+    const tokenizer = this.getTokenizer();
+    if (!tokenizer) return null;
+
+    const { systemPrompt } = constructFormatterPrompt(
+      params.context,
+      params.context.preset,
+      params.text,
+      tokenizer,
+    );
+    return {
+      inputTokens:
+        tokenizer.count(systemPrompt) +
+        tokenizer.count(params.text) +
+        2 * CHAT_MESSAGE_OVERHEAD_TOKENS +
+        CHAT_REPLY_OVERHEAD_TOKENS,
+      outputTokens: tokenizer.count(
+        `<formatted_text>${formattedText}</formatted_text>`,
+      ),
+    };
+  }
+
+  /**
+   * Tokenizer of this model; null when unknown, not installed or still
+   * loading (formatting does not wait for it)
+   */
+  protected getTokenizer(): BpeTokenizer | null {
+    return peekTokenizerForModel(this.model);
+  }
+
+  /**
+   * Run the chat completion and return the raw model output
+   */
+  protected async complete(
+    systemPrompt: string,
+    text: string,
+    maxTokens: number,
+    abortSignal?: AbortSignal,
+  ): Promise<string> {
+    // SDK is loaded on first use to keep it out of startup
+    const { generateText } = await loadAiSdk();
+
+    const { text: aiResponse } = await generateText({
+      model: await this.getLanguageModel(),
+      abortSignal,
+      messages: [
+        {
+          role: "system",
+          content: systemPrompt,
+        },
+        {
+          role: "user",
+          content: text,
+        },
+      ],
+      temperature: FORMATTING_TEMPERATURE,
+      maxTokens,
+    });
+    return aiResponse;
+  }
+
+  protected async getLanguageModel(): Promise<LanguageModelV1> {
+    if (!this.provider) {
+      const { createOpenAI } = await loadAiSdk();
+      this.provider = createOpenAI({
+        apiKey: this.apiKey,
+        baseURL: getOpenAIBaseURL(),
+      });
     }
+    return this.provider(this.model);
   }
 }
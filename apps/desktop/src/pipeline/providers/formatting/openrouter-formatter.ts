@@ -0,0 +1,24 @@
+import type { LanguageModelV1 } from "ai";
+import type { createOpenRouter } from "@openrouter/ai-sdk-provider";
+import { OpenAIFormatter } from "./openai-formatter";
+import { loadOpenRouterSdk } from "../sdk-loader";
+
+/**
+ * Formatter using OpenRouter (fallback when OpenAI is slow or failing)
+ *
+ * Same prompt and output handling as OpenAIFormatter; only the model
+ * provider differs. Model IDs are OpenRouter's, e.g. "openai/gpt-4o-mini".
+ */
+export class OpenRouterFormatter extends OpenAIFormatter {
+  readonly name: string = "openrouter";
+
+  private openRouter: ReturnType<typeof createOpenRouter> | null = null;
+
+  protected async getLanguageModel(): Promise<LanguageModelV1> {
+    if (!this.openRouter) {
+      const { createOpenRouter } = await loadOpenRouterSdk();
+      this.openRouter = createOpenRouter({ apiKey: this.apiKey });
+    }
+    return this.openRouter(this.model);
+  }
+}
@@ -2,6 +2,8 @@ import type { GetAccessibilityContextResult } from "@surasura/types";
 
 /**
  * テンプレート変数の定義
+ *
+ * maxLength は値をプロンプトに埋め込む際の上限文字数（未設定なら上限なし）
  */
 export const TEMPLATE_VARIABLES = {
   transcription: {
@@ -11,10 +13,12 @@ export const TEMPLATE_VARIABLES = {
   clipboard: {
     name: "clipboard",
     description: "クリップボードの内容",
+    maxLength: 8000,
   },
   appName: {
     name: "appName",
     description: "フォーカス中のアプリ名",
+    maxLength: 200,
   },
 } as const;
 
@@ -29,6 +33,140 @@ export interface TemplateContext {
   clipboardText?: string;
 }
 
+/**
+ * 変数値の取得元（必要な変数があるときだけ呼び出される）
+ */
+export interface TemplateSources {
+  accessibilityContext?: () => GetAccessibilityContextResult | null | undefined;
+  transcription?: () => string | undefined;
+  clipboardText?: () => string | undefined;
+}
+
+/**
+ * コンパイル済みテンプレートの構成要素
+ */
+export type TemplateNode =
+  | { type: "text"; value: string }
+  | { type: "variable"; name: TemplateVariableName };
+
+/**
+ * コンパイル済みテンプレート
+ */
+export interface CompiledTemplate {
+  source: string;
+  nodes: readonly TemplateNode[];
+  /** テンプレートが参照する変数 */
+  variables: ReadonlySet<TemplateVariableName>;
+}
+
+// プリセットは最大5つ＋デフォルト指示。編集中の古い版を溜めすぎないよう上限を設ける
+const COMPILE_CACHE_LIMIT = 32;
+const compileCache = new Map<string, CompiledTemplate>();
+
+function isVariableName(name: string): name is TemplateVariableName {
+  return Object.prototype.hasOwnProperty.call(TEMPLATE_VARIABLES, name);
+}
+
+function isWordChar(code: number): boolean {
+  return (
+    (code >= 0x30 && code <= 0x39) || // 0-9
+    (code >= 0x41 && code <= 0x5a) || // A-Z
+    (code >= 0x61 && code <= 0x7a) || // a-z
+    code === 0x5f // _
+  );
+}
+
+function parseTemplate(template: string): TemplateNode[] {
+  const nodes: TemplateNode[] = [];
+  let text = "";
+  let cursor = 0;
+
+  while (cursor < template.length) {
+    const open = template.indexOf("{{", cursor);
+    if (open === -1) break;
+
+    // {{variableName}} の形だけを変数として扱う
+    let end = open + 2;
+    while (end < template.length && isWordChar(template.charCodeAt(end))) {
+      end++;
+    }
+    const name = template.slice(open + 2, end);
+    const closed = template.startsWith("}}", end);
+
+    if (!closed || !name || !isVariableName(name)) {
+      // サポートされていない変数はそのまま残す
+      text += template.slice(cursor, open + 1);
+      cursor = open + 1;
+      continue;
+    }
+
+    text += template.slice(cursor, open);
+    if (text) nodes.push({ type: "text", value: text });
+    text = "";
+    nodes.push({ type: "variable", name });
+    cursor = end + 2;
+  }
+
+  text += template.slice(cursor);
+  if (text) nodes.push({ type: "text", value: text });
+  return nodes;
+}
+
+/**
+ * テンプレート文字列をコンパイルする（同じ文字列は再利用）
+ */
+export function compileTemplate(template: string): CompiledTemplate {
+  const cached = compileCache.get(template);
+  if (cached) return cached;
+
+  const nodes = parseTemplate(template);
+  const variables = new Set<TemplateVariableName>();
+  for (const node of nodes) {
+    if (node.type === "variable") variables.add(node.name);
+  }
+  const compiled: CompiledTemplate = { source: template, nodes, variables };
+
+  if (compileCache.size >= COMPILE_CACHE_LIMIT) {
+    compileCache.delete(compileCache.keys().next().value!);
+  }
+  compileCache.set(template, compiled);
+  return compiled;
+}
+
+function capLength(name: TemplateVariableName, value: string): string {
+  const variable: { maxLength?: number } = TEMPLATE_VARIABLES[name];
+  if (variable.maxLength === undefined || value.length <= variable.maxLength) {
+    return value;
+  }
+  return value.slice(0, variable.maxLength) + "…";
+}
+
+/**
+ * テンプレートが参照する変数の取得元だけを呼び出してコンテキストを作る
+ * 値は変数ごとの上限文字数で切り詰める
+ */
+export function resolveTemplateContext(
+  template: CompiledTemplate,
+  sources: TemplateSources,
+): TemplateContext {
+  const context: TemplateContext = {};
+  const { variables } = template;
+
+  if (variables.has("transcription")) {
+    context.transcription = sources.transcription?.();
+  }
+  if (variables.has("clipboard")) {
+    const clipboardText = sources.clipboardText?.();
+    if (clipboardText !== undefined) {
+      context.clipboardText = capLength("clipboard", clipboardText);
+    }
+  }
+  if (variables.has("appName")) {
+    context.accessibilityContext = sources.accessibilityContext?.();
+  }
+  return context;
+}
+
 /**
  * コンテキストから変数値を取得
  */
@@ -43,7 +181,7 @@ function getVariableValue(
 
   // clipboardも特別に処理（accessibilityContextに依存しない）
   if (variableName === "clipboard") {
-    return context.clipboardText ?? "";
+    return capLength("clipboard", context.clipboardText ?? "");
   }
 
   const axContext = context.accessibilityContext?.context;
@@ -53,12 +191,27 @@ function getVariableValue(
 
   switch (variableName) {
     case "appName":
-      return axContext.application?.name ?? "";
+      return capLength("appName", axContext.application?.name ?? "");
     default:
       return "";
   }
 }
 
+/**
+ * コンパイル済みテンプレートを1回の走査で描画する
+ */
+export function renderTemplate(
+  template: CompiledTemplate,
+  context: TemplateContext
+): string {
+  let result = "";
+  for (const node of template.nodes) {
+    result +=
+      node.type === "text" ? node.value : getVariableValue(node.name, context);
+  }
+  return result;
+}
+
 /**
  * テンプレート文字列内の {{variableName}} を実際の値に置換する
  *
@@ -70,22 +223,12 @@ export function replaceTemplateVariables(
   template: string,
   context: TemplateContext
 ): string {
-  // {{variableName}} のパターンにマッチ
-  const variablePattern = /\{\{(\w+)\}\}/g;
-
-  return template.replace(variablePattern, (match, variableName: string) => {
-    // サポートされている変数かチェック
-    if (variableName in TEMPLATE_VARIABLES) {
-      return getVariableValue(variableName as TemplateVariableName, context);
-    }
-    // サポートされていない変数はそのまま残す
-    return match;
-  });
+  return renderTemplate(compileTemplate(template), context);
 }
 
 /**
  * テンプレート文字列内で{{transcription}}変数が使用されているかチェック
  */
 export function hasTranscriptionVariable(template: string): boolean {
-  return template.includes("{{transcription}}");
+  return compileTemplate(template).variables.has("transcription");
 }
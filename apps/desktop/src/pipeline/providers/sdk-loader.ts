@@ -0,0 +1,75 @@
+import { logger } from "../../main/logger";
+
+/**
+ * Lazy loaders for the AI SDKs
+ *
+ * The OpenAI / Vercel AI SDKs are large and are not needed until the first
+ * dictation, so they are loaded on demand instead of at main-bundle
+ * evaluation time. Dynamic imports are split into separate chunks by Vite.
+ */
+
+type Loader<T> = () => Promise<T>;
+
+function memoizeLoader<T>(name: string, load: Loader<T>): Loader<T> {
+  let pending: Promise<T> | null = null;
+  return () => {
+    if (!pending) {
+      const startTime = performance.now();
+      pending = load().then(
+        (mod) => {
+          logger.pipeline.debug("SDK module loaded", {
+            module: name,
+            duration: `${(performance.now() - startTime).toFixed(1)}ms`,
+          });
+          return mod;
+        },
+        (error) => {
+          // Allow retry on next call
+          pending = null;
+          throw error;
+        },
+      );
+    }
+    return pending;
+  };
+}
+
+export const loadOpenAISdk = memoizeLoader("openai", async () => {
+  const mod = await import("openai");
+  return mod.default;
+});
+
+export const loadAiSdk = memoizeLoader("ai", async () => {
+  const [{ createOpenAI }, { generateText }] = await Promise.all([
+    import("@ai-sdk/openai"),
+    import("ai"),
+  ]);
+  return { createOpenAI, generateText };
+});
+
+// Only needed when formatting falls back to OpenRouter
+export const loadOpenRouterSdk = memoizeLoader("openrouter", async () => {
+  const { createOpenRouter } = await import("@openrouter/ai-sdk-provider");
+  return { createOpenRouter };
+});
+
+/**
+ * Optional OpenAI-compatible endpoint override (OPENAI_BASE_URL), e.g. a
+ * proxy or the local mock server used by the replay harness
+ */
+export function getOpenAIBaseURL(): string | undefined {
+  return process.env.OPENAI_BASE_URL || undefined;
+}
+
+/**
+ * Start loading the SDKs in the background (e.g. when recording starts) so
+ * the first API call does not pay the module evaluation cost.
+ */
+export function preloadSdks(): void {
+  loadOpenAISdk().catch((error) => {
+    logger.pipeline.warn("Failed to preload OpenAI SDK", { error });
+  });
+  loadAiSdk().catch((error) => {
+    logger.pipeline.warn("Failed to preload AI SDK", { error });
+  });
+}
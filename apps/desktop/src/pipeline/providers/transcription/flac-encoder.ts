@@ -0,0 +1,647 @@
+/**
+ * Streaming FLAC encoder for Whisper uploads
+ *
+ * 16-bit PCM WAV costs 32 KB per second of 16 kHz audio. FLAC is lossless
+ * (the decoded samples are exactly the WAV samples) and typically halves
+ * speech. Frames are encoded as audio arrives, so by the time a segment is
+ * cut only the last partial block and the 42-byte header remain.
+ *
+ * Mono, 16-bit, fixed block size. Each block picks the cheapest of a
+ * constant, fixed-predictor (order 0-4) or verbatim subframe; residuals are
+ * partitioned Rice codes. No LPC: for dictation it would gain a few percent
+ * at several times the CPU. STREAMINFO carries the MD5 of the samples, so
+ * reference decoders (`flac -t`, ffmpeg) verify the whole file.
+ */
+
+import { createHash, type Hash } from "node:crypto";
+
+export type SpeechUploadEncoding = "flac" | "wav";
+
+/** A complete FLAC file as parts (stream header first) */
+export interface EncodedFlac {
+  parts: Uint8Array[];
+  /** Encode time attributed to this file (ms) */
+  encodeMs: number;
+}
+
+/** A range of the current segment to finish as its own file */
+export interface FlacPart {
+  audio: Float32Array;
+  /** First sample of the part within the segment */
+  offset: number;
+}
+
+export interface FlacEncoderOptions {
+  sampleRate: number;
+  /** Samples per frame (16-65535) */
+  blockSize?: number;
+}
+
+const DEFAULT_BLOCK_SIZE = 4096;
+const MAX_FIXED_ORDER = 4;
+const MAX_PARTITION_ORDER = 8;
+const MAX_RICE_PARAMETER = 14; // 15 is the escape code
+const BITS_PER_SAMPLE = 16;
+const MIN_BLOCK_SIZE = 16; // Smaller frames are only allowed at the end
+
+// ───────────────────────────────────────────────────────────────────
+// Bit writer and checksums
+// ───────────────────────────────────────────────────────────────────
+
+class BitWriter {
+  bytes: Uint8Array;
+  length = 0;
+  private accumulator = 0;
+  private pending = 0; // Bits in the accumulator, always < 8
+
+  constructor(capacity: number) {
+    this.bytes = new Uint8Array(Math.max(64, capacity));
+  }
+
+  /** Write the low `count` bits of `value` (count <= 24) */
+  write(value: number, count: number): void {
+    if (count === 0) return;
+    this.accumulator =
+      (this.accumulator << count) | (value & ((1 << count) - 1));
+    this.pending += count;
+    while (this.pending >= 8) {
+      this.pending -= 8;
+      this.push((this.accumulator >>> this.pending) & 0xff);
+    }
+    this.accumulator &= (1 << this.pending) - 1;
+  }
+
+  writeZeros(count: number): void {
+    while (count > 24) {
+      this.write(0, 24);
+      count -= 24;
+    }
+    this.write(0, count);
+  }
+
+  /** Pad with zero bits to a byte boundary */
+  align(): void {
+    if (this.pending > 0) this.write(0, 8 - this.pending);
+  }
+
+  private push(byte: number): void {
+    if (this.length === this.bytes.length) {
+      const grown = new Uint8Array(this.bytes.length * 2);
+      grown.set(this.bytes);
+      this.bytes = grown;
+    }
+    this.bytes[this.length++] = byte;
+  }
+}
+
+const CRC8_TABLE = new Uint8Array(256);
+const CRC16_TABLE = new Uint16Array(256);
+for (let i = 0; i < 256; i++) {
+  let crc8 = i;
+  let crc16 = i << 8;
+  for (let bit = 0; bit < 8; bit++) {
+    crc8 = crc8 & 0x80 ? (crc8 << 1) ^ 0x07 : crc8 << 1;
+    crc16 = crc16 & 0x8000 ? (crc16 << 1) ^ 0x8005 : crc16 << 1;
+  }
+  CRC8_TABLE[i] = crc8 & 0xff;
+  CRC16_TABLE[i] = crc16 & 0xffff;
+}
+
+export function crc8(bytes: Uint8Array, start: number, end: number): number {
+  let crc = 0;
+  for (let i = start; i < end; i++) crc = CRC8_TABLE[crc ^ bytes[i]];
+  return crc;
+}
+
+export function crc16(bytes: Uint8Array, start: number, end: number): number {
+  let crc = 0;
+  for (let i = start; i < end; i++) {
+    crc = ((crc << 8) & 0xffff) ^ CRC16_TABLE[(crc >>> 8) ^ bytes[i]];
+  }
+  return crc;
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Frame encoding
+// ───────────────────────────────────────────────────────────────────
+
+// prettier-ignore
+const SAMPLE_RATE_CODES: Record<number, number> = {
+  88200: 0b0001, 176400: 0b0010, 192000: 0b0011, 8000: 0b0100,
+  16000: 0b0101, 22050: 0b0110, 24000: 0b0111, 32000: 0b1000,
+  44100: 0b1001, 48000: 0b1010, 96000: 0b1011,
+};
+
+function blockSizeCode(size: number): number {
+  if (size === 192) return 0b0001;
+  for (let code = 0b0010; code <= 0b0101; code++) {
+    if (size === 576 << (code - 2)) return code;
+  }
+  for (let code = 0b1000; code <= 0b1111; code++) {
+    if (size === 256 << (code - 8)) return code;
+  }
+  return size <= 256 ? 0b0110 : 0b0111; // Stored after the frame number
+}
+
+/** Same quantization as the WAV path */
+function quantize(value: number): number {
+  const sample = Math.max(-1, Math.min(1, value));
+  return (sample < 0 ? sample * 0x8000 : sample * 0x7fff) | 0;
+}
+
+/**
+ * FLAC's UTF-8-style variable-length frame number (fixed block size) or
+ * first sample number (variable block size)
+ */
+function writeFrameNumber(writer: BitWriter, value: number): void {
+  if (value < 0x80) {
+    writer.write(value, 8);
+    return;
+  }
+  let continuation = 1;
+  while (value >= 2 ** (6 - continuation + 6 * continuation)) continuation++;
+  const leading = (0xff00 >> (continuation + 1)) & 0xff;
+  writer.write(leading | (value / 2 ** (6 * continuation)), 8);
+  for (let i = continuation - 1; i >= 0; i--) {
+    writer.write(0x80 | (Math.floor(value / 2 ** (6 * i)) & 0x3f), 8);
+  }
+}
+
+/** Fixed-predictor residual of the given order, written into `out` */
+function fixedResidual(
+  samples: Int32Array,
+  count: number,
+  order: number,
+  out: Int32Array,
+): void {
+  for (let i = order; i < count; i++) {
+    const x = samples[i];
+    switch (order) {
+      case 0:
+        out[i] = x;
+        break;
+      case 1:
+        out[i] = x - samples[i - 1];
+        break;
+      case 2:
+        out[i] = x - 2 * samples[i - 1] + samples[i - 2];
+        break;
+      case 3:
+        out[i] = x - 3 * samples[i - 1] + 3 * samples[i - 2] - samples[i - 3];
+        break;
+      default:
+        out[i] =
+          x -
+          4 * samples[i - 1] +
+          6 * samples[i - 2] -
+          4 * samples[i - 3] +
+          samples[i - 4];
+    }
+  }
+}
+
+/** Order with the smallest total absolute residual, as libFLAC estimates */
+function chooseFixedOrder(samples: Int32Array, count: number): number {
+  const maxOrder = Math.min(MAX_FIXED_ORDER, count - 1);
+  const totals = [0, 0, 0, 0, 0];
+  const start = Math.min(MAX_FIXED_ORDER, count);
+  let e0 = start > 0 ? samples[start - 1] : 0;
+  let e1 = start > 1 ? e0 - samples[start - 2] : 0;
+  let e2 = start > 2 ? e1 - (samples[start - 2] - samples[start - 3]) : 0;
+  let e3 =
+    start > 3
+      ? e2 -
+        (samples[start - 2] -
+          samples[start - 3] -
+          (samples[start - 3] - samples[start - 4]))
+      : 0;
+  for (let i = start; i < count; i++) {
+    const r0 = samples[i];
+    const r1 = r0 - e0;
+    const r2 = r1 - e1;
+    const r3 = r2 - e2;
+    const r4 = r3 - e3;
+    totals[0] += Math.abs(r0);
+    totals[1] += Math.abs(r1);
+    totals[2] += Math.abs(r2);
+    totals[3] += Math.abs(r3);
+    totals[4] += Math.abs(r4);
+    e0 = r0;
+    e1 = r1;
+    e2 = r2;
+    e3 = r3;
+  }
+  let best = 0;
+  for (let order = 1; order <= maxOrder; order++) {
+    if (totals[order] < totals[best]) best = order;
+  }
+  return best;
+}
+
+interface RicePlan {
+  partitionOrder: number;
+  parameters: number[];
+  bits: number;
+}
+
+function riceParameter(sum: number, count: number): number {
+  // Optimal k ≈ log2(mean folded residual)
+  const mean = Math.floor(sum / count);
+  return mean < 1 ? 0 : Math.min(MAX_RICE_PARAMETER, 31 - Math.clz32(mean));
+}
+
+/** Pick the partition order and per-partition Rice parameters */
+function planRice(
+  folded: Uint32Array,
+  count: number,
+  order: number,
+): RicePlan {
+  // Partition sums at the finest usable order, merged for coarser orders
+  let maxOrder = 0;
+  while (
+    maxOrder < MAX_PARTITION_ORDER &&
+    count % (1 << (maxOrder + 1)) === 0 &&
+    count >> (maxOrder + 1) > order
+  ) {
+    maxOrder++;
+  }
+  const partitions = 1 << maxOrder;
+  const size = count >> maxOrder;
+  let sums = new Float64Array(partitions);
+  for (let p = 0; p < partitions; p++) {
+    let sum = 0;
+    const end = (p + 1) * size;
+    for (let i = p === 0 ? order : p * size; i < end; i++) sum += folded[i];
+    sums[p] = sum;
+  }
+
+  let best: RicePlan | null = null;
+  for (let partitionOrder = maxOrder; partitionOrder >= 0; partitionOrder--) {
+    const parts = 1 << partitionOrder;
+    const partSize = count >> partitionOrder;
+    const parameters: number[] = [];
+    let bits = 0;
+    for (let p = 0; p < parts; p++) {
+      const n = p === 0 ? partSize - order : partSize;
+      const k = riceParameter(sums[p], n);
+      parameters.push(k);
+      // Unary quotient + stop bit + k low bits, estimated from the sum
+      bits += 4 + n * (k + 1) + Math.floor(sums[p] / 2 ** k);
+    }
+    if (!best || bits < best.bits) best = { partitionOrder, parameters, bits };
+    if (partitionOrder > 0) {
+      const merged = new Float64Array(parts >> 1);
+      for (let p = 0; p < merged.length; p++) {
+        merged[p] = sums[2 * p] + sums[2 * p + 1];
+      }
+      sums = merged;
+    }
+  }
+  return best!;
+}
+
+// Per-encoder scratch buffers are sized to the block
+interface Scratch {
+  residual: Int32Array;
+  folded: Uint32Array;
+}
+
+function writeSubframe(
+  writer: BitWriter,
+  samples: Int32Array,
+  count: number,
+  scratch: Scratch,
+): void {
+  let constant = true;
+  for (let i = 1; i < count && constant; i++) {
+    constant = samples[i] === samples[0];
+  }
+  if (constant) {
+    writer.write(0b00000000, 8); // CONSTANT
+    writer.write(samples[0], BITS_PER_SAMPLE);
+    return;
+  }
+
+  const order = chooseFixedOrder(samples, count);
+  const { residual, folded } = scratch;
+  fixedResidual(samples, count, order, residual);
+  for (let i = order; i < count; i++) {
+    const r = residual[i];
+    folded[i] = r >= 0 ? r * 2 : -r * 2 - 1;
+  }
+  const plan = planRice(folded, count, order);
+
+  const fixedBits = 8 + order * BITS_PER_SAMPLE + 6 + plan.bits;
+  if (fixedBits >= 8 + count * BITS_PER_SAMPLE) {
+    writer.write(0b00000010, 8); // VERBATIM
+    for (let i = 0; i < count; i++) writer.write(samples[i], BITS_PER_SAMPLE);
+    return;
+  }
+
+  writer.write(0b00010000 | (order << 1), 8); // FIXED, no wasted bits
+  for (let i = 0; i < order; i++) writer.write(samples[i], BITS_PER_SAMPLE);
+  writer.write(0b00, 2); // Rice, 4-bit parameters
+  writer.write(plan.partitionOrder, 4);
+
+  const partSize = count >> plan.partitionOrder;
+  let i = order;
+  for (let p = 0; p < plan.parameters.length; p++) {
+    const k = plan.parameters[p];
+    writer.write(k, 4);
+    const end = (p + 1) * partSize;
+    const mask = (1 << k) - 1;
+    for (; i < end; i++) {
+      const u = folded[i];
+      const quotient = u >>> k;
+      // Zeros, stop bit and low bits in one write when they fit
+      if (quotient + 1 + k <= 24) {
+        writer.write((1 << k) | (u & mask), quotient + 1 + k);
+      } else {
+        writer.writeZeros(quotient);
+        writer.write(1, 1);
+        writer.write(u & mask, k);
+      }
+    }
+  }
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Encoder
+// ───────────────────────────────────────────────────────────────────
+
+export class StreamingFlacEncoder {
+  private readonly sampleRate: number;
+  private readonly blockSize: number;
+  private readonly block: Int32Array;
+  private readonly scratch: Scratch;
+  // The block as 16-bit PCM for the MD5 (little-endian on every platform
+  // Electron ships for, as STREAMINFO requires)
+  private readonly pcm: Int16Array;
+  private md5: Hash = createHash("md5");
+  private blockFill = 0;
+  private frames: Uint8Array[] = [];
+  // Header length of each frame, so that finishParts() can re-head it
+  private headerLengths: number[] = [];
+  private frameNumber = 0;
+  private samples = 0;
+  private bytes = 0;
+  private encodeTime = 0;
+  private lastSegmentEncodeTime = 0;
+
+  constructor(options: FlacEncoderOptions) {
+    this.sampleRate = options.sampleRate;
+    this.blockSize = options.blockSize ?? DEFAULT_BLOCK_SIZE;
+    if (this.blockSize < 16 || this.blockSize > 65535) {
+      throw new Error(`Invalid FLAC block size: ${this.blockSize}`);
+    }
+    this.block = new Int32Array(this.blockSize);
+    this.pcm = new Int16Array(this.blockSize);
+    this.scratch = {
+      residual: new Int32Array(this.blockSize),
+      folded: new Uint32Array(this.blockSize),
+    };
+  }
+
+  /** Samples written since the last finish/reset */
+  get sampleCount(): number {
+    return this.samples;
+  }
+
+  /** Time spent encoding since the last finish/reset (ms) */
+  get encodeMs(): number {
+    return this.encodeTime;
+  }
+
+  /** Total encode time of the segment returned by the last finish() (ms) */
+  get lastEncodeMs(): number {
+    return this.lastSegmentEncodeTime;
+  }
+
+  /**
+   * Append audio; every full block is encoded immediately
+   */
+  write(audio: Float32Array): void {
+    const start = performance.now();
+    for (let i = 0; i < audio.length; i++) {
+      this.block[this.blockFill++] = quantize(audio[i]);
+      if (this.blockFill === this.blockSize) this.encodeBlock();
+    }
+    this.samples += audio.length;
+    this.encodeTime += performance.now() - start;
+  }
+
+  /**
+   * Encode the remaining samples and return the complete file as parts
+   * (stream header first). The encoder is ready for the next segment.
+   */
+  finish(): Uint8Array[] {
+    const start = performance.now();
+    if (this.blockFill > 0) this.encodeBlock();
+    const header = this.streamHeader(
+      this.samples,
+      this.blockSize,
+      this.blockSize,
+      this.md5.digest(),
+    );
+    const parts = [header, ...this.frames];
+    this.lastSegmentEncodeTime =
+      this.encodeTime + (performance.now() - start);
+    this.reset();
+    return parts;
+  }
+
+  /**
+   * Finish the segment as one file per part instead (parts in order,
+   * covering the segment). Blocks already encoded inside a part are reused
+   * under a new header; only the samples around the cuts are encoded. The
+   * files use variable block sizes. The streamed encode time is shared out
+   * by length.
+   */
+  finishParts(parts: FlacPart[]): EncodedFlac[] {
+    const start = performance.now();
+    const streamedMs = this.encodeTime;
+    const files = parts.map((part) => {
+      const partStart = performance.now();
+      const encoded = this.encodePart(part);
+      const share = this.samples > 0 ? part.audio.length / this.samples : 0;
+      return {
+        parts: encoded,
+        encodeMs: streamedMs * share + (performance.now() - partStart),
+      };
+    });
+    this.lastSegmentEncodeTime = streamedMs + (performance.now() - start);
+    this.reset();
+    return files;
+  }
+
+  reset(): void {
+    this.blockFill = 0;
+    this.frames = [];
+    this.headerLengths = [];
+    this.frameNumber = 0;
+    this.samples = 0;
+    this.bytes = 0;
+    this.encodeTime = 0;
+    this.md5 = createHash("md5");
+  }
+
+  private encodeBlock(): void {
+    const count = this.blockFill;
+    for (let i = 0; i < count; i++) this.pcm[i] = this.block[i];
+    this.md5.update(new Uint8Array(this.pcm.buffer, 0, count * 2));
+    const { frame, headerLength } = this.encodeFrame(
+      count,
+      false,
+      this.frameNumber++,
+    );
+    this.frames.push(frame);
+    this.headerLengths.push(headerLength);
+    this.bytes += frame.length;
+    this.blockFill = 0;
+  }
+
+  private encodePart({ audio, offset }: FlacPart): Uint8Array[] {
+    const size = this.blockSize;
+    // Streamed blocks that lie entirely inside the part. A head too short
+    // for a frame of its own is encoded together with the rest instead.
+    const first = Math.ceil(offset / size);
+    const last = Math.min(
+      Math.floor((offset + audio.length) / size),
+      this.frames.length,
+    );
+    const head = first * size - offset;
+    const reused =
+      head > 0 && head < MIN_BLOCK_SIZE ? 0 : Math.max(0, last - first);
+    const reuseStart = reused > 0 ? head : audio.length;
+    const reuseEnd = reuseStart + reused * size;
+
+    const frames: Uint8Array[] = [];
+    const blockSizes: number[] = [];
+    this.encodeRange(audio, 0, reuseStart, frames, blockSizes);
+    for (let i = 0; i < reused; i++) {
+      frames.push(this.reheadFrame(first + i, reuseStart + i * size));
+      blockSizes.push(size);
+    }
+    this.encodeRange(audio, reuseEnd, audio.length, frames, blockSizes);
+
+    const md5 = createHash("md5");
+    for (let start = 0; start < audio.length; start += size) {
+      const count = Math.min(size, audio.length - start);
+      for (let i = 0; i < count; i++) this.pcm[i] = quantize(audio[start + i]);
+      md5.update(new Uint8Array(this.pcm.buffer, 0, count * 2));
+    }
+    // The last frame does not count towards the minimum
+    const leading =
+      blockSizes.length > 1 ? blockSizes.slice(0, -1) : blockSizes;
+    const header = this.streamHeader(
+      audio.length,
+      Math.min(...leading, size),
+      Math.max(...blockSizes, 0),
+      md5.digest(),
+    );
+    return [header, ...frames];
+  }
+
+  /** Encode audio[from, to) as variable-size frames at their sample numbers */
+  private encodeRange(
+    audio: Float32Array,
+    from: number,
+    to: number,
+    frames: Uint8Array[],
+    blockSizes: number[],
+  ): void {
+    for (let start = from; start < to; start += this.blockSize) {
+      const count = Math.min(this.blockSize, to - start);
+      for (let i = 0; i < count; i++) {
+        this.block[i] = quantize(audio[start + i]);
+      }
+      frames.push(this.encodeFrame(count, true, start).frame);
+      blockSizes.push(count);
+    }
+  }
+
+  /** A streamed frame with a variable-block-size header at `sampleNumber` */
+  private reheadFrame(index: number, sampleNumber: number): Uint8Array {
+    const frame = this.frames[index];
+    const writer = new BitWriter(16);
+    this.writeFrameHeader(writer, this.blockSize, true, sampleNumber);
+    const body = frame.subarray(this.headerLengths[index], frame.length - 2);
+    const out = new Uint8Array(writer.length + body.length + 2);
+    out.set(writer.bytes.subarray(0, writer.length));
+    out.set(body, writer.length);
+    const crc = crc16(out, 0, out.length - 2);
+    out[out.length - 2] = crc >> 8;
+    out[out.length - 1] = crc & 0xff;
+    return out;
+  }
+
+  /** One frame of the first `count` samples of the block */
+  private encodeFrame(
+    count: number,
+    variable: boolean,
+    number: number,
+  ): { frame: Uint8Array; headerLength: number } {
+    const writer = new BitWriter(count * 2 + 32);
+    this.writeFrameHeader(writer, count, variable, number);
+    const headerLength = writer.length;
+
+    writeSubframe(writer, this.block, count, this.scratch);
+    writer.align();
+    const crc = crc16(writer.bytes, 0, writer.length);
+    writer.write(crc >> 8, 8);
+    writer.write(crc & 0xff, 8);
+
+    return { frame: writer.bytes.slice(0, writer.length), headerLength };
+  }
+
+  /**
+   * Frame header; `number` is the frame number, or the first sample number
+   * when `variable` (block sizes differ between frames)
+   */
+  private writeFrameHeader(
+    writer: BitWriter,
+    count: number,
+    variable: boolean,
+    number: number,
+  ): void {
+    writer.write(0xff, 8); // Sync code
+    writer.write(variable ? 0xf9 : 0xf8, 8); // Blocking strategy in bit 0
+    const sizeCode = blockSizeCode(count);
+    writer.write(sizeCode, 4);
+    writer.write(SAMPLE_RATE_CODES[this.sampleRate] ?? 0b0000, 4);
+    writer.write(0b0000, 4); // Mono
+    writer.write(0b100, 3); // 16 bits per sample
+    writer.write(0, 1);
+    writeFrameNumber(writer, number);
+    if (sizeCode === 0b0110) writer.write(count - 1, 8);
+    if (sizeCode === 0b0111) writer.write(count - 1, 16);
+    writer.write(crc8(writer.bytes, 0, writer.length), 8);
+  }
+
+  /** "fLaC" marker and the STREAMINFO block */
+  private streamHeader(
+    totalSamples: number,
+    minBlockSize: number,
+    maxBlockSize: number,
+    md5: Uint8Array,
+  ): Uint8Array {
+    const writer = new BitWriter(42);
+    for (const char of "fLaC") writer.write(char.charCodeAt(0), 8);
+    writer.write(0x80, 8); // Last metadata block, STREAMINFO
+    writer.write(34, 24);
+    writer.write(minBlockSize, 16);
+    writer.write(maxBlockSize, 16);
+    writer.write(0, 24); // Min frame size (unknown)
+    writer.write(0, 24); // Max frame size (unknown)
+    writer.write(this.sampleRate >> 4, 16); // 20-bit sample rate
+    writer.write(this.sampleRate & 0xf, 4);
+    writer.write(0, 3); // Channels - 1
+    writer.write(BITS_PER_SAMPLE - 1, 5);
+    writer.write(Math.floor(totalSamples / 2 ** 32) & 0xf, 4); // 36-bit total
+    writer.write(totalSamples >>> 16, 16);
+    writer.write(totalSamples & 0xffff, 16);
+    const header = writer.bytes.slice(0, writer.length + 16);
+    header.set(md5, writer.length); // MD5 of the samples
+    return header;
+  }
+}
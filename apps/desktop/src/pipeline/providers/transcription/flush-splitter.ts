@@ -0,0 +1,186 @@
+/**
+ * Split long final flushes into sub-segments that can be transcribed in
+ * parallel
+ *
+ * Without a 3 s pause the whole utterance is still buffered when the user
+ * stops, and one request for 20-30 s of audio is what they wait for. Cutting
+ * it at VAD valleys (breaths, short pauses) into a few parts sent
+ * concurrently bounds the wait by the longest part instead of the sum.
+ *
+ * All lengths are in VAD frames (512 samples = 32 ms at 16 kHz).
+ */
+
+export interface FlushSplitOptions {
+  /** Buffers shorter than this are sent as a single request */
+  minTotalFrames: number;
+  /** Preferred sub-segment length; decides the number of parts */
+  targetPartFrames: number;
+  /** No part is shorter than this */
+  minPartFrames: number;
+  /** Upper bound on concurrent requests */
+  maxParts: number;
+  /** How far from the even split point a valley is searched for */
+  searchRadiusFrames: number;
+  /** Smoothed speech probability at or below which a frame is a valley */
+  valleyThreshold: number;
+  /** Moving-average window over the VAD probabilities */
+  smoothingFrames: number;
+  /** Audio shared by adjacent parts, so a cut never clips a word edge */
+  overlapFrames: number;
+}
+
+export const DEFAULT_FLUSH_SPLIT: FlushSplitOptions = {
+  minTotalFrames: 250, // 8 s
+  targetPartFrames: 190, // ~6 s
+  minPartFrames: 62, // ~2 s
+  maxParts: 4,
+  searchRadiusFrames: 90, // ~3 s
+  valleyThreshold: 0.35,
+  smoothingFrames: 5,
+  overlapFrames: 8, // 256 ms
+};
+
+/** A sub-segment as a half-open frame range [start, end) */
+export interface FrameRange {
+  start: number;
+  end: number;
+}
+
+function smooth(values: readonly number[], window: number): Float64Array {
+  const half = Math.floor(window / 2);
+  const prefix = new Float64Array(values.length + 1);
+  for (let i = 0; i < values.length; i++) {
+    prefix[i + 1] = prefix[i] + values[i];
+  }
+  const smoothed = new Float64Array(values.length);
+  for (let i = 0; i < values.length; i++) {
+    const from = Math.max(0, i - half);
+    const to = Math.min(values.length, i + half + 1);
+    smoothed[i] = (prefix[to] - prefix[from]) / (to - from);
+  }
+  return smoothed;
+}
+
+/**
+ * Frame indexes at which to cut, chosen as the quietest frame near each
+ * even split point. Returns an empty array when the buffer is short or has
+ * no valleys (continuous speech is never cut mid-word).
+ */
+export function findSplitPoints(
+  speechProbabilities: readonly number[],
+  options: FlushSplitOptions = DEFAULT_FLUSH_SPLIT,
+): number[] {
+  const total = speechProbabilities.length;
+  if (total < options.minTotalFrames) return [];
+
+  const parts = Math.min(
+    options.maxParts,
+    Math.round(total / options.targetPartFrames),
+  );
+  if (parts < 2) return [];
+
+  const smoothed = smooth(speechProbabilities, options.smoothingFrames);
+  const radius = options.searchRadiusFrames;
+  const cuts: number[] = [];
+  let previous = 0;
+
+  for (let k = 1; k < parts; k++) {
+    const ideal = Math.round((k * total) / parts);
+    const from = Math.max(previous + options.minPartFrames, ideal - radius);
+    const to = Math.min(total - options.minPartFrames, ideal + radius);
+
+    let best = -1;
+    let bestScore = Infinity;
+    for (let i = from; i <= to; i++) {
+      if (smoothed[i] > options.valleyThreshold) continue;
+      // Deepest valley wins; distance from the ideal point breaks ties
+      const score = smoothed[i] + (0.05 * Math.abs(i - ideal)) / radius;
+      if (score < bestScore) {
+        bestScore = score;
+        best = i;
+      }
+    }
+    if (best >= 0) {
+      cuts.push(best);
+      previous = best;
+    }
+  }
+
+  return cuts;
+}
+
+/**
+ * Frame ranges for the given cut points. Every part after the first starts
+ * `overlapFrames` before its cut.
+ */
+export function splitRanges(
+  totalFrames: number,
+  cuts: readonly number[],
+  overlapFrames: number = DEFAULT_FLUSH_SPLIT.overlapFrames,
+): FrameRange[] {
+  const ranges: FrameRange[] = [];
+  let start = 0;
+  for (const cut of cuts) {
+    ranges.push({ start, end: cut });
+    start = Math.max(0, cut - overlapFrames);
+  }
+  ranges.push({ start, end: totalFrames });
+  return ranges;
+}
+
+// Trailing punctuation the model adds at the end of each part
+const TRAILING_PUNCTUATION = /[\s。、．，.,!?！？]+$/;
+// Cuts are made in valleys, so repeats are short; shorter matches are more
+// likely to be coincidence than overlap
+const MIN_OVERLAP_CHARS = 3;
+const MAX_OVERLAP_CHARS = 24;
+
+function isLatinWordChar(char: string | undefined): boolean {
+  return char !== undefined && /[A-Za-z0-9']/.test(char);
+}
+
+/**
+ * Remove text repeated across a part boundary. The overlap audio can be
+ * transcribed in both parts, so the longest prefix of `next` that equals
+ * the end of `previous` (ignoring its final punctuation) is dropped.
+ * Latin-script matches must be whole words.
+ */
+function dropRepeatedPrefix(previous: string, next: string): string {
+  const tail = previous.replace(TRAILING_PUNCTUATION, "");
+  const limit = Math.min(MAX_OVERLAP_CHARS, tail.length, next.length);
+  for (let length = limit; length >= MIN_OVERLAP_CHARS; length--) {
+    const repeated = next.slice(0, length);
+    if (!tail.endsWith(repeated)) continue;
+    if (
+      (isLatinWordChar(repeated[0]) &&
+        isLatinWordChar(tail[tail.length - length - 1])) ||
+      (isLatinWordChar(repeated[length - 1]) && isLatinWordChar(next[length]))
+    ) {
+      continue;
+    }
+    return next.slice(length).replace(/^[\s。、．，.,]+/, "");
+  }
+  return next;
+}
+
+/**
+ * Join sub-segment transcripts in order, dropping text duplicated by the
+ * overlap between adjacent parts
+ */
+export function mergeSegmentTranscripts(parts: readonly string[]): string {
+  let merged = "";
+  for (const part of parts) {
+    const text = part.trim();
+    if (!text) continue;
+    if (!merged) {
+      merged = text;
+      continue;
+    }
+    const next = dropRepeatedPrefix(merged, text);
+    // Parts of Latin-script text need the space the model would have put
+    const separator =
+      /[A-Za-z0-9.,!?]$/.test(merged) && /^[A-Za-z0-9]/.test(next) ? " " : "";
+    merged += separator + next;
+  }
+  return merged;
+}
@@ -1,11 +1,86 @@
+import type OpenAI from "openai";
 import {
   TranscriptionProvider,
   TranscribeParams,
   TranscribeContext,
+  TranscribedSegmentInfo,
 } from "../../core/pipeline-types";
-import { logger } from "../../../main/logger";
+import { logger, isDebugEnabled } from "../../../main/logger";
 import { SettingsService } from "../../../services/settings-service";
-import OpenAI from "openai";
+import { loadOpenAISdk, getOpenAIBaseURL } from "../sdk-loader";
+import { metrics } from "../../../main/metrics";
+import { ProviderRouter } from "../../core/provider-router";
+import { buildRecognitionPrompt } from "./recognition-prompt";
+import type { BpeTokenizer } from "../../core/bpe-tokenizer";
+import { peekTokenizerForModel } from "../../core/tokenizer-loader";
+import {
+  StreamingFlacEncoder,
+  type EncodedFlac,
+  type SpeechUploadEncoding,
+} from "./flac-encoder";
+import {
+  findSplitPoints,
+  splitRanges,
+  mergeSegmentTranscripts,
+} from "./flush-splitter";
+import {
+  alignmentFromVerbose,
+  shiftAlignment,
+  type AlignedSegment,
+  type VerboseTranscription,
+} from "../../core/alignment-index";
+import {
+  LOW_CONFIDENCE,
+  MIN_SPEECH_RATIO,
+  applySpeechRatio,
+  combineConfidence,
+  speechRatio,
+  tokenLogprobConfidence,
+} from "../../core/transcript-confidence";
+
+interface WhisperRequest {
+  sessionId?: string;
+  openai: OpenAI;
+  model: string;
+  language?: string;
+  prompt: string;
+}
+
+interface SegmentResult {
+  text: string;
+  /** Null when the model does not return timestamps */
+  alignment: AlignedSegment[] | null;
+  /** 0-1, null when the model reported no scores */
+  confidence: number | null;
+}
+
+// Only whisper-1 returns segment and word timestamps (verbose_json)
+const TIMESTAMP_MODELS = new Set(["whisper-1"]);
+// The GPT-4o transcription models return token log-probabilities instead
+const LOGPROB_MODELS = new Set(["gpt-4o-transcribe", "gpt-4o-mini-transcribe"]);
+// Segments the model is unsure about are decoded again with the larger
+// model, instead of paying for it on every segment
+const ESCALATION_MODELS: Record<string, string> = {
+  "gpt-4o-mini-transcribe": "gpt-4o-transcribe",
+};
+// A hedge uploads the whole file again, which on a slow uplink (where
+// upload time dominates) only competes with the first request for
+// bandwidth. Only files up to this size (~4 s of FLAC speech) are hedged.
+const MAX_HEDGE_UPLOAD_BYTES = 128 * 1024;
+
+// Recorded per segment, so the label sets are bound once
+const wavEncodeLatency = metrics.uploadEncodeLatency.labels({ format: "wav" });
+const flacEncodeLatency = metrics.uploadEncodeLatency.labels({
+  format: "flac",
+});
+
+/** Audio of one uploaded part and its position in the buffered segment */
+interface SegmentPart {
+  audio: Float32Array;
+  offset: number;
+  /** Share of the part's VAD frames that are speech */
+  speechRatio: number;
+}
 
 export class OpenAIWhisperProvider implements TranscriptionProvider {
   readonly name = "openai-whisper";
@@ -15,6 +90,16 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
   private frameBufferSpeechProbabilities: number[] = [];
   private currentSilenceFrameCount = 0;
 
+  // Upload encoding: FLAC frames are encoded as audio arrives
+  private readonly flacEncoder = new StreamingFlacEncoder({
+    sampleRate: 16000,
+  });
+  private uploadEncoding: SpeechUploadEncoding = "flac";
+
+  // Timings and confidence of the last transcribed segment, until taken by
+  // the service
+  private pendingSegmentInfo: TranscribedSegmentInfo | null = null;
+
   // Configuration
   private readonly FRAME_SIZE = 512; // 32ms at 16kHz
   private readonly MAX_SILENCE_DURATION_MS = 3000; // Max silence before transcribing
@@ -22,9 +107,11 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
   private readonly IGNORE_FULLY_SILENT_CHUNKS = true;
 
   private settingsService: SettingsService;
+  private router: ProviderRouter;
 
   constructor(settingsService: SettingsService) {
     this.settingsService = settingsService;
+    this.router = ProviderRouter.getInstance();
   }
 
   /**
@@ -42,17 +129,30 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
   async transcribe(params: TranscribeParams): Promise<string> {
     const { audioData, speechProbability = 1, context } = params;
 
+    // The upload encoding is fixed per segment, read when one starts
+    // (served from SettingsService's memory after the first read)
+    if (this.frameBuffer.length === 0) {
+      this.uploadEncoding =
+        await this.settingsService.getSpeechUploadEncoding();
+    }
+
     // Add frame to buffer with speech probability
     this.frameBuffer.push(audioData);
     this.frameBufferSpeechProbabilities.push(speechProbability);
+    if (this.uploadEncoding === "flac") {
+      this.flacEncoder.write(audioData);
+    }
 
     // Use VAD's speech probability directly - low probability indicates silence
     // VADService already applies its own threshold logic
     const isSpeech = speechProbability > 0;
 
-    logger.transcription.debug(
-      `Frame received - SpeechProb: ${speechProbability.toFixed(3)}, Buffer size: ${this.frameBuffer.length}, Silence count: ${this.currentSilenceFrameCount}`,
-    );
+    // Per-frame: only build the message when debug output is enabled
+    if (isDebugEnabled("transcription")) {
+      logger.transcription.debug(
+        `Frame received - SpeechProb: ${speechProbability.toFixed(3)}, Buffer size: ${this.frameBuffer.length}, Silence count: ${this.currentSilenceFrameCount}`,
+      );
+    }
 
     // Handle speech/silence logic based on VAD result
     if (isSpeech) {
@@ -78,27 +178,39 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
       return "";
     }
 
-    return this.doTranscription(context);
+    return this.doTranscription(context, true);
   }
 
   /**
    * Shared transcription logic - aggregates buffer, calls OpenAI Whisper API
+   *
+   * A long final flush is what the user waits for after stopping, so it is
+   * cut at VAD valleys and the parts are transcribed concurrently.
    */
-  private async doTranscription(context: TranscribeContext): Promise<string> {
+  private async doTranscription(
+    context: TranscribeContext,
+    isFinal = false,
+  ): Promise<string> {
     try {
-      const isAllSilent = this.isAllSilent();
+      // Nothing to aggregate, split or encode for an all-silent buffer
+      if (this.isAllSilent() && this.IGNORE_FULLY_SILENT_CHUNKS) {
+        this.reset();
+        logger.transcription.debug("Skipping transcription - all silent");
+        return "";
+      }
 
       // Aggregate buffered frames
       const aggregatedAudio = this.aggregateFrames();
+      const aggregatedSpeechRatio = speechRatio(
+        this.frameBufferSpeechProbabilities,
+      );
+      const parts = isFinal ? this.splitFinalSegment() : null;
+      // Take the streamed FLAC frames before reset() discards them
+      const encoded = this.takeEncodedFlac(aggregatedAudio.length, parts);
 
       // Clear buffers immediately after aggregation
       this.reset();
 
-      if (isAllSilent && this.IGNORE_FULLY_SILENT_CHUNKS) {
-        logger.transcription.debug("Skipping transcription - all silent");
-        return "";
-      }
-
       logger.transcription.debug(
         `Starting OpenAI Whisper transcription of ${aggregatedAudio.length} samples (${((aggregatedAudio.length / this.SAMPLE_RATE) * 1000).toFixed(0)}ms)`,
       );
@@ -109,35 +221,68 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
         throw new Error("OpenAI API key is not configured");
       }
 
-      // Convert Float32Array to WAV format
-      const wavBuffer = this.float32ToWav(aggregatedAudio);
-
-      // Create OpenAI client
+      // Create OpenAI client (SDK is loaded on first use)
+      const OpenAI = await loadOpenAISdk();
       const openai = new OpenAI({
         apiKey: openaiConfig.apiKey,
-      });
-
-      // Create File object from WAV buffer
-      const audioFile = new File([wavBuffer], "audio.wav", {
-        type: "audio/wav",
+        baseURL: getOpenAIBaseURL(),
       });
 
       // Get speech model from settings, default to whisper-1
       const speechModel =
         (await this.settingsService.getDefaultSpeechModel()) || "whisper-1";
 
-      // Call OpenAI Whisper API
-      const response = await openai.audio.transcriptions.create({
-        file: audioFile,
+      const request = {
+        sessionId: context.sessionId,
+        openai,
         model: speechModel,
         language: context.language !== "auto" ? context.language : undefined,
+        // Parts run concurrently, so each gets the context before the flush.
+        // The upload never waits for the tokenizer (estimate until loaded)
         prompt: this.generateRecognitionPrompt(
-          context.vocabulary,
-          context.aggregatedTranscription,
+          context,
+          peekTokenizerForModel(speechModel),
         ),
-      });
-
-      const text = response.text || "";
+      };
+
+      let text: string;
+      if (parts) {
+        metrics.flushSplits.inc({ provider: this.name });
+        logger.transcription.debug(
+          `Transcribing final flush as ${parts.length} parallel parts`,
+        );
+        const results = await Promise.all(
+          parts.map((part, i) =>
+            this.transcribeSegment(
+              request,
+              this.createUploadFile(part.audio, encoded?.[i] ?? null),
+              part.audio.length,
+              part.speechRatio,
+            ),
+          ),
+        );
+        text = mergeSegmentTranscripts(results.map((result) => result.text));
+        this.setPendingSegmentInfo(results, parts, aggregatedAudio.length);
+      } else {
+        const result = await this.transcribeSegment(
+          request,
+          this.createUploadFile(aggregatedAudio, encoded?.[0] ?? null),
+          aggregatedAudio.length,
+          aggregatedSpeechRatio,
+        );
+        text = result.text;
+        this.setPendingSegmentInfo(
+          [result],
+          [
+            {
+              audio: aggregatedAudio,
+              offset: 0,
+              speechRatio: aggregatedSpeechRatio,
+            },
+          ],
+          aggregatedAudio.length,
+        );
+      }
 
       logger.transcription.debug(
         `OpenAI Whisper transcription completed, length: ${text.length}`,
@@ -145,15 +290,209 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
 
       return text;
     } catch (error) {
+      metrics.providerErrors.inc({ provider: this.name });
       logger.transcription.error("OpenAI Whisper transcription failed:", error);
       throw new Error(`OpenAI Whisper transcription failed: ${error}`);
     }
   }
 
+  /**
+   * Transcribe one uploaded segment and score it. A segment the model is
+   * unsure about is decoded again with the larger model when there is one;
+   * low scores on audio that is mostly non-speech are not retried, since a
+   * larger model cannot recover speech that is not there.
+   */
+  private async transcribeSegment(
+    request: WhisperRequest,
+    file: File,
+    sampleCount: number,
+    ratio: number,
+  ): Promise<SegmentResult> {
+    const result = await this.requestTranscription(request, file, sampleCount);
+    const largerModel = ESCALATION_MODELS[request.model];
+    if (
+      largerModel &&
+      result.confidence !== null &&
+      result.confidence < LOW_CONFIDENCE &&
+      ratio >= MIN_SPEECH_RATIO
+    ) {
+      metrics.speechEscalations.inc({ from: request.model, to: largerModel });
+      logger.transcription.debug("Re-decoding low-confidence segment", {
+        confidence: result.confidence,
+        model: largerModel,
+      });
+      try {
+        const escalated = await this.requestTranscription(
+          { ...request, model: largerModel },
+          file,
+          sampleCount,
+        );
+        if (escalated.text.trim()) return this.scoreSpeech(escalated, ratio);
+      } catch (error) {
+        logger.transcription.warn("Low-confidence re-decode failed", {
+          error,
+        });
+      }
+    }
+    return this.scoreSpeech(result, ratio);
+  }
+
+  private scoreSpeech(result: SegmentResult, ratio: number): SegmentResult {
+    if (result.confidence === null) return result;
+    return { ...result, confidence: applySpeechRatio(result.confidence, ratio) };
+  }
+
+  /**
+   * One segment through the provider router: for small files, a duplicate
+   * request is sent if this one runs past the p95 for segments of similar
+   * length
+   */
+  private async requestTranscription(
+    request: WhisperRequest,
+    file: File,
+    sampleCount: number,
+  ): Promise<SegmentResult> {
+    const labels = { provider: this.name, model: request.model };
+    metrics.segmentsUploaded.inc(labels);
+    const key = `transcription:${this.name}:${request.model}`;
+    // Latency grows with the audio length; compare within 5 s buckets
+    const bucket = Math.ceil(sampleCount / this.SAMPLE_RATE / 5) * 5;
+    const withTimestamps = TIMESTAMP_MODELS.has(request.model);
+    const withLogprobs = LOGPROB_MODELS.has(request.model);
+
+    return this.router.route(
+      [
+        {
+          key,
+          latencyKey: `${key}:${bucket}s`,
+          run: async (signal) => {
+            metrics.bytesUploaded.inc(labels, file.size);
+            const requestStart = performance.now();
+            const response = withTimestamps
+              ? await request.openai.audio.transcriptions.create(
+                  {
+                    file,
+                    model: request.model,
+                    language: request.language,
+                    prompt: request.prompt,
+                    response_format: "verbose_json",
+                    timestamp_granularities: ["segment", "word"],
+                  },
+                  { signal },
+                )
+              : await request.openai.audio.transcriptions.create(
+                  {
+                    file,
+                    model: request.model,
+                    language: request.language,
+                    prompt: request.prompt,
+                    ...(withLogprobs && { include: ["logprobs" as const] }),
+                  },
+                  { signal },
+                );
+            metrics.providerLatency.record(
+              performance.now() - requestStart,
+              labels,
+            );
+            return this.parseResponse(response, withTimestamps);
+          },
+        },
+      ],
+      {
+        kind: "transcription",
+        sessionId: request.sessionId,
+        hedge: file.size <= MAX_HEDGE_UPLOAD_BYTES,
+      },
+    );
+  }
+
+  /**
+   * Text, timings and confidence of one response
+   */
+  private parseResponse(
+    response: { text?: string; logprobs?: { logprob: number }[] | null },
+    withTimestamps: boolean,
+  ): SegmentResult {
+    const text = response.text || "";
+    if (!withTimestamps) {
+      return {
+        text,
+        alignment: null,
+        confidence: tokenLogprobConfidence(response.logprobs),
+      };
+    }
+
+    // Confidence of the whole response: its segments weighted by duration
+    const alignment = alignmentFromVerbose(response as VerboseTranscription);
+    const confidence = combineConfidence(
+      alignment.flatMap((segment) =>
+        segment.confidence === undefined
+          ? []
+          : [
+              {
+                confidence: segment.confidence,
+                weight: segment.endMs - segment.startMs,
+              },
+            ],
+      ),
+    );
+    return { text, alignment, confidence };
+  }
+
+  /**
+   * Timings and confidence of the text returned by the last transcribe/flush
+   * call. Null when nothing was transcribed.
+   */
+  takeSegmentInfo(): TranscribedSegmentInfo | null {
+    const info = this.pendingSegmentInfo;
+    this.pendingSegmentInfo = null;
+    return info;
+  }
+
+  /**
+   * Join the results of the uploaded parts of one segment. Timings are moved
+   * to the position of their part, dropping words a part repeats from the
+   * overlap with the previous part; confidence is weighted by part length.
+   */
+  private setPendingSegmentInfo(
+    results: SegmentResult[],
+    parts: SegmentPart[],
+    sampleCount: number,
+  ): void {
+    const alignment: AlignedSegment[] = [];
+    const hasAlignment = results.every((result) => result.alignment !== null);
+    let previousEndMs = 0;
+    results.forEach((result, i) => {
+      const part = parts[i];
+      if (hasAlignment) {
+        const offsetMs = (part.offset / this.SAMPLE_RATE) * 1000;
+        for (const segment of shiftAlignment(result.alignment!, offsetMs)) {
+          const words = segment.words.filter(
+            (word) => word.startMs >= previousEndMs,
+          );
+          if (words.length > 0) alignment.push({ ...segment, words });
+        }
+      }
+      previousEndMs =
+        ((part.offset + part.audio.length) / this.SAMPLE_RATE) * 1000;
+    });
+
+    const confidence = combineConfidence(
+      results.flatMap((result, i) =>
+        result.confidence === null
+          ? []
+          : [{ confidence: result.confidence, weight: parts[i].audio.length }],
+      ),
+    );
+    this.pendingSegmentInfo = { alignment, sampleCount, confidence };
+  }
+
   /**
    * Clear internal buffers without transcribing
    */
   reset(): void {
+    this.pendingSegmentInfo = null;
+    this.flacEncoder.reset();
     this.frameBuffer = [];
     this.frameBufferSpeechProbabilities = [];
     this.currentSilenceFrameCount = 0;
@@ -185,25 +524,28 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
       return true;
     }
 
-    logger.transcription.debug("Not transcribing", {
-      bufferDurationMs,
-      silenceDurationMs,
-      frameBufferLength: this.frameBuffer.length,
-      silenceFrameCount: this.currentSilenceFrameCount,
-    });
+    if (isDebugEnabled("transcription")) {
+      logger.transcription.debug("Not transcribing", {
+        bufferDurationMs,
+        silenceDurationMs,
+        frameBufferLength: this.frameBuffer.length,
+        silenceFrameCount: this.currentSilenceFrameCount,
+      });
+    }
 
     return false;
   }
 
-  private aggregateFrames(): Float32Array {
-    const totalLength = this.frameBuffer.reduce(
-      (sum, frame) => sum + frame.length,
-      0,
-    );
+  private aggregateFrames(
+    start = 0,
+    end = this.frameBuffer.length,
+  ): Float32Array {
+    const frames = this.frameBuffer.slice(start, end);
+    const totalLength = frames.reduce((sum, frame) => sum + frame.length, 0);
     const aggregated = new Float32Array(totalLength);
 
     let offset = 0;
-    for (const frame of this.frameBuffer) {
+    for (const frame of frames) {
       aggregated.set(frame, offset);
       offset += frame.length;
     }
@@ -211,6 +553,28 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
     return aggregated;
   }
 
+  /**
+   * Audio of each sub-segment when the buffer is long enough to be worth
+   * splitting and has valleys to cut at; null otherwise
+   */
+  private splitFinalSegment(): SegmentPart[] | null {
+    const cuts = findSplitPoints(this.frameBufferSpeechProbabilities);
+    if (cuts.length === 0) return null;
+
+    // Sample offset of each frame, for the position of each part
+    const frameOffsets = [0];
+    for (const frame of this.frameBuffer) {
+      frameOffsets.push(frameOffsets[frameOffsets.length - 1] + frame.length);
+    }
+    return splitRanges(this.frameBuffer.length, cuts).map(({ start, end }) => ({
+      audio: this.aggregateFrames(start, end),
+      offset: frameOffsets[start],
+      speechRatio: speechRatio(
+        this.frameBufferSpeechProbabilities.slice(start, end),
+      ),
+    }));
+  }
+
   private isAllSilent(): boolean {
     const bufferDurationMs =
       ((this.frameBuffer.length * this.FRAME_SIZE) / this.SAMPLE_RATE) * 1000;
@@ -221,6 +585,49 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
     return bufferDurationMs === silenceDurationMs;
   }
 
+  /**
+   * Finish the streaming FLAC encoder for the current segment, one file per
+   * part when the final flush is split (the streamed blocks are reused).
+   * Returns null when the segment was not streamed in full (WAV selected).
+   */
+  private takeEncodedFlac(
+    sampleCount: number,
+    parts: SegmentPart[] | null,
+  ): EncodedFlac[] | null {
+    if (
+      this.uploadEncoding !== "flac" ||
+      this.flacEncoder.sampleCount !== sampleCount
+    ) {
+      return null;
+    }
+    if (parts) return this.flacEncoder.finishParts(parts);
+    const encoded = this.flacEncoder.finish();
+    return [{ parts: encoded, encodeMs: this.flacEncoder.lastEncodeMs }];
+  }
+
+  /**
+   * Build the upload file in the configured encoding
+   */
+  private createUploadFile(
+    audio: Float32Array,
+    encoded: EncodedFlac | null,
+  ): File {
+    if (this.uploadEncoding === "wav") {
+      const start = performance.now();
+      const wavBuffer = this.float32ToWav(audio);
+      wavEncodeLatency.record(performance.now() - start);
+      return new File([wavBuffer], "audio.wav", { type: "audio/wav" });
+    }
+
+    if (!encoded) {
+      this.flacEncoder.write(audio);
+      const parts = this.flacEncoder.finish();
+      encoded = { parts, encodeMs: this.flacEncoder.lastEncodeMs };
+    }
+    flacEncodeLatency.record(encoded.encodeMs);
+    return new File(encoded.parts, "audio.flac", { type: "audio/flac" });
+  }
+
   /**
    * Convert Float32Array audio data to WAV format
    */
@@ -275,20 +682,15 @@ export class OpenAIWhisperProvider implements TranscriptionProvider {
    * 辞書の単語と前回までの認識結果を含めることで認識精度を向上させる
    */
   private generateRecognitionPrompt(
-    vocabulary?: string[],
-    aggregatedTranscription?: string,
+    context: TranscribeContext,
+    tokenizer: BpeTokenizer | null,
   ): string {
-    const promptParts: string[] = [];
-
-    if (vocabulary && vocabulary.length > 0) {
-      promptParts.push(vocabulary.join(", "));
-    }
-
-    if (aggregatedTranscription) {
-      promptParts.push(aggregatedTranscription);
-    }
-
-    const prompt = promptParts.join(" ");
+    const recentText = context.aggregatedTranscription;
+    // Most relevant terms first; the prompt builder fits them to the budget
+    const vocabulary = context.vocabularyIndex
+      ? context.vocabularyIndex.rank(recentText)
+      : context.vocabulary;
+    const prompt = buildRecognitionPrompt({ vocabulary, recentText, tokenizer });
     logger.transcription.debug(`Generated recognition prompt: "${prompt}"`);
 
     return prompt;
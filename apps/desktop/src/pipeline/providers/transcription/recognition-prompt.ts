@@ -0,0 +1,126 @@
+/**
+ * Token-budgeted Whisper recognition prompt
+ *
+ * Whisper only conditions on the last ~224 tokens of the prompt and silently
+ * drops the rest from the front, so an unbounded "vocabulary + everything
+ * said so far" prompt wastes upload bytes and loses the vocabulary first.
+ * The prompt is built to fit the budget up front: vocabulary terms (those
+ * that occur in the recent text first) followed by the most recent
+ * transcript text, which Whisper weights most.
+ */
+
+import { estimateTokens, type BpeTokenizer } from "../../core/bpe-tokenizer";
+
+export const WHISPER_PROMPT_TOKEN_LIMIT = 224;
+
+// Share of the budget vocabulary may use; unused space goes to recent text
+const VOCABULARY_BUDGET_SHARE = 0.5;
+
+// Characters of recent transcript worth considering (well above the budget)
+export const RECENT_CONTEXT_MAX_CHARS = 1000;
+
+const VOCABULARY_SEPARATOR = ", ";
+
+export { estimateTokens };
+
+/**
+ * Longest suffix of `text` within `maxTokens`, starting after a sentence or
+ * clause boundary when one is close to the cut. Exact when the model's
+ * tokenizer is given, estimated otherwise.
+ */
+function tailWithinBudget(
+  text: string,
+  maxTokens: number,
+  tokenizer: BpeTokenizer | null,
+): string {
+  if (maxTokens <= 0) return "";
+
+  let tail: string[];
+  if (tokenizer) {
+    if (tokenizer.count(text) <= maxTokens) return text;
+    tail = Array.from(tokenizer.truncateStart(text, maxTokens));
+  } else {
+    if (estimateTokens(text) <= maxTokens) return text;
+    const chars = Array.from(text);
+    let tokens = 0;
+    let start = chars.length;
+    while (start > 0) {
+      const cost = chars[start - 1].charCodeAt(0) < 0x80 ? 0.25 : 1.5;
+      if (tokens + cost > maxTokens) break;
+      tokens += cost;
+      start--;
+    }
+    tail = chars.slice(start);
+  }
+
+  // Avoid opening on a fragment: skip to just after the first boundary if it
+  // is within the first third of the kept text
+  const boundary = tail.findIndex((c) => /[。．.!?！？、,\s]/.test(c));
+  if (boundary >= 0 && boundary < tail.length / 3) {
+    tail = tail.slice(boundary + 1);
+  }
+  return tail.join("").trimStart();
+}
+
+export function buildRecognitionPrompt(options: {
+  vocabulary?: string[];
+  recentText?: string;
+  maxTokens?: number;
+  /** Tokenizer of the speech model, for exact counts (estimates without) */
+  tokenizer?: BpeTokenizer | null;
+}): string {
+  const {
+    vocabulary = [],
+    recentText = "",
+    maxTokens = WHISPER_PROMPT_TOKEN_LIMIT,
+    tokenizer = null,
+  } = options;
+  const countTokens = tokenizer
+    ? (text: string) => tokenizer.count(text)
+    : estimateTokens;
+
+  // Vocabulary: terms mentioned in the recent text first, then input order
+  // (callers pass vocabulary most-relevant first)
+  const terms: string[] = [];
+  if (vocabulary.length > 0) {
+    const seen = new Set<string>();
+    const mentioned: string[] = [];
+    const rest: string[] = [];
+    const haystack = recentText.toLowerCase();
+    for (const term of vocabulary) {
+      const trimmed = term.trim();
+      if (!trimmed || seen.has(trimmed)) continue;
+      seen.add(trimmed);
+      if (haystack && haystack.includes(trimmed.toLowerCase())) {
+        mentioned.push(trimmed);
+      } else {
+        rest.push(trimmed);
+      }
+    }
+
+    const vocabularyBudget = recentText
+      ? Math.floor(maxTokens * VOCABULARY_BUDGET_SHARE)
+      : maxTokens;
+    const separatorTokens = countTokens(VOCABULARY_SEPARATOR);
+    let used = 0;
+    for (const term of [...mentioned, ...rest]) {
+      const cost =
+        countTokens(term) + (terms.length > 0 ? separatorTokens : 0);
+      if (used + cost > vocabularyBudget) continue; // A shorter term may fit
+      terms.push(term);
+      used += cost;
+    }
+  }
+
+  const vocabularyPart = terms.join(VOCABULARY_SEPARATOR);
+  const vocabularyTokens = vocabularyPart
+    ? countTokens(vocabularyPart) + 1
+    : 0;
+  const textPart = tailWithinBudget(
+    recentText,
+    maxTokens - vocabularyTokens,
+    tokenizer,
+  );
+
+  return [vocabularyPart, textPart].filter(Boolean).join(" ");
+}
@@ -16,6 +16,7 @@ import { Progress } from "@/components/ui/progress";
 import { api } from "@/trpc/react";
 import { RefreshCw, Check, Download, Loader2, FileText, Shield, ExternalLink, BookOpen } from "lucide-react";
 import { LegalDocumentDialog } from "@/components/legal-document-dialog";
+import { MetricsDebugCard } from "./metrics-debug-card";
 import {
   getPrivacyPolicy,
   getDisclaimer,
@@ -313,6 +314,8 @@ export default function AboutSettingsPage() {
             </div>
           </CardContent>
         </Card>
+
+        <MetricsDebugCard />
       </div>
 
       {/* Legal Document Dialog */}
@@ -0,0 +1,107 @@
+import { Card, CardContent } from "@/components/ui/card";
+import {
+  Table,
+  TableBody,
+  TableCell,
+  TableHead,
+  TableHeader,
+  TableRow,
+} from "@/components/ui/table";
+import { api } from "@/trpc/react";
+
+const formatNumber = (value: number) =>
+  Number.isInteger(value) ? value.toString() : value.toFixed(2);
+
+const shortName = (name: string) => name.replace(/^surasura_/, "");
+
+/**
+ * Metrics debug panel (development builds, or when METRICS_PORT is set)
+ */
+export function MetricsDebugCard() {
+  const { data: status } = api.debug.getStatus.useQuery();
+  const { data: metrics } = api.debug.getMetrics.useQuery(undefined, {
+    enabled: !!status?.showMetrics,
+    refetchInterval: 2000, // Poll every 2 seconds
+  });
+
+  if (!status?.showMetrics || !metrics) return null;
+
+  const scalars = [...metrics.counters, ...metrics.gauges];
+
+  return (
+    <Card>
+      <CardContent className="space-y-4">
+        <div>
+          <div className="text-lg font-semibold">メトリクス（デバッグ）</div>
+          {status.metricsEndpointUrl && (
+            <p className="text-sm text-muted-foreground mt-1">
+              {status.metricsEndpointUrl}
+            </p>
+          )}
+        </div>
+
+        <Table>
+          <TableHeader>
+            <TableRow>
+              <TableHead>名前</TableHead>
+              <TableHead>ラベル</TableHead>
+              <TableHead className="text-right">値</TableHead>
+            </TableRow>
+          </TableHeader>
+          <TableBody>
+            {scalars.map((m) => (
+              <TableRow key={`${m.name}{${m.labels}}`}>
+                <TableCell className="font-mono text-xs">
+                  {shortName(m.name)}
+                </TableCell>
+                <TableCell className="font-mono text-xs">{m.labels}</TableCell>
+                <TableCell className="text-right font-mono text-xs">
+                  {formatNumber(m.value)}
+                </TableCell>
+              </TableRow>
+            ))}
+          </TableBody>
+        </Table>
+
+        <Table>
+          <TableHeader>
+            <TableRow>
+              <TableHead>名前</TableHead>
+              <TableHead>ラベル</TableHead>
+              <TableHead className="text-right">件数</TableHead>
+              <TableHead className="text-right">p50</TableHead>
+              <TableHead className="text-right">p90</TableHead>
+              <TableHead className="text-right">p99</TableHead>
+              <TableHead className="text-right">最大</TableHead>
+            </TableRow>
+          </TableHeader>
+          <TableBody>
+            {metrics.histograms.map((h) => (
+              <TableRow key={`${h.name}{${h.labels}}`}>
+                <TableCell className="font-mono text-xs">
+                  {shortName(h.name)}
+                </TableCell>
+                <TableCell className="font-mono text-xs">{h.labels}</TableCell>
+                <TableCell className="text-right font-mono text-xs">
+                  {h.count}
+                </TableCell>
+                <TableCell className="text-right font-mono text-xs">
+                  {formatNumber(h.p50)}
+                </TableCell>
+                <TableCell className="text-right font-mono text-xs">
+                  {formatNumber(h.p90)}
+                </TableCell>
+                <TableCell className="text-right font-mono text-xs">
+                  {formatNumber(h.p99)}
+                </TableCell>
+                <TableCell className="text-right font-mono text-xs">
+                  {formatNumber(h.max)}
+                </TableCell>
+              </TableRow>
+            ))}
+          </TableBody>
+        </Table>
+      </CardContent>
+    </Card>
+  );
+}
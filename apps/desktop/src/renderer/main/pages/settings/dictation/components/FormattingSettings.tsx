@@ -65,6 +65,7 @@ const MODEL_LABELS: Record<string, string> = {
 export function FormattingSettings() {
   const {
     formattingEnabled,
+    bypassEnabled,
     formattingOptions,
     activePreset,
     presets,
@@ -86,6 +87,7 @@ export function FormattingSettings() {
     maxNameLength,
     maxInstructionsLength,
     handleFormattingEnabledChange,
+    handleBypassEnabledChange,
     handleSelectPreset,
     handleStartEditing,
     handleStartCreating,
@@ -100,6 +102,8 @@ export function FormattingSettings() {
     handleEditColorChange,
     editType,
     editColor,
+    editCleanupOnly,
+    handleEditCleanupOnlyChange,
     pendingTypeChange,
     handleConfirmTypeChange,
     handleCancelTypeChange,
@@ -317,6 +321,22 @@ export function FormattingSettings() {
               </div>
             )}
           </div>
+
+          {/* Formatter Bypass */}
+          <div className="flex items-center justify-between rounded-lg border border-border p-4">
+            <div className="space-y-0.5 pr-4">
+              <Label className="text-sm font-medium">
+                整形不要な文字起こしをスキップ
+              </Label>
+              <p className="text-xs text-muted-foreground">
+                短い返事や句読点の整った文はAIに送らずそのまま出力します（「整形のみ」のプリセットで有効）
+              </p>
+            </div>
+            <Switch
+              checked={bypassEnabled}
+              onCheckedChange={handleBypassEnabledChange}
+            />
+          </div>
         </div>
       )}
 
@@ -388,6 +408,22 @@ export function FormattingSettings() {
               </div>
             </div>
 
+            {/* Cleanup Only */}
+            {editType === "formatting" && (
+              <div className="flex items-center justify-between">
+                <div className="space-y-0.5 pr-4">
+                  <Label className="text-sm font-medium">整形のみ</Label>
+                  <p className="text-xs text-muted-foreground">
+                    文体や形式を変えないプリセットです。整った文字起こしはAIに送らずに出力できます
+                  </p>
+                </div>
+                <Switch
+                  checked={editCleanupOnly}
+                  onCheckedChange={handleEditCleanupOnlyChange}
+                />
+              </div>
+            )}
+
             {/* Color Selection */}
             <div>
               <Label className="text-sm font-medium mb-2 block">アイコンの色</Label>
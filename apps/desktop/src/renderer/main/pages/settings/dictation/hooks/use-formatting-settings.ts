@@ -148,6 +148,7 @@ ${PROHIBITIONS}`,
 interface UseFormattingSettingsReturn {
   // State
   formattingEnabled: boolean;
+  bypassEnabled: boolean;
   formattingOptions: ComboboxOption[];
   activePreset: FormatPreset | null;
   presets: FormatPreset[];
@@ -163,6 +164,7 @@ interface UseFormattingSettingsReturn {
   editModelId: string;
   editInstructions: string;
   editColor: PresetColorId;
+  editCleanupOnly: boolean;
 
   // Type change confirmation
   pendingTypeChange: PresetTypeId | null;
@@ -192,6 +194,7 @@ interface UseFormattingSettingsReturn {
 
   // Handlers
   handleFormattingEnabledChange: (enabled: boolean) => void;
+  handleBypassEnabledChange: (enabled: boolean) => void;
   handleSelectPreset: (presetId: string | null) => void;
   handleStartEditing: (presetId: string) => void;
   handleStartCreating: () => void;
@@ -204,6 +207,7 @@ interface UseFormattingSettingsReturn {
   handleEditModelChange: (modelId: string) => void;
   handleEditInstructionsChange: (instructions: string) => void;
   handleEditColorChange: (color: PresetColorId) => void;
+  handleEditCleanupOnlyChange: (cleanupOnly: boolean) => void;
 }
 
 export function useFormattingSettings(): UseFormattingSettingsReturn {
@@ -228,6 +232,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
   const [editModelId, setEditModelId] = useState("gpt-4o-mini");
   const [editInstructions, setEditInstructions] = useState("");
   const [editColor, setEditColor] = useState<PresetColorId>("yellow");
+  const [editCleanupOnly, setEditCleanupOnly] = useState(false);
   const [pendingTypeChange, setPendingTypeChange] = useState<PresetTypeId | null>(null);
   const [showResetAllConfirm, setShowResetAllConfirm] = useState(false);
   const [initialEditState, setInitialEditState] = useState({
@@ -236,6 +241,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
     modelId: "gpt-4o-mini",
     instructions: "",
     color: "yellow" as PresetColorId,
+    cleanupOnly: false,
   });
 
   // Reset edit mode when leaving the page or when data changes
@@ -337,6 +343,8 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
   // Derived values
   const hasFormattingOptions = hasOpenAIKey;
   const formattingEnabled = formatterConfig?.enabled ?? false;
+  // 未設定は "shadow"（判定を記録するだけでスキップしない）
+  const bypassEnabled = formatterConfig?.bypassMode === "on";
   const disableFormattingToggle = !hasFormattingOptions;
   const showApiKeyRequired = !hasOpenAIKey;
   const canCreatePreset = presets.length < MAX_PRESETS;
@@ -348,9 +356,10 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
       editType !== initialEditState.type ||
       editModelId !== initialEditState.modelId ||
       editInstructions !== initialEditState.instructions ||
-      editColor !== initialEditState.color
+      editColor !== initialEditState.color ||
+      editCleanupOnly !== initialEditState.cleanupOnly
     );
-  }, [isEditMode, editName, editType, editModelId, editInstructions, editColor, initialEditState]);
+  }, [isEditMode, editName, editType, editModelId, editInstructions, editColor, editCleanupOnly, initialEditState]);
 
   // Check if currently editing a default preset
   const editingPreset = useMemo(() => {
@@ -370,9 +379,10 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
       editType !== defaultValues.type ||
       editModelId !== defaultValues.modelId ||
       editInstructions !== defaultValues.instructions ||
-      editColor !== defaultValues.color
+      editColor !== defaultValues.color ||
+      editCleanupOnly
     );
-  }, [isEditMode, isCreatingNew, editingPreset, editName, editType, editModelId, editInstructions, editColor]);
+  }, [isEditMode, isCreatingNew, editingPreset, editName, editType, editModelId, editInstructions, editColor, editCleanupOnly]);
 
   const isSaving = createPresetMutation.isPending || updatePresetMutation.isPending;
   const isDeleting = deletePresetMutation.isPending;
@@ -396,12 +406,24 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
         fallbackModelId: formatterConfig?.fallbackModelId,
         presets: formatterConfig?.presets,
         activePresetId: formatterConfig?.activePresetId,
+        bypassMode: formatterConfig?.bypassMode,
       };
       setFormatterConfigMutation.mutate(nextConfig);
     },
     [formatterConfig, setFormatterConfigMutation],
   );
 
+  const handleBypassEnabledChange = useCallback(
+    (enabled: boolean) => {
+      if (!formatterConfig) return;
+      setFormatterConfigMutation.mutate({
+        ...formatterConfig,
+        bypassMode: enabled ? "on" : "shadow",
+      });
+    },
+    [formatterConfig, setFormatterConfigMutation],
+  );
+
   const handleSelectPreset = useCallback(
     (presetId: string | null) => {
       // Close edit mode when selecting
@@ -425,12 +447,14 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
         setEditModelId(preset.modelId);
         setEditInstructions(preset.instructions);
         setEditColor(preset.color ?? "yellow");
+        setEditCleanupOnly(preset.cleanupOnly ?? false);
         setInitialEditState({
           name: preset.name,
           type: preset.type ?? "formatting",
           modelId: preset.modelId,
           instructions: preset.instructions,
           color: preset.color ?? "yellow",
+          cleanupOnly: preset.cleanupOnly ?? false,
         });
       });
     },
@@ -459,12 +483,14 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
       setEditModelId(defaultModelId);
       setEditInstructions(defaultInstructions);
       setEditColor(defaultColor);
+      setEditCleanupOnly(false);
       setInitialEditState({
         name: "",
         type: defaultType,
         modelId: defaultModelId,
         instructions: defaultInstructions,
         color: defaultColor,
+        cleanupOnly: false,
       });
     });
   }, [canCreatePreset]);
@@ -495,6 +521,8 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
     }
 
     const modelId = editModelId as "gpt-4.1-nano" | "gpt-4o-mini" | "gpt-4.1-mini" | "gpt-4.1" | "gpt-4o";
+    // 回答プリセットは整形のみにならない
+    const cleanupOnly = editType === "formatting" && editCleanupOnly;
 
     if (isCreatingNew) {
       createPresetMutation.mutate({
@@ -504,6 +532,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
         instructions: trimmedInstructions,
         isDefault: false,
         color: editColor,
+        cleanupOnly,
       });
     } else if (editingPresetId) {
       updatePresetMutation.mutate({
@@ -513,6 +542,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
         modelId,
         instructions: trimmedInstructions,
         color: editColor,
+        cleanupOnly,
       });
     }
   }, [
@@ -521,6 +551,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
     editModelId,
     editInstructions,
     editColor,
+    editCleanupOnly,
     isCreatingNew,
     editingPresetId,
     createPresetMutation,
@@ -541,6 +572,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
     setEditModelId(defaultValues.modelId);
     setEditInstructions(defaultValues.instructions);
     setEditColor(defaultValues.color);
+    setEditCleanupOnly(false);
   }, [editingPreset]);
 
   const handleShowResetAllConfirm = useCallback(() => {
@@ -591,9 +623,14 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
     setEditColor(color);
   }, []);
 
+  const handleEditCleanupOnlyChange = useCallback((cleanupOnly: boolean) => {
+    setEditCleanupOnly(cleanupOnly);
+  }, []);
+
   return {
     // State
     formattingEnabled,
+    bypassEnabled,
     formattingOptions,
     activePreset,
     presets,
@@ -609,6 +646,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
     editModelId,
     editInstructions,
     editColor,
+    editCleanupOnly,
 
     // Type change confirmation
     pendingTypeChange,
@@ -638,6 +676,7 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
 
     // Handlers
     handleFormattingEnabledChange,
+    handleBypassEnabledChange,
     handleSelectPreset,
     handleStartEditing,
     handleStartCreating,
@@ -650,5 +689,6 @@ export function useFormattingSettings(): UseFormattingSettingsReturn {
     handleEditModelChange,
     handleEditInstructionsChange,
     handleEditColorChange,
+    handleEditCleanupOnlyChange,
   };
 }
@@ -1,5 +1,5 @@
 import { useState, useRef, useEffect } from "react";
-import { Copy, Play, Pause, Download, Volume2 } from "lucide-react";
+import { Copy, Play, Pause, Download, Volume2, Search } from "lucide-react";
 import { Button } from "@/components/ui/button";
 import {
   Dialog,
@@ -19,6 +19,7 @@ type TranscriptionItem = {
   audioFile: string | null;
   speechModel: string | null;
   formattingModel: string | null;
+  confidence?: number | null;
   createdAt: Date;
   updatedAt: Date;
 };
@@ -27,6 +28,7 @@ interface TranscriptionDetailDialogProps {
   open: boolean;
   onOpenChange: (open: boolean) => void;
   transcription: TranscriptionItem | null;
+  searchQuery?: string; // 履歴検索の語（音声内の位置へ移動する）
 }
 
 function formatDate(date: Date): string {
@@ -54,12 +56,21 @@ function formatLanguage(code: string | null): string {
   return languageNames[code] || code;
 }
 
+// 英語などの単語間にだけ空白を入れる（日本語の単語はそのまま続ける）
+function needsSpace(previous: string, next: string): boolean {
+  return (
+    /[A-Za-z0-9.,!?]$/.test(previous.trim()) && /^[A-Za-z0-9]/.test(next.trim())
+  );
+}
+
 export function TranscriptionDetailDialog({
   open,
   onOpenChange,
   transcription,
+  searchQuery,
 }: TranscriptionDetailDialogProps) {
   const [isPlaying, setIsPlaying] = useState(false);
+  const [currentMs, setCurrentMs] = useState(0);
   const [audioUrl, setAudioUrl] = useState<string | null>(null);
   const [isLoadingAudio, setIsLoadingAudio] = useState(false);
   const audioRef = useRef<HTMLAudioElement | null>(null);
@@ -80,6 +91,15 @@ export function TranscriptionDetailDialog({
     },
   });
 
+  // 単語ごとのタイミング（認識モデルが返した場合のみ）
+  const { data: alignment } = api.transcriptions.getAlignment.useQuery(
+    {
+      transcriptionId: transcription?.id ?? 0,
+      query: searchQuery || undefined,
+    },
+    { enabled: open && !!transcription?.audioFile },
+  );
+
   const downloadAudioMutation = api.transcriptions.downloadAudioFile.useMutation({
     onSuccess: (result) => {
       if (result.success) {
@@ -107,6 +127,7 @@ export function TranscriptionDetailDialog({
         setAudioUrl(null);
       }
       setIsPlaying(false);
+      setCurrentMs(0);
       if (audioRef.current) {
         audioRef.current.pause();
         audioRef.current.currentTime = 0;
@@ -135,6 +156,17 @@ export function TranscriptionDetailDialog({
     setIsPlaying(!isPlaying);
   };
 
+  const handlePlayFromMatch = () => {
+    if (!audioRef.current || alignment?.matchMs == null) return;
+    audioRef.current.currentTime = alignment.matchMs / 1000;
+    audioRef.current.play();
+    setIsPlaying(true);
+  };
+
+  const handleTimeUpdate = () => {
+    if (audioRef.current) setCurrentMs(audioRef.current.currentTime * 1000);
+  };
+
   const handleDownload = () => {
     if (!transcription) return;
     downloadAudioMutation.mutate({ transcriptionId: transcription.id });
@@ -195,6 +227,7 @@ export function TranscriptionDetailDialog({
                       ref={audioRef}
                       src={audioUrl}
                       onEnded={handleAudioEnded}
+                      onTimeUpdate={handleTimeUpdate}
                       className="hidden"
                     />
                     <Button
@@ -215,6 +248,16 @@ export function TranscriptionDetailDialog({
                         </>
                       )}
                     </Button>
+                    {alignment?.matchMs != null && (
+                      <Button
+                        variant="outline"
+                        size="sm"
+                        onClick={handlePlayFromMatch}
+                      >
+                        <Search className="w-4 h-4 mr-2" />
+                        検索語から再生
+                      </Button>
+                    )}
                     <Button
                       variant="outline"
                       size="sm"
@@ -230,6 +273,29 @@ export function TranscriptionDetailDialog({
                     音声ファイルを読み込めませんでした
                   </p>
                 )}
+                {/* 認識結果（再生中の単語を強調） */}
+                {audioUrl && alignment && alignment.segments.length > 0 && (
+                  <p className="mt-4 text-sm text-muted-foreground break-words">
+                    {alignment.segments
+                      .flatMap((segment) => segment.words)
+                      .map((word, i, words) => (
+                        <span key={i}>
+                          {i > 0 && needsSpace(words[i - 1].text, word.text) && " "}
+                          <span
+                            className={
+                              isPlaying &&
+                              currentMs >= word.startMs &&
+                              currentMs < word.endMs
+                                ? "text-foreground bg-yellow-500/30 rounded-sm"
+                                : undefined
+                            }
+                          >
+                            {word.text.trim()}
+                          </span>
+                        </span>
+                      ))}
+                  </p>
+                )}
               </div>
             </div>
           )}
@@ -259,6 +325,12 @@ export function TranscriptionDetailDialog({
                     <p>{transcription.formattingModel}</p>
                   </div>
                 )}
+                {transcription.confidence != null && (
+                  <div>
+                    <p className="text-muted-foreground">認識の信頼度</p>
+                    <p>{Math.round(transcription.confidence * 100)}%</p>
+                  </div>
+                )}
               </div>
             </div>
           </div>
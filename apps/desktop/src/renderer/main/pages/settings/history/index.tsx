@@ -534,6 +534,7 @@ export default function HistorySettingsPage() {
         open={isDetailDialogOpen}
         onOpenChange={setIsDetailDialogOpen}
         transcription={selectedItem}
+        searchQuery={debouncedSearch}
       />
     </div>
   );
@@ -0,0 +1,241 @@
+import { spawn, ChildProcess } from "child_process";
+import fs from "node:fs";
+import net from "node:net";
+import { createScopedLogger, isDebugEnabled } from "../../main/logger";
+
+/**
+ * llama.cpp `llama-server` process for local (offline) formatting
+ *
+ * The server is started on demand and kept running, so the model stays
+ * loaded and its KV cache keeps the prompt prefix of the previous request.
+ * The GGUF file is memory-mapped (llama.cpp default): only the pages used
+ * are read, and they are shared with the OS page cache across restarts.
+ *
+ * Both paths are chosen in a main-process file dialog, never taken from
+ * the renderer, and are checked again before spawning.
+ */
+
+export interface LlamaServerOptions {
+  serverPath: string;
+  modelPath: string;
+  threads?: number;
+  contextSize?: number;
+}
+
+/**
+ * Something that serves the llama.cpp HTTP API
+ */
+export interface LlamaEndpoint {
+  /** Start the server if needed and return its base URL */
+  ensureStarted(): Promise<string>;
+}
+
+const DEFAULT_CONTEXT_SIZE = 4096;
+const HEALTH_POLL_INTERVAL_MS = 100;
+// Loading is mostly mmap + page faults, but large models on slow disks
+// take a while on the first run
+const STARTUP_TIMEOUT_MS = 120_000;
+// After a failed start, requests fail fast instead of cold-starting again
+const RETRY_BACKOFF_MS = 60_000;
+// The port is free when picked but may be taken before the child binds it
+const MAX_PORT_ATTEMPTS = 3;
+const BIND_FAILURE = /couldn't bind|address already in use|EADDRINUSE/i;
+// Startup stderr kept to tell a bind failure from other exits
+const MAX_STARTUP_OUTPUT = 8192;
+
+export type LlamaCppFileKind = "server" | "model";
+
+/**
+ * Check a llama-server binary (executable regular file) or GGUF model
+ * (readable regular .gguf file); throws with a user-facing reason
+ */
+export function validateLlamaCppFile(
+  kind: LlamaCppFileKind,
+  filePath: string,
+): void {
+  const label = kind === "server" ? "llama-server" : "GGUF model";
+  let stats: fs.Stats;
+  try {
+    stats = fs.statSync(filePath);
+  } catch {
+    throw new Error(`${label} not found: ${filePath}`);
+  }
+  if (!stats.isFile()) {
+    throw new Error(`${label} is not a regular file: ${filePath}`);
+  }
+  if (kind === "model" && !filePath.toLowerCase().endsWith(".gguf")) {
+    throw new Error(`GGUF model must be a .gguf file: ${filePath}`);
+  }
+  try {
+    fs.accessSync(
+      filePath,
+      kind === "server" ? fs.constants.X_OK : fs.constants.R_OK,
+    );
+  } catch {
+    throw new Error(
+      `${label} is not ${kind === "server" ? "executable" : "readable"}: ${filePath}`,
+    );
+  }
+}
+
+class BindError extends Error {}
+
+/** Ask the OS for a free loopback port */
+function findFreePort(): Promise<number> {
+  return new Promise((resolve, reject) => {
+    const server = net.createServer();
+    server.unref();
+    server.on("error", reject);
+    server.listen(0, "127.0.0.1", () => {
+      const { port } = server.address() as net.AddressInfo;
+      server.close(() => resolve(port));
+    });
+  });
+}
+
+export class LlamaServer implements LlamaEndpoint {
+  private logger = createScopedLogger("llama-server");
+  private readonly options: LlamaServerOptions;
+  private proc: ChildProcess | null = null;
+  private starting: Promise<string> | null = null;
+  private lastFailure: { at: number; error: unknown } | null = null;
+
+  constructor(options: LlamaServerOptions) {
+    this.options = options;
+  }
+
+  /** Whether the server was started with these options */
+  matches(options: LlamaServerOptions): boolean {
+    return (
+      this.options.serverPath === options.serverPath &&
+      this.options.modelPath === options.modelPath &&
+      this.options.threads === options.threads &&
+      this.options.contextSize === options.contextSize
+    );
+  }
+
+  ensureStarted(): Promise<string> {
+    if (this.starting) return this.starting;
+
+    const failure = this.lastFailure;
+    if (failure && performance.now() - failure.at < RETRY_BACKOFF_MS) {
+      return Promise.reject(failure.error);
+    }
+    this.lastFailure = null;
+    this.starting = this.start().catch((error) => {
+      // Retried by a request after the back-off
+      this.stop();
+      this.lastFailure = { at: performance.now(), error };
+      throw error;
+    });
+    return this.starting;
+  }
+
+  stop(): void {
+    if (this.proc && this.proc.exitCode === null) {
+      this.logger.info("Stopping llama-server");
+      this.proc.kill();
+    }
+    this.proc = null;
+    this.starting = null;
+  }
+
+  private async start(): Promise<string> {
+    validateLlamaCppFile("server", this.options.serverPath);
+    validateLlamaCppFile("model", this.options.modelPath);
+
+    for (let attempt = 1; ; attempt++) {
+      const port = await findFreePort();
+      try {
+        return await this.launch(port);
+      } catch (error) {
+        if (!(error instanceof BindError) || attempt >= MAX_PORT_ATTEMPTS) {
+          throw error;
+        }
+        this.logger.warn("llama-server could not bind its port, retrying", {
+          port,
+          attempt,
+        });
+      }
+    }
+  }
+
+  /** Spawn the server on `port` and wait until it is ready */
+  private async launch(port: number): Promise<string> {
+    const { serverPath, modelPath, threads, contextSize } = this.options;
+    const args = [
+      "--model",
+      modelPath,
+      "--host",
+      "127.0.0.1",
+      "--port",
+      String(port),
+      "--ctx-size",
+      String(contextSize ?? DEFAULT_CONTEXT_SIZE),
+      // One slot: every request lands on the KV cache holding the previous
+      // prompt, so the shared system prompt prefix is not evaluated again
+      "--parallel",
+      "1",
+    ];
+    if (threads) args.push("--threads", String(threads));
+
+    this.logger.info("Spawning llama-server", { serverPath, modelPath, port });
+    const proc = spawn(serverPath, args, { stdio: ["ignore", "pipe", "pipe"] });
+    this.proc = proc;
+
+    let exited = false;
+    let ready = false;
+    proc.on("error", (error) => {
+      this.logger.error("llama-server process error", { error });
+    });
+    proc.on("close", (code, signal) => {
+      exited = true;
+      this.logger.info("llama-server exited", { code, signal });
+      if (this.proc === proc) {
+        this.proc = null;
+        // An exit during startup is handled by the startup loop (which
+        // may retry on another port); a crash later restarts on demand
+        if (ready) this.starting = null;
+      }
+    });
+    // llama-server logs every request on stderr; keep it out of the app log
+    // unless asked for
+    let startupOutput = "";
+    proc.stderr?.on("data", (data: Buffer) => {
+      if (!ready && startupOutput.length < MAX_STARTUP_OUTPUT) {
+        startupOutput += data.toString();
+      }
+      if (isDebugEnabled("llama-server")) {
+        this.logger.debug("llama-server output", { message: data.toString() });
+      }
+    });
+    proc.stdout?.resume();
+
+    const baseURL = `http://127.0.0.1:${port}`;
+    const startedAt = performance.now();
+    while (performance.now() - startedAt < STARTUP_TIMEOUT_MS) {
+      if (exited) {
+        const message = `llama-server exited during startup (code ${proc.exitCode})`;
+        throw BIND_FAILURE.test(startupOutput)
+          ? new BindError(message)
+          : new Error(message);
+      }
+      try {
+        // 503 while the model is loading, 200 once it can serve
+        const response = await fetch(`${baseURL}/health`);
+        if (response.ok) {
+          this.logger.info("llama-server ready", {
+            startupMs: Math.round(performance.now() - startedAt),
+          });
+          ready = true;
+          startupOutput = "";
+          return baseURL;
+        }
+      } catch {
+        // Not listening yet
+      }
+      await new Promise((resolve) => setTimeout(resolve, HEALTH_POLL_INTERVAL_MS));
+    }
+    throw new Error("llama-server did not become ready in time");
+  }
+}
@@ -7,7 +7,8 @@ import { v4 as uuid } from "uuid";
 import { getNativeHelperName, getNativeHelperDir } from "../../utils/platform";
 
 import { EventEmitter } from "events";
-import { createScopedLogger } from "../../main/logger";
+import { createScopedLogger, isDebugEnabled } from "../../main/logger";
+import { metrics } from "../../main/metrics";
 import {
   RpcRequestSchema,
   RpcRequest,
@@ -158,7 +159,9 @@ export class NativeBridge extends EventEmitter {
       if (!line.trim()) return; // Ignore empty lines
       try {
         const message = JSON.parse(line);
-        this.logger.debug("Received message from helper", { message });
+        if (isDebugEnabled("native-bridge")) {
+          this.logger.debug("Received message from helper", { message });
+        }
 
         // Try to parse as RpcResponse first
         const responseValidation = RpcResponseSchema.safeParse(message);
@@ -356,8 +359,10 @@ export class NativeBridge extends EventEmitter {
             this.pending.delete(id); // Clean up immediately
             const completedAt = Date.now();
             const duration = completedAt - startTime;
+            metrics.helperRpcLatency.record(duration, { method });
 
             if (resp.error) {
+              metrics.helperRpcErrors.inc({ method, reason: "error" });
               const error = new Error(resp.error.message);
               (error as any).code = resp.error.code;
               (error as any).data = resp.error.data;
@@ -403,6 +408,7 @@ export class NativeBridge extends EventEmitter {
           this.pending.delete(id);
           const timedOutAt = Date.now();
           const duration = timedOutAt - startTime;
+          metrics.helperRpcErrors.inc({ method, reason: "timeout" });
           reject(
             new Error(
               `NativeBridge: RPC call "${method}" (id: ${id}) timed out after ${timeoutMs}ms (duration: ${duration}ms, started: ${new Date(startTime).toISOString()})`,
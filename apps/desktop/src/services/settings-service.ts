@@ -8,8 +8,16 @@ import {
   updateAppSettings,
   getDefaultShortcuts,
   generateDefaultPresets,
+  defaultSettings,
 } from "../db/app-settings";
 import type { AppSettingsData } from "../db/schema";
+import type { SpeechUploadEncoding } from "../pipeline/providers/transcription/flac-encoder";
+import {
+  DEFAULT_AUDIO_ENHANCEMENT,
+  type AudioEnhancementConfig,
+} from "../pipeline/core/audio-enhancer";
+import { DEFAULT_MIC_STANDBY_MS } from "../utils/microphone-standby";
+import { DEFAULT_PRE_ROLL_MS } from "../utils/pre-roll-buffer";
 
 /**
  * Database-backed settings service with typed configuration
@@ -33,9 +41,26 @@ export interface AppPreferences {
   autoPasteEnabled: boolean;
 }
 
+type OpenAIConfig = { apiKey: string };
+type OpenRouterConfig = { apiKey: string; model?: string };
+type LlamaCppConfig = NonNullable<
+  NonNullable<AppSettingsData["modelProvidersConfig"]>["llamaCpp"]
+>;
+
 export class SettingsService extends EventEmitter {
+  // Decrypted OpenAI config, so the hot path doesn't re-read the settings
+  // blob and round-trip through safeStorage. Cleared whenever the stored
+  // key can change
+  private openAIConfigCache: { value: OpenAIConfig | undefined } | null = null;
+  private openAIConfigLoad: Promise<OpenAIConfig | undefined> | null = null;
+  private credentialGeneration = 0;
+  // Read at the start of every speech segment; cleared with the credentials
+  // since both live in modelProvidersConfig
+  private speechUploadEncodingCache: SpeechUploadEncoding | null = null;
+
   constructor() {
     super();
+    this.on("api-key-changed", () => this.invalidateCredentialCache());
   }
 
   /**
@@ -85,7 +110,9 @@ export class SettingsService extends EventEmitter {
   async updateSettings(
     settings: Partial<AppSettingsData>,
   ): Promise<AppSettingsData> {
-    return await updateAppSettings(settings);
+    const updated = await updateAppSettings(settings);
+    if (settings.modelProvidersConfig) this.invalidateCredentialCache();
+    return updated;
   }
 
   /**
@@ -143,6 +170,68 @@ export class SettingsService extends EventEmitter {
     await updateSettingsSection("recording", recordingSettings);
   }
 
+  /**
+   * Get the audio clean-up stages run before VAD and transcription
+   */
+  async getAudioEnhancement(): Promise<AudioEnhancementConfig> {
+    const recording = await this.getRecordingSettings();
+    return { ...DEFAULT_AUDIO_ENHANCEMENT, ...recording?.audioEnhancement };
+  }
+
+  /**
+   * Set the audio clean-up stages run before VAD and transcription
+   */
+  async setAudioEnhancement(config: AudioEnhancementConfig): Promise<void> {
+    const recording = await this.getRecordingSettings();
+    await this.setRecordingSettings({
+      ...defaultSettings.recording!,
+      ...recording,
+      audioEnhancement: config,
+    });
+  }
+
+  /**
+   * Get how long the microphone stays open after a recording
+   */
+  async getMicStandbyMs(): Promise<number> {
+    const recording = await this.getRecordingSettings();
+    return recording?.micStandbyMs ?? DEFAULT_MIC_STANDBY_MS;
+  }
+
+  /**
+   * Set how long the microphone stays open after a recording (0: close it
+   * when the recording stops)
+   */
+  async setMicStandbyMs(standbyMs: number): Promise<void> {
+    const recording = await this.getRecordingSettings();
+    await this.setRecordingSettings({
+      ...defaultSettings.recording!,
+      ...recording,
+      micStandbyMs: standbyMs,
+    });
+  }
+
+  /**
+   * Get how much audio before capture starts is prepended to a recording
+   */
+  async getPreRollMs(): Promise<number> {
+    const recording = await this.getRecordingSettings();
+    return recording?.preRollMs ?? DEFAULT_PRE_ROLL_MS;
+  }
+
+  /**
+   * Set how much audio before capture starts is prepended to a recording
+   * (0: off). Only available while the microphone is on standby.
+   */
+  async setPreRollMs(preRollMs: number): Promise<void> {
+    const recording = await this.getRecordingSettings();
+    await this.setRecordingSettings({
+      ...defaultSettings.recording!,
+      ...recording,
+      preRollMs,
+    });
+  }
+
   /**
    * Get dictation settings
    */
@@ -239,6 +328,7 @@ export class SettingsService extends EventEmitter {
     config: AppSettingsData["modelProvidersConfig"],
   ): Promise<void> {
     await updateSettingsSection("modelProvidersConfig", config);
+    this.invalidateCredentialCache();
   }
 
   private static readonly ENCRYPTED_PREFIX = "enc:v1:";
@@ -281,8 +371,49 @@ export class SettingsService extends EventEmitter {
 
   /**
    * Get OpenAI configuration
+   * Decrypted once and served from memory until invalidated
+   */
+  async getOpenAIConfig(): Promise<OpenAIConfig | undefined> {
+    if (this.openAIConfigCache) return this.openAIConfigCache.value;
+    if (this.openAIConfigLoad) return this.openAIConfigLoad;
+
+    // A write during the load bumps the generation; the stale result is
+    // returned to this caller but not cached
+    const generation = this.credentialGeneration;
+    const load = this.loadOpenAIConfig().then((value) => {
+      const frozen = value ? Object.freeze({ ...value }) : undefined;
+      if (generation === this.credentialGeneration) {
+        this.openAIConfigCache = { value: frozen };
+      }
+      return frozen;
+    });
+    this.openAIConfigLoad = load;
+    load
+      .finally(() => {
+        if (this.openAIConfigLoad === load) this.openAIConfigLoad = null;
+      })
+      .catch(() => {});
+    return load;
+  }
+
+  /**
+   * Drop the decrypted credentials; the next read decrypts again
+   */
+  invalidateCredentialCache(): void {
+    this.credentialGeneration++;
+    this.openAIConfigCache = null;
+    this.openAIConfigLoad = null;
+    this.speechUploadEncodingCache = null;
+  }
+
+  /**
+   * Release decrypted credentials on shutdown
    */
-  async getOpenAIConfig(): Promise<{ apiKey: string } | undefined> {
+  dispose(): void {
+    this.invalidateCredentialCache();
+  }
+
+  private async loadOpenAIConfig(): Promise<OpenAIConfig | undefined> {
     const config = await this.getModelProvidersConfig();
     if (!config?.openai) return undefined;
 
@@ -307,7 +438,7 @@ export class SettingsService extends EventEmitter {
   /**
    * Update OpenAI configuration
    */
-  async setOpenAIConfig(config: { apiKey: string }): Promise<void> {
+  async setOpenAIConfig(config: OpenAIConfig): Promise<void> {
     const currentConfig = await this.getModelProvidersConfig();
     await this.setModelProvidersConfig({
       ...currentConfig,
@@ -319,6 +450,51 @@ export class SettingsService extends EventEmitter {
     this.emit("api-key-changed");
   }
 
+  /**
+   * Get OpenRouter configuration (fallback formatting provider)
+   * Read only when formatting, so it is not cached
+   */
+  async getOpenRouterConfig(): Promise<OpenRouterConfig | undefined> {
+    const config = await this.getModelProvidersConfig();
+    if (!config?.openrouter?.apiKey) return undefined;
+    const apiKey = this.decryptApiKey(config.openrouter.apiKey);
+    return apiKey ? { ...config.openrouter, apiKey } : undefined;
+  }
+
+  /**
+   * Update OpenRouter configuration
+   */
+  async setOpenRouterConfig(config: OpenRouterConfig): Promise<void> {
+    const currentConfig = await this.getModelProvidersConfig();
+    await this.setModelProvidersConfig({
+      ...currentConfig,
+      openrouter: {
+        ...config,
+        apiKey: this.encryptApiKey(config.apiKey),
+      },
+    });
+  }
+
+  /**
+   * Get local llama.cpp formatter configuration
+   */
+  async getLlamaCppConfig(): Promise<LlamaCppConfig | undefined> {
+    const config = await this.getModelProvidersConfig();
+    return config?.llamaCpp;
+  }
+
+  /**
+   * Update local llama.cpp formatter configuration
+   */
+  async setLlamaCppConfig(config: LlamaCppConfig): Promise<void> {
+    const currentConfig = await this.getModelProvidersConfig();
+    await this.setModelProvidersConfig({
+      ...currentConfig,
+      llamaCpp: config,
+    });
+    this.emit("llama-cpp-changed");
+  }
+
   /**
    * Get default speech model (Whisper)
    */
@@ -338,6 +514,32 @@ export class SettingsService extends EventEmitter {
     });
   }
 
+  /**
+   * Get the audio encoding used for Whisper uploads
+   * Served from memory until modelProvidersConfig is written
+   */
+  async getSpeechUploadEncoding(): Promise<SpeechUploadEncoding> {
+    if (this.speechUploadEncodingCache) return this.speechUploadEncodingCache;
+    const generation = this.credentialGeneration;
+    const config = await this.getModelProvidersConfig();
+    const encoding = config?.speechUploadEncoding ?? "flac";
+    if (generation === this.credentialGeneration) {
+      this.speechUploadEncodingCache = encoding;
+    }
+    return encoding;
+  }
+
+  /**
+   * Set the audio encoding used for Whisper uploads
+   */
+  async setSpeechUploadEncoding(encoding: SpeechUploadEncoding): Promise<void> {
+    const currentConfig = await this.getModelProvidersConfig();
+    await this.setModelProvidersConfig({
+      ...currentConfig,
+      speechUploadEncoding: encoding,
+    });
+  }
+
   /**
    * Get default language model
    */
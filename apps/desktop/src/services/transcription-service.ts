@@ -3,37 +3,93 @@ import {
   StreamingPipelineContext,
   StreamingSession,
   TranscriptionProvider,
-  FormattingProvider,
+  FormatParams,
 } from "../pipeline/core/pipeline-types";
 import { createDefaultContext } from "../pipeline/core/context";
 import { ProviderRegistry } from "../pipeline/core/provider-registry";
+import { ProviderRouter } from "../pipeline/core/provider-router";
+import { TranscriptBuilder } from "../pipeline/core/transcript-builder";
+import {
+  VocabularyIndex,
+  describeAppContext,
+  type RankableVocabularyEntry,
+} from "../pipeline/core/vocabulary-ranker";
+import { PhoneticMatcher } from "../pipeline/core/phonetic-matcher";
 import { OpenAIWhisperProvider } from "../pipeline/providers/transcription/openai-whisper-provider";
 import { OpenAIFormatter } from "../pipeline/providers/formatting/openai-formatter";
+import { OpenRouterFormatter } from "../pipeline/providers/formatting/openrouter-formatter";
+import { LlamaCppFormatter } from "../pipeline/providers/formatting/llama-cpp-formatter";
+import { compilePresetTemplate } from "../pipeline/providers/formatting/formatter-prompt";
+import { resolveTemplateContext } from "../pipeline/providers/formatting/template-variables";
+import {
+  compareFormatting,
+  decideFormatterBypass,
+} from "../pipeline/providers/formatting/format-bypass";
+import { preloadSdks } from "../pipeline/providers/sdk-loader";
+import { loadTokenizerForModel } from "../pipeline/core/tokenizer-loader";
+import { RECENT_CONTEXT_MAX_CHARS } from "../pipeline/providers/transcription/recognition-prompt";
 import { SettingsService } from "../services/settings-service";
 import type { NativeBridge } from "./platform/native-bridge-service";
+import { LlamaServer } from "./platform/llama-server";
 import type { OnboardingService } from "./onboarding-service";
 import { createTranscription } from "../db/transcriptions";
-import { getVocabulary, MAX_VOCABULARY_COUNT } from "../db/vocabulary";
-import { logger } from "../main/logger";
+import { writeAlignmentFile } from "../utils/alignment-file";
+import { shiftAlignment } from "../pipeline/core/alignment-index";
+import { combineConfidence } from "../pipeline/core/transcript-confidence";
+import {
+  AudioEnhancer,
+  isAudioEnhancementEnabled,
+} from "../pipeline/core/audio-enhancer";
+import {
+  estimateLanguageCost,
+  estimateSpeechCost,
+} from "../constants/model-costs";
+import {
+  getVocabulary,
+  incrementVocabularyUsage,
+  MAX_VOCABULARY_COUNT,
+} from "../db/vocabulary";
+import { logger, isDebugEnabled } from "../main/logger";
+import { metrics } from "../main/metrics";
 import { v4 as uuid } from "uuid";
 import { VADService } from "./vad-service";
 import { Mutex } from "async-mutex";
 import { dialog, clipboard } from "electron";
+import path from "node:path";
+
+// Share of bypassed transcriptions still formatted in the background, to
+// check the bypass decisions against the formatter's output
+const BYPASS_SHADOW_SAMPLE_RATE = 0.1;
+
+// Sample rate of the recorded chunks (and of the saved audio file)
+const AUDIO_SAMPLE_RATE = 16000;
+
+// Closed session ids remembered to turn away late frames
+const CLOSED_SESSIONS_MAX = 64;
 
 /**
  * Service for audio transcription and optional formatting
  */
 export class TranscriptionService {
   private registry: ProviderRegistry;
+  private router: ProviderRouter;
   private openaiWhisperProvider: OpenAIWhisperProvider;
   private currentProvider: TranscriptionProvider | null = null;
   private streamingSessions = new Map<string, StreamingSession>();
+  // Per-session clean-up chain, null when every stage is bypassed. Created
+  // on the first frame, before the session itself (which VAD precedes).
+  private enhancers = new Map<string, Promise<AudioEnhancer | null>>();
+  // Recently finalized or cancelled sessions, so that a late frame does not
+  // create a new enhancer for them. Bounded; oldest first.
+  private closedSessions = new Set<string>();
   private vadService: VADService | null;
   private settingsService: SettingsService;
   private vadMutex: Mutex;
   private transcriptionMutex: Mutex;
   private lastTranscription: string | null = null;
   private formatterCache = new Map<string, OpenAIFormatter>();
+  private llamaServer: LlamaServer | null = null;
+  private localFormatter: LlamaCppFormatter | null = null;
 
   constructor(
     vadService: VADService,
@@ -42,6 +98,7 @@ export class TranscriptionService {
     private onboardingService: OnboardingService | null,
   ) {
     this.registry = ProviderRegistry.getInstance();
+    this.router = ProviderRouter.getInstance();
     this.openaiWhisperProvider = new OpenAIWhisperProvider(settingsService);
     this.vadService = vadService;
     this.settingsService = settingsService;
@@ -87,19 +144,95 @@ export class TranscriptionService {
   /**
    * Get a cached formatter instance, creating one if necessary
    */
-  private getOrCreateFormatter(apiKey: string, modelId: string): OpenAIFormatter {
-    const cacheKey = `${modelId}`;
+  private getOrCreateFormatter(
+    apiKey: string,
+    modelId: string,
+    provider: "openai" | "openrouter" = "openai",
+  ): OpenAIFormatter {
+    const cacheKey = `${provider}:${modelId}`;
     let formatter = this.formatterCache.get(cacheKey);
 
     if (!formatter) {
-      formatter = new OpenAIFormatter(apiKey, modelId);
+      formatter =
+        provider === "openrouter"
+          ? new OpenRouterFormatter(apiKey, modelId)
+          : new OpenAIFormatter(apiKey, modelId);
       this.formatterCache.set(cacheKey, formatter);
-      logger.transcription.debug("Created new formatter instance", { modelId });
+      logger.transcription.debug("Created new formatter instance", {
+        provider,
+        modelId,
+      });
     }
 
     return formatter;
   }
 
+  /**
+   * Local llama.cpp formatter when it is enabled. The server is restarted
+   * only when its configuration changes, so the loaded model and its
+   * prompt cache survive between dictations.
+   */
+  private async getLocalFormatter(): Promise<LlamaCppFormatter | null> {
+    const config = await this.settingsService.getLlamaCppConfig();
+    if (!config?.enabled || !config.serverPath || !config.modelPath) {
+      this.stopLocalFormatter();
+      return null;
+    }
+
+    if (!this.llamaServer?.matches(config)) {
+      this.stopLocalFormatter();
+      this.llamaServer = new LlamaServer(config);
+      const modelName = path.basename(config.modelPath, ".gguf");
+      this.localFormatter = new LlamaCppFormatter(this.llamaServer, modelName);
+      logger.transcription.debug("Created local formatter", {
+        model: modelName,
+      });
+    }
+    return this.localFormatter;
+  }
+
+  private stopLocalFormatter(): void {
+    this.llamaServer?.stop();
+    this.llamaServer = null;
+    this.localFormatter = null;
+  }
+
+  /**
+   * Formatters in routing order: the local model when enabled (offline, no
+   * network round trip), then the configured OpenAI model, then OpenRouter
+   * as a fallback when it is configured
+   */
+  private async getFormatters(modelId: string): Promise<OpenAIFormatter[]> {
+    const formatters: OpenAIFormatter[] = [];
+
+    const localFormatter = await this.getLocalFormatter();
+    if (localFormatter) {
+      formatters.push(localFormatter);
+    }
+
+    const openaiConfig = await this.settingsService.getOpenAIConfig();
+    if (openaiConfig?.apiKey) {
+      formatters.push(this.getOrCreateFormatter(openaiConfig.apiKey, modelId));
+    }
+
+    const openRouterConfig = await this.settingsService.getOpenRouterConfig();
+    if (openRouterConfig) {
+      // OpenRouter names OpenAI models "openai/<model>"
+      const openRouterModel =
+        openRouterConfig.model ??
+        (modelId.includes("/") ? modelId : `openai/${modelId}`);
+      formatters.push(
+        this.getOrCreateFormatter(
+          openRouterConfig.apiKey,
+          openRouterModel,
+          "openrouter",
+        ),
+      );
+    }
+
+    return formatters;
+  }
+
   async initialize(): Promise<void> {
     // Check if OpenAI API is configured
     const isApiConfigured = await this.isApiConfigured();
@@ -123,9 +256,74 @@ export class TranscriptionService {
       }, 2000); // Delay to ensure windows are ready
     }
 
+    // Compile preset templates up front and again whenever they are saved
+    await this.compilePresetTemplates();
+    this.settingsService.on("presets-updated", () => {
+      void this.compilePresetTemplates();
+    });
+
     logger.transcription.info("Transcription service initialized");
   }
 
+  /**
+   * Compile the instruction templates of all presets so finalize only
+   * renders them
+   */
+  private async compilePresetTemplates(): Promise<void> {
+    try {
+      const config = await this.settingsService.getFormatterConfig();
+      compilePresetTemplate(null);
+      for (const preset of config?.presets ?? []) {
+        compilePresetTemplate(preset);
+      }
+    } catch (error) {
+      logger.transcription.warn("Failed to compile preset templates", {
+        error,
+      });
+    }
+  }
+
+  /**
+   * Preload the lazily-loaded AI SDKs while the user is still speaking
+   */
+  warmup(): void {
+    preloadSdks();
+    void this.preloadTokenizers();
+    // Start llama-server (model load) before formatting needs it. A start
+    // already in progress is joined, and after a failed start the server
+    // is not cold-started again until its back-off has passed
+    void this.getLocalFormatter()
+      .then((formatter) => formatter && this.llamaServer?.ensureStarted())
+      .catch((error) => {
+        logger.transcription.warn("Failed to start local formatter", {
+          error,
+        });
+      });
+  }
+
+  /**
+   * Load the tokenizers of the configured speech and formatter models, so
+   * the first upload and format use exact token counts
+   */
+  private async preloadTokenizers(): Promise<void> {
+    try {
+      const [speechModel, formatterConfig, activePreset, languageModel] =
+        await Promise.all([
+          this.settingsService.getDefaultSpeechModel(),
+          this.settingsService.getFormatterConfig(),
+          this.settingsService.getActivePreset(),
+          this.settingsService.getDefaultLanguageModel(),
+        ]);
+      const formatterModel =
+        activePreset?.modelId || formatterConfig?.modelId || languageModel;
+      for (const model of [speechModel, formatterModel]) {
+        if (model) void loadTokenizerForModel(model);
+      }
+    } catch (error) {
+      logger.transcription.warn("Failed to preload tokenizers", { error });
+    }
+  }
+
   /**
    * Check if OpenAI API is configured
    */
@@ -142,8 +340,20 @@ export class TranscriptionService {
     audioChunk: Float32Array;
     recordingStartedAt?: number;
   }): Promise<string> {
-    const { sessionId, audioChunk, recordingStartedAt } = options;
+    const { sessionId, recordingStartedAt } = options;
 
+    // Clean up the frame for VAD and the provider. RecordingManager keeps
+    // the raw chunk for the audio file.
+    const audioChunk = await this.enhanceFrame(sessionId, options.audioChunk);
+    return this.processEnhancedChunk(sessionId, audioChunk, recordingStartedAt);
+  }
+
+  /** VAD and transcription of a frame that already went through enhanceFrame */
+  private async processEnhancedChunk(
+    sessionId: string,
+    audioChunk: Float32Array,
+    recordingStartedAt?: number,
+  ): Promise<string> {
     // Run VAD on the audio chunk
     let speechProbability = 0;
     let isSpeaking = false;
@@ -153,7 +363,9 @@ export class TranscriptionService {
       await this.vadMutex.acquire();
       try {
         // Pass Float32Array directly to VAD
+        const vadStart = performance.now();
         const vadResult = await this.vadService.processAudioFrame(audioChunk);
+        metrics.vadLatency.record(performance.now() - vadStart);
 
         speechProbability = vadResult.probability;
         isSpeaking = vadResult.isSpeaking;
@@ -162,10 +374,12 @@ export class TranscriptionService {
         this.vadMutex.release();
       }
 
-      logger.transcription.debug("VAD result", {
-        probability: speechProbability.toFixed(3),
-        isSpeaking,
-      });
+      if (isDebugEnabled("transcription")) {
+        logger.transcription.debug("VAD result", {
+          probability: speechProbability.toFixed(3),
+          isSpeaking,
+        });
+      }
     }
 
     // Acquire transcription mutex
@@ -188,10 +402,13 @@ export class TranscriptionService {
         // Get accessibility context from NativeBridge
         streamingContext.sharedData.accessibilityContext =
           this.nativeBridge?.getAccessibilityContext() ?? null;
+        streamingContext.sharedData.vocabularyIndex?.setAppContext(
+          describeAppContext(streamingContext.sharedData.accessibilityContext),
+        );
 
         session = {
           context: streamingContext,
-          transcriptionResults: [],
+          transcript: new TranscriptBuilder(),
           firstChunkReceivedAt: performance.now(),
           recordingStartedAt: recordingStartedAt,
         };
@@ -204,16 +421,17 @@ export class TranscriptionService {
       }
 
       // Direct frame to Whisper - it will handle aggregation and VAD internally
-      const previousChunk =
-        session.transcriptionResults.length > 0
-          ? session.transcriptionResults[
-              session.transcriptionResults.length - 1
-            ]
-          : undefined;
-      const aggregatedTranscription = session.transcriptionResults.join("");
+      // Recent context only: the prompt is token-budgeted, and both reads are
+      // cached between appends, so this stays O(1) per frame
+      const previousChunk = session.transcript.at(-1);
+      const aggregatedTranscription = session.transcript.tail(
+        RECENT_CONTEXT_MAX_CHARS,
+      );
 
       // Select the appropriate provider
       const provider = await this.selectProvider();
+      session.audioSampleCount =
+        (session.audioSampleCount ?? 0) + audioChunk.length;
 
       // Transcribe chunk (flush is done separately in finalizeSession)
       const chunkTranscription = await provider.transcribe({
@@ -222,6 +440,7 @@ export class TranscriptionService {
         context: {
           sessionId,
           vocabulary: session.context.sharedData.vocabulary,
+          vocabularyIndex: session.context.sharedData.vocabularyIndex,
           accessibilityContext: session.context.sharedData.accessibilityContext,
           previousChunk,
           aggregatedTranscription: aggregatedTranscription || undefined,
@@ -232,25 +451,30 @@ export class TranscriptionService {
       // Accumulate the result only if Whisper returned something
       // (it returns empty string while buffering)
       if (chunkTranscription.trim()) {
-        session.transcriptionResults.push(chunkTranscription);
+        session.transcript.append(
+          this.correctVocabulary(session, chunkTranscription),
+        );
+        this.recordSegmentInfo(session, provider);
         logger.transcription.info("Whisper returned transcription", {
           sessionId,
           transcriptionLength: chunkTranscription.length,
-          totalResults: session.transcriptionResults.length,
+          totalResults: session.transcript.count,
         });
       }
 
-      logger.transcription.debug("Processed frame", {
-        sessionId,
-        frameSize: audioChunk.length,
-        hadTranscription: chunkTranscription.length > 0,
-      });
+      if (isDebugEnabled("transcription")) {
+        logger.transcription.debug("Processed frame", {
+          sessionId,
+          frameSize: audioChunk.length,
+          hadTranscription: chunkTranscription.length > 0,
+        });
+      }
     } finally {
       // Release transcription mutex - always release even on error
       this.transcriptionMutex.release();
     }
 
-    return session.transcriptionResults.join("");
+    return session.transcript.text;
   }
 
   /**
@@ -258,6 +482,8 @@ export class TranscriptionService {
    * Used when recording is cancelled (e.g., quick tap, accidental activation)
    */
   async cancelStreamingSession(sessionId: string): Promise<void> {
+    // The first frame creates the enhancer before the session exists
+    this.closeEnhancer(sessionId);
     if (this.streamingSessions.has(sessionId)) {
       // Acquire mutex to prevent race with processStreamingChunk
       await this.transcriptionMutex.acquire();
@@ -266,6 +492,7 @@ export class TranscriptionService {
         this.currentProvider?.reset();
 
         this.streamingSessions.delete(sessionId);
+        this.router.takeSessionDecisions(sessionId);
         logger.transcription.info("Streaming session cancelled", { sessionId });
       } finally {
         this.transcriptionMutex.release();
@@ -286,12 +513,23 @@ export class TranscriptionService {
     const { sessionId, audioFilePath, recordingStartedAt, recordingStoppedAt } =
       options;
 
+    // The enhancer only serves incoming frames; drop it even if the session
+    // is missing or finalization fails
+    const enhancer = this.closeEnhancer(sessionId);
+
     const session = this.streamingSessions.get(sessionId);
     if (!session) {
       logger.transcription.warn("No session found to finalize", { sessionId });
       return "";
     }
 
+    // The last `latencySamples` of the recording are still in the enhancer's
+    // delay line; pass them on before the provider flushes
+    const tail = (await enhancer)?.flush();
+    if (tail && tail.length > 0) {
+      await this.processEnhancedChunk(sessionId, tail);
+    }
+
     // Update session timestamps
     session.finalizationStartedAt = performance.now();
     session.recordingStoppedAt = recordingStoppedAt;
@@ -304,18 +542,16 @@ export class TranscriptionService {
     // Flush provider to get any remaining buffered audio
     await this.transcriptionMutex.acquire();
     try {
-      const previousChunk =
-        session.transcriptionResults.length > 0
-          ? session.transcriptionResults[
-              session.transcriptionResults.length - 1
-            ]
-          : undefined;
-      const aggregatedTranscription = session.transcriptionResults.join("");
+      const previousChunk = session.transcript.at(-1);
+      const aggregatedTranscription = session.transcript.tail(
+        RECENT_CONTEXT_MAX_CHARS,
+      );
 
       const provider = await this.selectProvider();
       const finalTranscription = await provider.flush({
         sessionId,
         vocabulary: session.context.sharedData.vocabulary,
+        vocabularyIndex: session.context.sharedData.vocabularyIndex,
         accessibilityContext: session.context.sharedData.accessibilityContext,
         previousChunk,
         aggregatedTranscription: aggregatedTranscription || undefined,
@@ -324,18 +560,21 @@ export class TranscriptionService {
       });
 
       if (finalTranscription.trim()) {
-        session.transcriptionResults.push(finalTranscription);
+        session.transcript.append(
+          this.correctVocabulary(session, finalTranscription),
+        );
+        this.recordSegmentInfo(session, provider);
         logger.transcription.info("Whisper returned final transcription", {
           sessionId,
           transcriptionLength: finalTranscription.length,
-          totalResults: session.transcriptionResults.length,
+          totalResults: session.transcript.count,
         });
       }
     } finally {
       this.transcriptionMutex.release();
     }
 
-    let completeTranscription = session.transcriptionResults.join("");
+    let completeTranscription = session.transcript.text;
 
     // Apply simple pre-formatting (handles Whisper leading space artifact)
     const preSelectionText =
@@ -351,12 +590,17 @@ export class TranscriptionService {
     logger.transcription.info("Finalizing streaming session", {
       sessionId,
       rawTranscriptionLength: completeTranscription.length,
-      chunkCount: session.transcriptionResults.length,
+      chunkCount: session.transcript.count,
     });
 
     // Fetch formatter config on-demand
     let formattingUsed = false;
     let formattingModel: string | undefined;
+    let formattingTokens: {
+      inputTokens: number;
+      outputTokens: number;
+    } | null = null;
+    let formattingBypass: string | undefined;
 
     if (!formatterConfig || !formatterConfig.enabled) {
       logger.transcription.debug("Formatting skipped: disabled in config");
@@ -373,31 +617,64 @@ export class TranscriptionService {
         (await this.settingsService.getDefaultLanguageModel()) ||
         "gpt-4o-mini";
 
-      // Use OpenAI formatter
-      const openaiConfig = await this.settingsService.getOpenAIConfig();
-      if (!openaiConfig?.apiKey) {
-        logger.transcription.warn("Formatting skipped: OpenAI API key missing");
+      // Clean or very short transcriptions come back from the formatter
+      // unchanged; skip the round trip when enabled. "shadow" (default)
+      // only records the decision, until the shadow outcomes back it up
+      const bypassMode = formatterConfig.bypassMode ?? "shadow";
+      const bypass =
+        bypassMode === "off"
+          ? null
+          : decideFormatterBypass(
+              completeTranscription,
+              activePreset,
+              session.context.sharedData.dictionaryEntries,
+            );
+      if (bypass) {
+        metrics.formatterBypassDecisions.inc({
+          decision: bypass.bypass ? "bypass" : "format",
+          reason: bypass.reason,
+        });
+      }
+
+      // Cached formatter instances, in routing order
+      const formatters = await this.getFormatters(modelId);
+      if (formatters.length === 0) {
+        logger.transcription.warn(
+          "Formatting skipped: no formatting provider configured",
+        );
+      } else if (bypassMode === "on" && bypass?.bypass) {
+        formattingBypass = bypass.reason;
+        logger.transcription.info("Formatting bypassed", {
+          sessionId,
+          reason: bypass.reason,
+          features: bypass.features,
+        });
+        if (Math.random() < BYPASS_SHADOW_SAMPLE_RATE) {
+          this.runBypassShadow(formatters[0], completeTranscription, session);
+        }
       } else {
         logger.transcription.info("Starting formatting", {
           sessionId,
-          provider: "OpenAI",
+          providers: formatters.map((formatter) => formatter.name),
           model: modelId,
           presetName: activePreset?.name,
         });
 
-        // Use cached formatter instance
-        const formatter = this.getOrCreateFormatter(openaiConfig.apiKey, modelId);
         const result = await this.formatWithProvider(
-          formatter,
+          formatters,
           sessionId,
           completeTranscription,
           session,
         );
         if (result) {
+          if (bypass?.bypass) {
+            this.recordBypassShadow(completeTranscription, result.text);
+          }
           completeTranscription = result.text;
           formattingDuration = result.duration;
           formattingUsed = true;
-          formattingModel = modelId;
+          formattingModel = result.model;
+          formattingTokens = result.tokens;
         }
       }
     }
@@ -420,6 +697,19 @@ export class TranscriptionService {
       }
     }
 
+    // Hedges, fallbacks and open circuits seen during this session
+    const routingDecisions = this.router.takeSessionDecisions(sessionId);
+
+    const estimatedCost = await this.estimateCost(
+      session,
+      formattingModel,
+      formattingTokens,
+    );
+
+    // Speech model confidence over the whole dictation (null without scores)
+    const confidence = combineConfidence(session.confidences ?? []);
+    if (confidence !== null) metrics.transcriptionConfidence.record(confidence);
+
     // Save directly to database
     logger.transcription.info("Saving transcription with audio file", {
       sessionId,
@@ -427,21 +717,57 @@ export class TranscriptionService {
       hasAudioFile: !!audioFilePath,
     });
 
-    await createTranscription({
-      text: completeTranscription,
-      language: session.context.sharedData.userPreferences?.language || "en",
-      duration: session.context.sharedData.audioMetadata?.duration,
-      speechModel: "whisper-local",
-      formattingModel,
-      audioFile: audioFilePath,
-      meta: {
-        sessionId,
-        source: session.context.sharedData.audioMetadata?.source,
-        vocabularySize: session.context.sharedData.vocabulary?.length || 0,
-        formattingStyle:
-          session.context.sharedData.userPreferences?.formattingStyle,
-      },
-    });
+    await metrics.dbQueryLatency.time(
+      { operation: "createTranscription" },
+      () =>
+        createTranscription({
+          text: completeTranscription,
+          language: session.context.sharedData.userPreferences?.language || "en",
+          duration: session.context.sharedData.audioMetadata?.duration,
+          speechModel: "whisper-local",
+          formattingModel,
+          audioFile: audioFilePath,
+          confidence,
+          meta: {
+            sessionId,
+            source: session.context.sharedData.audioMetadata?.source,
+            vocabularySize: session.context.sharedData.vocabulary?.length || 0,
+            formattingStyle:
+              session.context.sharedData.userPreferences?.formattingStyle,
+            routing:
+              routingDecisions.length > 0 ? routingDecisions : undefined,
+            estimatedCost,
+            formattingBypass,
+          },
+        }),
+    );
+
+    // Count vocabulary hits for ranking (best effort, off the paste path)
+    const mentionedIds =
+      session.context.sharedData.vocabularyIndex?.findMentions(
+        completeTranscription,
+      ) ?? [];
+    if (mentionedIds.length > 0) {
+      metrics.dbQueryLatency
+        .time({ operation: "incrementVocabularyUsage" }, () =>
+          incrementVocabularyUsage(mentionedIds),
+        )
+        .catch((error) => {
+          logger.transcription.warn("Failed to update vocabulary usage", {
+            error,
+          });
+        });
+    }
+
+    // Word timings next to the audio file (best effort, off the paste path)
+    const alignment = session.alignment ?? [];
+    if (audioFilePath && alignment.length > 0) {
+      writeAlignmentFile(audioFilePath, alignment).catch((error) => {
+        logger.transcription.warn("Failed to write alignment index", {
+          error,
+        });
+      });
+    }
 
     this.streamingSessions.delete(sessionId);
 
@@ -473,7 +799,11 @@ export class TranscriptionService {
     }
 
     // Load vocabulary, replacements, and dictionary entries
-    const vocabEntries = await getVocabulary({ limit: MAX_VOCABULARY_COUNT });
+    const vocabEntries = await metrics.dbQueryLatency.time(
+      { operation: "getVocabulary" },
+      () => getVocabulary({ limit: MAX_VOCABULARY_COUNT }),
+    );
+    const rankable: RankableVocabularyEntry[] = [];
     for (const entry of vocabEntries) {
       // Always add word to vocabulary for Whisper hints
       context.sharedData.vocabulary.push(entry.word);
@@ -484,6 +814,14 @@ export class TranscriptionService {
       if (entry.reading2) readings.push(entry.reading2);
       if (entry.reading3) readings.push(entry.reading3);
 
+      rankable.push({
+        id: entry.id,
+        word: entry.word,
+        readings,
+        usageCount: entry.usageCount,
+        updatedAt: entry.updatedAt,
+      });
+
       if (readings.length > 0) {
         context.sharedData.dictionaryEntries.push({
           word: entry.word,
@@ -505,9 +843,128 @@ export class TranscriptionService {
       }
     }
 
+    // Precomputed once per session; ranking per segment is a cheap lookup
+    context.sharedData.vocabularyIndex = new VocabularyIndex(rankable);
+    context.sharedData.phoneticMatcher = new PhoneticMatcher(rankable);
+
     return context;
   }
 
+  /**
+   * High-pass, noise suppression and AGC on a copy of the frame (see
+   * audio-enhancer). The chain is looked up synchronously so that frames
+   * arriving while its settings load are still processed in order.
+   */
+  private async enhanceFrame(
+    sessionId: string,
+    frame: Float32Array,
+  ): Promise<Float32Array> {
+    if (frame.length === 0) return frame;
+
+    let enhancer = this.enhancers.get(sessionId);
+    if (!enhancer) {
+      // Late frame after cancel/finalize: nothing would drain the chain
+      if (this.closedSessions.has(sessionId)) return frame;
+      enhancer = this.settingsService
+        .getAudioEnhancement()
+        .then((config) =>
+          isAudioEnhancementEnabled(config) ? new AudioEnhancer(config) : null,
+        )
+        .catch((error) => {
+          logger.transcription.warn("Audio enhancement unavailable", {
+            error,
+          });
+          return null;
+        });
+      this.enhancers.set(sessionId, enhancer);
+    }
+
+    const chain = await enhancer;
+    if (!chain) return frame;
+    const start = performance.now();
+    const enhanced = frame.slice();
+    chain.process(enhanced);
+    metrics.enhancementLatency.record(performance.now() - start);
+    return enhanced;
+  }
+
+  /**
+   * Stop enhancing a session's frames and hand back its chain, if any
+   */
+  private closeEnhancer(
+    sessionId: string,
+  ): Promise<AudioEnhancer | null> | undefined {
+    const enhancer = this.enhancers.get(sessionId);
+    this.enhancers.delete(sessionId);
+    this.closedSessions.add(sessionId);
+    if (this.closedSessions.size > CLOSED_SESSIONS_MAX) {
+      const oldest = this.closedSessions.values().next().value;
+      if (oldest !== undefined) this.closedSessions.delete(oldest);
+    }
+    return enhancer;
+  }
+
+  /**
+   * Keep the timings and confidence of the segment the provider just
+   * returned. Timings are moved to the segment's position in the session's
+   * audio (it ends at the samples received so far).
+   */
+  private recordSegmentInfo(
+    session: StreamingSession,
+    provider: TranscriptionProvider,
+  ): void {
+    const info = provider.takeSegmentInfo?.();
+    if (!info) return;
+
+    if (info.confidence !== null) {
+      (session.confidences ??= []).push({
+        confidence: info.confidence,
+        weight: info.sampleCount,
+      });
+    }
+
+    if (info.alignment.length > 0) {
+      const startSample = Math.max(
+        0,
+        (session.audioSampleCount ?? 0) - info.sampleCount,
+      );
+      const offsetMs = (startSample / AUDIO_SAMPLE_RATE) * 1000;
+      (session.alignment ??= []).push(
+        ...shiftAlignment(info.alignment, offsetMs),
+      );
+    }
+  }
+
+  /**
+   * Replace near-miss spellings of vocabulary terms in a segment before it
+   * joins the transcript, so the corrected terms also reach the prompt
+   * context and the formatter.
+   */
+  private correctVocabulary(
+    session: StreamingSession,
+    segment: string,
+  ): string {
+    const matcher = session.context.sharedData.phoneticMatcher;
+    if (!matcher || matcher.size === 0) return segment;
+
+    const start = performance.now();
+    const { text, corrections } = matcher.correct(segment);
+    metrics.vocabularyMatchLatency.record(performance.now() - start);
+
+    if (corrections.length > 0) {
+      metrics.vocabularyCorrections.inc(undefined, corrections.length);
+      logger.transcription.info("Corrected vocabulary near-misses", {
+        sessionId: session.context.sessionId,
+        corrections: corrections.map(({ from, to, score }) => ({
+          from,
+          to,
+          score: Number(score.toFixed(2)),
+        })),
+      });
+    }
+    return text;
+  }
+
   /**
    * Simple pre-formatter for local Transcription models.
    * Handles leading space based on insertion context to avoid double spaces or unwanted leading whitespace.
@@ -574,47 +1031,158 @@ export class TranscriptionService {
     return result;
   }
 
-  private async formatWithProvider(
-    provider: FormattingProvider,
-    sessionId: string,
+  /**
+   * Estimated API cost of a dictation, from the recording length and the
+   * formatting token counts (prices in constants/model-costs)
+   */
+  private async estimateCost(
+    session: StreamingSession,
+    formattingModel: string | undefined,
+    formattingTokens: { inputTokens: number; outputTokens: number } | null,
+  ): Promise<
+    | {
+        speechUsd?: number;
+        formattingUsd?: number;
+        formattingInputTokens?: number;
+        formattingOutputTokens?: number;
+      }
+    | undefined
+  > {
+    const speechModel =
+      (await this.settingsService.getDefaultSpeechModel()) || "whisper-1";
+    // Upper bound: the recording length (only speech segments are uploaded)
+    const speechUsd =
+      session.recordingStartedAt && session.recordingStoppedAt
+        ? estimateSpeechCost(
+            speechModel,
+            (session.recordingStoppedAt - session.recordingStartedAt) / 1000,
+          )
+        : undefined;
+    const formattingUsd =
+      formattingModel && formattingTokens
+        ? estimateLanguageCost(
+            formattingModel,
+            formattingTokens.inputTokens,
+            formattingTokens.outputTokens,
+          )
+        : undefined;
+
+    if (speechUsd === undefined && !formattingTokens) return undefined;
+    return {
+      speechUsd,
+      formattingUsd,
+      formattingInputTokens: formattingTokens?.inputTokens,
+      formattingOutputTokens: formattingTokens?.outputTokens,
+    };
+  }
+
+  /**
+   * Formatter input for the session's transcription and active preset
+   */
+  private async buildFormatParams(
     text: string,
     session: StreamingSession,
-  ): Promise<{ text: string; duration: number } | null> {
-    const startTime = performance.now();
+  ): Promise<FormatParams> {
     const style = session.context.sharedData.userPreferences?.formattingStyle;
 
     // Get active preset for custom formatting instructions
     const activePreset = await this.settingsService.getActivePreset();
 
-    // Get clipboard content for {{clipboard}} template variable
-    let clipboardText: string | undefined;
-    try {
-      clipboardText = clipboard.readText();
-    } catch (error) {
-      logger.transcription.warn("Failed to read clipboard", { error });
+    // Fetch only the sources the preset's template references; a large
+    // clipboard is never read unless {{clipboard}} is used
+    const templateContext = resolveTemplateContext(
+      compilePresetTemplate(activePreset),
+      {
+        accessibilityContext: () =>
+          session.context.sharedData.accessibilityContext,
+        clipboardText: () => {
+          try {
+            return clipboard.readText();
+          } catch (error) {
+            logger.transcription.warn("Failed to read clipboard", { error });
+            return undefined;
+          }
+        },
+      },
+    );
+
+    return {
+      text,
+      context: {
+        style,
+        vocabulary: session.context.sharedData.vocabulary,
+        dictionaryEntries: session.context.sharedData.dictionaryEntries,
+        accessibilityContext: templateContext.accessibilityContext,
+        clipboardText: templateContext.clipboardText,
+        previousChunk:
+          session.transcript.count > 1 ? session.transcript.at(-2) : undefined,
+        aggregatedTranscription: text,
+        preset: activePreset,
+      },
+    };
+  }
+
+  /**
+   * Format a bypassed transcription in the background and record whether
+   * the formatter would have changed it (off the paste path)
+   */
+  private runBypassShadow(
+    formatter: OpenAIFormatter,
+    text: string,
+    session: StreamingSession,
+  ): void {
+    this.buildFormatParams(text, session)
+      .then((params) => formatter.formatOrThrow(params))
+      .then((formattedText) => this.recordBypassShadow(text, formattedText))
+      .catch((error) => {
+        logger.transcription.debug("Bypass shadow formatting failed", {
+          error,
+        });
+      });
+  }
+
+  private recordBypassShadow(original: string, formatted: string): void {
+    const outcome = compareFormatting(original, formatted);
+    metrics.formatterBypassShadow.inc({ outcome });
+    if (outcome === "changed") {
+      logger.transcription.info("Formatter changed a bypassable transcription", {
+        originalLength: original.length,
+        formattedLength: formatted.length,
+      });
     }
+  }
+
+  private async formatWithProvider(
+    formatters: OpenAIFormatter[],
+    sessionId: string,
+    text: string,
+    session: StreamingSession,
+  ): Promise<{
+    text: string;
+    duration: number;
+    model: string;
+    tokens: { inputTokens: number; outputTokens: number } | null;
+  } | null> {
+    const startTime = performance.now();
+    const params = await this.buildFormatParams(text, session);
 
     try {
-      const formattedText = await provider.format({
-        text,
-        context: {
-          style,
-          vocabulary: session.context.sharedData.vocabulary,
-          dictionaryEntries: session.context.sharedData.dictionaryEntries,
-          accessibilityContext: session.context.sharedData.accessibilityContext,
-          clipboardText,
-          previousChunk:
-            session.transcriptionResults.length > 1
-              ? session.transcriptionResults[
-                  session.transcriptionResults.length - 2
-                ]
-              : undefined,
-          aggregatedTranscription: text,
-          preset: activePreset,
-        },
-      });
+      // Hedged past the formatter's p95; falls back to the next formatter.
+      // llama-server handles one request at a time, so it is never hedged
+      const { formattedText, formatter } = await this.router.route(
+        formatters.map((formatter) => ({
+          key: `formatting:${formatter.name}:${formatter.modelId}`,
+          hedge: !(formatter instanceof LlamaCppFormatter),
+          run: async (signal: AbortSignal) => ({
+            formattedText: await formatter.formatOrThrow(params, signal),
+            formatter,
+          }),
+        })),
+        { kind: "formatting", sessionId, hedge: true },
+      );
 
       const duration = performance.now() - startTime;
+      metrics.formatterLatency.record(duration, { provider: formatter.name });
 
       logger.transcription.info("Text formatted successfully", {
         sessionId,
@@ -623,7 +1191,12 @@ export class TranscriptionService {
         formattingDuration: duration,
       });
 
-      return { text: formattedText, duration };
+      return {
+        text: formattedText,
+        duration,
+        model: formatter.modelId,
+        tokens: await formatter.countTokens(params, formattedText),
+      };
     } catch (error) {
       logger.transcription.error("Formatting failed, using unformatted text", {
         sessionId,
@@ -639,6 +1212,7 @@ export class TranscriptionService {
   async dispose(): Promise<void> {
     await this.openaiWhisperProvider.dispose();
     this.formatterCache.clear();
+    this.stopLocalFormatter();
     // VAD service is managed by ServiceManager
     logger.transcription.info("Transcription service disposed");
   }
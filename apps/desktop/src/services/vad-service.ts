@@ -4,6 +4,8 @@ import { app } from "electron";
 import * as path from "path";
 import { EventEmitter } from "node:events";
 import { existsSync } from "node:fs";
+import { SilenceGate } from "../pipeline/core/silence-gate";
+import { metrics } from "../main/metrics";
 
 export class VADService extends EventEmitter {
   private session: ort.InferenceSession | null = null;
@@ -23,9 +25,12 @@ export class VADService extends EventEmitter {
   private speechFrameCount = 0;
   private silenceFrameCount = 0;
   private isSpeaking = false;
+  // Skips inference on frames that are clearly silence; null when disabled
+  private gate: SilenceGate | null;
 
-  constructor() {
+  constructor(options: { preGate?: boolean } = {}) {
     super();
+    this.gate = options.preGate === false ? null : new SilenceGate();
   }
 
   async initialize(): Promise<void> {
@@ -92,6 +97,17 @@ export class VADService extends EventEmitter {
       throw new Error("VAD service not initialized");
     }
 
+    if (this.gate?.shouldSkip(audioFrames)) {
+      // The LSTM state is left as it was: the gate only skips after frames
+      // the model scored as non-speech. The context still moves on, so the
+      // next inference sees the real preceding samples.
+      this.context = audioFrames.slice(
+        this.WINDOW_SIZE_SAMPLES - this.CTX_SIZE,
+      );
+      metrics.vadFramesSkipped.inc();
+      return { probability: 0, isSpeaking: this.applySpeechDetectionLogic(0) };
+    }
+
     try {
       // v6: Create combined input [context | frame] with fixed size 576
       const input = new Float32Array(this.INPUT_SIZE);
@@ -129,6 +145,8 @@ export class VADService extends EventEmitter {
       // v6: Update context = last CTX_SIZE samples of the input
       this.context = input.slice(this.INPUT_SIZE - this.CTX_SIZE);
 
+      this.gate?.update(probability > this.SPEECH_THRESHOLD);
+
       // Apply smoothing logic
       const isSpeaking = this.applySpeechDetectionLogic(probability);
 
@@ -203,6 +221,7 @@ export class VADService extends EventEmitter {
     this.speechFrameCount = 0;
     this.silenceFrameCount = 0;
     this.isSpeaking = false;
+    this.gate?.reset();
     logger.main.debug("VAD state reset for new recording session");
   }
 
@@ -6,6 +6,7 @@ import { updaterRouter } from "./routers/updater";
 import { recordingRouter } from "./routers/recording";
 import { widgetRouter } from "./routers/widget";
 import { onboardingRouter } from "./routers/onboarding";
+import { debugRouter } from "./routers/debug";
 import { createRouter, procedure } from "./trpc";
 
 export const router = createRouter({
@@ -53,6 +54,9 @@ export const router = createRouter({
 
   // Onboarding router
   onboarding: onboardingRouter,
+
+  // Debug router (metrics)
+  debug: debugRouter,
 });
 
 export type AppRouter = typeof router;
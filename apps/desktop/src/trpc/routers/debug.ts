@@ -0,0 +1,28 @@
+import { app } from "electron";
+import { createRouter, procedure } from "../trpc";
+import { metricsRegistry } from "../../main/metrics";
+import {
+  getMetricsEndpointUrl,
+  getMetricsPort,
+} from "../../main/metrics/server";
+
+export const debugRouter = createRouter({
+  // Whether the metrics debug panel should be shown
+  getStatus: procedure.query(() => {
+    const isDev = process.env.NODE_ENV === "development" || !app.isPackaged;
+    return {
+      showMetrics: isDev || getMetricsPort() !== null,
+      metricsEndpointUrl: getMetricsEndpointUrl(),
+    };
+  }),
+
+  // JSON snapshot of all counters, gauges and histogram summaries
+  getMetrics: procedure.query(() => {
+    return metricsRegistry.snapshot();
+  }),
+
+  // Prometheus text exposition format (same as the localhost endpoint)
+  getPrometheusText: procedure.query(() => {
+    return metricsRegistry.toPrometheus();
+  }),
+});
@@ -12,6 +12,8 @@ import { WIDGET_NOTIFICATION_CONFIG } from "../../types/widget-notification";
 interface RecordingStateUpdate {
   state: RecordingState;
   mode: RecordingMode;
+  /** Key-down that started the recording (epoch ms) */
+  triggeredAt: number | null;
 }
 
 export const recordingRouter = createRouter({
@@ -57,6 +59,7 @@ export const recordingRouter = createRouter({
       emit.next({
         state: recordingManager.getState(),
         mode: recordingManager.getRecordingMode(),
+        triggeredAt: recordingManager.getTriggeredAt(),
       });
 
       // Set up listener for state changes
@@ -64,6 +67,7 @@ export const recordingRouter = createRouter({
         emit.next({
           state: status,
           mode: recordingManager.getRecordingMode(),
+          triggeredAt: recordingManager.getTriggeredAt(),
         });
       };
 
@@ -71,6 +75,7 @@ export const recordingRouter = createRouter({
         emit.next({
           state: recordingManager.getState(),
           mode,
+          triggeredAt: recordingManager.getTriggeredAt(),
         });
       };
 
@@ -7,6 +7,17 @@ import { createRouter, procedure } from "../trpc";
 import { dbPath, closeDatabase } from "../../db";
 import { getDefaultShortcuts } from "../../db/app-settings";
 import * as fs from "fs/promises";
+import { flushLogs } from "../../main/logger";
+import { DEFAULT_AUDIO_ENHANCEMENT } from "../../pipeline/core/audio-enhancer";
+import {
+  DEFAULT_MIC_STANDBY_MS,
+  MAX_MIC_STANDBY_MS,
+} from "../../utils/microphone-standby";
+import {
+  DEFAULT_PRE_ROLL_MS,
+  MAX_PRE_ROLL_MS,
+} from "../../utils/pre-roll-buffer";
+import { validateLlamaCppFile } from "../../services/platform/llama-server";
 
 // FormatPreset schema
 const FormatPresetSchema = z.object({
@@ -16,6 +27,7 @@ const FormatPresetSchema = z.object({
   instructions: z.string().max(1000),
   isDefault: z.boolean(),
   color: z.enum(["yellow", "blue", "green", "red", "purple", "orange"]),
+  cleanupOnly: z.boolean().optional(),
   createdAt: z.string(),
   updatedAt: z.string(),
 });
@@ -27,6 +39,7 @@ const FormatterConfigSchema = z.object({
   fallbackModelId: z.string().optional(),
   presets: z.array(FormatPresetSchema).max(5).optional(),
   activePresetId: z.string().nullable().optional(),
+  bypassMode: z.enum(["off", "shadow", "on"]).optional(),
 });
 
 // Create preset input schema
@@ -37,6 +50,7 @@ const CreateFormatPresetSchema = z.object({
   instructions: z.string().max(1000),
   isDefault: z.boolean().default(false),
   color: z.enum(["yellow", "blue", "green", "red", "purple", "orange"]).default("yellow"),
+  cleanupOnly: z.boolean().default(false),
 });
 
 // Update preset input schema
@@ -48,6 +62,7 @@ const UpdateFormatPresetSchema = z.object({
   instructions: z.string().max(1000).optional(),
   isDefault: z.boolean().optional(),
   color: z.enum(["yellow", "blue", "green", "red", "purple", "orange"]).optional(),
+  cleanupOnly: z.boolean().optional(),
 });
 
 // Shortcut schema (array of key names)
@@ -71,8 +86,23 @@ const OpenAIConfigSchema = z.object({
   apiKey: z.string(),
 });
 
+const OpenRouterConfigSchema = z.object({
+  apiKey: z.string(),
+  model: z.string().optional(),
+});
+
+// The llama-server and model paths are not accepted from the renderer:
+// the main process spawns the binary, so they are only set through
+// selectLlamaCppFile's file dialog
+const LlamaCppConfigSchema = z.object({
+  enabled: z.boolean(),
+  threads: z.number().int().positive().optional(),
+  contextSize: z.number().int().min(512).optional(),
+});
+
 const ModelProvidersConfigSchema = z.object({
   openai: OpenAIConfigSchema.optional(),
+  openrouter: OpenRouterConfigSchema.optional(),
 });
 
 const DictationSettingsSchema = z.object({
@@ -683,7 +713,12 @@ export const settingsRouter = createRouter({
         if (!settingsService) {
           throw new Error("SettingsService not available");
         }
-        await settingsService.setModelProvidersConfig(input);
+        // llama.cpp settings (with their paths) are kept as stored
+        const current = await settingsService.getModelProvidersConfig();
+        await settingsService.setModelProvidersConfig({
+          ...input,
+          llamaCpp: current?.llamaCpp,
+        });
 
         const logger = ctx.serviceManager.getLogger();
         if (logger) {
@@ -744,6 +779,162 @@ export const settingsRouter = createRouter({
     }
   }),
 
+  // Set OpenRouter configuration (fallback formatting provider)
+  setOpenRouterConfig: procedure
+    .input(OpenRouterConfigSchema)
+    .mutation(async ({ input, ctx }) => {
+      try {
+        const settingsService =
+          ctx.serviceManager.getService("settingsService");
+        if (!settingsService) {
+          throw new Error("SettingsService not available");
+        }
+        await settingsService.setOpenRouterConfig(input);
+
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.info("OpenRouter configuration updated");
+        }
+
+        return true;
+      } catch (error) {
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.error("Error setting OpenRouter config:", error);
+        }
+        throw error;
+      }
+    }),
+
+  // Get OpenRouter configuration
+  getOpenRouterConfig: procedure.query(async ({ ctx }) => {
+    try {
+      const settingsService = ctx.serviceManager.getService("settingsService");
+      if (!settingsService) {
+        throw new Error("SettingsService not available");
+      }
+      return await settingsService.getOpenRouterConfig();
+    } catch (error) {
+      const logger = ctx.serviceManager.getLogger();
+      if (logger) {
+        logger.main.error("Error getting OpenRouter config:", error);
+      }
+      return undefined;
+    }
+  }),
+
+  // Set local llama.cpp formatter configuration
+  setLlamaCppConfig: procedure
+    .input(LlamaCppConfigSchema)
+    .mutation(async ({ input, ctx }) => {
+      try {
+        const settingsService =
+          ctx.serviceManager.getService("settingsService");
+        if (!settingsService) {
+          throw new Error("SettingsService not available");
+        }
+        const current = await settingsService.getLlamaCppConfig();
+        await settingsService.setLlamaCppConfig({
+          ...input,
+          serverPath: current?.serverPath ?? "",
+          modelPath: current?.modelPath ?? "",
+        });
+
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.info("llama.cpp configuration updated", {
+            enabled: input.enabled,
+          });
+        }
+
+        return true;
+      } catch (error) {
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.error("Error setting llama.cpp config:", error);
+        }
+        throw error;
+      }
+    }),
+
+  // Choose the llama-server binary or the GGUF model in a file dialog
+  selectLlamaCppFile: procedure
+    .input(z.object({ kind: z.enum(["server", "model"]) }))
+    .mutation(async ({ input, ctx }) => {
+      try {
+        const settingsService =
+          ctx.serviceManager.getService("settingsService");
+        if (!settingsService) {
+          throw new Error("SettingsService not available");
+        }
+
+        const { dialog, BrowserWindow } = await import("electron");
+        const focusedWindow = BrowserWindow.getFocusedWindow();
+        const openOptions = {
+          title:
+            input.kind === "server"
+              ? "llama-server を選択"
+              : "GGUFモデルを選択",
+          filters:
+            input.kind === "model"
+              ? [{ name: "GGUF Models", extensions: ["gguf"] }]
+              : [],
+          properties: ["openFile" as const],
+        };
+        const { filePaths } = focusedWindow
+          ? await dialog.showOpenDialog(focusedWindow, openOptions)
+          : await dialog.showOpenDialog(openOptions);
+
+        if (filePaths.length === 0) {
+          return { cancelled: true as const };
+        }
+        const filePath = filePaths[0];
+        validateLlamaCppFile(input.kind, filePath);
+
+        const current = await settingsService.getLlamaCppConfig();
+        await settingsService.setLlamaCppConfig({
+          enabled: current?.enabled ?? false,
+          ...current,
+          serverPath: current?.serverPath ?? "",
+          modelPath: current?.modelPath ?? "",
+          [input.kind === "server" ? "serverPath" : "modelPath"]: filePath,
+        });
+
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.info("llama.cpp file selected", {
+            kind: input.kind,
+            path: filePath,
+          });
+        }
+
+        return { cancelled: false as const, path: filePath };
+      } catch (error) {
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.error("Error selecting llama.cpp file:", error);
+        }
+        throw error;
+      }
+    }),
+
+  // Get local llama.cpp formatter configuration
+  getLlamaCppConfig: procedure.query(async ({ ctx }) => {
+    try {
+      const settingsService = ctx.serviceManager.getService("settingsService");
+      if (!settingsService) {
+        throw new Error("SettingsService not available");
+      }
+      return await settingsService.getLlamaCppConfig();
+    } catch (error) {
+      const logger = ctx.serviceManager.getLogger();
+      if (logger) {
+        logger.main.error("Error getting llama.cpp config:", error);
+      }
+      return undefined;
+    }
+  }),
+
   // Get default speech model (Whisper)
   getDefaultSpeechModel: procedure.query(async ({ ctx }) => {
     try {
@@ -790,6 +981,198 @@ export const settingsRouter = createRouter({
       }
     }),
 
+  // Get the audio clean-up stages run before VAD and transcription
+  getAudioEnhancement: procedure.query(async ({ ctx }) => {
+    try {
+      const settingsService = ctx.serviceManager.getService("settingsService");
+      if (!settingsService) {
+        throw new Error("SettingsService not available");
+      }
+      return await settingsService.getAudioEnhancement();
+    } catch (error) {
+      const logger = ctx.serviceManager.getLogger();
+      if (logger) {
+        logger.main.error("Error getting audio enhancement settings:", error);
+      }
+      return DEFAULT_AUDIO_ENHANCEMENT;
+    }
+  }),
+
+  // Enable or bypass individual audio clean-up stages
+  setAudioEnhancement: procedure
+    .input(
+      z.object({
+        highPass: z.boolean(),
+        noiseSuppression: z.boolean(),
+        autoGain: z.boolean(),
+      }),
+    )
+    .mutation(async ({ input, ctx }) => {
+      try {
+        const settingsService =
+          ctx.serviceManager.getService("settingsService");
+        if (!settingsService) {
+          throw new Error("SettingsService not available");
+        }
+        await settingsService.setAudioEnhancement(input);
+
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.info("Audio enhancement settings updated", input);
+        }
+
+        return true;
+      } catch (error) {
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.error("Error setting audio enhancement settings:", error);
+        }
+        throw error;
+      }
+    }),
+
+  // Get how long the microphone stays open after a recording
+  getMicStandbyMs: procedure.query(async ({ ctx }) => {
+    try {
+      const settingsService = ctx.serviceManager.getService("settingsService");
+      if (!settingsService) {
+        throw new Error("SettingsService not available");
+      }
+      return await settingsService.getMicStandbyMs();
+    } catch (error) {
+      const logger = ctx.serviceManager.getLogger();
+      if (logger) {
+        logger.main.error("Error getting microphone standby:", error);
+      }
+      return DEFAULT_MIC_STANDBY_MS;
+    }
+  }),
+
+  // Set how long the microphone stays open after a recording
+  setMicStandbyMs: procedure
+    .input(
+      z.object({
+        standbyMs: z.number().int().min(0).max(MAX_MIC_STANDBY_MS),
+      }),
+    )
+    .mutation(async ({ input, ctx }) => {
+      try {
+        const settingsService =
+          ctx.serviceManager.getService("settingsService");
+        if (!settingsService) {
+          throw new Error("SettingsService not available");
+        }
+        await settingsService.setMicStandbyMs(input.standbyMs);
+
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.info("Microphone standby updated:", input.standbyMs);
+        }
+
+        return true;
+      } catch (error) {
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.error("Error setting microphone standby:", error);
+        }
+        throw error;
+      }
+    }),
+
+  // Get how much audio before capture starts is prepended to a recording
+  getPreRollMs: procedure.query(async ({ ctx }) => {
+    try {
+      const settingsService = ctx.serviceManager.getService("settingsService");
+      if (!settingsService) {
+        throw new Error("SettingsService not available");
+      }
+      return await settingsService.getPreRollMs();
+    } catch (error) {
+      const logger = ctx.serviceManager.getLogger();
+      if (logger) {
+        logger.main.error("Error getting pre-roll:", error);
+      }
+      return DEFAULT_PRE_ROLL_MS;
+    }
+  }),
+
+  // Set how much audio before capture starts is prepended to a recording
+  setPreRollMs: procedure
+    .input(
+      z.object({
+        preRollMs: z.number().int().min(0).max(MAX_PRE_ROLL_MS),
+      }),
+    )
+    .mutation(async ({ input, ctx }) => {
+      try {
+        const settingsService =
+          ctx.serviceManager.getService("settingsService");
+        if (!settingsService) {
+          throw new Error("SettingsService not available");
+        }
+        await settingsService.setPreRollMs(input.preRollMs);
+
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.info("Pre-roll updated:", input.preRollMs);
+        }
+
+        return true;
+      } catch (error) {
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.error("Error setting pre-roll:", error);
+        }
+        throw error;
+      }
+    }),
+
+  // Get the audio encoding used for Whisper uploads
+  getSpeechUploadEncoding: procedure.query(async ({ ctx }) => {
+    try {
+      const settingsService = ctx.serviceManager.getService("settingsService");
+      if (!settingsService) {
+        throw new Error("SettingsService not available");
+      }
+      return await settingsService.getSpeechUploadEncoding();
+    } catch (error) {
+      const logger = ctx.serviceManager.getLogger();
+      if (logger) {
+        logger.main.error("Error getting speech upload encoding:", error);
+      }
+      return "flac" as const;
+    }
+  }),
+
+  // Set the audio encoding used for Whisper uploads
+  setSpeechUploadEncoding: procedure
+    .input(z.object({ encoding: z.enum(["flac", "wav"]) }))
+    .mutation(async ({ input, ctx }) => {
+      try {
+        const settingsService =
+          ctx.serviceManager.getService("settingsService");
+        if (!settingsService) {
+          throw new Error("SettingsService not available");
+        }
+        await settingsService.setSpeechUploadEncoding(input.encoding);
+
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.info("Speech upload encoding updated", {
+            encoding: input.encoding,
+          });
+        }
+
+        return true;
+      } catch (error) {
+        const logger = ctx.serviceManager.getLogger();
+        if (logger) {
+          logger.main.error("Error setting speech upload encoding:", error);
+        }
+        throw error;
+      }
+    }),
+
   // Validate OpenAI API connection
   validateOpenAIConnection: procedure
     .input(z.object({ apiKey: z.string() }))
@@ -854,6 +1237,8 @@ export const settingsRouter = createRouter({
       : await dialog.showSaveDialog(saveOptions);
 
     if (filePath) {
+      // Make sure buffered log records are on disk before copying
+      await flushLogs();
       await fs.copyFile(logPath, filePath);
       return { success: true, path: filePath };
     }
@@ -17,6 +17,8 @@ import {
   MAX_HISTORY_AGE_MS,
 } from "../../db/transcriptions.js";
 import { deleteAudioFile } from "../../utils/audio-file-cleanup.js";
+import { readAlignmentFile } from "../../utils/alignment-file.js";
+import { findAlignedOffset } from "../../pipeline/core/alignment-index.js";
 
 // Input schemas
 const GetTranscriptionsSchema = z.object({
@@ -181,6 +183,29 @@ export const transcriptionsRouter = createRouter({
       }
     }),
 
+  // Get word timings of the audio file (for highlighting during playback)
+  // `query` (e.g. the history search term) is located in the audio:
+  // matchMs is null when it is not found in the recognized words
+  getAlignment: procedure
+    .input(
+      z.object({
+        transcriptionId: z.number(),
+        query: z.string().optional(),
+      }),
+    )
+    .query(async ({ input }) => {
+      const transcription = await getTranscriptionById(input.transcriptionId);
+      if (!transcription?.audioFile) return null;
+
+      const segments = await readAlignmentFile(transcription.audioFile);
+      if (!segments) return null;
+
+      return {
+        segments,
+        matchMs: input.query ? findAlignedOffset(segments, input.query) : null,
+      };
+    }),
+
   // Download audio file with save dialog
   // Mutation because this triggers a system dialog and file write operation
   // Not a query since it has side effects beyond just fetching data
@@ -34,14 +34,19 @@ export interface FormatPreset {
   instructions: string; // 最大1000文字
   isDefault: boolean;
   color: PresetColorId; // プリセットの色
+  cleanupOnly?: boolean; // 整形のみ（文体や形式を変えない）- 整った文字起こしは整形をスキップできる
   createdAt: string; // ISO 8601
   updatedAt: string;
 }
 
+// 整形スキップのモード（off: 常に整形 / shadow: 常に整形し判定精度だけ記録 / on: スキップする）
+export type FormatterBypassMode = "off" | "shadow" | "on";
+
 export interface FormatterConfig {
   enabled: boolean;
   modelId?: string;
   fallbackModelId?: string;
   presets?: FormatPreset[]; // 最大5つ
   activePresetId?: string | null;
+  bypassMode?: FormatterBypassMode; // 整形不要な文字起こしでLLMを省略するか（未設定の場合は "shadow"）
 }
@@ -0,0 +1,39 @@
+import * as fs from "node:fs";
+import {
+  encodeAlignment,
+  decodeAlignment,
+  type AlignedSegment,
+} from "../pipeline/core/alignment-index";
+
+/**
+ * The alignment index of a dictation is stored next to its audio file, so
+ * it is cleaned up with the audio and never loaded with history lists.
+ */
+export function alignmentPathFor(audioFilePath: string): string {
+  return `${audioFilePath}.align`;
+}
+
+export async function writeAlignmentFile(
+  audioFilePath: string,
+  segments: readonly AlignedSegment[],
+): Promise<void> {
+  await fs.promises.writeFile(
+    alignmentPathFor(audioFilePath),
+    encodeAlignment(segments),
+  );
+}
+
+/**
+ * Alignment of an audio file, or null when none was recorded
+ */
+export async function readAlignmentFile(
+  audioFilePath: string,
+): Promise<AlignedSegment[] | null> {
+  try {
+    const data = await fs.promises.readFile(alignmentPathFor(audioFilePath));
+    return decodeAlignment(data);
+  } catch (error) {
+    if ((error as NodeJS.ErrnoException).code === "ENOENT") return null;
+    throw error;
+  }
+}
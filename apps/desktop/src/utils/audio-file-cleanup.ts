@@ -2,6 +2,7 @@ import { app } from "electron";
 import * as fs from "node:fs";
 import * as path from "node:path";
 import { logger } from "../main/logger";
+import { alignmentPathFor } from "./alignment-file";
 
 /**
  * Clean up old audio files from the audio directory
@@ -114,6 +115,8 @@ export async function deleteAudioFile(filePath: string): Promise<void> {
 
     await fs.promises.unlink(filePath);
     logger.main.info("Deleted audio file", { filePath });
+    // Word timings of the recording, if any
+    await fs.promises.unlink(alignmentPathFor(filePath)).catch(() => {});
   } catch (error) {
     if ((error as NodeJS.ErrnoException).code !== "ENOENT") {
       logger.main.error("Failed to delete audio file", { filePath, error });
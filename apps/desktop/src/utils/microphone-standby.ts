@@ -0,0 +1,49 @@
+/**
+ * Warm microphone standby
+ *
+ * After a recording stops, useAudioCapture keeps the microphone stream and
+ * audio graph running for a grace period (frames are discarded), so that a
+ * back-to-back dictation skips enumerateDevices, getUserMedia and graph
+ * setup. The OS shows the microphone as in use during standby.
+ */
+
+/** Grace period after a recording stops (0 closes the microphone at once) */
+export const DEFAULT_MIC_STANDBY_MS = 10_000;
+export const MAX_MIC_STANDBY_MS = 5 * 60_000;
+
+/**
+ * Resolves a microphone label to its device ID from one enumerateDevices()
+ * call, reused until invalidate() (on `devicechange`)
+ */
+export class DeviceIdResolver {
+  private devices: Promise<Map<string, string>> | null = null;
+
+  constructor(private readonly enumerate: () => Promise<MediaDeviceInfo[]>) {}
+
+  /** Device ID of the audio input labelled `label`, if connected */
+  async resolve(label: string): Promise<string | undefined> {
+    if (!this.devices) {
+      const pending = this.enumerate().then((devices) => {
+        const ids = new Map<string, string>();
+        for (const device of devices) {
+          // First match wins, as with devices.find()
+          if (device.kind === "audioinput" && !ids.has(device.label)) {
+            ids.set(device.label, device.deviceId);
+          }
+        }
+        return ids;
+      });
+      // A failed enumeration is retried on the next call
+      pending.catch(() => {
+        if (this.devices === pending) this.devices = null;
+      });
+      this.devices = pending;
+    }
+    const devices = await this.devices;
+    return devices.get(label);
+  }
+
+  invalidate(): void {
+    this.devices = null;
+  }
+}
@@ -0,0 +1,201 @@
+/**
+ * Streaming polyphase resampler
+ *
+ * Converts microphone audio captured at the device's native rate (44.1 or
+ * 48 kHz, usually) to the 16 kHz the VAD and Whisper expect, with a known
+ * filter instead of whatever Chromium does when the AudioContext is asked
+ * for 16 kHz.
+ *
+ * The rate change is the reduced fraction L/M (48000 → 16000 is 1/3,
+ * 44100 → 16000 is 160/441). The anti-aliasing filter is a Kaiser-windowed
+ * sinc designed at L × the input rate and split into L phases, so each
+ * output sample is one dot product of `tapsPerPhase` input samples.
+ *
+ * - Passband flat to 85% of the output Nyquist frequency (6.8 kHz at
+ *   16 kHz), stopband from the Nyquist frequency, 80 dB attenuation.
+ * - Output is time-aligned with the input: the filter's group delay
+ *   (`latencyMs`, ~2 ms) is held back and released by flush().
+ */
+
+export interface PolyphaseResamplerOptions {
+  /** Stopband attenuation in dB (default 80) */
+  attenuationDb?: number;
+  /** Passband edge as a fraction of the lower Nyquist frequency (default 0.85) */
+  passband?: number;
+}
+
+function gcd(a: number, b: number): number {
+  while (b) [a, b] = [b, a % b];
+  return a;
+}
+
+/** Modified Bessel function of the first kind, order 0 (Kaiser window) */
+function besselI0(x: number): number {
+  let sum = 1;
+  let term = 1;
+  const q = (x * x) / 4;
+  for (let k = 1; k < 50; k++) {
+    term *= q / (k * k);
+    sum += term;
+    if (term < sum * 1e-12) break;
+  }
+  return sum;
+}
+
+export class PolyphaseResampler {
+  readonly inputRate: number;
+  readonly outputRate: number;
+  readonly tapsPerPhase: number;
+
+  private readonly up: number; // L
+  private readonly down: number; // M
+  // Phase p occupies [p * taps, (p + 1) * taps), reversed so that it is a
+  // forward dot product with the input window ending at the newest sample
+  private readonly coefficients: Float32Array;
+  // Centre of the prototype filter, in upsampled samples
+  private readonly delay: number;
+
+  // Last (taps - 1) input samples followed by unprocessed input
+  private history: Float32Array;
+  // Position of the next output sample in `history`, in upsampled samples
+  private time: number;
+  private inputCount = 0;
+  private outputCount = 0;
+
+  constructor(
+    inputRate: number,
+    outputRate: number,
+    options: PolyphaseResamplerOptions = {},
+  ) {
+    if (
+      !Number.isInteger(inputRate) ||
+      !Number.isInteger(outputRate) ||
+      inputRate <= 0 ||
+      outputRate <= 0
+    ) {
+      throw new Error(`Unsupported resampling ${inputRate} → ${outputRate}`);
+    }
+    const divisor = gcd(inputRate, outputRate);
+    this.inputRate = inputRate;
+    this.outputRate = outputRate;
+    this.up = outputRate / divisor;
+    this.down = inputRate / divisor;
+
+    const attenuation = options.attenuationDb ?? 80;
+    const nyquist = Math.min(inputRate, outputRate) / 2;
+    const passbandEdge = nyquist * (options.passband ?? 0.85);
+    const transition = nyquist - passbandEdge;
+
+    // Kaiser's estimate of the filter length, counted in input samples
+    const taps = Math.ceil(
+      (attenuation - 8) / (2.285 * ((2 * Math.PI * transition) / inputRate)),
+    );
+    this.tapsPerPhase = Math.max(taps, Math.ceil(this.down / this.up) + 1);
+
+    const length = this.up * this.tapsPerPhase;
+    this.delay = Math.floor((length - 1) / 2);
+    const beta =
+      attenuation > 50
+        ? 0.1102 * (attenuation - 8.7)
+        : 0.5842 * (attenuation - 21) ** 0.4 + 0.07886 * (attenuation - 21);
+    // Cut-off halfway through the transition band, normalised to the
+    // upsampled rate; the gain of L makes up for the inserted zeros
+    const cutoff = (passbandEdge + nyquist) / 2 / (inputRate * this.up);
+    const windowScale = besselI0(beta);
+
+    this.coefficients = new Float32Array(length);
+    for (let j = 0; j <= 2 * this.delay; j++) {
+      const x = j - this.delay;
+      const sinc =
+        x === 0
+          ? 2 * cutoff
+          : Math.sin(2 * Math.PI * cutoff * x) / (Math.PI * x);
+      const r = x / this.delay;
+      const window = besselI0(beta * Math.sqrt(Math.max(0, 1 - r * r)));
+      const phase = j % this.up;
+      const tap = Math.floor(j / this.up);
+      this.coefficients[
+        phase * this.tapsPerPhase + (this.tapsPerPhase - 1 - tap)
+      ] = (this.up * sinc * window) / windowScale;
+    }
+
+    this.history = new Float32Array(this.tapsPerPhase - 1);
+    this.time = this.initialTime();
+  }
+
+  /** Group delay held back until flush() */
+  get latencyMs(): number {
+    return (this.delay / (this.inputRate * this.up)) * 1000;
+  }
+
+  /**
+   * Resample the next chunk of input. Returns the output samples that are
+   * complete so far (about length × outputRate / inputRate).
+   */
+  process(input: Float32Array): Float32Array {
+    this.inputCount += input.length;
+    return this.run(input);
+  }
+
+  /**
+   * Output the samples still held back by the filter delay, so the total
+   * output is ceil(input length × outputRate / inputRate), then reset
+   */
+  flush(): Float32Array {
+    const expected = Math.ceil((this.inputCount * this.up) / this.down);
+    const remaining = Math.max(0, expected - this.outputCount);
+    const padding = new Float32Array(Math.ceil(this.delay / this.up) + 1);
+    const tail = this.run(padding);
+    this.reset();
+    return tail.subarray(0, Math.min(tail.length, remaining));
+  }
+
+  reset(): void {
+    this.history = new Float32Array(this.tapsPerPhase - 1);
+    this.time = this.initialTime();
+    this.inputCount = 0;
+    this.outputCount = 0;
+  }
+
+  private initialTime(): number {
+    // Output 0 is centred on input 0, which follows the zero history
+    return (this.tapsPerPhase - 1) * this.up + this.delay;
+  }
+
+  private run(input: Float32Array): Float32Array {
+    const taps = this.tapsPerPhase;
+    const up = this.up;
+    const down = this.down;
+    const coefficients = this.coefficients;
+
+    const buffer = new Float32Array(this.history.length + input.length);
+    buffer.set(this.history);
+    buffer.set(input, this.history.length);
+
+    const available = Math.max(
+      0,
+      Math.ceil((buffer.length * up - this.time) / down),
+    );
+    const output = new Float32Array(available);
+    let time = this.time;
+    for (let n = 0; n < available; n++) {
+      const newest = Math.floor(time / up);
+      const phase = time - newest * up;
+      const base = phase * taps;
+      const start = newest - taps + 1;
+      let sum = 0;
+      for (let k = 0; k < taps; k++) {
+        sum += coefficients[base + k] * buffer[start + k];
+      }
+      output[n] = sum;
+      time += down;
+    }
+
+    // Keep the window the next output needs
+    const keepFrom = Math.min(buffer.length, Math.floor(time / up) - taps + 1);
+    this.history = buffer.slice(keepFrom);
+    this.time = time - keepFrom * up;
+    this.outputCount += available;
+    return output;
+  }
+}
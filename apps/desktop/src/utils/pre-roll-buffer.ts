@@ -0,0 +1,82 @@
+/**
+ * Pre-roll capture ring
+ *
+ * While the microphone is on warm standby (see microphone-standby),
+ * useAudioCapture keeps the last few hundred milliseconds of audio here
+ * instead of discarding it. When a recording starts, the audio captured
+ * since the key-down is prepended to the session, so the first syllable
+ * spoken during the start-up checks, mute and capture start is not lost.
+ *
+ * Samples are kept in one preallocated Float32Array (no allocation per
+ * frame) with the time of the newest sample. Times are in milliseconds on
+ * any clock; useAudioCapture uses the AudioContext's.
+ */
+
+/** Off unless enabled in the recording settings */
+export const DEFAULT_PRE_ROLL_MS = 0;
+export const MAX_PRE_ROLL_MS = 1000;
+
+// A write starting later than this after the previous one ends is a break
+// in the audio; older samples are dropped rather than given wrong times
+const GAP_TOLERANCE_MS = 20;
+
+export class PreRollBuffer {
+  readonly sampleRate: number;
+  private readonly ring: Float32Array;
+  private writeIndex = 0;
+  private filled = 0;
+  // Time just after the newest sample
+  private endTime = 0;
+
+  constructor(sampleRate: number, durationMs: number) {
+    this.sampleRate = sampleRate;
+    this.ring = new Float32Array(
+      Math.max(1, Math.round((sampleRate * durationMs) / 1000)),
+    );
+  }
+
+  /** Milliseconds of audio currently held */
+  get durationMs(): number {
+    return (this.filled / this.sampleRate) * 1000;
+  }
+
+  /** Append `samples`, the last of which ends at `endTime` */
+  write(samples: Float32Array, endTime: number): void {
+    const startTime = endTime - (samples.length / this.sampleRate) * 1000;
+    if (this.filled > 0 && startTime - this.endTime > GAP_TOLERANCE_MS) {
+      this.clear();
+    }
+    this.endTime = endTime;
+
+    const capacity = this.ring.length;
+    const input =
+      samples.length > capacity ? samples.subarray(-capacity) : samples;
+    const first = Math.min(input.length, capacity - this.writeIndex);
+    this.ring.set(input.subarray(0, first), this.writeIndex);
+    this.ring.set(input.subarray(first), 0);
+    this.writeIndex = (this.writeIndex + input.length) % capacity;
+    this.filled = Math.min(capacity, this.filled + input.length);
+  }
+
+  /**
+   * Samples captured from `since` on, oldest first, and empty the buffer.
+   * At most the buffer's duration, even when `since` is earlier.
+   */
+  takeSince(since: number): Float32Array {
+    const wanted = Math.ceil(((this.endTime - since) * this.sampleRate) / 1000);
+    const count = Math.max(0, Math.min(this.filled, wanted));
+    const output = new Float32Array(count);
+    const capacity = this.ring.length;
+    const start = (this.writeIndex - count + capacity) % capacity;
+    const first = Math.min(count, capacity - start);
+    output.set(this.ring.subarray(start, start + first));
+    output.set(this.ring.subarray(0, count - first), first);
+    this.clear();
+    return output;
+  }
+
+  clear(): void {
+    this.writeIndex = 0;
+    this.filled = 0;
+  }
+}
@@ -1,5 +1,5 @@
 import * as fs from "node:fs";
-import { logger } from "../main/logger";
+import { logger, isDebugEnabled } from "../main/logger";
 
 /**
  * StreamingWavWriter allows incremental writing of audio data to a WAV file.
@@ -91,11 +91,13 @@ export class StreamingWavWriter {
 
     this.dataSize += buffer.length;
 
-    logger.transcription.debug("Appended audio to WAV file", {
-      samplesWritten: audioData.length,
-      bytesWritten: buffer.length,
-      totalDataSize: this.dataSize,
-    });
+    if (isDebugEnabled("transcription")) {
+      logger.transcription.debug("Appended audio to WAV file", {
+        samplesWritten: audioData.length,
+        bytesWritten: buffer.length,
+        totalDataSize: this.dataSize,
+      });
+    }
   }
 
   /**
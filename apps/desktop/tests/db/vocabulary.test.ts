@@ -12,6 +12,7 @@ import {
   deleteVocabulary,
   getVocabularyCount,
   trackWordUsage,
+  incrementVocabularyUsage,
   getMostUsedWords,
   searchVocabulary,
   MAX_VOCABULARY_COUNT,
@@ -296,6 +297,26 @@ describe("DB: 単語帳", () => {
     });
   });
 
+  describe("incrementVocabularyUsage", () => {
+    beforeEach(async () => {
+      await seedDatabase(testDb, "withVocabulary");
+    });
+
+    it("指定したIDの使用回数をまとめてインクリメントする", async () => {
+      const before = await getVocabularyByWord("surasura");
+      const beforeCount = before!.usageCount ?? 0;
+
+      const result = await incrementVocabularyUsage([before!.id]);
+
+      expect(result).toHaveLength(1);
+      expect(result[0].usageCount).toBe(beforeCount + 1);
+    });
+
+    it("空の配列では何もしない", async () => {
+      expect(await incrementVocabularyUsage([])).toEqual([]);
+    });
+  });
+
   describe("getMostUsedWords", () => {
     beforeEach(async () => {
       await seedDatabase(testDb, "withVocabulary");
@@ -0,0 +1,149 @@
+import { describe, it, expect, beforeEach, afterEach } from "vitest";
+import fs from "node:fs";
+import os from "node:os";
+import path from "node:path";
+import { AsyncLogWriter, snapshotLogArgs } from "@main/async-log-writer";
+
+describe("AsyncLogWriter", () => {
+  let tmpDir: string;
+  let logFile: string;
+
+  beforeEach(() => {
+    tmpDir = fs.mkdtempSync(path.join(os.tmpdir(), "async-log-writer-"));
+    logFile = path.join(tmpDir, "logs", "test.log");
+  });
+
+  afterEach(() => {
+    fs.rmSync(tmpDir, { recursive: true, force: true });
+  });
+
+  const readLines = () =>
+    fs.readFileSync(logFile, "utf8").split("\n").filter(Boolean);
+
+  it("書き込みはフラッシュまでファイルに反映されない", async () => {
+    const writer = new AsyncLogWriter({
+      filePath: logFile,
+      maxFileSize: 1024 * 1024,
+      flushIntervalMs: 60_000,
+    });
+
+    writer.write("line 1", "info");
+    writer.write("line 2", "info");
+    expect(fs.existsSync(logFile)).toBe(false);
+
+    await writer.flush();
+    expect(readLines()).toEqual(["line 1", "line 2"]);
+    expect(writer.getStats().buffered).toBe(0);
+  });
+
+  it("レコードはフラッシュ時にまとめてフォーマットされる", async () => {
+    const formatted: number[] = [];
+    const writer = new AsyncLogWriter<{ n: number }>({
+      filePath: logFile,
+      maxFileSize: 1024 * 1024,
+      flushIntervalMs: 60_000,
+      format: (record) => {
+        formatted.push(record.n);
+        return `n=${record.n}`;
+      },
+    });
+
+    writer.write({ n: 1 }, "info");
+    writer.write({ n: 2 }, "debug");
+    expect(formatted).toEqual([]);
+
+    await writer.flush();
+    expect(formatted).toEqual([1, 2]);
+    expect(readLines()).toEqual(["n=1", "n=2"]);
+  });
+
+  it("高水位を超えるとdebugレコードを破棄し、破棄数を記録する", async () => {
+    const writer = new AsyncLogWriter({
+      filePath: logFile,
+      maxFileSize: 1024 * 1024,
+      capacity: 4,
+      highWatermark: 0.5,
+      flushIntervalMs: 60_000,
+    });
+
+    writer.write("info 1", "info");
+    writer.write("info 2", "info");
+    writer.write("debug 1", "debug"); // dropped: 2 >= 2
+    writer.write("error 1", "error");
+
+    expect(writer.getStats().droppedDebug).toBe(1);
+
+    await writer.flush();
+    const lines = readLines();
+    expect(lines[0]).toContain("debug=1, overflow=0");
+    expect(lines.slice(1)).toEqual(["info 1", "info 2", "error 1"]);
+  });
+
+  it("リングが満杯の場合は最も古いレコードを上書きする", async () => {
+    const writer = new AsyncLogWriter({
+      filePath: logFile,
+      maxFileSize: 1024 * 1024,
+      capacity: 2,
+      flushIntervalMs: 60_000,
+    });
+
+    writer.write("a", "error");
+    writer.write("b", "error");
+    writer.write("c", "error");
+
+    writer.flushSync();
+    const lines = readLines();
+    expect(lines[0]).toContain("overflow=1");
+    expect(lines.slice(1)).toEqual(["b", "c"]);
+  });
+
+  it("最大サイズを超えると .old ファイルにローテーションする", async () => {
+    const writer = new AsyncLogWriter({
+      filePath: logFile,
+      maxFileSize: 16,
+      flushIntervalMs: 60_000,
+    });
+
+    writer.write("0123456789", "info");
+    await writer.flush();
+    writer.write("abcdefghij", "info");
+    await writer.flush();
+
+    const archived = path.join(tmpDir, "logs", "test.old.log");
+    expect(fs.readFileSync(archived, "utf8")).toBe("0123456789\n");
+    expect(readLines()).toEqual(["abcdefghij"]);
+  });
+
+  it("終了時の同期フラッシュでも最大サイズを超えるとローテーションする", async () => {
+    const writer = new AsyncLogWriter({
+      filePath: logFile,
+      maxFileSize: 16,
+      flushIntervalMs: 60_000,
+    });
+
+    writer.write("0123456789", "info");
+    await writer.flush();
+    writer.write("abcdefghij", "info");
+    writer.flushSync();
+
+    const archived = path.join(tmpDir, "logs", "test.old.log");
+    expect(fs.readFileSync(archived, "utf8")).toBe("0123456789\n");
+    expect(readLines()).toEqual(["abcdefghij"]);
+  });
+
+  it("プレーンオブジェクトの引数はログ時点の値を保持する", async () => {
+    const writer = new AsyncLogWriter<unknown[]>({
+      filePath: logFile,
+      format: (args) => JSON.stringify(args),
+      maxFileSize: 1024 * 1024,
+      flushIntervalMs: 60_000,
+    });
+    const state = { count: 1 };
+
+    writer.write(snapshotLogArgs(["state", state]), "info");
+    state.count = 2;
+    await writer.flush();
+
+    expect(readLines()).toEqual(['["state",{"count":1}]']);
+  });
+});
@@ -0,0 +1,177 @@
+import { describe, it, expect } from "vitest";
+import {
+  EventLogEncoder,
+  decodeSegment,
+  eventFromLogArgs,
+  formatEventAsText,
+} from "@main/event-log/codec";
+
+function encodeSegment(
+  baseTimeMs: number,
+  events: ReturnType<typeof eventFromLogArgs>[],
+): Buffer {
+  const encoder = new EventLogEncoder(baseTimeMs);
+  return Buffer.concat([
+    encoder.header(),
+    ...events.map((event) => encoder.encode(event)),
+  ]);
+}
+
+describe("イベントログコーデック", () => {
+  const base = Date.UTC(2025, 0, 1);
+
+  it("エンコードしたイベントをそのままデコードできる", () => {
+    const events = [
+      eventFromLogArgs(base + 5, "info", "audio", [
+        "Recording started",
+        { sessionId: "session-1", duration: "12.34ms" },
+      ]),
+      eventFromLogArgs(base + 40, "debug", "transcription", [
+        "Processed frame",
+        { frameSize: 512, ratio: 0.25, negative: -3, ok: true, none: null },
+      ]),
+      eventFromLogArgs(base + 41, "error", "main", [
+        "Failed",
+        { nested: { a: [1, 2] } },
+      ]),
+    ];
+
+    const decoded = [...decodeSegment(encodeSegment(base, events))];
+
+    expect(decoded).toHaveLength(3);
+    expect(decoded[0]).toEqual({
+      timeMs: base + 5,
+      level: "info",
+      scope: "audio",
+      message: "Recording started",
+      sessionId: "session-1",
+      fields: { duration: "12.34ms" },
+    });
+    expect(decoded[1].fields).toEqual({
+      frameSize: 512,
+      ratio: 0.25,
+      negative: -3,
+      ok: true,
+      none: null,
+    });
+    expect(decoded[2].fields).toEqual({ nested: { a: [1, 2] } });
+  });
+
+  it("タイムスタンプは単調増加として保存される", () => {
+    const events = [
+      eventFromLogArgs(base + 100, "info", "main", ["a"]),
+      eventFromLogArgs(base + 50, "info", "main", ["b"]), // clock went back
+    ];
+
+    const decoded = [...decodeSegment(encodeSegment(base, events))];
+
+    expect(decoded.map((e) => e.timeMs)).toEqual([base + 100, base + 100]);
+  });
+
+  it("繰り返し出現する文字列はインターンされ、サイズが小さくなる", () => {
+    const encoder = new EventLogEncoder(base);
+    encoder.header();
+    const event = eventFromLogArgs(base, "debug", "transcription", [
+      "Processed frame",
+      { sessionId: "session-1", frameSize: 512 },
+    ]);
+
+    const first = encoder.encode(event);
+    const second = encoder.encode(event);
+
+    expect(second.length).toBeLessThan(first.length);
+    expect(second.length).toBeLessThan(16);
+  });
+
+  it("値を埋め込んだメッセージはテンプレートだけをインターンする", () => {
+    const encoder = new EventLogEncoder(base);
+    encoder.header();
+    const messages = [
+      "Transcribed chunk 1 in 12.34ms",
+      "Transcribed chunk 2 in 8ms",
+      "Transcribed chunk -3 in 0.5ms",
+    ];
+
+    const chunks = messages.map((message) =>
+      encoder.encode(
+        eventFromLogArgs(base, "debug", "transcription", [message]),
+      ),
+    );
+    const decoded = [
+      ...decodeSegment(
+        Buffer.concat([new EventLogEncoder(base).header(), ...chunks]),
+      ),
+    ];
+
+    expect(decoded.map((e) => e.message)).toEqual(messages);
+    // Later messages reuse the template defined by the first one
+    expect(chunks[1].length).toBeLessThan(16);
+    expect(chunks[2].length).toBeLessThan(20);
+  });
+
+  it("識別子や先頭ゼロを含むメッセージもそのまま復元する", () => {
+    const messages = [
+      "Using gpt-4o-mini v6 on port 08080",
+      "Session 123e4567-e89b-12d3-a456-426614174000 ended after 1.50s",
+      "Range 1.2.3 and 1e5",
+    ];
+
+    const decoded = [
+      ...decodeSegment(
+        encodeSegment(
+          base,
+          messages.map((m) => eventFromLogArgs(base, "info", "main", [m])),
+        ),
+      ),
+    ];
+
+    expect(decoded.map((e) => e.message)).toEqual(messages);
+  });
+
+  it("ヘッダーは長さプレフィックスなしのマジックで始まる", () => {
+    const header = new EventLogEncoder(base).header();
+
+    expect(header.subarray(0, 4).toString("ascii")).toBe("SSEL");
+  });
+
+  it("Errorや非オブジェクト引数をフィールドとして保持する", () => {
+    const error = new Error("boom");
+    const [decoded] = decodeSegment(
+      encodeSegment(base, [
+        eventFromLogArgs(base, "error", "main", ["Failed:", error, 42]),
+      ]),
+    );
+
+    expect(decoded.fields.arg0).toMatchObject({
+      name: "Error",
+      message: "boom",
+    });
+    expect(decoded.fields.arg1).toBe(42);
+  });
+
+  it("末尾が途切れたセグメントは読めたところまでデコードする", () => {
+    const buf = encodeSegment(base, [
+      eventFromLogArgs(base, "info", "main", ["first"]),
+      eventFromLogArgs(base, "info", "main", ["second", { value: "x" }]),
+    ]);
+
+    const decoded = [...decodeSegment(buf.subarray(0, buf.length - 2))];
+
+    expect(decoded.map((e) => e.message)).toEqual(["first"]);
+  });
+
+  it("テキスト形式ではセッションIDをフィールドに含める", () => {
+    const text = formatEventAsText({
+      timeMs: base,
+      level: "info",
+      scope: "audio",
+      message: "Recording started",
+      sessionId: "s1",
+      fields: { n: 1 },
+    });
+
+    expect(text).toMatch(
+      /^\[\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}\.\d{3}\] \[info\] \[audio\] Recording started \{"sessionId":"s1","n":1\}$/,
+    );
+  });
+});
@@ -0,0 +1,83 @@
+import { describe, it, expect, beforeEach, afterEach, vi } from "vitest";
+import fs from "node:fs";
+import os from "node:os";
+import path from "node:path";
+import { decodeSegment } from "@main/event-log/codec";
+import { EventLogTransport } from "@main/event-log/transport";
+
+describe("EventLogTransport", () => {
+  let dir: string;
+
+  beforeEach(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), "event-log-transport-"));
+  });
+
+  afterEach(() => {
+    vi.restoreAllMocks();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  const readEvents = () =>
+    fs
+      .readdirSync(dir)
+      .sort()
+      .flatMap((name) => [
+        ...decodeSegment(fs.readFileSync(path.join(dir, name))),
+      ]);
+
+  it("書き込み時はエンコードせず、フラッシュ時にまとめて書き出す", async () => {
+    const transport = new EventLogTransport({ dir, flushIntervalMs: 60_000 });
+    const fields = { frame: 1 };
+
+    transport.write("info", "audio", ["Frame", fields]);
+    fields.frame = 2; // mutated after logging
+    expect(fs.readdirSync(dir)).toEqual([]);
+
+    await transport.flush();
+    const events = readEvents();
+    expect(events.map((e) => e.message)).toEqual(["Frame"]);
+    expect(events[0].fields).toEqual({ frame: 1 });
+  });
+
+  it("高水位を超えるとdebugから破棄し、warn/errorは残す", async () => {
+    const transport = new EventLogTransport({
+      dir,
+      capacity: 4,
+      highWatermark: 0.5,
+      flushIntervalMs: 60_000,
+    });
+
+    transport.write("info", "main", ["info 1"]);
+    transport.write("info", "main", ["info 2"]);
+    transport.write("debug", "main", ["debug 1"]); // dropped: 2 >= 2
+    transport.write("error", "main", ["error 1"]);
+
+    transport.flushSync();
+    const events = readEvents();
+    expect(events[0].message).toBe(
+      "Event log records dropped under pressure",
+    );
+    expect(events[0].fields).toEqual({ debug: 1, overflow: 0 });
+    expect(events.slice(1).map((e) => e.message)).toEqual([
+      "info 1",
+      "info 2",
+      "error 1",
+    ]);
+  });
+
+  it("壁時計の時刻を使い、時計が戻っても単調増加に保つ", async () => {
+    const now = vi.spyOn(Date, "now");
+    const transport = new EventLogTransport({ dir, flushIntervalMs: 60_000 });
+
+    now.mockReturnValue(1_700_000_000_000);
+    transport.write("info", "main", ["a"]);
+    now.mockReturnValue(1_699_999_999_000); // clock went back
+    transport.write("info", "main", ["b"]);
+
+    await transport.flush();
+    expect(readEvents().map((e) => e.timeMs)).toEqual([
+      1_700_000_000_000, 1_700_000_000_000,
+    ]);
+    expect(fs.readdirSync(dir)).toEqual(["events-1700000000000.sslog"]);
+  });
+});
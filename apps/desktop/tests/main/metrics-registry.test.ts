@@ -0,0 +1,110 @@
+import { describe, it, expect } from "vitest";
+import {
+  MetricsRegistry,
+  bucketIndex,
+  bucketValue,
+} from "@main/metrics/registry";
+
+describe("MetricsRegistry", () => {
+  it("カウンターをラベルごとに集計する", () => {
+    const registry = new MetricsRegistry();
+    const counter = registry.counter("test_total", "Test counter");
+
+    counter.inc();
+    counter.inc({ method: "paste" });
+    counter.inc({ method: "paste" }, 2);
+
+    expect(counter.get()).toBe(1);
+    expect(counter.get({ method: "paste" })).toBe(3);
+  });
+
+  it("labelsで束縛した系列はラベル指定と同じ系列に記録され、reset後も使える", () => {
+    const registry = new MetricsRegistry();
+    const counter = registry.counter("bound_total", "Bound counter");
+    const histogram = registry.histogram("bound_ms", "Bound histogram");
+    const paste = counter.labels({ method: "paste", app: "editor" });
+    const flac = histogram.labels({ format: "flac" });
+
+    paste.inc();
+    paste.inc(2);
+    counter.inc({ app: "editor", method: "paste" });
+    flac.record(5);
+    expect(counter.get({ method: "paste", app: "editor" })).toBe(4);
+    expect(histogram.summaries().map((s) => [s.labels, s.count])).toEqual([
+      ['format="flac"', 1],
+    ]);
+
+    registry.reset();
+    flac.record(7);
+    const [summary] = histogram.summaries();
+    expect([summary.labels, summary.count, summary.max]).toEqual([
+      'format="flac"',
+      1,
+      7,
+    ]);
+  });
+
+  it("同じ名前のメトリクスは二重登録できない", () => {
+    const registry = new MetricsRegistry();
+    registry.counter("dup_total", "a");
+    expect(() => registry.gauge("dup_total", "b")).toThrow(/already/);
+  });
+
+  it("ヒストグラムの分位点は相対誤差の範囲内に収まる", () => {
+    const registry = new MetricsRegistry();
+    const histogram = registry.histogram("latency_ms", "Latency");
+
+    for (let i = 1; i <= 1000; i++) {
+      histogram.record(i);
+    }
+
+    const [summary] = histogram.summaries();
+    expect(summary.count).toBe(1000);
+    expect(summary.min).toBe(1);
+    expect(summary.max).toBe(1000);
+    expect(Math.abs(summary.p50 - 500) / 500).toBeLessThan(0.04);
+    expect(Math.abs(summary.p90 - 900) / 900).toBeLessThan(0.04);
+    expect(Math.abs(summary.p99 - 990) / 990).toBeLessThan(0.04);
+  });
+
+  it("バケットインデックスは値に対して単調増加する", () => {
+    let previous = -1;
+    for (let v = 0; v < 100_000; v += 7) {
+      const index = bucketIndex(v);
+      expect(index).toBeGreaterThanOrEqual(previous);
+      previous = index;
+      // Bucket midpoint stays close to the value
+      if (v > 0) {
+        expect(Math.abs(bucketValue(index) - v) / v).toBeLessThan(0.04);
+      }
+    }
+    expect(bucketIndex(2 ** 31 - 1)).toBeLessThan(864);
+  });
+
+  it("Prometheusテキスト形式で出力する", () => {
+    const registry = new MetricsRegistry();
+    registry.counter("frames_total", "Frames").inc({ reason: 'a"b' });
+    registry.gauge("lag_ms", "Lag").set(1.5);
+    registry.histogram("rpc_ms", "RPC").record(10, { method: "paste" });
+
+    const text = registry.toPrometheus();
+
+    expect(text).toContain("# TYPE frames_total counter");
+    expect(text).toContain('frames_total{reason="a\\"b"} 1');
+    expect(text).toContain("lag_ms 1.5");
+    expect(text).toContain("# TYPE rpc_ms summary");
+    expect(text).toContain('rpc_ms{method="paste",quantile="0.5"} 10');
+    expect(text).toContain('rpc_ms_count{method="paste"} 1');
+  });
+
+  it("ゲージは読み取り時にコレクターで更新される", () => {
+    const registry = new MetricsRegistry();
+    let value = 0;
+    const gauge = registry
+      .gauge("dynamic", "Dynamic")
+      .onCollect(() => gauge.set(++value));
+
+    expect(registry.snapshot().gauges[0].value).toBe(1);
+    expect(registry.snapshot().gauges[0].value).toBe(2);
+  });
+});
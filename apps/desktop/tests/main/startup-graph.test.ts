@@ -0,0 +1,131 @@
+import { describe, it, expect } from "vitest";
+import {
+  StartupGraph,
+  StartupGraphError,
+} from "@main/core/startup-graph";
+
+const delay = (ms: number) => new Promise((r) => setTimeout(r, ms));
+
+describe("StartupGraph", () => {
+  it("依存関係の順序でタスクを実行する", async () => {
+    const order: string[] = [];
+    const graph = new StartupGraph()
+      .add({
+        name: "settings",
+        dependsOn: ["database"],
+        run: () => {
+          order.push("settings");
+        },
+      })
+      .add({
+        name: "database",
+        run: async () => {
+          await delay(5);
+          order.push("database");
+        },
+      });
+
+    await graph.run();
+
+    expect(order).toEqual(["database", "settings"]);
+  });
+
+  it("独立したタスクを並列に実行する", async () => {
+    let running = 0;
+    let maxRunning = 0;
+    const task = (name: string) => ({
+      name,
+      run: async () => {
+        running++;
+        maxRunning = Math.max(maxRunning, running);
+        await delay(10);
+        running--;
+      },
+    });
+
+    await new StartupGraph().add(task("vad")).add(task("database")).run();
+
+    expect(maxRunning).toBe(2);
+  });
+
+  it("レポートは宣言順で各タスクの結果を含む", async () => {
+    const report = await new StartupGraph()
+      .add({ name: "a", run: () => {} })
+      .add({ name: "b", dependsOn: ["a"], run: () => {} })
+      .run();
+
+    expect(report.tasks.map((t) => t.name)).toEqual(["a", "b"]);
+    expect(report.tasks.every((t) => t.status === "ok")).toBe(true);
+    expect(report.tasks[1].startedAtMs).toBeGreaterThanOrEqual(
+      report.tasks[0].startedAtMs,
+    );
+  });
+
+  it("必須タスクが失敗した場合は依存タスクをスキップしてエラーを投げる", async () => {
+    const cause = new Error("migration failed");
+    const graph = new StartupGraph()
+      .add({
+        name: "database",
+        run: () => {
+          throw cause;
+        },
+      })
+      .add({ name: "settings", dependsOn: ["database"], run: () => {} })
+      .add({ name: "platform", run: () => {} });
+
+    const error = await graph.run().catch((e) => e);
+
+    expect(error).toBeInstanceOf(StartupGraphError);
+    expect((error as StartupGraphError).cause).toBe(cause);
+    const statuses = Object.fromEntries(
+      (error as StartupGraphError).report.tasks.map((t) => [t.name, t.status]),
+    );
+    expect(statuses).toEqual({
+      database: "failed",
+      settings: "skipped",
+      platform: "ok",
+    });
+  });
+
+  it("オプショナルタスクの失敗は依存タスクをブロックしない", async () => {
+    let ran = false;
+    const report = await new StartupGraph()
+      .add({
+        name: "vad",
+        optional: true,
+        run: () => {
+          throw new Error("model not found");
+        },
+      })
+      .add({
+        name: "ai",
+        dependsOn: ["vad"],
+        run: () => {
+          ran = true;
+        },
+      })
+      .run();
+
+    expect(ran).toBe(true);
+    expect(report.tasks[0].status).toBe("failed");
+  });
+
+  it("循環依存と未知の依存を検出する", async () => {
+    const cyclic = new StartupGraph()
+      .add({ name: "a", dependsOn: ["b"], run: () => {} })
+      .add({ name: "b", dependsOn: ["a"], run: () => {} });
+    await expect(cyclic.run()).rejects.toThrow(/cycle/);
+
+    const unknown = new StartupGraph().add({
+      name: "a",
+      dependsOn: ["missing"],
+      run: () => {},
+    });
+    await expect(unknown.run()).rejects.toThrow(/Unknown startup task/);
+  });
+
+  it("重複したタスク名を拒否する", () => {
+    const graph = new StartupGraph().add({ name: "a", run: () => {} });
+    expect(() => graph.add({ name: "a", run: () => {} })).toThrow(/Duplicate/);
+  });
+});
@@ -0,0 +1,108 @@
+import { describe, it, expect } from "vitest";
+import {
+  alignmentFromVerbose,
+  decodeAlignment,
+  encodeAlignment,
+  findAlignedOffset,
+  shiftAlignment,
+  type AlignedSegment,
+} from "@/pipeline/core/alignment-index";
+
+const segments: AlignedSegment[] = [
+  {
+    startMs: 0,
+    endMs: 1500,
+    confidence: 0.5,
+    words: [
+      { text: "明日の", startMs: 120, endMs: 480 },
+      { text: "会議", startMs: 480, endMs: 900 },
+      { text: "です。", startMs: 900, endMs: 1500 },
+    ],
+  },
+  {
+    startMs: 4200,
+    endMs: 5600,
+    words: [
+      { text: "Whisper", startMs: 4200, endMs: 4800 },
+      { text: "API", startMs: 4900, endMs: 5600 },
+    ],
+  },
+];
+
+describe("alignment index", () => {
+  it("エンコードしたタイミングとテキストを復元できる", () => {
+    expect(decodeAlignment(encodeAlignment(segments))).toEqual(segments);
+    expect(decodeAlignment(encodeAlignment([]))).toEqual([]);
+  });
+
+  it("10ms単位に丸めて単語あたり数バイトに収める", () => {
+    const words = Array.from({ length: 1000 }, (_, i) => ({
+      text: "あ",
+      startMs: i * 300 + 3,
+      endMs: i * 300 + 254,
+    }));
+    const data = encodeAlignment([{ startMs: 0, endMs: 300_000, words }]);
+
+    // 3 bytes of text + 1 length byte + ~3 bytes of timing per word
+    expect(data.length).toBeLessThan(1000 * 8);
+    const decoded = decodeAlignment(data)[0].words;
+    expect(decoded[1]).toEqual({ text: "あ", startMs: 300, endMs: 550 });
+  });
+
+  it("セグメントの信頼度を1バイトで保存する", () => {
+    const decoded = decodeAlignment(
+      encodeAlignment([{ ...segments[0], confidence: 0.8123 }, segments[1]]),
+    );
+    expect(decoded[0].confidence).toBeCloseTo(0.8123, 2);
+    expect(decoded[1].confidence).toBeUndefined();
+  });
+
+  it("壊れたデータはエラーにする", () => {
+    const data = encodeAlignment(segments);
+    expect(() => decodeAlignment(data.subarray(0, data.length - 2))).toThrow();
+    expect(() => decodeAlignment(new Uint8Array([9]))).toThrow();
+  });
+
+  it("verbose_json の単語をセグメントに割り当てる", () => {
+    const aligned = alignmentFromVerbose({
+      text: "はい。そうです。",
+      segments: [
+        { start: 0, end: 0.8, text: "はい。", avg_logprob: -0.05 },
+        { start: 1.2, end: 2.4, text: "そうです。" },
+      ],
+      words: [
+        { word: "はい", start: 0.1, end: 0.6 },
+        { word: "そう", start: 1.2, end: 1.7 },
+        { word: "です", start: 1.7, end: 2.4 },
+      ],
+    });
+    expect(aligned.map((segment) => segment.words.map((w) => w.text))).toEqual([
+      ["はい"],
+      ["そう", "です"],
+    ]);
+    expect(aligned[1].words[0].startMs).toBe(1200);
+    expect(aligned[0].confidence).toBeCloseTo(Math.exp(-0.05));
+    expect(aligned[1].confidence).toBeUndefined();
+  });
+
+  it("単語のタイミングがなければセグメント全体を1語にする", () => {
+    const aligned = alignmentFromVerbose({
+      segments: [{ start: 0.5, end: 1.5, text: " こんにちは" }],
+    });
+    expect(aligned).toEqual([
+      {
+        startMs: 500,
+        endMs: 1500,
+        words: [{ text: "こんにちは", startMs: 500, endMs: 1500 }],
+      },
+    ]);
+  });
+
+  it("検索語を含む単語の開始位置を返す", () => {
+    const shifted = shiftAlignment(segments, 1000);
+    expect(findAlignedOffset(shifted, "会議です")).toBe(1480);
+    expect(findAlignedOffset(shifted, "whisper api")).toBe(5200);
+    expect(findAlignedOffset(shifted, "議事録")).toBeNull();
+    expect(findAlignedOffset(shifted, "  ")).toBeNull();
+  });
+});
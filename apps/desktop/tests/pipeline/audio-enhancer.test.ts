@@ -0,0 +1,203 @@
+import { describe, it, expect } from "vitest";
+import {
+  AudioEnhancer,
+  DEFAULT_AUDIO_ENHANCEMENT,
+  type AudioEnhancementConfig,
+} from "@/pipeline/core/audio-enhancer";
+
+const SAMPLE_RATE = 16000;
+const FRAME_SIZE = 512;
+
+/** Config with a single stage enabled */
+function only(stage: keyof AudioEnhancementConfig): AudioEnhancementConfig {
+  return {
+    highPass: false,
+    noiseSuppression: false,
+    autoGain: false,
+    [stage]: true,
+  };
+}
+
+const ALL_STAGES: AudioEnhancementConfig = {
+  highPass: true,
+  noiseSuppression: true,
+  autoGain: true,
+};
+
+function createRandom(seed: number) {
+  let state = seed;
+  return () => (state = (state * 48271) % 0x7fffffff) / 0x7fffffff;
+}
+
+function tone(frequency: number, amplitude: number, length: number) {
+  const samples = new Float32Array(length);
+  for (let i = 0; i < length; i++) {
+    samples[i] =
+      amplitude * Math.sin((2 * Math.PI * frequency * i) / SAMPLE_RATE);
+  }
+  return samples;
+}
+
+/** Run the enhancer over `input` in renderer-sized frames */
+function enhance(config: AudioEnhancementConfig, input: Float32Array) {
+  const enhancer = new AudioEnhancer(config);
+  const output = input.slice();
+  for (let offset = 0; offset < output.length; offset += FRAME_SIZE) {
+    enhancer.process(output.subarray(offset, offset + FRAME_SIZE));
+  }
+  return { output, latency: enhancer.latencySamples };
+}
+
+function rms(samples: Float32Array, start = 0, end = samples.length) {
+  let sum = 0;
+  for (let i = start; i < end; i++) sum += samples[i] * samples[i];
+  return Math.sqrt(sum / (end - start));
+}
+
+const db = (ratio: number) => 20 * Math.log10(ratio);
+
+describe("AudioEnhancer", () => {
+  it("すべてバイパスすると音声を変更しない", () => {
+    const input = tone(440, 0.3, 4096);
+    const { output, latency } = enhance(
+      { highPass: false, noiseSuppression: false, autoGain: false },
+      input,
+    );
+    expect(latency).toBe(0);
+    expect(output).toEqual(input);
+  });
+
+  it("ハイパスは直流とハムを落とし、音声帯域は通す", () => {
+    const length = SAMPLE_RATE;
+    const hum = tone(30, 0.3, length).map((x) => x + 0.2);
+    const { output: filteredHum } = enhance(only("highPass"), hum);
+    expect(
+      db(rms(filteredHum, length / 2) / rms(hum, length / 2)),
+    ).toBeLessThan(-14);
+
+    const voice = tone(1000, 0.3, length);
+    const { output: filteredVoice } = enhance(only("highPass"), voice);
+    expect(
+      Math.abs(db(rms(filteredVoice, length / 2) / rms(voice, length / 2))),
+    ).toBeLessThan(0.1);
+  });
+
+  it("ノイズ抑圧は定常ノイズを下げ、発話区間のレベルを保つ", () => {
+    // 1 s of noise, then 1 s of a tone in the same noise
+    const random = createRandom(7);
+    const length = 2 * SAMPLE_RATE;
+    const input = new Float32Array(length).map(
+      () => (random() * 2 - 1) * 0.05,
+    );
+    const speech = tone(700, 0.3, SAMPLE_RATE);
+    for (let i = 0; i < SAMPLE_RATE; i++) input[SAMPLE_RATE + i] += speech[i];
+
+    const { output, latency } = enhance(only("noiseSuppression"), input);
+    expect(latency).toBe(256);
+
+    // Noise-only section, after the estimate has settled
+    const noiseReduction = db(
+      rms(output, 0.5 * SAMPLE_RATE, SAMPLE_RATE) /
+        rms(input, 0.5 * SAMPLE_RATE, SAMPLE_RATE),
+    );
+    expect(noiseReduction).toBeLessThan(-10);
+
+    // The tone comes through at its level, `latency` samples later
+    const from = 1.25 * SAMPLE_RATE;
+    const to = 1.75 * SAMPLE_RATE;
+    const toneLevel = db(
+      rms(output, from + latency, to + latency) / rms(speech, 0, to - from),
+    );
+    expect(Math.abs(toneLevel)).toBeLessThan(1.5);
+  });
+
+  it("AGCは小さな発話を持ち上げ、背景ノイズは持ち上げない", () => {
+    const length = 3 * SAMPLE_RATE;
+    // -60 dBFS of noise, then -40 dBFS speech from 0.5 s
+    const random = createRandom(3);
+    const input = new Float32Array(length).map(
+      () => (random() * 2 - 1) * 0.0017,
+    );
+    const quiet = tone(300, 0.014, length);
+    for (let i = SAMPLE_RATE / 2; i < length; i++) input[i] += quiet[i];
+    const { output } = enhance(only("autoGain"), input);
+    const level = rms(output, 2 * SAMPLE_RATE, length);
+    expect(level).toBeGreaterThan(0.07);
+    expect(level).toBeLessThan(0.13);
+
+    // Louder noise without speech keeps unity gain
+    const noise = new Float32Array(length).map(
+      () => (random() * 2 - 1) * 0.01,
+    );
+    const { output: held } = enhance(only("autoGain"), noise);
+    const change = db(
+      rms(held, SAMPLE_RATE, length) / rms(noise, SAMPLE_RATE, length),
+    );
+    expect(Math.abs(change)).toBeLessThan(1);
+  });
+
+  it("リミッターはピークを-1dBFS以下に抑える", () => {
+    const input = tone(200, 0.1, 2 * SAMPLE_RATE);
+    input.fill(0.0001, 0, SAMPLE_RATE / 4); // Near-silent start
+    // Sudden shout: 10x louder than the level the AGC settled on
+    for (let i = SAMPLE_RATE; i < SAMPLE_RATE + 4000; i++) input[i] *= 10;
+    const { output } = enhance(only("autoGain"), input);
+    let peak = 0;
+    for (const sample of output) peak = Math.max(peak, Math.abs(sample));
+    expect(peak).toBeLessThanOrEqual(0.891 + 1e-6);
+    expect(peak).toBeGreaterThan(0.5);
+  });
+
+  it("既定ではハイパスのみ有効で、遅延はない", () => {
+    expect(DEFAULT_AUDIO_ENHANCEMENT).toEqual(only("highPass"));
+    expect(new AudioEnhancer(DEFAULT_AUDIO_ENHANCEMENT).latencySamples).toBe(
+      0,
+    );
+  });
+
+  it("すべての段を有効にすると遅延は21msになる", () => {
+    const enhancer = new AudioEnhancer(ALL_STAGES);
+    expect((enhancer.latencySamples / SAMPLE_RATE) * 1000).toBe(21);
+  });
+
+  it("flushで遅延線に残った末尾を取り出せる", () => {
+    const input = tone(440, 0.3, 2 * SAMPLE_RATE);
+    const enhancer = new AudioEnhancer(ALL_STAGES);
+    const output = input.slice();
+    for (let offset = 0; offset < output.length; offset += FRAME_SIZE) {
+      enhancer.process(output.subarray(offset, offset + FRAME_SIZE));
+    }
+    const tail = enhancer.flush();
+    expect(tail.length).toBe(enhancer.latencySamples);
+    // The tail is the end of the tone, not silence
+    expect(rms(tail)).toBeGreaterThan(rms(output, SAMPLE_RATE) * 0.5);
+  });
+});
+
+// Per-frame cost against the 1 ms budget; run with `pnpm bench:enhancer`
+describe.skipIf(!process.env.ENHANCER_BENCH)("音声前処理ベンチ", () => {
+  it("512サンプルのフレームあたりの処理時間を計測する", () => {
+    const random = createRandom(1);
+    const input = new Float32Array(60 * SAMPLE_RATE).map(
+      (_, i) =>
+        0.2 * Math.sin((2 * Math.PI * 220 * i) / SAMPLE_RATE) +
+        (random() * 2 - 1) * 0.02,
+    );
+    const enhancer = new AudioEnhancer(ALL_STAGES);
+    const timings: number[] = [];
+    for (let offset = 0; offset < input.length; offset += FRAME_SIZE) {
+      const frame = input.subarray(offset, offset + FRAME_SIZE);
+      const start = performance.now();
+      enhancer.process(frame);
+      timings.push(performance.now() - start);
+    }
+    timings.sort((a, b) => a - b);
+    const p50 = timings[Math.floor(timings.length * 0.5)];
+    const p99 = timings[Math.floor(timings.length * 0.99)];
+    console.log(
+      `enhancer: ${timings.length} frames, ` +
+        `p50 ${p50.toFixed(3)}ms, p99 ${p99.toFixed(3)}ms per 32ms frame`,
+    );
+    expect(p99).toBeLessThan(1);
+  });
+});
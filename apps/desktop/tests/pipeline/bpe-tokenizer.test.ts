@@ -0,0 +1,235 @@
+import { describe, it, expect } from "vitest";
+import fs from "node:fs";
+import path from "node:path";
+import {
+  BpeTokenizer,
+  encodingForModel,
+} from "@/pipeline/core/bpe-tokenizer";
+import { buildRecognitionPrompt } from "@/pipeline/providers/transcription/recognition-prompt";
+
+/**
+ * Small vocabulary in .tiktoken format: all 256 bytes, then `merges` in
+ * rank order. Like a trained vocabulary, every byte prefix of a merge is a
+ * token too (so multi-byte characters can be reached pair by pair).
+ */
+function tiktokenFile(merges: string[]): string {
+  const tokens: Buffer[] = [];
+  const seen = new Set<string>();
+  for (let byte = 0; byte < 256; byte++) {
+    tokens.push(Buffer.from([byte]));
+    seen.add(Buffer.from([byte]).toString("hex"));
+  }
+  for (const merge of merges) {
+    const bytes = Buffer.from(merge, "utf8");
+    for (let length = 2; length <= bytes.length; length++) {
+      const prefix = bytes.subarray(0, length);
+      if (seen.has(prefix.toString("hex"))) continue;
+      seen.add(prefix.toString("hex"));
+      tokens.push(prefix);
+    }
+  }
+  return (
+    tokens.map((token, rank) => `${token.toString("base64")} ${rank}`).join("\n") +
+    "\n"
+  );
+}
+
+function tokenizer(merges: string[]): BpeTokenizer {
+  return BpeTokenizer.fromTiktoken("cl100k_base", tiktokenFile(merges));
+}
+
+/** Text of each token, for readable expectations */
+function pieces(bpe: BpeTokenizer, text: string): string[] {
+  return bpe.encode(text).map((token) => bpe.decode([token]));
+}
+
+describe("BpeTokenizer", () => {
+  it("ランクの低いペアから順にマージする", () => {
+    expect(pieces(tokenizer(["ab", "bc"]), "abc")).toEqual(["ab", "c"]);
+    expect(pieces(tokenizer(["bc", "ab"]), "abc")).toEqual(["a", "bc"]);
+  });
+
+  it("マージを重ねて語彙にある長いトークンにする", () => {
+    const bpe = tokenizer(["ll", "he", "llo", "hello", " w", "or", " wor", " world"]);
+    expect(pieces(bpe, "hello world")).toEqual(["hello", " world"]);
+  });
+
+  it("事前分割の境界を越えてマージしない", () => {
+    // "o w" would merge to "o w" if pieces were not split at " world"
+    const bpe = tokenizer(["o ", "o w", "'l", "'ll"]);
+    expect(pieces(bpe, "I'll go world")).toEqual([
+      "I",
+      "'ll",
+      " ",
+      "g",
+      "o",
+      " ",
+      "w",
+      "o",
+      "r",
+      "l",
+      "d",
+    ]);
+  });
+
+  it("同じランクのペアは左から順にマージする", () => {
+    const bpe = tokenizer(["aa"]);
+    expect(pieces(bpe, "aaa")).toEqual(["aa", "a"]);
+    expect(pieces(bpe, "aaaaa")).toEqual(["aa", "aa", "a"]);
+  });
+
+  it("素朴な文字列マージと同じトークン列になる", () => {
+    const merges = ["ab", "bc", "ca", "aa", "abc", "bca", "cab", "abca", "aab"];
+    const bpe = tokenizer(merges);
+    const vocabulary = new Set(["a", "b", "c", ...merges]);
+    for (const merge of merges) {
+      for (let length = 2; length <= merge.length; length++) {
+        vocabulary.add(merge.slice(0, length));
+      }
+    }
+    const rank = (part: string) => bpe.encode(part)[0];
+
+    // Reference: rescan all adjacent pairs and merge the lowest-ranked one
+    // (a word that is itself a token is taken whole, as tiktoken does)
+    const reference = (word: string): string[] => {
+      if (vocabulary.has(word)) return [word];
+      const parts = [...word];
+      for (;;) {
+        let best = -1;
+        let bestRank = Infinity;
+        for (let i = 0; i < parts.length - 1; i++) {
+          const merged = parts[i] + parts[i + 1];
+          if (vocabulary.has(merged) && rank(merged) < bestRank) {
+            best = i;
+            bestRank = rank(merged);
+          }
+        }
+        if (best < 0) return parts;
+        parts.splice(best, 2, parts[best] + parts[best + 1]);
+      }
+    };
+
+    let seed = 7;
+    for (let n = 0; n < 200; n++) {
+      let word = "";
+      const length = 1 + (n % 12);
+      for (let i = 0; i < length; i++) {
+        seed = (Math.imul(seed, 1103515245) + 12345) & 0x7fffffff;
+        word += "abc"[seed % 3];
+      }
+      expect(pieces(bpe, word)).toEqual(reference(word));
+    }
+  });
+
+  it("マルチバイト文字をUTF-8のバイト列として扱い、復元できる", () => {
+    const bpe = tokenizer(["こん", "にち", "こんにち"]);
+    const text = "こんにちは、世界！ 🎉 test\n";
+
+    // "は" is not in the vocabulary: it stays as partial-byte tokens
+    const tokens = bpe.encode("こんにちは");
+    expect(tokens).toHaveLength(3);
+    expect(bpe.decode(tokens.slice(0, 1))).toBe("こんにち");
+    expect(bpe.decode(bpe.encode(text))).toBe(text);
+    expect(bpe.count(text)).toBe(bpe.encode(text).length);
+  });
+
+  it("トークン予算で切り詰め、文字を途中で切らない", () => {
+    const bpe = tokenizer([]);
+    // One token per byte: 3 tokens per kana
+    const text = "あいうえお";
+
+    expect(bpe.truncate(text, 7)).toBe("あい");
+    expect(bpe.truncateStart(text, 7)).toBe("えお");
+    expect(bpe.truncate(text, 15)).toBe(text);
+    expect(bpe.truncate(text, 0)).toBe("");
+  });
+});
+
+describe("encodingForModel", () => {
+  it("モデルIDからエンコーディングを選ぶ", () => {
+    expect(encodingForModel("gpt-4o-mini")).toBe("o200k_base");
+    expect(encodingForModel("openai/gpt-4.1-nano")).toBe("o200k_base");
+    expect(encodingForModel("gpt-4o-transcribe")).toBe("o200k_base");
+    expect(encodingForModel("gpt-4-turbo")).toBe("cl100k_base");
+    expect(encodingForModel("whisper-1")).toBeNull();
+    expect(encodingForModel("qwen2.5-3b-instruct-q4_k_m")).toBeNull();
+  });
+});
+
+describe("buildRecognitionPrompt（トークナイザー使用時）", () => {
+  it("実際のトークン数で予算内に収める", () => {
+    const bpe = tokenizer(["議事", "議事録", "会議"]);
+    const recentText = "会議の議事録を作成します。".repeat(50);
+
+    const prompt = buildRecognitionPrompt({
+      vocabulary: ["surasura"],
+      recentText,
+      maxTokens: 120,
+      tokenizer: bpe,
+    });
+
+    expect(bpe.count(prompt)).toBeLessThanOrEqual(120);
+    expect(prompt.startsWith("surasura ")).toBe(true);
+    expect(prompt.endsWith("会議の議事録を作成します。")).toBe(true);
+  });
+});
+
+const VOCABULARY_FILE =
+  process.env.TIKTOKEN_FILE ??
+  path.join(process.cwd(), "models", "tokenizers", "o200k_base.tiktoken");
+
+describe.skipIf(!process.env.TOKENIZER_BENCH)("トークナイザーベンチ", () => {
+  it("o200k_base でのエンコード速度を計測する", () => {
+    let start = performance.now();
+    const bpe = BpeTokenizer.fromTiktoken(
+      "o200k_base",
+      fs.readFileSync(VOCABULARY_FILE, "utf8"),
+    );
+    const loadMs = performance.now() - start;
+
+    const samples = {
+      japanese:
+        "えーと、今日の会議の資料をあのー明日までに送ります。新しい機能のリリースは月末を予定しています。",
+      english:
+        "The quick brown fox jumps over the lazy dog. We'll ship the release at the end of the month, won't we? ",
+      mixed: "surasuraの設定画面からWhisperのモデルを選んでください (gpt-4o-mini, 2,000 tokens)。\n",
+    };
+
+    const rows: string[] = [];
+    const measure = (name: string, warmUp: string, text: string) => {
+      const bytes = Buffer.byteLength(text, "utf8");
+      bpe.count(warmUp);
+      start = performance.now();
+      const tokens = bpe.count(text);
+      const seconds = (performance.now() - start) / 1000;
+      rows.push(
+        `${name}: ${(bytes / 1e6 / seconds).toFixed(1)} MB/s, ` +
+          `${(bytes / tokens).toFixed(2)} bytes/token`,
+      );
+    };
+
+    for (const [name, sample] of Object.entries(samples)) {
+      const text = sample.repeat(Math.ceil(4_000_000 / sample.length));
+      measure(name, text, text); // warm up the JIT and the piece cache
+    }
+
+    // Characters shuffled so pieces rarely repeat: measures the merge loop
+    // rather than the piece cache
+    const chars = [...Object.values(samples).join("")];
+    let seed = 1;
+    const shuffled = () => {
+      let text = "";
+      while (text.length < 1_000_000) {
+        seed = (Math.imul(seed, 1103515245) + 12345) & 0x7fffffff;
+        text += chars[seed % chars.length];
+      }
+      return text;
+    };
+    measure("shuffled", shuffled(), shuffled());
+
+    console.log(
+      `o200k_base: ${bpe.vocabularySize} tokens, load ${loadMs.toFixed(0)}ms\n` +
+        rows.join("\n"),
+    );
+  });
+});
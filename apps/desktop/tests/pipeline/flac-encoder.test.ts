@@ -0,0 +1,278 @@
+import { createHash } from "node:crypto";
+import { describe, it, expect } from "vitest";
+import {
+  StreamingFlacEncoder,
+  crc8,
+  crc16,
+} from "@/pipeline/providers/transcription/flac-encoder";
+
+/**
+ * Minimal FLAC decoder for the subset the encoder emits (mono, 16-bit,
+ * CONSTANT / VERBATIM / FIXED subframes). Verifies both CRCs and the frame
+ * (fixed block size) or sample (variable block size) numbers.
+ */
+function decodeFlac(bytes: Uint8Array): {
+  sampleRate: number;
+  totalSamples: number;
+  md5: string;
+  samples: Int16Array;
+} {
+  let bit = 0;
+  const read = (count: number): number => {
+    let value = 0;
+    for (let i = 0; i < count; i++, bit++) {
+      value = value * 2 + ((bytes[bit >> 3] >> (7 - (bit & 7))) & 1);
+    }
+    return value;
+  };
+  const readSigned = (count: number): number => {
+    const value = read(count);
+    return value >= 2 ** (count - 1) ? value - 2 ** count : value;
+  };
+
+  expect(String.fromCharCode(...bytes.slice(0, 4))).toBe("fLaC");
+  bit = 32;
+  expect(read(1)).toBe(1); // Last metadata block
+  expect(read(7)).toBe(0); // STREAMINFO
+  expect(read(24)).toBe(34);
+  read(16 + 16 + 24 + 24);
+  const sampleRate = read(20);
+  expect(read(3)).toBe(0);
+  expect(read(5)).toBe(15);
+  const totalSamples = read(36);
+  const md5 = Buffer.from(bytes.subarray(26, 42)).toString("hex");
+  read(128);
+
+  const samples: number[] = [];
+  let variable: boolean | null = null;
+  for (let frameNumber = 0; bit >> 3 < bytes.length; frameNumber++) {
+    const frameStart = bit >> 3;
+    expect(read(15)).toBe(0b111111111111100);
+    const strategy = read(1) === 1;
+    // One blocking strategy per stream
+    expect(strategy).toBe(variable ?? strategy);
+    variable = strategy;
+    const sizeCode = read(4);
+    read(4);
+    expect(read(4)).toBe(0);
+    expect(read(3)).toBe(0b100);
+    read(1);
+    // UTF-8 frame or sample number
+    let first = read(8);
+    let extra = 0;
+    while (first & 0x80) {
+      first = (first << 1) & 0xff;
+      extra++;
+    }
+    let number = first >> extra;
+    for (let i = 1; i < extra; i++) number = number * 64 + (read(8) & 0x3f);
+    expect(number).toBe(variable ? samples.length : frameNumber);
+    let blockSize =
+      sizeCode >= 8 ? 256 << (sizeCode - 8) : 576 << (sizeCode - 2);
+    if (sizeCode === 0b0110) blockSize = read(8) + 1;
+    if (sizeCode === 0b0111) blockSize = read(16) + 1;
+    const headerEnd = bit >> 3;
+    expect(read(8)).toBe(crc8(bytes, frameStart, headerEnd));
+
+    expect(read(1)).toBe(0);
+    const type = read(6);
+    expect(read(1)).toBe(0);
+    const block: number[] = [];
+    if (type === 0) {
+      const value = readSigned(16);
+      for (let i = 0; i < blockSize; i++) block.push(value);
+    } else if (type === 1) {
+      for (let i = 0; i < blockSize; i++) block.push(readSigned(16));
+    } else {
+      expect(type >> 3).toBe(1);
+      const order = type & 7;
+      for (let i = 0; i < order; i++) block.push(readSigned(16));
+      expect(read(2)).toBe(0);
+      const partitionOrder = read(4);
+      const partSize = blockSize >> partitionOrder;
+      for (let p = 0; p < 1 << partitionOrder; p++) {
+        const k = read(4);
+        const n = p === 0 ? partSize - order : partSize;
+        for (let i = 0; i < n; i++) {
+          let quotient = 0;
+          while (read(1) === 0) quotient++;
+          const u = quotient * 2 ** k + read(k);
+          const residual = u & 1 ? -(u + 1) / 2 : u / 2;
+          const j = block.length;
+          const predicted = [
+            0,
+            block[j - 1],
+            2 * block[j - 1] - block[j - 2],
+            3 * block[j - 1] - 3 * block[j - 2] + block[j - 3],
+            4 * block[j - 1] -
+              6 * block[j - 2] +
+              4 * block[j - 3] -
+              block[j - 4],
+          ][order];
+          block.push(predicted + residual);
+        }
+      }
+    }
+    samples.push(...block);
+
+    bit = Math.ceil(bit / 8) * 8;
+    const frameEnd = bit >> 3;
+    expect(read(16)).toBe(crc16(bytes, frameStart, frameEnd));
+  }
+
+  return { sampleRate, totalSamples, md5, samples: Int16Array.from(samples) };
+}
+
+function concat(parts: Uint8Array[]): Uint8Array {
+  const out = new Uint8Array(parts.reduce((sum, p) => sum + p.length, 0));
+  let offset = 0;
+  for (const part of parts) {
+    out.set(part, offset);
+    offset += part.length;
+  }
+  return out;
+}
+
+/** MD5 of 16-bit little-endian PCM, as reference decoders compute it */
+function pcmMd5(samples: Int16Array): string {
+  const bytes = Buffer.alloc(samples.length * 2);
+  samples.forEach((sample, i) => bytes.writeInt16LE(sample, i * 2));
+  return createHash("md5").update(bytes).digest("hex");
+}
+
+/** Same quantization as float32ToWav */
+function toPcm16(audio: Float32Array): Int16Array {
+  return Int16Array.from(audio, (value) => {
+    const sample = Math.max(-1, Math.min(1, value));
+    return sample < 0 ? sample * 0x8000 : sample * 0x7fff;
+  });
+}
+
+function speechLike(length: number, seed = 1): Float32Array {
+  let state = seed;
+  const noise = () => ((state = (state * 48271) % 0x7fffffff) / 0x7fffffff) * 2 - 1;
+  return Float32Array.from({ length }, (_, i) => {
+    const envelope = 0.5 + 0.5 * Math.sin(i / 1600);
+    return (
+      envelope *
+        (0.3 * Math.sin((2 * Math.PI * 180 * i) / 16000) +
+          0.15 * Math.sin((2 * Math.PI * 720 * i) / 16000)) +
+      0.01 * noise()
+    );
+  });
+}
+
+describe("StreamingFlacEncoder", () => {
+  it("WAVと同じサンプルに復号できる", () => {
+    const audio = speechLike(16000 * 3 + 123);
+    const encoder = new StreamingFlacEncoder({ sampleRate: 16000 });
+    // Streamed in renderer-sized frames
+    for (let offset = 0; offset < audio.length; offset += 512) {
+      encoder.write(audio.subarray(offset, offset + 512));
+    }
+    const decoded = decodeFlac(concat(encoder.finish()));
+
+    expect(decoded.sampleRate).toBe(16000);
+    expect(decoded.totalSamples).toBe(audio.length);
+    expect(decoded.samples).toEqual(toPcm16(audio));
+  });
+
+  it("STREAMINFOのMD5は参照デコーダーが検証するPCMのMD5と一致する", () => {
+    const audio = speechLike(16000 * 2 + 77);
+    const encoder = new StreamingFlacEncoder({ sampleRate: 16000 });
+    for (let offset = 0; offset < audio.length; offset += 512) {
+      encoder.write(audio.subarray(offset, offset + 512));
+    }
+    const decoded = decodeFlac(concat(encoder.finish()));
+
+    // Independent of the decoder above: `flac -t` and ffmpeg reject the
+    // file unless their decoded samples hash to this value
+    expect(decoded.md5).toBe(pcmMd5(toPcm16(audio)));
+    expect(decoded.md5).toBe(pcmMd5(decoded.samples));
+
+    // Each segment starts a fresh hash (MD5 of no data)
+    encoder.write(new Float32Array(0));
+    expect(decodeFlac(concat(encoder.finish())).md5).toBe(
+      "d41d8cd98f00b204e9800998ecf8427e",
+    );
+  });
+
+  it("無音・クリップ・ノイズを含む信号も可逆に符号化する", () => {
+    let state = 7;
+    const audio = new Float32Array(10000);
+    for (let i = 0; i < audio.length; i++) {
+      state = (state * 48271) % 0x7fffffff;
+      if (i < 4096) audio[i] = 0; // CONSTANT
+      else if (i < 6000) audio[i] = (state / 0x7fffffff) * 2 - 1; // VERBATIM
+      else audio[i] = i % 2 ? 1.5 : -1.5; // Clipped
+    }
+    const encoder = new StreamingFlacEncoder({ sampleRate: 16000 });
+    encoder.write(audio);
+
+    expect(decodeFlac(concat(encoder.finish())).samples).toEqual(
+      toPcm16(audio),
+    );
+  });
+
+  it("音声はWAVより小さくなる", () => {
+    const audio = speechLike(16000 * 10);
+    const encoder = new StreamingFlacEncoder({ sampleRate: 16000 });
+    encoder.write(audio);
+    const bytes = concat(encoder.finish()).length;
+
+    expect(bytes).toBeLessThan((44 + audio.length * 2) * 0.7);
+  });
+
+  it("finish後は次のセグメントを先頭から符号化する", () => {
+    const encoder = new StreamingFlacEncoder({ sampleRate: 16000 });
+    encoder.write(speechLike(5000, 1));
+    encoder.finish();
+
+    const second = speechLike(3000, 2);
+    encoder.write(second);
+    expect(encoder.sampleCount).toBe(3000);
+    const decoded = decodeFlac(concat(encoder.finish()));
+
+    expect(decoded.totalSamples).toBe(3000);
+    expect(decoded.samples).toEqual(toPcm16(second));
+  });
+
+  it("分割した各パートを符号化済みのブロックから可逆に組み立てる", () => {
+    const audio = speechLike(16000 * 3 + 123);
+    const encoder = new StreamingFlacEncoder({ sampleRate: 16000 });
+    for (let offset = 0; offset < audio.length; offset += 512) {
+      encoder.write(audio.subarray(offset, offset + 512));
+    }
+    // Cuts on renderer frames, one just short of a block boundary and one
+    // inside a single block
+    const cuts = [0, 512 * 20, 4096 * 3 - 8, 4096 * 3 + 512, audio.length];
+    const parts = cuts.slice(0, -1).map((offset, i) => ({
+      audio: audio.subarray(offset, cuts[i + 1]),
+      offset,
+    }));
+    const files = encoder.finishParts(parts);
+
+    expect(files).toHaveLength(parts.length);
+    files.forEach((file, i) => {
+      const decoded = decodeFlac(concat(file.parts));
+      const expected = toPcm16(parts[i].audio);
+      expect(decoded.totalSamples).toBe(parts[i].audio.length);
+      expect(decoded.samples).toEqual(expected);
+      expect(decoded.md5).toBe(pcmMd5(expected));
+    });
+    expect(encoder.sampleCount).toBe(0);
+  });
+
+  it("200フレームを超えても可変長のフレーム番号を正しく書く", () => {
+    const audio = speechLike(300 * 64);
+    const encoder = new StreamingFlacEncoder({
+      sampleRate: 16000,
+      blockSize: 64,
+    });
+    encoder.write(audio);
+
+    expect(decodeFlac(concat(encoder.finish())).samples).toEqual(
+      toPcm16(audio),
+    );
+  });
+});
@@ -0,0 +1,91 @@
+import { describe, it, expect } from "vitest";
+import {
+  DEFAULT_FLUSH_SPLIT,
+  findSplitPoints,
+  splitRanges,
+  mergeSegmentTranscripts,
+} from "@/pipeline/providers/transcription/flush-splitter";
+
+/** Speech probabilities: 0.9 everywhere except short pauses at `valleys` */
+function probabilities(total: number, valleys: number[]): number[] {
+  const values = new Array<number>(total).fill(0.9);
+  for (const center of valleys) {
+    for (let i = center - 4; i <= center + 4; i++) {
+      if (i >= 0 && i < total) values[i] = 0.05;
+    }
+  }
+  return values;
+}
+
+describe("findSplitPoints", () => {
+  it("短いバッファは分割しない", () => {
+    expect(findSplitPoints(probabilities(200, [100]))).toEqual([]);
+  });
+
+  it("途切れない発話は単語の途中で切らない", () => {
+    expect(findSplitPoints(probabilities(900, []))).toEqual([]);
+  });
+
+  it("均等な分割点の近くにある息継ぎで切る", () => {
+    // 30 s with pauses near 10 s and 21 s
+    const cuts = findSplitPoints(probabilities(940, [300, 650]));
+
+    // Even split points are 235, 470 and 705; 470 has no pause in reach
+    expect(cuts).toHaveLength(2);
+    expect(Math.abs(cuts[0] - 300)).toBeLessThanOrEqual(4);
+    expect(Math.abs(cuts[1] - 650)).toBeLessThanOrEqual(4);
+  });
+
+  it("分割数と各パートの長さに上限・下限がある", () => {
+    const valleys = Array.from({ length: 60 }, (_, i) => 15 + i * 30);
+    const cuts = findSplitPoints(probabilities(1800, valleys));
+
+    expect(cuts.length).toBeLessThanOrEqual(DEFAULT_FLUSH_SPLIT.maxParts - 1);
+    const bounds = [0, ...cuts, 1800];
+    for (let i = 1; i < bounds.length; i++) {
+      expect(bounds[i] - bounds[i - 1]).toBeGreaterThanOrEqual(
+        DEFAULT_FLUSH_SPLIT.minPartFrames,
+      );
+    }
+  });
+});
+
+describe("splitRanges", () => {
+  it("後続のパートは切れ目の少し前から始まる", () => {
+    expect(splitRanges(600, [200, 400], 8)).toEqual([
+      { start: 0, end: 200 },
+      { start: 192, end: 400 },
+      { start: 392, end: 600 },
+    ]);
+  });
+});
+
+describe("mergeSegmentTranscripts", () => {
+  it("順番どおりに連結する", () => {
+    expect(
+      mergeSegmentTranscripts(["今日は晴れです。", "明日は雨です。"]),
+    ).toBe("今日は晴れです。明日は雨です。");
+  });
+
+  it("重なり部分で重複した文字列を取り除く", () => {
+    expect(
+      mergeSegmentTranscripts(["会議の資料を送ります。", "送ります。よろしく"]),
+    ).toBe("会議の資料を送ります。よろしく");
+  });
+
+  it("英語は単語単位で重複を判定し空白を補う", () => {
+    expect(mergeSegmentTranscripts(["send the report", "report today"])).toBe(
+      "send the report today",
+    );
+    // "at" is not a repeat of the end of "cat"
+    expect(mergeSegmentTranscripts(["feed the cat", "at noon"])).toBe(
+      "feed the cat at noon",
+    );
+  });
+
+  it("空のパートは無視する", () => {
+    expect(mergeSegmentTranscripts(["", "こんにちは", "  "])).toBe(
+      "こんにちは",
+    );
+  });
+});
@@ -0,0 +1,121 @@
+import { describe, it, expect } from "vitest";
+import {
+  compareFormatting,
+  decideFormatterBypass,
+  extractTranscriptFeatures,
+  isCleanupPreset,
+} from "@/pipeline/providers/formatting/format-bypass";
+import { DEFAULT_INSTRUCTIONS } from "@/pipeline/providers/formatting/formatter-prompt";
+
+const formattingPreset = {
+  type: "formatting" as const,
+  instructions: "「{{transcription}}」を自然で読みやすい日本語に整形してください。",
+  cleanupOnly: true,
+};
+
+describe("extractTranscriptFeatures", () => {
+  it("フィラー・繰り返し・句読点を数える", () => {
+    const features = extractTranscriptFeatures(
+      "えーと、明日の会議ですけど、あのー資料資料を送ります。",
+    );
+    expect(features.fillers).toBe(2);
+    expect(features.repeats).toBe(1);
+    expect(features.endsWithTerminal).toBe(true);
+    expect(features.latin).toBe(false);
+  });
+
+  it("英語では単語単位で判定する", () => {
+    const features = extractTranscriptFeatures("So um I I think we should ship it");
+    expect(features.latin).toBe(true);
+    expect(features.fillers).toBe(1);
+    expect(features.repeats).toBe(1);
+    expect(features.endsWithTerminal).toBe(false);
+  });
+});
+
+describe("decideFormatterBypass", () => {
+  it("短い返事と整った文はスキップする", () => {
+    expect(decideFormatterBypass("はい。", formattingPreset)).toMatchObject({
+      bypass: true,
+      reason: "short",
+    });
+    expect(
+      decideFormatterBypass("資料は明日の午前中に送ります。", formattingPreset),
+    ).toMatchObject({ bypass: true, reason: "clean" });
+    expect(
+      decideFormatterBypass("Sounds good, I'll send it tomorrow.", null),
+    ).toMatchObject({ bypass: true, reason: "clean" });
+  });
+
+  it("フィラーや句読点の欠落があれば整形する", () => {
+    expect(
+      decideFormatterBypass("えっと資料を送ります。", formattingPreset).reason,
+    ).toBe("fillers");
+    expect(
+      decideFormatterBypass("明日の会議の資料を午前中に送ります", formattingPreset)
+        .reason,
+    ).toBe("unpunctuated");
+    expect(
+      decideFormatterBypass(
+        "明日の会議で使う資料を午前中までにまとめてチームのみんなに共有しておきます。",
+        formattingPreset,
+      ).reason,
+    ).toBe("long_clause");
+  });
+
+  it("辞書の読みを含む場合は整形する", () => {
+    const decision = decideFormatterBypass("すらすらを使います。", formattingPreset, [
+      { word: "surasura", readings: ["すらすら"] },
+    ]);
+    expect(decision).toMatchObject({ bypass: false, reason: "dictionary" });
+  });
+
+  it("整形のみのプリセットとデフォルト指示だけをスキップ対象にする", () => {
+    expect(isCleanupPreset(null)).toBe(true);
+    expect(isCleanupPreset(formattingPreset)).toBe(true);
+    expect(
+      isCleanupPreset({ type: "formatting", instructions: DEFAULT_INSTRUCTIONS }),
+    ).toBe(true);
+    expect(isCleanupPreset({ type: "formatting", instructions: "" })).toBe(true);
+  });
+
+  it("文体を変えるプリセットや回答プリセットでは整形する", () => {
+    // Free-form instructions are not guessed at without the flag
+    for (const instructions of ["です・ます調で", "Slack向けに絵文字を付けて", "敬体"]) {
+      expect(isCleanupPreset({ type: "formatting", instructions })).toBe(false);
+      expect(
+        decideFormatterBypass("はい。", { type: "formatting", instructions }),
+      ).toMatchObject({ bypass: false, reason: "preset" });
+    }
+    expect(
+      isCleanupPreset({
+        type: "formatting",
+        instructions: "{{clipboard}} への返信として整形してください",
+        cleanupOnly: true,
+      }),
+    ).toBe(false);
+    expect(
+      isCleanupPreset({ type: "answering", instructions: "", cleanupOnly: true }),
+    ).toBe(false);
+    expect(decideFormatterBypass("はい。", { type: "answering", instructions: "" }))
+      .toMatchObject({ bypass: false, reason: "preset" });
+  });
+});
+
+describe("compareFormatting", () => {
+  it("整形結果との差を分類する", () => {
+    expect(compareFormatting("資料を送ります。", "資料を送ります。 ")).toBe(
+      "identical",
+    );
+    expect(compareFormatting("資料を送ります", "資料を送ります。")).toBe(
+      "punctuation",
+    );
+    expect(
+      compareFormatting(
+        "明日の午前中に資料を送ります。よろしくお願いします。",
+        "明日の午前中に資料をお送りします。よろしくお願いします。",
+      ),
+    ).toBe("minor");
+    expect(compareFormatting("はい。", "承知しました。")).toBe("changed");
+  });
+});
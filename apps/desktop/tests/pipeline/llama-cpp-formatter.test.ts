@@ -0,0 +1,270 @@
+import { describe, it, expect, beforeAll, afterAll } from "vitest";
+import fs from "node:fs";
+import http from "node:http";
+import os from "node:os";
+import path from "node:path";
+import type { AddressInfo } from "node:net";
+import { LlamaCppFormatter } from "@/pipeline/providers/formatting/llama-cpp-formatter";
+import { constructFormatterPrompt } from "@/pipeline/providers/formatting/formatter-prompt";
+import {
+  LlamaServer,
+  validateLlamaCppFile,
+} from "@/services/platform/llama-server";
+import type { FormatParams } from "@/pipeline/core/pipeline-types";
+
+const DICTIONARY: NonNullable<FormatParams["context"]["dictionaryEntries"]> = [
+  { word: "surasura", readings: ["すらすら"] },
+  { word: "Whisper", readings: ["うぃすぱー"] },
+];
+
+/**
+ * Minimal llama-server stand-in streaming a fixed completion
+ */
+function startMockLlamaServer(chunks: string[], status = 200) {
+  const requests: Record<string, unknown>[] = [];
+  const server = http.createServer((req, res) => {
+    let body = "";
+    req.on("data", (data) => (body += data));
+    req.on("end", () => {
+      requests.push(JSON.parse(body));
+      if (status !== 200) {
+        res.writeHead(status).end();
+        return;
+      }
+      res.writeHead(200, { "Content-Type": "text/event-stream" });
+      const events = [
+        { choices: [{ delta: { role: "assistant", content: null } }] },
+        ...chunks.map((content) => ({ choices: [{ delta: { content } }] })),
+        {
+          choices: [{ delta: {}, finish_reason: "stop" }],
+          timings: {
+            cache_n: 120,
+            prompt_n: 18,
+            predicted_n: chunks.length,
+            predicted_per_second: 42.5,
+          },
+        },
+      ];
+      // Split one event across writes, as a real stream may
+      const payload =
+        events.map((event) => `data: ${JSON.stringify(event)}\n\n`).join("") +
+        "data: [DONE]\n\n";
+      const half = Math.floor(payload.length / 2);
+      res.write(payload.slice(0, half));
+      setTimeout(() => res.end(payload.slice(half)), 5);
+    });
+  });
+  return new Promise<{ url: string; requests: typeof requests; close: () => void }>(
+    (resolve) => {
+      server.listen(0, "127.0.0.1", () => {
+        const { port } = server.address() as AddressInfo;
+        resolve({
+          url: `http://127.0.0.1:${port}`,
+          requests,
+          close: () => server.close(),
+        });
+      });
+    },
+  );
+}
+
+function params(text: string): FormatParams {
+  return { text, context: { dictionaryEntries: DICTIONARY } };
+}
+
+describe("LlamaCppFormatter", () => {
+  let mock: Awaited<ReturnType<typeof startMockLlamaServer>>;
+
+  beforeAll(async () => {
+    mock = await startMockLlamaServer([
+      "<formatted_",
+      "text>すらすらで入力します。",
+      "</formatted_text>",
+    ]);
+  });
+
+  afterAll(() => mock.close());
+
+  it("ストリームを連結して formatted_text を取り出し、統計を記録する", async () => {
+    const formatter = new LlamaCppFormatter({
+      ensureStarted: async () => mock.url,
+    });
+
+    const result = await formatter.formatOrThrow(params("すらすらで入力します"));
+
+    expect(result).toBe("すらすらで入力します。");
+    expect(formatter.lastStats).toMatchObject({
+      cachedPromptTokens: 120,
+      evaluatedPromptTokens: 18,
+      generatedTokens: 3,
+      tokensPerSecond: 42.5,
+    });
+    expect(formatter.lastStats?.ttftMs).toBeGreaterThanOrEqual(0);
+
+    const request = mock.requests.at(-1)!;
+    expect(request).toMatchObject({ stream: true, cache_prompt: true });
+    expect(request.messages).toEqual([
+      { role: "system", content: expect.stringContaining("辞書置換ルール") },
+      { role: "user", content: "すらすらで入力します" },
+    ]);
+  });
+
+  it("サーバーエラーは呼び出し元に伝え、format() では元のテキストを返す", async () => {
+    const failing = await startMockLlamaServer([], 503);
+    const formatter = new LlamaCppFormatter({
+      ensureStarted: async () => failing.url,
+    });
+
+    await expect(formatter.formatOrThrow(params("テスト"))).rejects.toThrow(
+      "503",
+    );
+    expect(await formatter.format(params("テスト"))).toBe("テスト");
+    failing.close();
+  });
+
+  it("読み込み中のサーバーは待ち切らずに失敗し、次の整形に譲る", async () => {
+    const formatter = new LlamaCppFormatter(
+      { ensureStarted: () => new Promise<string>(() => {}) },
+      "local",
+      { startupWaitMs: 20 },
+    );
+
+    await expect(formatter.formatOrThrow(params("テスト"))).rejects.toThrow(
+      "still loading",
+    );
+  });
+
+  it("応答しないサーバーへの要求はタイムアウトする", async () => {
+    const stalled = http.createServer(() => {});
+    await new Promise<void>((resolve) =>
+      stalled.listen(0, "127.0.0.1", resolve),
+    );
+    const { port } = stalled.address() as AddressInfo;
+    const formatter = new LlamaCppFormatter(
+      { ensureStarted: async () => `http://127.0.0.1:${port}` },
+      "local",
+      { requestTimeoutMs: 50 },
+    );
+
+    await expect(formatter.formatOrThrow(params("テスト"))).rejects.toThrow(
+      "timed out",
+    );
+    stalled.closeAllConnections();
+    stalled.close();
+  });
+});
+
+describe("LlamaServer", () => {
+  it("通常ファイル以外や .gguf 以外のモデルを受け付けない", () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), "llama-server-test-"));
+    const text = path.join(dir, "model.txt");
+    fs.writeFileSync(text, "");
+    try {
+      expect(() => validateLlamaCppFile("server", dir)).toThrow(
+        "not a regular file",
+      );
+      expect(() => validateLlamaCppFile("model", text)).toThrow(".gguf");
+      expect(() =>
+        validateLlamaCppFile("server", path.join(dir, "missing")),
+      ).toThrow("not found");
+    } finally {
+      fs.rmSync(dir, { recursive: true, force: true });
+    }
+  });
+
+  it("起動に失敗した直後は起動し直さずに同じエラーを返す", async () => {
+    const server = new LlamaServer({
+      serverPath: path.join(os.tmpdir(), "missing-llama-server"),
+      modelPath: path.join(os.tmpdir(), "missing.gguf"),
+    });
+
+    const first = await server.ensureStarted().catch((error) => error);
+    const second = await server.ensureStarted().catch((error) => error);
+    expect(first).toBeInstanceOf(Error);
+    expect(second).toBe(first);
+  });
+});
+
+describe("constructFormatterPrompt", () => {
+  it("発話ごとに変わる指示より前の部分は同じになる（プレフィックスキャッシュ用）", () => {
+    const first = constructFormatterPrompt(
+      { dictionaryEntries: DICTIONARY },
+      null,
+      "一つ目の発話",
+    ).systemPrompt;
+    const second = constructFormatterPrompt(
+      { dictionaryEntries: DICTIONARY },
+      null,
+      "二つ目の発話",
+    ).systemPrompt;
+
+    const marker = "## ユーザーからの指示";
+    const prefix = first.slice(0, first.indexOf(marker));
+    expect(prefix).toContain("辞書置換ルール");
+    expect(second.startsWith(prefix)).toBe(true);
+  });
+});
+
+describe.skipIf(!process.env.LLAMA_BENCH)("ローカル整形ベンチ", () => {
+  it(
+    "llama-server で TTFT とトークン/秒を計測する",
+    async () => {
+      const serverPath = process.env.LLAMA_SERVER_PATH;
+      const modelPath = process.env.LLAMA_MODEL_PATH;
+      if (!serverPath || !modelPath) {
+        throw new Error("Set LLAMA_SERVER_PATH and LLAMA_MODEL_PATH");
+      }
+      const threads = process.env.LLAMA_THREADS
+        ? Number(process.env.LLAMA_THREADS)
+        : undefined;
+
+      const server = new LlamaServer({ serverPath, modelPath, threads });
+      // Generation on a slow CPU may exceed the app's request timeout
+      const formatter = new LlamaCppFormatter(server, "local", {
+        requestTimeoutMs: 5 * 60_000,
+      });
+      const utterances = [
+        "えーと今日の会議の資料をあのー明日までに送ります",
+        "すらすらの設定画面からうぃすぱーのモデルを選んでください",
+        "なんか来週の予定がまだ決まってないのでまた連絡します",
+        "えー新しい機能のリリースは月末を予定しています",
+        "あのー先ほどの件ですがやっぱり金曜日にしましょう",
+        "テストが全部通ったらマージしてもらって大丈夫です",
+      ];
+
+      try {
+        const start = performance.now();
+        await server.ensureStarted();
+        const startupMs = performance.now() - start;
+
+        const rows: string[] = [];
+        const warm = { ttft: [] as number[], tps: [] as number[] };
+        for (const [i, text] of utterances.entries()) {
+          await formatter.formatOrThrow(params(text));
+          const stats = formatter.lastStats!;
+          rows.push(
+            `#${i} ttft ${stats.ttftMs?.toFixed(0)}ms, ` +
+              `total ${stats.totalMs.toFixed(0)}ms, ` +
+              `prompt ${stats.evaluatedPromptTokens} evaluated / ` +
+              `${stats.cachedPromptTokens ?? "?"} cached, ` +
+              `${stats.tokensPerSecond?.toFixed(1)} tok/s`,
+          );
+          if (i > 0 && stats.ttftMs !== null) warm.ttft.push(stats.ttftMs);
+          if (stats.tokensPerSecond !== null) warm.tps.push(stats.tokensPerSecond);
+        }
+
+        const median = (values: number[]) =>
+          [...values].sort((a, b) => a - b)[Math.floor(values.length / 2)];
+        console.log(
+          `llama-server startup ${startupMs.toFixed(0)}ms\n` +
+            rows.join("\n") +
+            `\nwarm prefix: median ttft ${median(warm.ttft).toFixed(0)}ms, ` +
+            `median ${median(warm.tps).toFixed(1)} tok/s`,
+        );
+      } finally {
+        server.stop();
+      }
+    },
+    10 * 60_000,
+  );
+});
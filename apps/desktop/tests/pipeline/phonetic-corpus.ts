@@ -0,0 +1,87 @@
+import type { PhoneticVocabularyEntry } from "@/pipeline/core/phonetic-matcher";
+
+/**
+ * Labelled corpus for the phonetic matcher: Whisper-style near-misses of
+ * vocabulary terms, and sentences that must come through unchanged
+ */
+
+export const CORPUS_VOCABULARY: PhoneticVocabularyEntry[] = [
+  { word: "surasura", readings: ["すらすら"] },
+  { word: "Kubernetes", readings: ["クバネティス", "クーベルネテス"] },
+  { word: "サーバーレス" },
+  { word: "Whisper", readings: ["ウィスパー"] },
+  { word: "東京都庁", readings: ["とうきょうとちょう"] },
+  { word: "PostgreSQL", readings: ["ポストグレスキューエル", "ポスグレ"] },
+  { word: "Terraform", readings: ["テラフォーム"] },
+  { word: "アクセシビリティ" },
+  { word: "ダッシュボード" },
+  { word: "田中一郎", readings: ["たなかいちろう"] },
+  { word: "Slack", readings: ["スラック"] },
+  { word: "GitHub", readings: ["ギットハブ"] },
+];
+
+export interface LabelledCase {
+  input: string;
+  expected: string;
+}
+
+export const LABELLED_CORPUS: LabelledCase[] = [
+  // Script variants
+  { input: "スラスラで入力します", expected: "surasuraで入力します" },
+  { input: "sura sura を使う", expected: "surasura を使う" },
+  { input: "たなかいちろうさんに連絡", expected: "田中一郎さんに連絡" },
+  { input: "とうきょうとちょうに行く", expected: "東京都庁に行く" },
+  // Long vowels and small kana
+  { input: "サーバレスの構成", expected: "サーバーレスの構成" },
+  { input: "ウイスパーで文字起こし", expected: "Whisperで文字起こし" },
+  { input: "ダッシュボドを開く", expected: "ダッシュボードを開く" },
+  { input: "アクセシビリテイの改善", expected: "アクセシビリティの改善" },
+  // One-sound slips
+  { input: "クバネテスにデプロイ", expected: "Kubernetesにデプロイ" },
+  { input: "クーベルネティスの話", expected: "Kubernetesの話" },
+  { input: "テラホームで管理する", expected: "Terraformで管理する" },
+  { input: "ポストグレスキューエルに移行", expected: "PostgreSQLに移行" },
+  // Must stay unchanged
+  { input: "今日はいい天気ですね", expected: "今日はいい天気ですね" },
+  { input: "surasura は正しい", expected: "surasura は正しい" },
+  { input: "サーバーの再起動をお願いします", expected: "サーバーの再起動をお願いします" },
+  { input: "すらっと書ける", expected: "すらっと書ける" },
+  { input: "タスクを片付ける", expected: "タスクを片付ける" },
+  { input: "テラスで食事", expected: "テラスで食事" },
+  { input: "田中さんと話した", expected: "田中さんと話した" },
+  { input: "東京に行く", expected: "東京に行く" },
+];
+
+export interface CorpusScore {
+  total: number;
+  correct: number;
+  // Cases changed that should have been left alone
+  falsePositives: number;
+  // Cases with a term that was not (fully) corrected
+  misses: number;
+  failures: { input: string; expected: string; actual: string }[];
+}
+
+export function scoreCorpus(
+  correct: (text: string) => string,
+  corpus: LabelledCase[] = LABELLED_CORPUS,
+): CorpusScore {
+  const score: CorpusScore = {
+    total: corpus.length,
+    correct: 0,
+    falsePositives: 0,
+    misses: 0,
+    failures: [],
+  };
+  for (const { input, expected } of corpus) {
+    const actual = correct(input);
+    if (actual === expected) {
+      score.correct++;
+      continue;
+    }
+    if (input === expected) score.falsePositives++;
+    else score.misses++;
+    score.failures.push({ input, expected, actual });
+  }
+  return score;
+}
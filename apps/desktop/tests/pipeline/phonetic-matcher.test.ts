@@ -0,0 +1,177 @@
+import { describe, it, expect } from "vitest";
+import {
+  PhoneticMatcher,
+  DeletionIndex,
+  levenshtein,
+  phoneticKey,
+  romajiToHiragana,
+} from "@/pipeline/core/phonetic-matcher";
+import {
+  CORPUS_VOCABULARY,
+  LABELLED_CORPUS,
+  scoreCorpus,
+} from "./phonetic-corpus";
+
+describe("phoneticKey", () => {
+  it("カタカナ・長音・小書き文字を揃える", () => {
+    expect(phoneticKey("サーバー")).toBe(phoneticKey("さば"));
+    expect(phoneticKey("ウィスパー")).toBe(phoneticKey("ウイスパ"));
+  });
+
+  it("外来音を近い音に揃える", () => {
+    expect(phoneticKey("テラフォーム")).toBe(phoneticKey("テラホーム"));
+    expect(phoneticKey("ヴァイオリン")).toBe(phoneticKey("バイオリン"));
+  });
+
+  it("ローマ字をひらがなに変換する", () => {
+    expect(phoneticKey("Sura Sura")).toBe("すらすら");
+  });
+});
+
+describe("romajiToHiragana", () => {
+  it("促音と撥音を扱う", () => {
+    expect(romajiToHiragana("gakkou")).toBe("がっこう");
+    expect(romajiToHiragana("shinbun")).toBe("しんぶん");
+    expect(romajiToHiragana("konnichiwa")).toBe("こんにちわ");
+  });
+
+  it("ローマ字でない文字列はnullを返す", () => {
+    expect(romajiToHiragana("GPT4")).toBeNull();
+    expect(romajiToHiragana("すらすら")).toBeNull();
+  });
+});
+
+describe("DeletionIndex", () => {
+  it("編集距離の範囲内のキーだけを返す", () => {
+    const index = new DeletionIndex(2);
+    for (const key of ["くばねてす", "てらほむ", "だつしゆぼど"]) {
+      index.add(key);
+    }
+
+    expect(index.search("くばねちす", 1)).toEqual([
+      { key: "くばねてす", distance: 1 },
+    ]);
+    expect(index.search("くばねちす", 0)).toEqual([]);
+    expect(index.search("だしゆぼど", 2)).toEqual([
+      { key: "だつしゆぼど", distance: 1 },
+    ]);
+  });
+
+  it("総当たりと同じ結果を返す", () => {
+    const keys = [
+      "あいうえお",
+      "あいうえ",
+      "かきくけこ",
+      "あかいえお",
+      "いうえおあ",
+    ];
+    const index = new DeletionIndex(2);
+    keys.forEach((key) => index.add(key));
+
+    for (const query of ["あいうお", "あいうえおか", "かきけこ", "いうえ"]) {
+      const expected = keys.filter((key) => levenshtein(query, key) <= 2).sort();
+      const actual = index
+        .search(query, 2)
+        .map((match) => match.key)
+        .sort();
+      expect(actual).toEqual(expected);
+    }
+  });
+});
+
+describe("PhoneticMatcher", () => {
+  const matcher = new PhoneticMatcher(CORPUS_VOCABULARY);
+
+  it("表記ゆれを語彙の単語に置き換える", () => {
+    const { text, corrections } = matcher.correct("クバネテスにデプロイ");
+    expect(text).toBe("Kubernetesにデプロイ");
+    expect(corrections).toEqual([
+      expect.objectContaining({ index: 0, from: "クバネテス", distance: 1 }),
+    ]);
+  });
+
+  it("長音記号を置換範囲に含める", () => {
+    expect(matcher.correct("ウイスパーで文字起こし").text).toBe(
+      "Whisperで文字起こし",
+    );
+  });
+
+  it("すでに正しい表記は報告しない", () => {
+    expect(matcher.correct("surasura は正しい").corrections).toEqual([]);
+  });
+
+  it("しきい値未満の一致は置き換えない", () => {
+    const strict = new PhoneticMatcher(CORPUS_VOCABULARY, { threshold: 0.9 });
+    expect(strict.correct("クバネテスにデプロイ").text).toBe(
+      "クバネテスにデプロイ",
+    );
+  });
+
+  it("短い語は完全一致のみ", () => {
+    const short = new PhoneticMatcher([{ word: "Rust", readings: ["ラスト"] }]);
+    expect(short.correct("ラストで書く").text).toBe("Rustで書く");
+    expect(short.correct("ラフトで書く").text).toBe("ラフトで書く");
+  });
+
+  it("語彙が空なら何もしない", () => {
+    const empty = new PhoneticMatcher([]);
+    expect(empty.size).toBe(0);
+    expect(empty.correct("クバネテス").text).toBe("クバネテス");
+  });
+
+  it("ラベル付きコーパスをすべて正しく補正する", () => {
+    const score = scoreCorpus((text) => matcher.correct(text).text);
+    expect(score.failures).toEqual([]);
+    expect(score.correct).toBe(LABELLED_CORPUS.length);
+  });
+});
+
+// Per-segment cost with a full 500-entry vocabulary; run with
+// `pnpm bench:vocabulary`
+describe.skipIf(!process.env.VOCABULARY_BENCH)("語彙補正ベンチ", () => {
+  it("500語の語彙でセグメントごとの補正時間を計測する", () => {
+    const kana = "あいうえおかきくけこさしすせそたちつてとなにぬねのはひふへほまみむめもらりるれろ";
+    let seed = 1;
+    const random = () => (seed = (seed * 48271) % 0x7fffffff) / 0x7fffffff;
+
+    const entries = [...CORPUS_VOCABULARY];
+    for (let i = entries.length; i < 500; i++) {
+      let reading = "";
+      const length = 3 + Math.floor(random() * 6);
+      for (let j = 0; j < length; j++) {
+        reading += kana[Math.floor(random() * kana.length)];
+      }
+      entries.push({ word: `用語${i}`, readings: [reading] });
+    }
+
+    let start = performance.now();
+    const matcher = new PhoneticMatcher(entries);
+    const buildMs = performance.now() - start;
+
+    // Whisper segments are a sentence or two
+    const segments = LABELLED_CORPUS.map(({ input }) => input.repeat(4));
+    const timings: number[] = [];
+    for (let round = 0; round < 20; round++) {
+      for (const segment of segments) {
+        start = performance.now();
+        matcher.correct(segment);
+        timings.push(performance.now() - start);
+      }
+    }
+    timings.sort((a, b) => a - b);
+    const p50 = timings[Math.floor(timings.length * 0.5)];
+    const p99 = timings[Math.floor(timings.length * 0.99)];
+
+    const score = scoreCorpus((text) => matcher.correct(text).text);
+    console.log(
+      `vocabulary: ${entries.length} entries, build ${buildMs.toFixed(1)}ms\n` +
+        `per segment (~${segments[0].length} chars): ` +
+        `p50 ${p50.toFixed(2)}ms, p99 ${p99.toFixed(2)}ms\n` +
+        `corpus: ${score.correct}/${score.total} correct, ` +
+        `${score.falsePositives} false positives, ${score.misses} misses`,
+    );
+
+    expect(p50).toBeLessThan(10);
+    expect(score.falsePositives).toBe(0);
+  });
+});
@@ -0,0 +1,225 @@
+import { describe, it, expect, beforeEach } from "vitest";
+import {
+  ProviderRouter,
+  type RouteTarget,
+} from "@/pipeline/core/provider-router";
+
+/** Target answering `value` after `delayMs`, or failing; counts calls */
+function target(
+  key: string,
+  value: string,
+  delayMs: number | (() => number),
+  fail = false,
+) {
+  const calls = { started: 0, aborted: 0 };
+  const route: RouteTarget<string> = {
+    key,
+    run: async (signal) => {
+      calls.started++;
+      const delay = typeof delayMs === "function" ? delayMs() : delayMs;
+      await new Promise<void>((resolve, reject) => {
+        const timer = setTimeout(resolve, delay);
+        signal.addEventListener("abort", () => {
+          clearTimeout(timer);
+          calls.aborted++;
+          reject(new Error("aborted"));
+        });
+      });
+      if (fail) throw new Error(`${key} failed`);
+      return value;
+    },
+  };
+  return { route, calls };
+}
+
+describe("ProviderRouter", () => {
+  let router: ProviderRouter;
+
+  beforeEach(() => {
+    ProviderRouter.resetInstance();
+    router = ProviderRouter.getInstance();
+  });
+
+  it("正常時は優先ターゲットだけを呼ぶ", async () => {
+    const primary = target("a", "A", 1);
+    const backup = target("b", "B", 1);
+
+    const result = await router.route([primary.route, backup.route], {
+      kind: "formatting",
+      sessionId: "s1",
+    });
+
+    expect(result).toBe("A");
+    expect(backup.calls.started).toBe(0);
+    expect(router.takeSessionDecisions("s1")).toEqual([]);
+  });
+
+  it("失敗したら次のターゲットにフォールバックする", async () => {
+    const primary = target("a", "A", 1, true);
+    const backup = target("b", "B", 1);
+
+    const result = await router.route([primary.route, backup.route], {
+      kind: "formatting",
+      sessionId: "s1",
+    });
+
+    expect(result).toBe("B");
+    expect(router.takeSessionDecisions("s1")).toEqual([
+      { kind: "formatting", decision: "fallback", target: "b" },
+    ]);
+  });
+
+  it("すべて失敗したら最後のエラーで失敗する", async () => {
+    const primary = target("a", "A", 1, true);
+    const backup = target("b", "B", 1, true);
+
+    await expect(
+      router.route([primary.route, backup.route], { kind: "formatting" }),
+    ).rejects.toThrow("b failed");
+  });
+
+  it("p95を超えたらヘッジし、先に返った方を採用して他を中断する", async () => {
+    let delay = 5;
+    const primary = target("a", "A", () => delay);
+    const backup = target("b", "B", 5);
+
+    // Warm up the latency window (~5 ms)
+    for (let i = 0; i < 10; i++) {
+      await router.route([primary.route], { kind: "transcription" });
+    }
+
+    delay = 500;
+    const result = await router.route([primary.route, backup.route], {
+      kind: "transcription",
+      sessionId: "s1",
+      hedge: true,
+    });
+
+    expect(result).toBe("B");
+    expect(primary.calls.aborted).toBe(1);
+    expect(router.takeSessionDecisions("s1").map((d) => d.decision)).toEqual([
+      "hedge",
+      "hedge_won",
+    ]);
+  });
+
+  it("代替がなければ同じターゲットに重複リクエストを送る", async () => {
+    // The 11th call stalls; its duplicate (the 12th) answers normally
+    let call = 0;
+    const flaky = target("a", "A", () => (++call === 11 ? 500 : 5));
+
+    for (let i = 0; i < 10; i++) {
+      await router.route([flaky.route], { kind: "transcription" });
+    }
+    const start = performance.now();
+    const result = await router.route([flaky.route], {
+      kind: "transcription",
+      hedge: true,
+    });
+
+    expect(result).toBe("A");
+    expect(flaky.calls.started).toBe(12);
+    expect(performance.now() - start).toBeLessThan(400);
+  });
+
+  it("フォールバック後は失敗したターゲットにヘッジしない", async () => {
+    let failing = false;
+    let started = 0;
+    const primary: RouteTarget<string> = {
+      key: "a",
+      run: async () => {
+        started++;
+        await new Promise((resolve) => setTimeout(resolve, 5));
+        if (failing) throw new Error("a failed");
+        return "A";
+      },
+    };
+    const slowBackup = target("b", "B", 400);
+
+    // Warm up the latency window (~5 ms): hedge delay is the 250 ms floor
+    for (let i = 0; i < 10; i++) {
+      await router.route([primary], { kind: "transcription" });
+    }
+
+    failing = true;
+    const result = await router.route([primary, slowBackup.route], {
+      kind: "transcription",
+      sessionId: "s1",
+      hedge: true,
+    });
+
+    expect(result).toBe("B");
+    expect(started).toBe(11);
+    expect(router.takeSessionDecisions("s1").map((d) => d.decision)).toEqual([
+      "fallback",
+    ]);
+  });
+
+  it("ヘッジ不可のターゲットには重複リクエストを送らない", async () => {
+    let call = 0;
+    const local = target("local", "L", () => (++call === 11 ? 400 : 5));
+    const route = { ...local.route, hedge: false };
+
+    for (let i = 0; i < 10; i++) {
+      await router.route([route], { kind: "formatting" });
+    }
+    const result = await router.route([route], {
+      kind: "formatting",
+      hedge: true,
+    });
+
+    expect(result).toBe("L");
+    expect(local.calls.started).toBe(11);
+  });
+
+  it("連続失敗でサーキットを開き、そのターゲットを飛ばす", async () => {
+    const broken = target("a", "A", 1, true);
+    const backup = target("b", "B", 1);
+
+    for (let i = 0; i < 3; i++) {
+      await router.route([broken.route, backup.route], { kind: "formatting" });
+    }
+    expect(broken.calls.started).toBe(3);
+
+    const result = await router.route([broken.route, backup.route], {
+      kind: "formatting",
+      sessionId: "s1",
+    });
+
+    expect(result).toBe("B");
+    expect(broken.calls.started).toBe(3);
+    expect(router.takeSessionDecisions("s1")).toEqual([
+      { kind: "formatting", decision: "skip_open", target: "a" },
+    ]);
+    const health = router.getHealthSnapshot().find((h) => h.key === "a");
+    expect(health?.state).toBe("open");
+  });
+
+  it("すべてのサーキットが開いていても優先ターゲットを試す", async () => {
+    const broken = target("a", "A", 1, true);
+    for (let i = 0; i < 3; i++) {
+      await router.route([broken.route], { kind: "formatting" }).catch(() => {});
+    }
+
+    await expect(
+      router.route([broken.route], { kind: "formatting", sessionId: "s1" }),
+    ).rejects.toThrow("a failed");
+    expect(broken.calls.started).toBe(4);
+    expect(router.takeSessionDecisions("s1").map((d) => d.decision)).toEqual([
+      "skip_open",
+      "forced",
+    ]);
+  });
+
+  it("セッションの判断記録は取り出すと消える", async () => {
+    const primary = target("a", "A", 1, true);
+    const backup = target("b", "B", 1);
+    await router.route([primary.route, backup.route], {
+      kind: "formatting",
+      sessionId: "s1",
+    });
+
+    expect(router.takeSessionDecisions("s1")).toHaveLength(1);
+    expect(router.takeSessionDecisions("s1")).toEqual([]);
+  });
+});
@@ -0,0 +1,62 @@
+import { describe, it, expect } from "vitest";
+import {
+  buildRecognitionPrompt,
+  estimateTokens,
+  WHISPER_PROMPT_TOKEN_LIMIT,
+} from "@/pipeline/providers/transcription/recognition-prompt";
+
+describe("buildRecognitionPrompt", () => {
+  it("語彙と直近のテキストを連結する", () => {
+    const prompt = buildRecognitionPrompt({
+      vocabulary: ["surasura", "Whisper"],
+      recentText: "今日は晴れです。",
+    });
+    expect(prompt).toBe("surasura, Whisper 今日は晴れです。");
+  });
+
+  it("長いセッションでもトークン予算内に収まる", () => {
+    const recentText = "会議の議事録を作成します。".repeat(200);
+    const vocabulary = Array.from({ length: 500 }, (_, i) => `用語${i}`);
+
+    const prompt = buildRecognitionPrompt({ vocabulary, recentText });
+
+    expect(estimateTokens(prompt)).toBeLessThanOrEqual(
+      WHISPER_PROMPT_TOKEN_LIMIT,
+    );
+    // Most recent text is kept
+    expect(prompt.endsWith("会議の議事録を作成します。")).toBe(true);
+  });
+
+  it("直近のテキストに出現する語彙を優先する", () => {
+    const vocabulary = Array.from({ length: 200 }, (_, i) => `term${i}`);
+    vocabulary.push("Kubernetes");
+
+    const prompt = buildRecognitionPrompt({
+      vocabulary,
+      recentText: "we deployed it to kubernetes yesterday",
+    });
+
+    expect(prompt.startsWith("Kubernetes, ")).toBe(true);
+  });
+
+  it("重複と空の語彙を除外する", () => {
+    const prompt = buildRecognitionPrompt({
+      vocabulary: ["API", " ", "API", "SDK"],
+    });
+    expect(prompt).toBe("API, SDK");
+  });
+
+  it("切り詰めたテキストは区切り文字の直後から始める", () => {
+    // 30 tokens ≈ 20 kana: "ささささ。" + 15 × "あ" → cut after "。"
+    const recentText = "さ".repeat(100) + "。" + "あ".repeat(15);
+    const prompt = buildRecognitionPrompt({ recentText, maxTokens: 30 });
+
+    expect(prompt).toBe("あ".repeat(15));
+  });
+
+  it("語彙がない場合は予算全体をテキストに使う", () => {
+    const recentText = "x".repeat(2000);
+    const prompt = buildRecognitionPrompt({ recentText });
+    expect(prompt.length).toBe(WHISPER_PROMPT_TOKEN_LIMIT * 4);
+  });
+});
@@ -0,0 +1,99 @@
+import { describe, it, expect } from "vitest";
+import { SilenceGate } from "@/pipeline/core/silence-gate";
+
+const SAMPLE_RATE = 16000;
+const FRAME_SIZE = 512;
+
+function createRandom(seed: number) {
+  let state = seed;
+  return () => (state = (state * 48271) % 0x7fffffff) / 0x7fffffff;
+}
+
+const random = createRandom(11);
+
+function noise(amplitude: number) {
+  return new Float32Array(FRAME_SIZE).map(
+    () => (random() * 2 - 1) * amplitude,
+  );
+}
+
+function tone(frequency: number, amplitude: number) {
+  return new Float32Array(FRAME_SIZE).map(
+    (_, i) => amplitude * Math.sin((2 * Math.PI * frequency * i) / SAMPLE_RATE),
+  );
+}
+
+/** Gate a frame, scoring the ones it lets through as the model would */
+function feed(gate: SilenceGate, frame: Float32Array, isSpeech = false) {
+  const skipped = gate.shouldSkip(frame);
+  if (!skipped) gate.update(isSpeech);
+  return skipped;
+}
+
+describe("SilenceGate", () => {
+  it("デジタル無音は学習前からスキップする", () => {
+    const gate = new SilenceGate();
+    expect(feed(gate, new Float32Array(FRAME_SIZE))).toBe(true);
+  });
+
+  it("ノイズフロアを学習した後の定常ノイズをスキップする", () => {
+    const gate = new SilenceGate();
+    const verdicts = Array.from({ length: 20 }, () =>
+      feed(gate, noise(0.01)),
+    );
+    // Warm-up frames go to the model, the rest are skipped
+    expect(verdicts.slice(0, 4)).toEqual([false, false, false, false]);
+    expect(verdicts.slice(4).every(Boolean)).toBe(true);
+
+    expect(feed(gate, tone(200, 0.1), true)).toBe(false);
+  });
+
+  it("発話の直後はハングオーバー中モデルに渡し続ける", () => {
+    const gate = new SilenceGate();
+    for (let i = 0; i < 10; i++) feed(gate, noise(0.01));
+    expect(feed(gate, tone(200, 0.1), true)).toBe(false);
+
+    const verdicts = Array.from({ length: 10 }, () =>
+      feed(gate, noise(0.01)),
+    );
+    expect(verdicts.slice(0, 8).some(Boolean)).toBe(false);
+    expect(verdicts.slice(8).every(Boolean)).toBe(true);
+  });
+
+  it("発話直後のデジタル無音もハングオーバー中はモデルに渡す", () => {
+    const gate = new SilenceGate();
+    expect(feed(gate, tone(200, 0.1), true)).toBe(false);
+
+    const verdicts = Array.from({ length: 10 }, () =>
+      feed(gate, new Float32Array(FRAME_SIZE)),
+    );
+    expect(verdicts.slice(0, 8).some(Boolean)).toBe(false);
+    expect(verdicts.slice(8).every(Boolean)).toBe(true);
+  });
+
+  it("フロア付近でもゼロ交差率が変われば摩擦音としてモデルに渡す", () => {
+    // Low hum as room tone, then a white "s" at a similar level
+    const gate = new SilenceGate();
+    for (let i = 0; i < 10; i++) feed(gate, tone(120, 0.02));
+    expect(feed(gate, tone(120, 0.02))).toBe(true);
+    expect(feed(gate, noise(0.03))).toBe(false);
+  });
+
+  it("ノイズが大きくなってもフロアが追従する", () => {
+    const gate = new SilenceGate();
+    for (let i = 0; i < 10; i++) feed(gate, noise(0.005));
+    // 4x louder (12 dB): the model sees it until the floor has risen
+    const verdicts = Array.from({ length: 120 }, () =>
+      feed(gate, noise(0.02)),
+    );
+    expect(verdicts[0]).toBe(false);
+    expect(verdicts.slice(-20).every(Boolean)).toBe(true);
+  });
+
+  it("リセットで学習内容を捨てる", () => {
+    const gate = new SilenceGate();
+    for (let i = 0; i < 10; i++) feed(gate, noise(0.01));
+    gate.reset();
+    expect(feed(gate, noise(0.01))).toBe(false);
+  });
+});
@@ -0,0 +1,91 @@
+import { describe, it, expect } from "vitest";
+import {
+  compileTemplate,
+  renderTemplate,
+  replaceTemplateVariables,
+  resolveTemplateContext,
+  TEMPLATE_VARIABLES,
+} from "@/pipeline/providers/formatting/template-variables";
+import { compilePresetTemplate } from "@/pipeline/providers/formatting/formatter-prompt";
+import type { GetAccessibilityContextResult } from "@surasura/types";
+
+const axContext = {
+  context: { application: { name: "Slack" } },
+} as GetAccessibilityContextResult;
+
+describe("compileTemplate", () => {
+  it("参照している変数を列挙する", () => {
+    const template = compileTemplate("{{appName}}で{{transcription}}を整形");
+    expect([...template.variables]).toEqual(["appName", "transcription"]);
+    expect(template.nodes).toEqual([
+      { type: "variable", name: "appName" },
+      { type: "text", value: "で" },
+      { type: "variable", name: "transcription" },
+      { type: "text", value: "を整形" },
+    ]);
+  });
+
+  it("サポートされていない変数と不完全な括弧はテキストとして残す", () => {
+    const template = compileTemplate("{{unknown}} {{clipboard} {{{appName}}}");
+    expect([...template.variables]).toEqual(["appName"]);
+    expect(renderTemplate(template, { accessibilityContext: axContext })).toBe(
+      "{{unknown}} {{clipboard} {Slack}",
+    );
+  });
+
+  it("同じ文字列は再コンパイルしない", () => {
+    expect(compileTemplate("{{clipboard}}")).toBe(
+      compileTemplate("{{clipboard}}"),
+    );
+  });
+});
+
+describe("resolveTemplateContext", () => {
+  it("参照されていない取得元は呼び出さない", () => {
+    let clipboardReads = 0;
+    const context = resolveTemplateContext(compileTemplate("{{appName}}"), {
+      accessibilityContext: () => axContext,
+      clipboardText: () => {
+        clipboardReads++;
+        return "secret";
+      },
+    });
+
+    expect(clipboardReads).toBe(0);
+    expect(context.clipboardText).toBeUndefined();
+    expect(context.accessibilityContext).toBe(axContext);
+  });
+
+  it("大きなクリップボードは上限文字数で切り詰める", () => {
+    const limit = TEMPLATE_VARIABLES.clipboard.maxLength;
+    const context = resolveTemplateContext(compileTemplate("{{clipboard}}"), {
+      clipboardText: () => "あ".repeat(limit * 100),
+    });
+
+    expect(context.clipboardText).toHaveLength(limit + 1);
+    expect(context.clipboardText!.endsWith("…")).toBe(true);
+  });
+});
+
+describe("replaceTemplateVariables", () => {
+  it("従来どおり変数を置換する", () => {
+    expect(
+      replaceTemplateVariables("「{{transcription}}」({{clipboard}})", {
+        transcription: "こんにちは",
+        clipboardText: "メモ",
+      }),
+    ).toBe("「こんにちは」(メモ)");
+  });
+
+  it("コンテキストがない変数は空文字列になる", () => {
+    expect(replaceTemplateVariables("[{{appName}}]", {})).toBe("[]");
+  });
+});
+
+describe("compilePresetTemplate", () => {
+  it("指示が空ならデフォルト指示を使う", () => {
+    const template = compilePresetTemplate({ instructions: "  " });
+    expect(template.variables.has("transcription")).toBe(true);
+    expect(template.variables.has("clipboard")).toBe(false);
+  });
+});
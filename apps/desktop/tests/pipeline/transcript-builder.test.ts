@@ -0,0 +1,59 @@
+import { describe, it, expect } from "vitest";
+import { TranscriptBuilder } from "@/pipeline/core/transcript-builder";
+
+describe("TranscriptBuilder", () => {
+  it("追加したセグメントを連結して返す", () => {
+    const builder = new TranscriptBuilder();
+    builder.append("今日は");
+    builder.append("晴れです。");
+
+    expect(builder.text).toBe("今日は晴れです。");
+    expect(builder.count).toBe(2);
+    expect(builder.length).toBe(8);
+  });
+
+  it("空文字列は追加しない", () => {
+    const builder = new TranscriptBuilder();
+    builder.append("");
+    expect(builder.count).toBe(0);
+    expect(builder.text).toBe("");
+  });
+
+  it("負のインデックスで末尾のセグメントを取得する", () => {
+    const builder = new TranscriptBuilder();
+    builder.append("a");
+    builder.append("b");
+
+    expect(builder.at(-1)).toBe("b");
+    expect(builder.at(-2)).toBe("a");
+    expect(builder.at(-3)).toBeUndefined();
+  });
+
+  it("末尾から指定文字数だけを返す", () => {
+    const builder = new TranscriptBuilder();
+    builder.append("abcdef");
+    builder.append("ghij");
+
+    expect(builder.tail(5)).toBe("fghij");
+    expect(builder.tail(100)).toBe("abcdefghij");
+  });
+
+  it("追加後はキャッシュを更新する", () => {
+    const builder = new TranscriptBuilder();
+    builder.append("abc");
+    expect(builder.tail(2)).toBe("bc");
+    expect(builder.text).toBe("abc");
+
+    builder.append("de");
+    expect(builder.tail(2)).toBe("de");
+    expect(builder.text).toBe("abcde");
+  });
+
+  it("サロゲートペアの途中から始めない", () => {
+    const builder = new TranscriptBuilder();
+    builder.append("a😀b");
+    // "😀" is two code units; a 2-unit tail would start on its low half
+    expect(builder.tail(2)).toBe("b");
+    expect(builder.tail(3)).toBe("😀b");
+  });
+});
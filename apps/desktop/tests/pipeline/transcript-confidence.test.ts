@@ -0,0 +1,66 @@
+import { describe, it, expect } from "vitest";
+import {
+  applySpeechRatio,
+  combineConfidence,
+  speechRatio,
+  tokenLogprobConfidence,
+  whisperSegmentConfidence,
+} from "@/pipeline/core/transcript-confidence";
+
+describe("whisperSegmentConfidence", () => {
+  it("平均対数確率と無音確率から信頼度を計算する", () => {
+    expect(
+      whisperSegmentConfidence({ avg_logprob: -0.1, no_speech_prob: 0.01 }),
+    ).toBeCloseTo(Math.exp(-0.1) * 0.99);
+    expect(
+      whisperSegmentConfidence({ avg_logprob: -0.1, no_speech_prob: 0.9 }),
+    ).toBeLessThan(0.1);
+    expect(whisperSegmentConfidence({})).toBeNull();
+  });
+
+  it("圧縮率が高い（繰り返しの）セグメントは信頼度を下げる", () => {
+    const normal = whisperSegmentConfidence({
+      avg_logprob: -0.2,
+      compression_ratio: 1.5,
+    })!;
+    const looped = whisperSegmentConfidence({
+      avg_logprob: -0.2,
+      compression_ratio: 3.1,
+    })!;
+    expect(looped).toBeCloseTo(normal / 2);
+  });
+});
+
+describe("tokenLogprobConfidence", () => {
+  it("トークン確率の幾何平均を返す", () => {
+    expect(
+      tokenLogprobConfidence([{ logprob: Math.log(0.9) }, { logprob: Math.log(0.4) }]),
+    ).toBeCloseTo(0.6);
+    expect(tokenLogprobConfidence([])).toBeNull();
+    expect(tokenLogprobConfidence(undefined)).toBeNull();
+  });
+});
+
+describe("VADの発話率", () => {
+  it("発話フレームがほとんどない音声の信頼度を下げる", () => {
+    expect(speechRatio([0.9, 0.8, 0.05, 0.02])).toBe(0.5);
+    expect(speechRatio([])).toBe(0);
+
+    expect(applySpeechRatio(0.9, 0.5)).toBe(0.9);
+    expect(applySpeechRatio(0.9, 0.05)).toBeCloseTo(0.45);
+    expect(applySpeechRatio(0.9, 0)).toBe(0);
+  });
+});
+
+describe("combineConfidence", () => {
+  it("長さで重み付けした平均を返す", () => {
+    expect(
+      combineConfidence([
+        { confidence: 0.9, weight: 3000 },
+        { confidence: 0.3, weight: 1000 },
+      ]),
+    ).toBeCloseTo(0.75);
+    expect(combineConfidence([{ confidence: 0.5, weight: 0 }])).toBeNull();
+    expect(combineConfidence([])).toBeNull();
+  });
+});
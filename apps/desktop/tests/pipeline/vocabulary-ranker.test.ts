@@ -0,0 +1,162 @@
+import { describe, it, expect } from "vitest";
+import {
+  VocabularyIndex,
+  describeAppContext,
+  normalizeForMatching,
+  type RankableVocabularyEntry,
+} from "@/pipeline/core/vocabulary-ranker";
+import type { GetAccessibilityContextResult } from "@surasura/types";
+
+const NOW = new Date("2026-01-01T00:00:00Z").getTime();
+const DAY = 24 * 60 * 60 * 1000;
+
+function entry(
+  id: number,
+  word: string,
+  overrides: Partial<RankableVocabularyEntry> = {},
+): RankableVocabularyEntry {
+  return {
+    id,
+    word,
+    readings: [],
+    usageCount: 0,
+    updatedAt: new Date(NOW - 365 * DAY),
+    ...overrides,
+  };
+}
+
+describe("normalizeForMatching", () => {
+  it("カタカナをひらがなに、英字を小文字に揃える", () => {
+    expect(normalizeForMatching("スラスラ API")).toBe("すらすら api");
+  });
+
+  it("全角英数字を半角に揃える", () => {
+    expect(normalizeForMatching("ＧＰＴ４")).toBe("gpt4");
+  });
+});
+
+describe("VocabularyIndex", () => {
+  it("使用回数の多い単語を優先する", () => {
+    const index = new VocabularyIndex(
+      [
+        entry(1, "alpha"),
+        entry(2, "beta", { usageCount: 50 }),
+        entry(3, "gamma", { usageCount: 3 }),
+      ],
+      NOW,
+    );
+    expect(index.rank("", 3)).toEqual(["beta", "gamma", "alpha"]);
+  });
+
+  it("最近使われた単語を優先する", () => {
+    const index = new VocabularyIndex(
+      [entry(1, "old"), entry(2, "fresh", { updatedAt: new Date(NOW - DAY) })],
+      NOW,
+    );
+    expect(index.rank("", 1)).toEqual(["fresh"]);
+  });
+
+  it("直近の文字起こしに出現する単語を優先する", () => {
+    const index = new VocabularyIndex(
+      [
+        entry(1, "Kubernetes", { usageCount: 0 }),
+        entry(2, "Terraform", { usageCount: 100 }),
+      ],
+      NOW,
+    );
+    expect(index.rank("昨日kubernetesにデプロイした", 1)).toEqual([
+      "Kubernetes",
+    ]);
+  });
+
+  it("読みで文字起こしと一致する単語も優先する", () => {
+    const index = new VocabularyIndex(
+      [
+        entry(1, "鈴木", { usageCount: 10 }),
+        entry(2, "surasura", { readings: ["すらすら"] }),
+      ],
+      NOW,
+    );
+    // Katakana in the transcript matches the hiragana reading
+    expect(index.rank("スラスラで入力する", 1)).toEqual(["surasura"]);
+  });
+
+  it("アクティブなアプリの文脈に一致する単語を優先する", () => {
+    const index = new VocabularyIndex(
+      [entry(1, "Figma"), entry(2, "Notion"), entry(3, "Slack")],
+      NOW,
+    );
+    index.setAppContext("Notion - 議事録");
+    expect(index.rank("", 1)).toEqual(["Notion"]);
+
+    index.setAppContext("");
+    expect(index.rank("", 1)).toEqual(["Figma"]);
+  });
+
+  it("上位K件に絞り込む", () => {
+    const entries = Array.from({ length: 500 }, (_, i) => entry(i, `w${i}`));
+    const index = new VocabularyIndex(entries, NOW);
+    expect(index.rank("text", 10)).toHaveLength(10);
+    expect(index.rank("text", 0)).toEqual([]);
+  });
+
+  it("文字起こし結果に含まれる単語のIDを返す", () => {
+    const index = new VocabularyIndex(
+      [entry(7, "surasura"), entry(8, "Whisper"), entry(9, "未使用")],
+      NOW,
+    );
+    expect(index.findMentions("SuraSuraとwhisperを使う")).toEqual([7, 8]);
+  });
+
+  it("500件の語彙でも1回のランキングは1ms未満で終わる", () => {
+    const entries = Array.from({ length: 500 }, (_, i) =>
+      entry(i, `用語${i}`, {
+        readings: [`ようご${i}`],
+        usageCount: i % 17,
+        updatedAt: new Date(NOW - (i % 90) * DAY),
+      }),
+    );
+    const index = new VocabularyIndex(entries, NOW);
+    const recentText =
+      "今日の会議では用語12と用語345について話しました。".repeat(20);
+
+    // Warm up the JIT before timing
+    for (let i = 0; i < 100; i++) index.rank(recentText);
+
+    const iterations = 1000;
+    const start = performance.now();
+    for (let i = 0; i < iterations; i++) index.rank(recentText);
+    const perCallMs = (performance.now() - start) / iterations;
+
+    expect(perCallMs).toBeLessThan(1);
+    expect(index.rank(recentText)).toContain("用語345");
+  });
+});
+
+describe("describeAppContext", () => {
+  it("アプリ名・ウィンドウ・カーソル周辺のテキストを連結する", () => {
+    const context = {
+      context: {
+        application: { name: "Slack" },
+        windowInfo: { title: "#dev", url: null },
+        focusedElement: null,
+        textSelection: {
+          preSelectionText: "x".repeat(600) + "直前",
+          postSelectionText: "直後",
+        },
+      },
+    } as unknown as GetAccessibilityContextResult;
+
+    const text = describeAppContext(context);
+    expect(text.split("\n")).toEqual([
+      "Slack",
+      "#dev",
+      "x".repeat(498) + "直前",
+      "直後",
+    ]);
+  });
+
+  it("コンテキストがない場合は空文字列を返す", () => {
+    expect(describeAppContext(null)).toBe("");
+  });
+});
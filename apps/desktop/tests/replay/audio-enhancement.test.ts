@@ -0,0 +1,136 @@
+import { describe, it, expect, beforeEach, afterEach } from "vitest";
+import { createTestDatabase, type TestDatabase } from "../helpers/test-db";
+import { setTestDatabase } from "../setup";
+import {
+  REPLAY_FRAME_SIZE,
+  createEnergyVad,
+  formatReplayReport,
+  runReplay,
+} from "./harness";
+import { MockOpenAIServer } from "./mock-openai-server";
+import {
+  createSyntheticCorpus,
+  loadCorpusDirectory,
+  type CorpusEntry,
+} from "./wav-corpus";
+import {
+  AudioEnhancer,
+  type AudioEnhancementConfig,
+} from "@/pipeline/core/audio-enhancer";
+
+const BYPASS: AudioEnhancementConfig = {
+  highPass: false,
+  noiseSuppression: false,
+  autoGain: false,
+};
+
+const VARIANTS: Record<string, AudioEnhancementConfig> = {
+  bypass: BYPASS,
+  highPass: { ...BYPASS, highPass: true },
+  noiseSuppression: { ...BYPASS, highPass: true, noiseSuppression: true },
+  all: { highPass: true, noiseSuppression: true, autoGain: true },
+};
+
+/**
+ * Share of frames the replay's energy VAD labels correctly against the
+ * known speech range, after running the corpus through `config`. Labels
+ * are shifted by the chain's latency.
+ */
+async function vadFrameAccuracy(
+  corpus: CorpusEntry[],
+  config: AudioEnhancementConfig,
+  threshold = 0.01,
+) {
+  const vad = createEnergyVad(threshold);
+  let correct = 0;
+  let total = 0;
+  for (const entry of corpus) {
+    if (!entry.speech) continue;
+    const enhancer = new AudioEnhancer(config);
+    const samples = entry.samples.slice();
+    for (let offset = 0; offset < samples.length; offset += REPLAY_FRAME_SIZE) {
+      const frame = samples.subarray(offset, offset + REPLAY_FRAME_SIZE);
+      enhancer.process(frame);
+      const centre = offset + frame.length / 2 - enhancer.latencySamples;
+      const { start, end } = entry.speech;
+      const isSpeech = centre >= start && centre < end;
+      const { isSpeaking } = await vad.processAudioFrame(frame);
+      if (isSpeaking === isSpeech) correct++;
+      total++;
+    }
+  }
+  return correct / total;
+}
+
+describe("音声前処理とVAD", () => {
+  it("騒がしい環境ではノイズ抑圧でVADの誤検出が減る", async () => {
+    // Background noise well above the stub VAD's threshold
+    const corpus = createSyntheticCorpus({ noise: 0.03 });
+    const raw = await vadFrameAccuracy(corpus, BYPASS);
+    const enhanced = await vadFrameAccuracy(corpus, VARIANTS.all);
+    expect(enhanced).toBeGreaterThan(raw + 0.1);
+    expect(enhanced).toBeGreaterThan(0.85);
+  });
+
+  it("静かな環境では精度を大きく落とさない", async () => {
+    // Suppression trims the quietest syllable edges below the fixed
+    // threshold, a few frames per utterance
+    const corpus = createSyntheticCorpus();
+    const raw = await vadFrameAccuracy(corpus, BYPASS);
+    const enhanced = await vadFrameAccuracy(corpus, VARIANTS.all);
+    expect(enhanced).toBeGreaterThan(raw - 0.05);
+  });
+});
+
+/**
+ * Standalone A/B bench per stage: `pnpm bench:enhancement`
+ *
+ * REPLAY_CORPUS_DIR   directory of *.wav (default: noisy synthetic corpus;
+ *                     frame accuracy needs the synthetic speech ranges)
+ * ENHANCEMENT_NOISE   background noise level of the synthetic corpus
+ */
+describe.skipIf(!process.env.ENHANCEMENT_BENCH)("音声前処理ベンチ", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({
+      name: `enhancement-bench-${Date.now()}`,
+    });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("段ごとにVAD精度・送信バイト数・処理速度を比較する", async () => {
+    const env = process.env;
+    const corpus = env.REPLAY_CORPUS_DIR
+      ? loadCorpusDirectory(env.REPLAY_CORPUS_DIR)
+      : createSyntheticCorpus({
+          count: 12,
+          noise: Number(env.ENHANCEMENT_NOISE ?? 0.03),
+        });
+
+    for (const [name, config] of Object.entries(VARIANTS)) {
+      const server = new MockOpenAIServer();
+      const report = await runReplay({
+        corpus,
+        server,
+        pacing: "max",
+        formattingEnabled: false,
+        audioEnhancement: config,
+      });
+      await server.stop();
+      const accuracy = corpus.every((entry) => entry.speech)
+        ? `${((await vadFrameAccuracy(corpus, config)) * 100).toFixed(1)}%`
+        : "n/a";
+      console.log(`--- ${name} ---\n${formatReplayReport(report)}`);
+      console.log(
+        `${name}: VAD frame accuracy ${accuracy}, ` +
+          `${report.server.transcriptionRequests} requests, ` +
+          `${report.server.bytesReceived} bytes uploaded`,
+      );
+    }
+  }, 600_000);
+});
@@ -0,0 +1,443 @@
+import { RecordingManager } from "@main/managers/recording-manager";
+import type { ServiceManager } from "@main/managers/service-manager";
+import { metricsRegistry } from "@main/metrics";
+import { Histogram, type HistogramSummary } from "@main/metrics/registry";
+import { TranscriptionService } from "@services/transcription-service";
+import { ProviderRouter } from "@/pipeline/core/provider-router";
+import type { VADService } from "@services/vad-service";
+import type { SettingsService } from "@services/settings-service";
+import type { NativeBridge } from "@services/platform/native-bridge-service";
+import type { SpeechUploadEncoding } from "@/pipeline/providers/transcription/flac-encoder";
+import {
+  DEFAULT_AUDIO_ENHANCEMENT,
+  type AudioEnhancementConfig,
+} from "@/pipeline/core/audio-enhancer";
+import { PreRollBuffer } from "@/utils/pre-roll-buffer";
+import { MockOpenAIServer, type MockServerStats } from "./mock-openai-server";
+import { REPLAY_SAMPLE_RATE, type CorpusEntry } from "./wav-corpus";
+
+/**
+ * Deterministic replay harness
+ *
+ * Drives RecordingManager.handleAudioChunk → TranscriptionService → Whisper
+ * provider → formatter → DB headlessly, using a WAV corpus instead of the
+ * microphone and a local mock server (OPENAI_BASE_URL) instead of OpenAI.
+ *
+ * Pipeline stages are measured by the application's own metrics registry;
+ * the harness adds per-frame IPC handling, start and stop-to-result
+ * latencies. The database must already be set up (see tests/helpers/test-db).
+ */
+
+export const REPLAY_FRAME_SIZE = 512; // Same as the renderer's worklet
+
+export type ReplayPacing = "realtime" | "max";
+
+export interface ReplayOptions {
+  corpus: CorpusEntry[];
+  /** "realtime" paces frames at 32ms like a live microphone */
+  pacing?: ReplayPacing;
+  server?: MockOpenAIServer;
+  formattingEnabled?: boolean;
+  /** RMS above which the stub VAD reports speech */
+  vadThreshold?: number;
+  uploadEncoding?: SpeechUploadEncoding;
+  /** Clean-up stages before VAD (default: the app default, all on) */
+  audioEnhancement?: AudioEnhancementConfig;
+  /**
+   * Audio after the key-down (the start of each entry) that is captured
+   * before the recording takes frames: start-up checks, mute, renderer
+   * capture start. Lost unless pre-rolled. Default 0.
+   */
+  startupDelayMs?: number;
+  /** Pre-roll ring on the standby microphone (default 0: off) */
+  preRollMs?: number;
+}
+
+export interface ReplayResult {
+  id: string;
+  expected: string;
+  actual: string;
+}
+
+export interface ReplayReport {
+  pacing: ReplayPacing;
+  entries: number;
+  audioSeconds: number;
+  wallSeconds: number;
+  /** Audio seconds processed per wall-clock second */
+  realtimeFactor: number;
+  framesPerSecond: number;
+  stages: Record<string, HistogramSummary>;
+  server: MockServerStats;
+  results: ReplayResult[];
+  /** Audio between key-down and capture start, over all entries */
+  capture: {
+    lostMs: number;
+    recoveredMs: number;
+    /** Share of known speech samples that reached the pipeline */
+    speechCoverage: number | null;
+  };
+}
+
+// Application histograms reported as pipeline stages
+const PIPELINE_STAGES: Record<string, string> = {
+  vad: "surasura_vad_latency_ms",
+  encode: "surasura_transcription_upload_encode_ms",
+  provider: "surasura_transcription_provider_latency_ms",
+  formatter: "surasura_formatter_latency_ms",
+  db: "surasura_db_query_latency_ms",
+};
+
+/**
+ * Energy-based stand-in for the Silero VAD (the ONNX runtime is not
+ * available under vitest). Deterministic for a given corpus.
+ */
+export function createEnergyVad(threshold: number) {
+  return {
+    reset: () => {},
+    processAudioFrame: async (frame: Float32Array) => {
+      let energy = 0;
+      for (let i = 0; i < frame.length; i++) energy += frame[i] * frame[i];
+      const rms = Math.sqrt(energy / Math.max(1, frame.length));
+      const isSpeaking = rms >= threshold;
+      return {
+        probability: isSpeaking ? Math.min(1, rms / threshold / 2) : 0,
+        isSpeaking,
+      };
+    },
+  };
+}
+
+function createStubSettings(
+  formattingEnabled: boolean,
+  uploadEncoding: SpeechUploadEncoding,
+  audioEnhancement: AudioEnhancementConfig,
+) {
+  return {
+    getOpenAIConfig: async () => ({ apiKey: "sk-replay" }),
+    getPreferences: async () => ({
+      soundEnabled: false,
+      // Results are captured from the paste-fallback event
+      autoPasteEnabled: false,
+    }),
+    getFormatterConfig: async () => ({
+      enabled: formattingEnabled,
+      modelId: "gpt-4o-mini",
+      // Replays measure the formatter path on every entry
+      bypassMode: "off",
+    }),
+    getPipelineSettings: async () => ({
+      transcriptionProviderId: "openai-whisper",
+    }),
+    getDictationSettings: async () => ({ selectedLanguage: "ja" }),
+    getActivePreset: async () => null,
+    getOpenRouterConfig: async () => undefined,
+    getLlamaCppConfig: async () => undefined,
+    getDefaultSpeechModel: async () => "whisper-1",
+    getSpeechUploadEncoding: async () => uploadEncoding,
+    getAudioEnhancement: async () => audioEnhancement,
+    getDefaultLanguageModel: async () => "gpt-4o-mini",
+  };
+}
+
+function createStubNativeBridge() {
+  return {
+    refreshAccessibilityContext: () => {},
+    getAccessibilityContext: () => null,
+    call: async () => ({ success: true }),
+  };
+}
+
+export function wait(ms: number): Promise<void> {
+  return ms > 0
+    ? new Promise((resolve) => setTimeout(resolve, ms))
+    : Promise.resolve();
+}
+
+export interface ReplayPipelineOptions {
+  server: MockOpenAIServer;
+  formattingEnabled?: boolean;
+  vadThreshold?: number;
+  uploadEncoding?: SpeechUploadEncoding;
+  audioEnhancement?: AudioEnhancementConfig;
+}
+
+export interface ReplayPipeline {
+  manager: RecordingManager;
+  /** The IPC entry point (private on RecordingManager) */
+  handleAudioChunk(chunk: Float32Array, isFinal: boolean): Promise<void>;
+  dispose(): Promise<void>;
+}
+
+/**
+ * Wire a real RecordingManager and TranscriptionService to stub platform
+ * services and the mock server. Shared by the replay and soak benches.
+ */
+export async function createReplayPipeline(
+  options: ReplayPipelineOptions,
+): Promise<ReplayPipeline> {
+  const {
+    server,
+    formattingEnabled = true,
+    vadThreshold = 0.01,
+    uploadEncoding = "flac",
+    audioEnhancement = DEFAULT_AUDIO_ENHANCEMENT,
+  } = options;
+
+  const previousBaseURL = process.env.OPENAI_BASE_URL;
+  process.env.OPENAI_BASE_URL = await server.start();
+  metricsRegistry.reset();
+  // Provider health must not carry over from a previous run's mock server
+  ProviderRouter.resetInstance();
+
+  const settingsService = createStubSettings(
+    formattingEnabled,
+    uploadEncoding,
+    audioEnhancement,
+  );
+  const nativeBridge = createStubNativeBridge();
+  const vadService = createEnergyVad(vadThreshold);
+  const transcriptionService = new TranscriptionService(
+    vadService as unknown as VADService,
+    settingsService as unknown as SettingsService,
+    nativeBridge as unknown as NativeBridge,
+    null,
+  );
+  const services: Record<string, unknown> = {
+    settingsService,
+    nativeBridge,
+    vadService,
+    transcriptionService,
+    windowManager: { moveWidgetToCursorDisplay: () => {} },
+  };
+  const serviceManager = {
+    getService: (name: string) => services[name],
+  } as unknown as ServiceManager;
+  const manager = new RecordingManager(serviceManager);
+
+  const internals = manager as unknown as {
+    handleAudioChunk(chunk: Float32Array, isFinal: boolean): Promise<void>;
+  };
+
+  return {
+    manager,
+    handleAudioChunk: (chunk, isFinal) =>
+      internals.handleAudioChunk(chunk, isFinal),
+    dispose: async () => {
+      await manager.cleanup();
+      await transcriptionService.dispose();
+      if (previousBaseURL === undefined) {
+        delete process.env.OPENAI_BASE_URL;
+      } else {
+        process.env.OPENAI_BASE_URL = previousBaseURL;
+      }
+    },
+  };
+}
+
+export async function runReplay(options: ReplayOptions): Promise<ReplayReport> {
+  const { corpus, pacing = "max", formattingEnabled, vadThreshold } = options;
+  const { uploadEncoding, audioEnhancement } = options;
+  const { startupDelayMs = 0, preRollMs = 0 } = options;
+
+  const server = options.server ?? new MockOpenAIServer();
+  const ownsServer = !options.server;
+  const { manager, handleAudioChunk, dispose } = await createReplayPipeline({
+    server,
+    formattingEnabled,
+    vadThreshold,
+    uploadEncoding,
+    audioEnhancement,
+  });
+
+  const stages = {
+    chunk: new Histogram("replay_chunk_ms", "handleAudioChunk per frame"),
+    start: new Histogram("replay_start_ms", "signalStart"),
+    stopToResult: new Histogram(
+      "replay_stop_to_result_ms",
+      "signalStop until the final result",
+    ),
+  };
+
+  const results: ReplayResult[] = [];
+  let lastResult = "";
+  manager.on("paste-fallback", (text: string) => {
+    lastResult = text;
+  });
+
+  const frameMs = (REPLAY_FRAME_SIZE / REPLAY_SAMPLE_RATE) * 1000;
+  let frameCount = 0;
+  let audioSamples = 0;
+  let lostSamples = 0;
+  let recoveredSamples = 0;
+  let speechSamples = 0;
+  let deliveredSpeechSamples = 0;
+  const runStart = performance.now();
+
+  try {
+    for (const entry of corpus) {
+      server.transcript = entry.transcript;
+      lastResult = "";
+
+      const startAt = performance.now();
+      await manager.signalStart();
+      stages.start.record(performance.now() - startAt);
+      if (manager.getState() !== "recording") {
+        throw new Error(`Recording did not start for ${entry.id}`);
+      }
+
+      // Audio from before capture starts reaches the session only through
+      // the pre-roll: standby frames go into the ring as in useAudioCapture
+      // and what has been captured since the key-down (t = 0) is kept
+      const startupSamples = Math.min(
+        entry.samples.length,
+        Math.round((startupDelayMs / 1000) * REPLAY_SAMPLE_RATE),
+      );
+      let firstSample = startupSamples;
+      if (preRollMs > 0 && startupSamples > 0) {
+        const preRoll = new PreRollBuffer(REPLAY_SAMPLE_RATE, preRollMs);
+        for (
+          let offset = 0;
+          offset < startupSamples;
+          offset += REPLAY_FRAME_SIZE
+        ) {
+          const end = Math.min(offset + REPLAY_FRAME_SIZE, startupSamples);
+          preRoll.write(
+            entry.samples.subarray(offset, end),
+            (end / REPLAY_SAMPLE_RATE) * 1000,
+          );
+        }
+        firstSample -= preRoll.takeSince(0).length;
+      }
+      lostSamples += firstSample;
+      recoveredSamples += startupSamples - firstSample;
+      if (entry.speech) {
+        const { start, end } = entry.speech;
+        speechSamples += end - start;
+        deliveredSpeechSamples += Math.max(
+          0,
+          end - Math.max(start, firstSample),
+        );
+      }
+
+      // Realtime: frames are fired on a fixed schedule without waiting,
+      // like IPC from the renderer. Max: each frame is awaited.
+      const pending: Promise<void>[] = [];
+      const streamStart = performance.now();
+      let index = 0;
+      for (
+        let offset = firstSample;
+        offset < entry.samples.length;
+        offset += REPLAY_FRAME_SIZE
+      ) {
+        const frame = entry.samples.slice(offset, offset + REPLAY_FRAME_SIZE);
+        if (pacing === "realtime") {
+          await wait(streamStart + index * frameMs - performance.now());
+        }
+        const frameStart = performance.now();
+        const handled = handleAudioChunk(frame, false).then(() => {
+          stages.chunk.record(performance.now() - frameStart);
+        });
+        if (pacing === "realtime") {
+          pending.push(handled);
+        } else {
+          await handled;
+        }
+        index++;
+      }
+      frameCount += index;
+      audioSamples += entry.samples.length - firstSample;
+
+      const stopAt = performance.now();
+      await manager.signalStop();
+      await Promise.all(pending);
+      await handleAudioChunk(new Float32Array(0), true);
+      stages.stopToResult.record(performance.now() - stopAt);
+
+      results.push({
+        id: entry.id,
+        expected: entry.transcript,
+        actual: lastResult,
+      });
+    }
+  } finally {
+    await dispose();
+    if (ownsServer) await server.stop();
+  }
+
+  const wallSeconds = (performance.now() - runStart) / 1000;
+  const audioSeconds = audioSamples / REPLAY_SAMPLE_RATE;
+
+  const report: ReplayReport = {
+    pacing,
+    entries: corpus.length,
+    audioSeconds,
+    wallSeconds,
+    realtimeFactor: wallSeconds > 0 ? audioSeconds / wallSeconds : 0,
+    framesPerSecond: wallSeconds > 0 ? frameCount / wallSeconds : 0,
+    stages: {},
+    server: server.getStats(),
+    results,
+    capture: {
+      lostMs: (lostSamples / REPLAY_SAMPLE_RATE) * 1000,
+      recoveredMs: (recoveredSamples / REPLAY_SAMPLE_RATE) * 1000,
+      speechCoverage:
+        speechSamples > 0 ? deliveredSpeechSamples / speechSamples : null,
+    },
+  };
+
+  for (const [stage, histogram] of Object.entries(stages)) {
+    const [summary] = histogram.summaries();
+    if (summary) report.stages[stage] = summary;
+  }
+  for (const [stage, name] of Object.entries(PIPELINE_STAGES)) {
+    for (const summary of metricsRegistry.histogramSummaries(name)) {
+      const key = summary.labels ? `${stage}{${summary.labels}}` : stage;
+      report.stages[key] = summary;
+    }
+  }
+
+  return report;
+}
+
+/**
+ * Plain-text table for console output
+ */
+export function formatReplayReport(report: ReplayReport): string {
+  const ms = (value: number) => value.toFixed(2).padStart(9);
+  const lines = [
+    `Replay (${report.pacing}): ${report.entries} entries, ` +
+      `${report.audioSeconds.toFixed(1)}s audio in ` +
+      `${report.wallSeconds.toFixed(2)}s ` +
+      `(${report.realtimeFactor.toFixed(1)}x realtime, ` +
+      `${report.framesPerSecond.toFixed(0)} frames/s)`,
+    `Mock server: ${report.server.transcriptionRequests} transcription, ` +
+      `${report.server.chatRequests} chat, ${report.server.errors} errors, ` +
+      `${report.server.bytesReceived} bytes`,
+  ];
+  const { capture } = report;
+  if (capture.lostMs > 0 || capture.recoveredMs > 0) {
+    const coverage =
+      capture.speechCoverage === null
+        ? "n/a"
+        : `${(capture.speechCoverage * 100).toFixed(1)}%`;
+    lines.push(
+      `Capture start: ${capture.lostMs.toFixed(0)}ms lost, ` +
+        `${capture.recoveredMs.toFixed(0)}ms recovered by pre-roll, ` +
+        `speech coverage ${coverage}`,
+    );
+  }
+  lines.push(
+    "",
+    `${"stage".padEnd(48)}${"count".padStart(7)}` +
+      `${"p50".padStart(9)}${"p90".padStart(9)}` +
+      `${"p99".padStart(9)}${"max".padStart(9)}`,
+  );
+  for (const [stage, s] of Object.entries(report.stages)) {
+    lines.push(
+      `${stage.padEnd(48)}${String(s.count).padStart(7)}` +
+        `${ms(s.p50)}${ms(s.p90)}${ms(s.p99)}${ms(s.max)}`,
+    );
+  }
+  return lines.join("\n");
+}
@@ -0,0 +1,233 @@
+import http from "node:http";
+import type { AddressInfo } from "node:net";
+
+/**
+ * Local stand-in for the OpenAI API used by the replay harness
+ *
+ * Serves the two endpoints the pipeline calls:
+ * - POST /v1/audio/transcriptions → { text } (Whisper, JSON response format)
+ * - POST /v1/chat/completions → chat completion wrapping the user message in
+ *   <formatted_text> tags (OpenAIFormatter)
+ *
+ * Latency, jitter and error rate are configured per endpoint. Jitter comes
+ * from a seeded PRNG so that runs are reproducible. An optional upload
+ * bandwidth throttles request bodies to model a slow uplink.
+ */
+
+export interface EndpointProfile {
+  /** Base response latency (ms) */
+  latencyMs: number;
+  /** Uniform jitter added to the latency, ±jitterMs */
+  jitterMs: number;
+  /** Fraction of requests answered with HTTP 500 (0-1) */
+  errorRate: number;
+}
+
+export interface MockOpenAIServerOptions {
+  transcription?: Partial<EndpointProfile>;
+  chat?: Partial<EndpointProfile>;
+  seed?: number;
+  /** Request body bandwidth in bytes per second (default: unlimited) */
+  uploadBytesPerSecond?: number;
+}
+
+export interface MockServerStats {
+  transcriptionRequests: number;
+  chatRequests: number;
+  errors: number;
+  bytesReceived: number;
+}
+
+const DEFAULT_PROFILE: EndpointProfile = {
+  latencyMs: 0,
+  jitterMs: 0,
+  errorRate: 0,
+};
+
+/** mulberry32 - small, fast, deterministic */
+export function createRandom(seed: number): () => number {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+export class MockOpenAIServer {
+  private server: http.Server | null = null;
+  private random: () => number;
+  private transcriptionProfile: EndpointProfile;
+  private chatProfile: EndpointProfile;
+  private uploadBytesPerSecond: number;
+  private stats: MockServerStats = {
+    transcriptionRequests: 0,
+    chatRequests: 0,
+    errors: 0,
+    bytesReceived: 0,
+  };
+
+  /** Text returned by the transcription endpoint (set per corpus entry) */
+  transcript = "";
+
+  constructor(options: MockOpenAIServerOptions = {}) {
+    this.random = createRandom(options.seed ?? 1);
+    this.transcriptionProfile = {
+      ...DEFAULT_PROFILE,
+      ...options.transcription,
+    };
+    this.chatProfile = { ...DEFAULT_PROFILE, ...options.chat };
+    this.uploadBytesPerSecond = options.uploadBytesPerSecond ?? Infinity;
+  }
+
+  /**
+   * Start listening on an ephemeral localhost port
+   * @returns base URL to use as OPENAI_BASE_URL
+   */
+  async start(): Promise<string> {
+    const server = http.createServer((req, res) => {
+      this.handle(req, res).catch(() => {
+        if (!res.headersSent) res.writeHead(500);
+        res.end();
+      });
+    });
+    this.server = server;
+
+    await new Promise<void>((resolve) => {
+      server.listen(0, "127.0.0.1", () => resolve());
+    });
+
+    const { port } = server.address() as AddressInfo;
+    return `http://127.0.0.1:${port}/v1`;
+  }
+
+  async stop(): Promise<void> {
+    const server = this.server;
+    this.server = null;
+    if (!server) return;
+    server.closeAllConnections();
+    await new Promise<void>((resolve) => server.close(() => resolve()));
+  }
+
+  getStats(): MockServerStats {
+    return { ...this.stats };
+  }
+
+  private async handle(
+    req: http.IncomingMessage,
+    res: http.ServerResponse,
+  ): Promise<void> {
+    const body = await readBody(req, this.uploadBytesPerSecond);
+    this.stats.bytesReceived += body.length;
+
+    const url = req.url?.split("?")[0] ?? "";
+    let profile: EndpointProfile;
+    let respond: () => unknown;
+
+    if (req.method === "POST" && url.endsWith("/audio/transcriptions")) {
+      this.stats.transcriptionRequests++;
+      profile = this.transcriptionProfile;
+      const text = this.transcript;
+      respond = () => ({ text });
+    } else if (req.method === "POST" && url.endsWith("/chat/completions")) {
+      this.stats.chatRequests++;
+      profile = this.chatProfile;
+      respond = () => chatCompletion(JSON.parse(body.toString("utf8")));
+    } else {
+      res.writeHead(404).end();
+      return;
+    }
+
+    await sleep(this.sampleLatency(profile));
+
+    if (profile.errorRate > 0 && this.random() < profile.errorRate) {
+      this.stats.errors++;
+      sendJson(res, 500, {
+        error: { message: "Mock server error", type: "server_error" },
+      });
+      return;
+    }
+
+    sendJson(res, 200, respond());
+  }
+
+  private sampleLatency(profile: EndpointProfile): number {
+    const jitter = (this.random() * 2 - 1) * profile.jitterMs;
+    return Math.max(0, profile.latencyMs + jitter);
+  }
+}
+
+interface ChatRequest {
+  model?: string;
+  messages?: { role: string; content: unknown }[];
+}
+
+function chatCompletion(request: ChatRequest) {
+  const userMessage = [...(request.messages ?? [])]
+    .reverse()
+    .find((m) => m.role === "user");
+  const text =
+    typeof userMessage?.content === "string" ? userMessage.content : "";
+  const content = `<formatted_text>${text}</formatted_text>`;
+
+  return {
+    id: "chatcmpl-replay",
+    object: "chat.completion",
+    created: Math.floor(Date.now() / 1000),
+    model: request.model ?? "mock",
+    choices: [
+      {
+        index: 0,
+        message: { role: "assistant", content },
+        finish_reason: "stop",
+      },
+    ],
+    usage: {
+      prompt_tokens: 0,
+      completion_tokens: 0,
+      total_tokens: 0,
+    },
+  };
+}
+
+/**
+ * Read the request body. With a finite bandwidth the stream is paused after
+ * each chunk until the budget for the bytes received so far has elapsed, so
+ * TCP backpressure slows the client down like a real uplink.
+ */
+function readBody(
+  req: http.IncomingMessage,
+  bytesPerSecond = Infinity,
+): Promise<Buffer> {
+  return new Promise((resolve, reject) => {
+    const chunks: Buffer[] = [];
+    const start = performance.now();
+    let received = 0;
+    req.on("data", (chunk: Buffer) => {
+      chunks.push(chunk);
+      received += chunk.length;
+      if (!Number.isFinite(bytesPerSecond)) return;
+      const due = start + (received / bytesPerSecond) * 1000;
+      const delay = due - performance.now();
+      if (delay > 0) {
+        req.pause();
+        setTimeout(() => req.resume(), delay);
+      }
+    });
+    req.on("end", () => resolve(Buffer.concat(chunks)));
+    req.on("error", reject);
+  });
+}
+
+function sendJson(res: http.ServerResponse, status: number, body: unknown) {
+  res.writeHead(status, { "Content-Type": "application/json" });
+  res.end(JSON.stringify(body));
+}
+
+function sleep(ms: number): Promise<void> {
+  return ms > 0
+    ? new Promise((resolve) => setTimeout(resolve, ms))
+    : Promise.resolve();
+}
@@ -0,0 +1,119 @@
+import { describe, it, expect, beforeEach, afterEach } from "vitest";
+import { createTestDatabase, type TestDatabase } from "../helpers/test-db";
+import { setTestDatabase } from "../setup";
+import { runReplay, formatReplayReport, type ReplayReport } from "./harness";
+import { MockOpenAIServer } from "./mock-openai-server";
+import { createSyntheticCorpus, loadCorpusDirectory } from "./wav-corpus";
+
+let dbCounter = 0;
+
+async function replayWith(
+  startupDelayMs: number,
+  preRollMs: number,
+  corpus = createSyntheticCorpus({ count: 2 }),
+): Promise<ReplayReport> {
+  const server = new MockOpenAIServer();
+  const report = await runReplay({
+    corpus,
+    server,
+    pacing: "max",
+    formattingEnabled: false,
+    startupDelayMs,
+    preRollMs,
+  });
+  await server.stop();
+  return report;
+}
+
+describe("プリロール (録音開始前の音声)", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({
+      name: `pre-roll-test-${dbCounter++}`,
+    });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("プリロールなしでは開始までの発話の頭が欠ける", async () => {
+    // Synthetic entries start speaking 300 ms after the key-down
+    const report = await replayWith(450, 0);
+
+    expect(report.capture.lostMs).toBeCloseTo(2 * 450, 0);
+    expect(report.capture.recoveredMs).toBe(0);
+    expect(report.capture.speechCoverage).toBeLessThan(1);
+  });
+
+  it("開始までの遅延より長いプリロールで発話の頭を取り戻す", async () => {
+    const report = await replayWith(450, 500);
+
+    expect(report.capture.lostMs).toBe(0);
+    expect(report.capture.recoveredMs).toBeCloseTo(2 * 450, 0);
+    expect(report.capture.speechCoverage).toBe(1);
+  });
+
+  it("プリロールの長さまでしか取り戻さない", async () => {
+    const report = await replayWith(450, 200);
+
+    expect(report.capture.recoveredMs).toBeCloseTo(2 * 200, 0);
+    expect(report.capture.lostMs).toBeCloseTo(2 * 250, 0);
+    expect(report.capture.speechCoverage).toBeLessThan(1);
+  });
+});
+
+/**
+ * Start-up delay × pre-roll sweep: `pnpm bench:pre-roll`
+ *
+ * REPLAY_CORPUS_DIR   directory of *.wav (default: synthetic corpus)
+ * PRE_ROLL_DELAYS_MS  comma-separated start-up delays (default: 0,150,300,600)
+ */
+describe.skipIf(!process.env.PRE_ROLL_BENCH)("プリロールベンチ", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({ name: `pre-roll-bench-${Date.now()}` });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("開始遅延ごとに失われる音声と発話の取りこぼしを比較する", async () => {
+    const env = process.env;
+    const corpus = env.REPLAY_CORPUS_DIR
+      ? loadCorpusDirectory(env.REPLAY_CORPUS_DIR)
+      : createSyntheticCorpus({ count: 10 });
+    const delays = (env.PRE_ROLL_DELAYS_MS ?? "0,150,300,600")
+      .split(",")
+      .map(Number);
+
+    for (const startupDelayMs of delays) {
+      for (const preRollMs of [0, 300, 500, 1000]) {
+        const report = await replayWith(startupDelayMs, preRollMs, corpus);
+        const { lostMs, recoveredMs, speechCoverage } = report.capture;
+        const coverage =
+          speechCoverage === null
+            ? "n/a"
+            : `${(speechCoverage * 100).toFixed(1)}%`;
+        console.log(
+          `startup ${startupDelayMs}ms, pre-roll ${preRollMs}ms: ` +
+            `${lostMs.toFixed(0)}ms lost, ${recoveredMs.toFixed(0)}ms ` +
+            `recovered, speech coverage ${coverage}, ` +
+            `stop-to-result p50 ${report.stages.stopToResult.p50.toFixed(0)}ms`,
+        );
+        if (preRollMs === 0 && startupDelayMs > 0) {
+          console.log(formatReplayReport(report));
+        }
+        expect(lostMs + recoveredMs).toBeCloseTo(
+          corpus.length * startupDelayMs,
+          -1,
+        );
+      }
+    }
+  }, 600_000);
+});
@@ -0,0 +1,120 @@
+import { describe, it, expect, beforeEach, afterEach } from "vitest";
+import fs from "node:fs";
+import { createTestDatabase, type TestDatabase } from "../helpers/test-db";
+import { setTestDatabase } from "../setup";
+import { getTranscriptions } from "@db/transcriptions";
+import { runReplay, formatReplayReport } from "./harness";
+import { MockOpenAIServer } from "./mock-openai-server";
+import { createSyntheticCorpus, loadCorpusDirectory } from "./wav-corpus";
+
+let dbCounter = 0;
+
+describe("リプレイハーネス", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({
+      name: `replay-test-${dbCounter++}`,
+    });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("WAVコーパスをパイプライン全体に流してDBに保存する", async () => {
+    const corpus = createSyntheticCorpus({ count: 3 });
+    const server = new MockOpenAIServer({
+      transcription: { latencyMs: 5, jitterMs: 2 },
+      chat: { latencyMs: 5, jitterMs: 2 },
+    });
+
+    const report = await runReplay({ corpus, server, pacing: "max" });
+    await server.stop();
+
+    expect(report.results.map((r) => r.actual)).toEqual(
+      corpus.map((e) => e.transcript),
+    );
+    expect(report.server.transcriptionRequests).toBe(3);
+    expect(report.server.chatRequests).toBe(3);
+    expect(report.stages.chunk.count).toBeGreaterThan(0);
+    expect(report.stages.vad.count).toBe(report.stages.chunk.count);
+    expect(
+      report.stages['provider{model="whisper-1",provider="openai-whisper"}']
+        .count,
+    ).toBe(3);
+    expect(report.stages['formatter{provider="openai"}'].count).toBe(3);
+
+    const saved = await getTranscriptions();
+    expect(saved).toHaveLength(3);
+  });
+
+  it("リアルタイム再生では音声長以上の時間がかかる", async () => {
+    const corpus = createSyntheticCorpus({ count: 1 });
+
+    const report = await runReplay({
+      corpus,
+      pacing: "realtime",
+      formattingEnabled: false,
+    });
+
+    expect(report.results[0].actual).toBe(corpus[0].transcript);
+    expect(report.server.chatRequests).toBe(0);
+    // Last frame is dispatched one frame before the end of the audio
+    expect(report.wallSeconds).toBeGreaterThan(report.audioSeconds - 0.1);
+  });
+});
+
+/**
+ * Standalone bench: `pnpm bench:replay`
+ *
+ * REPLAY_CORPUS_DIR   directory of *.wav (+ optional *.txt references)
+ * REPLAY_PACING       realtime | max (default: max)
+ * REPLAY_LATENCY_MS   mock provider latency (default: 300)
+ * REPLAY_JITTER_MS    mock provider jitter, ± (default: 100)
+ * REPLAY_ERROR_RATE   fraction of failed requests (default: 0)
+ * REPLAY_REPORT       write the JSON report to this path
+ */
+describe.skipIf(!process.env.REPLAY_BENCH)("リプレイベンチ", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({ name: `replay-bench-${Date.now()}` });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("コーパスを再生して段階別レイテンシを出力する", async () => {
+    const env = process.env;
+    const corpus = env.REPLAY_CORPUS_DIR
+      ? loadCorpusDirectory(env.REPLAY_CORPUS_DIR)
+      : createSyntheticCorpus({ count: 20 });
+    const profile = {
+      latencyMs: Number(env.REPLAY_LATENCY_MS ?? 300),
+      jitterMs: Number(env.REPLAY_JITTER_MS ?? 100),
+      errorRate: Number(env.REPLAY_ERROR_RATE ?? 0),
+    };
+    const server = new MockOpenAIServer({
+      transcription: profile,
+      chat: profile,
+    });
+
+    const report = await runReplay({
+      corpus,
+      server,
+      pacing: env.REPLAY_PACING === "realtime" ? "realtime" : "max",
+    });
+    await server.stop();
+
+    console.log(formatReplayReport(report));
+    if (env.REPLAY_REPORT) {
+      fs.writeFileSync(env.REPLAY_REPORT, JSON.stringify(report, null, 2));
+    }
+
+    expect(report.results).toHaveLength(corpus.length);
+  }, 600_000);
+});
@@ -0,0 +1,95 @@
+import { describe, it, expect, beforeEach, afterEach } from "vitest";
+import fs from "node:fs";
+import { createTestDatabase, type TestDatabase } from "../helpers/test-db";
+import { setTestDatabase } from "../setup";
+import {
+  runSoak,
+  computeGrowth,
+  checkGrowth,
+  formatSoakReport,
+  DEFAULT_SOAK_THRESHOLDS,
+  type SoakSample,
+} from "./soak";
+
+function sample(index: number, heap: number, chunkP50 = 1): SoakSample {
+  return {
+    audioSeconds: index * 60,
+    wallSeconds: index,
+    heapUsedBytes: heap,
+    rssBytes: heap,
+    arrayBuffersBytes: 0,
+    chunkP50,
+    chunkP99: chunkP50,
+    chunkMax: chunkP50,
+    gcCount: 0,
+    gcPauseMs: 0,
+    gcMaxPauseMs: 0,
+    uploadBytes: 1000,
+  };
+}
+
+describe("ソーク計測の成長判定", () => {
+  const series = (f: (i: number) => number, latency?: (i: number) => number) =>
+    Array.from({ length: 13 }, (_, i) => sample(i, f(i), latency?.(i)));
+
+  it("線形なメモリ増加は許容する", () => {
+    const growth = computeGrowth(series((i) => 100e6 + i * 2e6));
+    expect(growth.heap).toBeCloseTo(1, 1);
+    expect(checkGrowth(growth)).toEqual([]);
+  });
+
+  it("二次的なメモリ増加を検出する", () => {
+    const growth = computeGrowth(series((i) => 100e6 + i * i * 1e6));
+    expect(growth.heap).toBeGreaterThan(DEFAULT_SOAK_THRESHOLDS.heap);
+    expect(checkGrowth(growth).join()).toMatch(/heap/);
+  });
+
+  it("チャンク処理レイテンシの増加を検出する", () => {
+    const growth = computeGrowth(
+      series(
+        () => 100e6,
+        (i) => 0.1 * (i + 1),
+      ),
+    );
+    expect(growth.chunkLatency).toBeGreaterThan(
+      DEFAULT_SOAK_THRESHOLDS.chunkLatency,
+    );
+  });
+});
+
+/**
+ * Long-session soak: `pnpm bench:soak`
+ *
+ * SOAK_MINUTES        simulated session length (default: 60)
+ * SOAK_WINDOW_SECONDS sampling window in audio seconds (default: 60)
+ * SOAK_PACING         realtime | max (default: max)
+ * SOAK_REPORT         write the JSON report to this path
+ */
+describe.skipIf(!process.env.SOAK_BENCH)("長時間セッションのソーク", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({ name: `soak-${Date.now()}` });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("メモリとレイテンシがセッション長に対して超線形に増えない", async () => {
+    const env = process.env;
+    const report = await runSoak({
+      durationMinutes: Number(env.SOAK_MINUTES ?? 60),
+      windowSeconds: Number(env.SOAK_WINDOW_SECONDS ?? 60),
+      pacing: env.SOAK_PACING === "realtime" ? "realtime" : "max",
+    });
+
+    console.log(formatSoakReport(report));
+    if (env.SOAK_REPORT) {
+      fs.writeFileSync(env.SOAK_REPORT, JSON.stringify(report, null, 2));
+    }
+
+    expect(checkGrowth(report.growth)).toEqual([]);
+  }, 3 * 60 * 60 * 1000);
+});
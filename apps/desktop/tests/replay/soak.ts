@@ -0,0 +1,321 @@
+import v8 from "node:v8";
+import vm from "node:vm";
+import { PerformanceObserver, type PerformanceEntry } from "node:perf_hooks";
+import { Histogram } from "@main/metrics/registry";
+import {
+  createReplayPipeline,
+  wait,
+  REPLAY_FRAME_SIZE,
+  type ReplayPacing,
+} from "./harness";
+import { MockOpenAIServer } from "./mock-openai-server";
+import { createSyntheticCorpus, REPLAY_SAMPLE_RATE } from "./wav-corpus";
+
+/**
+ * Long hands-free session soak benchmark
+ *
+ * Streams one continuous session (utterances separated by pauses long enough
+ * for the Whisper provider to upload mid-session) through the replay
+ * pipeline and samples memory, GC and per-chunk latency per window of audio
+ * time. Everything that scales with session length - RecordingManager's
+ * audio buffer, the provider frame buffer, accumulated transcription results
+ * and the recognition prompt - shows up here.
+ *
+ * Linear memory growth is expected (the session audio is kept until the WAV
+ * is written); the checks flag growth that accelerates over the session.
+ */
+
+export interface SoakOptions {
+  /** Simulated session length in audio minutes */
+  durationMinutes: number;
+  /** Sampling window in audio seconds */
+  windowSeconds?: number;
+  pacing?: ReplayPacing;
+  /** Pause after each utterance; > 3s triggers a mid-session upload */
+  pauseSeconds?: number;
+  server?: MockOpenAIServer;
+}
+
+export interface SoakSample {
+  audioSeconds: number;
+  wallSeconds: number;
+  heapUsedBytes: number;
+  rssBytes: number;
+  arrayBuffersBytes: number;
+  /** Per-chunk handling latency within the window (ms) */
+  chunkP50: number;
+  chunkP99: number;
+  chunkMax: number;
+  gcCount: number;
+  gcPauseMs: number;
+  gcMaxPauseMs: number;
+  /** Bytes received by the mock server within the window */
+  uploadBytes: number;
+}
+
+export interface SoakReport {
+  durationMinutes: number;
+  wallSeconds: number;
+  samples: SoakSample[];
+  growth: SoakGrowth;
+}
+
+export interface SoakGrowth {
+  /**
+   * Late/early slope ratios: growth per audio second in the second half of
+   * the session divided by growth per audio second in the first half.
+   * ~1 for linear growth, ~3 for quadratic, < 1 when levelling off.
+   */
+  heap: number;
+  rss: number;
+  /** Late-window p50 chunk latency / early-window p50 */
+  chunkLatency: number;
+  /** Late-window upload bytes / early-window upload bytes */
+  uploadBytes: number;
+}
+
+export interface SoakThresholds {
+  heap: number;
+  rss: number;
+  chunkLatency: number;
+  uploadBytes: number;
+}
+
+export const DEFAULT_SOAK_THRESHOLDS: SoakThresholds = {
+  heap: 1.5,
+  rss: 1.5,
+  chunkLatency: 2,
+  uploadBytes: 2,
+};
+
+/**
+ * `global.gc` without requiring --expose-gc on the command line
+ */
+function exposeGc(): () => void {
+  v8.setFlagsFromString("--expose-gc");
+  return vm.runInNewContext("gc") as () => void;
+}
+
+export async function runSoak(options: SoakOptions): Promise<SoakReport> {
+  const {
+    durationMinutes,
+    windowSeconds = 60,
+    pacing = "max",
+    pauseSeconds = 3.5,
+  } = options;
+  const server = options.server ?? new MockOpenAIServer();
+  const ownsServer = !options.server;
+  const gc = exposeGc();
+
+  // One loop unit: utterance followed by a pause
+  const corpus = createSyntheticCorpus();
+  const pauseSamples = Math.round(pauseSeconds * REPLAY_SAMPLE_RATE);
+  const units = corpus.map((entry) => {
+    const samples = new Float32Array(entry.samples.length + pauseSamples);
+    samples.set(entry.samples);
+    return { samples, transcript: entry.transcript };
+  });
+
+  const { manager, handleAudioChunk, dispose } = await createReplayPipeline({
+    server,
+    formattingEnabled: true,
+  });
+
+  let gcCount = 0;
+  let gcPauseMs = 0;
+  let gcMaxPauseMs = 0;
+  const gcObserver = new PerformanceObserver((list) => {
+    for (const entry of list.getEntries() as PerformanceEntry[]) {
+      gcCount++;
+      gcPauseMs += entry.duration;
+      gcMaxPauseMs = Math.max(gcMaxPauseMs, entry.duration);
+    }
+  });
+  gcObserver.observe({ entryTypes: ["gc"] });
+
+  const totalFrames = Math.ceil(
+    (durationMinutes * 60 * REPLAY_SAMPLE_RATE) / REPLAY_FRAME_SIZE,
+  );
+  const framesPerWindow = Math.max(
+    1,
+    Math.round((windowSeconds * REPLAY_SAMPLE_RATE) / REPLAY_FRAME_SIZE),
+  );
+  const frameMs = (REPLAY_FRAME_SIZE / REPLAY_SAMPLE_RATE) * 1000;
+
+  const samples: SoakSample[] = [];
+  let windowLatency = new Histogram("soak_chunk_ms", "Chunk latency");
+  let lastUploadBytes = 0;
+
+  const takeSample = (frames: number) => {
+    // Collect first so heapUsed reflects retained memory, not garbage
+    gc();
+    const memory = process.memoryUsage();
+    const [latency] = windowLatency.summaries();
+    const { bytesReceived } = server.getStats();
+    samples.push({
+      audioSeconds: (frames * REPLAY_FRAME_SIZE) / REPLAY_SAMPLE_RATE,
+      wallSeconds: (performance.now() - runStart) / 1000,
+      heapUsedBytes: memory.heapUsed,
+      rssBytes: memory.rss,
+      arrayBuffersBytes: memory.arrayBuffers,
+      chunkP50: latency?.p50 ?? 0,
+      chunkP99: latency?.p99 ?? 0,
+      chunkMax: latency?.max ?? 0,
+      gcCount,
+      gcPauseMs,
+      gcMaxPauseMs,
+      uploadBytes: bytesReceived - lastUploadBytes,
+    });
+    lastUploadBytes = bytesReceived;
+    windowLatency = new Histogram("soak_chunk_ms", "Chunk latency");
+    gcCount = 0;
+    gcPauseMs = 0;
+    gcMaxPauseMs = 0;
+  };
+
+  const runStart = performance.now();
+
+  try {
+    await manager.signalStart();
+    if (manager.getState() !== "recording") {
+      throw new Error("Recording did not start");
+    }
+    takeSample(0);
+
+    const pending: Promise<void>[] = [];
+    let unitIndex = 0;
+    let unitOffset = 0;
+
+    for (let frame = 0; frame < totalFrames; frame++) {
+      const unit = units[unitIndex];
+      server.transcript = unit.transcript;
+      const chunk = unit.samples.slice(
+        unitOffset,
+        unitOffset + REPLAY_FRAME_SIZE,
+      );
+      unitOffset += REPLAY_FRAME_SIZE;
+      if (unitOffset >= unit.samples.length) {
+        unitIndex = (unitIndex + 1) % units.length;
+        unitOffset = 0;
+      }
+
+      if (pacing === "realtime") {
+        await wait(runStart + frame * frameMs - performance.now());
+      }
+      const chunkStart = performance.now();
+      const handled = handleAudioChunk(chunk, false).then(() => {
+        windowLatency.record(performance.now() - chunkStart);
+      });
+      if (pacing === "realtime") {
+        pending.push(handled);
+      } else {
+        await handled;
+      }
+
+      if ((frame + 1) % framesPerWindow === 0) {
+        await Promise.all(pending.splice(0));
+        takeSample(frame + 1);
+      }
+    }
+
+    await manager.signalStop();
+    await Promise.all(pending);
+    await handleAudioChunk(new Float32Array(0), true);
+  } finally {
+    gcObserver.disconnect();
+    await dispose();
+    if (ownsServer) await server.stop();
+  }
+
+  return {
+    durationMinutes,
+    wallSeconds: (performance.now() - runStart) / 1000,
+    samples,
+    growth: computeGrowth(samples),
+  };
+}
+
+/**
+ * Compare the second half of the session against the first
+ */
+export function computeGrowth(samples: SoakSample[]): SoakGrowth {
+  // samples[0] is the baseline taken before streaming
+  const windows = samples.slice(1);
+  if (windows.length < 4) {
+    return { heap: 1, rss: 1, chunkLatency: 1, uploadBytes: 1 };
+  }
+
+  // Start from the first window so SDK loading and warmup don't count
+  const first = windows[0];
+  const middle = windows[Math.floor(windows.length / 2)];
+  const last = windows[windows.length - 1];
+  const slopeRatio = (key: "heapUsedBytes" | "rssBytes") => {
+    const early =
+      (middle[key] - first[key]) / (middle.audioSeconds - first.audioSeconds);
+    const late =
+      (last[key] - middle[key]) / (last.audioSeconds - middle.audioSeconds);
+    // Below ~1KB per audio second the slope is GC noise, not growth
+    return late / Math.max(early, 1024);
+  };
+
+  // Quarter windows smooth out per-window noise
+  const quarter = Math.max(1, Math.floor(windows.length / 4));
+  const average = (list: SoakSample[], key: keyof SoakSample) =>
+    list.reduce((sum, s) => sum + s[key], 0) / list.length;
+  const ratio = (key: keyof SoakSample) => {
+    const early = average(windows.slice(0, quarter), key);
+    const late = average(windows.slice(-quarter), key);
+    return early > 0 ? late / early : 1;
+  };
+
+  return {
+    heap: slopeRatio("heapUsedBytes"),
+    rss: slopeRatio("rssBytes"),
+    chunkLatency: ratio("chunkP50"),
+    uploadBytes: ratio("uploadBytes"),
+  };
+}
+
+/**
+ * @returns human-readable violations (empty when within thresholds)
+ */
+export function checkGrowth(
+  growth: SoakGrowth,
+  thresholds: SoakThresholds = DEFAULT_SOAK_THRESHOLDS,
+): string[] {
+  return (Object.keys(thresholds) as (keyof SoakThresholds)[])
+    .filter((key) => growth[key] > thresholds[key])
+    .map(
+      (key) =>
+        `${key} growth ${growth[key].toFixed(2)}x exceeds ${thresholds[key]}x`,
+    );
+}
+
+export function formatSoakReport(report: SoakReport): string {
+  const mb = (bytes: number) => (bytes / 1024 / 1024).toFixed(1).padStart(8);
+  const num = (value: number, digits = 2) =>
+    value.toFixed(digits).padStart(8);
+  const lines = [
+    `Soak: ${report.durationMinutes} min session in ` +
+      `${report.wallSeconds.toFixed(1)}s`,
+    `${"audio_s".padStart(8)}${"heap_mb".padStart(8)}${"rss_mb".padStart(8)}` +
+      `${"ab_mb".padStart(8)}${"p50_ms".padStart(8)}${"p99_ms".padStart(8)}` +
+      `${"gc_n".padStart(8)}${"gc_ms".padStart(8)}${"up_kb".padStart(8)}`,
+  ];
+  for (const s of report.samples) {
+    lines.push(
+      `${num(s.audioSeconds, 0)}${mb(s.heapUsedBytes)}${mb(s.rssBytes)}` +
+        `${mb(s.arrayBuffersBytes)}${num(s.chunkP50, 3)}${num(s.chunkP99, 3)}` +
+        `${num(s.gcCount, 0)}${num(s.gcPauseMs, 1)}` +
+        `${num(s.uploadBytes / 1024, 1)}`,
+    );
+  }
+  const g = report.growth;
+  lines.push(
+    "",
+    `Growth (late/early): heap ${g.heap.toFixed(2)}x, rss ${g.rss.toFixed(2)}x, ` +
+      `chunk p50 ${g.chunkLatency.toFixed(2)}x, ` +
+      `upload ${g.uploadBytes.toFixed(2)}x`,
+  );
+  return lines.join("\n");
+}
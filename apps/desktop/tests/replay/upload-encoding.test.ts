@@ -0,0 +1,126 @@
+import { describe, it, expect, beforeEach, afterEach } from "vitest";
+import { createTestDatabase, type TestDatabase } from "../helpers/test-db";
+import { setTestDatabase } from "../setup";
+import { runReplay, formatReplayReport, type ReplayReport } from "./harness";
+import { MockOpenAIServer } from "./mock-openai-server";
+import { createSyntheticCorpus, loadCorpusDirectory } from "./wav-corpus";
+import type { SpeechUploadEncoding } from "@/pipeline/providers/transcription/flac-encoder";
+
+let dbCounter = 0;
+
+async function replayWith(
+  encoding: SpeechUploadEncoding,
+  server: MockOpenAIServer,
+  corpus = createSyntheticCorpus({ count: 2 }),
+): Promise<ReplayReport> {
+  const report = await runReplay({
+    corpus,
+    server,
+    pacing: "max",
+    formattingEnabled: false,
+    uploadEncoding: encoding,
+  });
+  await server.stop();
+  return report;
+}
+
+describe("アップロード音声の符号化", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({
+      name: `upload-encoding-test-${dbCounter++}`,
+    });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("FLACはWAVより少ないバイト数で同じ結果になる", async () => {
+    const wav = await replayWith("wav", new MockOpenAIServer());
+    const flac = await replayWith("flac", new MockOpenAIServer());
+
+    expect(flac.results).toEqual(wav.results);
+    expect(flac.server.transcriptionRequests).toBe(
+      wav.server.transcriptionRequests,
+    );
+    expect(flac.server.bytesReceived).toBeLessThan(
+      wav.server.bytesReceived * 0.7,
+    );
+    expect(flac.stages['encode{format="flac"}'].count).toBe(
+      flac.server.transcriptionRequests,
+    );
+  });
+
+  it("帯域制限下ではFLACの方が早く結果が返る", async () => {
+    // 256 kbit/s: a 2-second WAV segment takes about 2 s to upload
+    const uploadBytesPerSecond = 32_000;
+    const corpus = createSyntheticCorpus({ count: 1 });
+    const wav = await replayWith(
+      "wav",
+      new MockOpenAIServer({ uploadBytesPerSecond }),
+      corpus,
+    );
+    const flac = await replayWith(
+      "flac",
+      new MockOpenAIServer({ uploadBytesPerSecond }),
+      corpus,
+    );
+
+    expect(flac.stages.stopToResult.max).toBeLessThan(
+      wav.stages.stopToResult.max,
+    );
+  }, 30_000);
+});
+
+/**
+ * Standalone A/B bench: `pnpm bench:upload`
+ *
+ * REPLAY_CORPUS_DIR      directory of *.wav (default: synthetic corpus)
+ * UPLOAD_BYTES_PER_SEC   mock uplink bandwidth (default: 64000 ≈ 512 kbit/s)
+ * UPLOAD_LATENCY_MS      mock provider latency (default: 300)
+ */
+describe.skipIf(!process.env.UPLOAD_BENCH)("アップロード符号化ベンチ", () => {
+  let testDb: TestDatabase;
+
+  beforeEach(async () => {
+    testDb = await createTestDatabase({ name: `upload-bench-${Date.now()}` });
+    setTestDatabase(testDb.db);
+  });
+
+  afterEach(async () => {
+    if (testDb) await testDb.close();
+  });
+
+  it("WAVとFLACのバイト数・符号化時間・停止から結果までを比較する", async () => {
+    const env = process.env;
+    const corpus = env.REPLAY_CORPUS_DIR
+      ? loadCorpusDirectory(env.REPLAY_CORPUS_DIR)
+      : createSyntheticCorpus({ count: 10 });
+    const uploadBytesPerSecond = Number(env.UPLOAD_BYTES_PER_SEC ?? 64_000);
+    const latencyMs = Number(env.UPLOAD_LATENCY_MS ?? 300);
+
+    const reports: Record<string, ReplayReport> = {};
+    for (const encoding of ["wav", "flac"] as const) {
+      const server = new MockOpenAIServer({
+        transcription: { latencyMs },
+        uploadBytesPerSecond,
+      });
+      reports[encoding] = await replayWith(encoding, server, corpus);
+      console.log(`--- ${encoding} ---\n${formatReplayReport(reports[encoding])}`);
+    }
+
+    const { wav, flac } = reports;
+    const ratio = flac.server.bytesReceived / wav.server.bytesReceived;
+    console.log(
+      `FLAC/WAV bytes: ${(ratio * 100).toFixed(1)}%, ` +
+        `stop-to-result p50 ${wav.stages.stopToResult.p50.toFixed(0)}ms → ` +
+        `${flac.stages.stopToResult.p50.toFixed(0)}ms`,
+    );
+
+    expect(flac.results).toEqual(wav.results);
+    expect(ratio).toBeLessThan(1);
+  }, 600_000);
+});
@@ -0,0 +1,142 @@
+import { describe, it, expect, vi } from "vitest";
+import { VADService } from "@services/vad-service";
+import { REPLAY_FRAME_SIZE } from "./harness";
+import { createRandom } from "./mock-openai-server";
+import {
+  createSyntheticCorpus,
+  loadCorpusDirectory,
+  type CorpusEntry,
+} from "./wav-corpus";
+
+interface GateRun {
+  frames: number;
+  inferences: number;
+  elapsedMs: number;
+  /** isSpeaking per frame, entries concatenated */
+  decisions: boolean[];
+}
+
+/** Replay every corpus entry as its own recording through `vad` */
+async function replayVad(
+  vad: VADService,
+  corpus: CorpusEntry[],
+  onFrame: (frame: Float32Array) => void = () => {},
+): Promise<Omit<GateRun, "inferences">> {
+  const decisions: boolean[] = [];
+  let elapsedMs = 0;
+  for (const entry of corpus) {
+    vad.reset();
+    for (let i = 0; i < entry.samples.length; i += REPLAY_FRAME_SIZE) {
+      const frame = entry.samples.subarray(i, i + REPLAY_FRAME_SIZE);
+      onFrame(frame);
+      const start = performance.now();
+      const { isSpeaking } = await vad.processAudioFrame(frame);
+      elapsedMs += performance.now() - start;
+      decisions.push(isSpeaking);
+    }
+  }
+  return { frames: decisions.length, elapsedMs, decisions };
+}
+
+function agreement(a: boolean[], b: boolean[]) {
+  return a.filter((decision, i) => decision === b[i]).length / a.length;
+}
+
+/**
+ * VADService with a stand-in for the Silero session: scores the frame being
+ * replayed by its RMS, like the replay harness's energy VAD
+ */
+async function replayWithStandIn(corpus: CorpusEntry[], preGate: boolean) {
+  const vad = new VADService({ preGate });
+  let current = new Float32Array(0);
+  const run = vi.fn(async () => {
+    let energy = 0;
+    for (const sample of current) energy += sample * sample;
+    const rms = Math.sqrt(energy / Math.max(1, current.length));
+    return {
+      output: { data: new Float32Array([Math.min(1, rms / 0.02)]) },
+      stateN: { data: new Float32Array(256) },
+    };
+  });
+  // eslint-disable-next-line @typescript-eslint/no-explicit-any
+  const internals = vad as any;
+  internals.session = { run, outputNames: ["output", "stateN"] };
+  internals.state = {};
+
+  const result = await replayVad(vad, corpus, (frame) => (current = frame));
+  return { ...result, inferences: run.mock.calls.length } satisfies GateRun;
+}
+
+describe("VADの無音ゲート (リプレイコーパス)", () => {
+  it("発話判定を変えずに無音区間の推論を省く", async () => {
+    // Utterances with a second of room tone around them, as in dictation
+    const random = createRandom(5);
+    const corpus = createSyntheticCorpus().map((entry) => {
+      const padding = 16000;
+      const length = entry.samples.length + 2 * padding;
+      const samples = new Float32Array(length).map(
+        () => (random() * 2 - 1) * 0.002,
+      );
+      samples.set(entry.samples, padding);
+      return { ...entry, samples };
+    });
+
+    const ungated = await replayWithStandIn(corpus, false);
+    const gated = await replayWithStandIn(corpus, true);
+
+    expect(ungated.inferences).toBe(ungated.frames);
+    expect(gated.inferences).toBeLessThan(gated.frames * 0.6);
+    expect(agreement(gated.decisions, ungated.decisions)).toBe(1);
+  });
+});
+
+/**
+ * Silero with and without the gate: `pnpm bench:vad-gate`
+ *
+ * Loads the real ONNX model (models/silero_vad_v6.onnx) through the actual
+ * onnxruntime-node, so it needs the native module installed.
+ *
+ * REPLAY_CORPUS_DIR   directory of *.wav (default: synthetic corpus)
+ */
+describe.skipIf(!process.env.VAD_GATE_BENCH)("VAD無音ゲートベンチ", () => {
+  it("推論回数・処理時間・発話判定の一致率を比較する", async () => {
+    vi.doUnmock("onnxruntime-node");
+    vi.resetModules();
+    const { VADService: RealVADService } = await import(
+      "@services/vad-service"
+    );
+
+    const corpus = process.env.REPLAY_CORPUS_DIR
+      ? loadCorpusDirectory(process.env.REPLAY_CORPUS_DIR)
+      : createSyntheticCorpus({ count: 12 });
+
+    const runs: Record<string, GateRun> = {};
+    for (const preGate of [false, true]) {
+      const vad = new RealVADService({ preGate });
+      await vad.initialize();
+      // Count inferences by wrapping the loaded session
+      // eslint-disable-next-line @typescript-eslint/no-explicit-any
+      const session = (vad as any).session;
+      const run = session.run.bind(session);
+      let inferences = 0;
+      session.run = (...args: unknown[]) => {
+        inferences++;
+        return run(...args);
+      };
+      const result = await replayVad(vad, corpus);
+      await vad.dispose();
+      runs[preGate ? "gated" : "ungated"] = { ...result, inferences };
+    }
+
+    const { gated, ungated } = runs;
+    console.log(
+      `frames ${ungated.frames}, ` +
+        `inferences ${ungated.inferences} → ${gated.inferences} ` +
+        `(${((1 - gated.inferences / ungated.inferences) * 100).toFixed(1)}% ` +
+        `skipped), VAD time ${ungated.elapsedMs.toFixed(0)}ms → ` +
+        `${gated.elapsedMs.toFixed(0)}ms, decision agreement ` +
+        `${(agreement(gated.decisions, ungated.decisions) * 100).toFixed(2)}%`,
+    );
+    expect(gated.inferences).toBeLessThanOrEqual(ungated.inferences);
+  }, 600_000);
+});
@@ -0,0 +1,215 @@
+import fs from "node:fs";
+import path from "node:path";
+import { createRandom } from "./mock-openai-server";
+
+/**
+ * Replay corpus: 16kHz mono Float32 utterances with their reference text
+ *
+ * Either generated synthetically (deterministic, used by the vitest run) or
+ * loaded from a directory of WAV files (REPLAY_CORPUS_DIR). A `name.txt`
+ * next to `name.wav` provides the reference transcript.
+ */
+
+export const REPLAY_SAMPLE_RATE = 16000;
+
+export interface CorpusEntry {
+  id: string;
+  samples: Float32Array;
+  transcript: string;
+  /** Sample range of the speech, when known (synthetic entries) */
+  speech?: { start: number; end: number };
+}
+
+// ───────────────────────────────────────────────────────────────────
+// Synthetic corpus
+// ───────────────────────────────────────────────────────────────────
+
+const SYNTHETIC_PHRASES = [
+  "今日は晴れています。",
+  "会議は午後三時から始まります。",
+  "資料を共有してください。",
+  "Let's ship this today.",
+  "明日の予定を確認します。",
+  "バグの再現手順を教えてください。",
+];
+
+/**
+ * Speech-like signal: voiced harmonics with a syllable-rate envelope,
+ * surrounded by low-level noise so that the VAD sees leading and trailing
+ * silence. `noise` is the peak level of that (uniform) background noise.
+ */
+export function createSyntheticCorpus(
+  options: { count?: number; seed?: number; noise?: number } = {},
+): CorpusEntry[] {
+  const {
+    count = SYNTHETIC_PHRASES.length,
+    seed = 42,
+    noise = 0.002,
+  } = options;
+  const random = createRandom(seed);
+  const entries: CorpusEntry[] = [];
+
+  for (let i = 0; i < count; i++) {
+    const transcript = SYNTHETIC_PHRASES[i % SYNTHETIC_PHRASES.length];
+    const speechSeconds = 0.8 + random() * 1.6;
+    const silenceSeconds = 0.3;
+    const total = Math.round(
+      (speechSeconds + silenceSeconds * 2) * REPLAY_SAMPLE_RATE,
+    );
+    const speechStart = Math.round(silenceSeconds * REPLAY_SAMPLE_RATE);
+    const speechEnd = total - speechStart;
+    const pitch = 110 + random() * 120;
+    const samples = new Float32Array(total);
+
+    for (let n = 0; n < total; n++) {
+      let value = (random() * 2 - 1) * noise; // Background noise
+      if (n >= speechStart && n < speechEnd) {
+        const t = (n - speechStart) / REPLAY_SAMPLE_RATE;
+        const envelope = 0.5 + 0.5 * Math.sin(2 * Math.PI * 4 * t);
+        let voiced = 0;
+        for (let h = 1; h <= 4; h++) {
+          voiced += Math.sin(2 * Math.PI * pitch * h * t) / h;
+        }
+        value += 0.25 * envelope * voiced;
+      }
+      samples[n] = value;
+    }
+
+    entries.push({
+      id: `synthetic-${i}`,
+      samples,
+      transcript,
+      speech: { start: speechStart, end: speechEnd },
+    });
+  }
+
+  return entries;
+}
+
+// ───────────────────────────────────────────────────────────────────
+// WAV corpus directory
+// ───────────────────────────────────────────────────────────────────
+
+export function loadCorpusDirectory(dir: string): CorpusEntry[] {
+  return fs
+    .readdirSync(dir)
+    .filter((name) => name.toLowerCase().endsWith(".wav"))
+    .sort()
+    .map((name) => {
+      const id = name.replace(/\.wav$/i, "");
+      const transcriptPath = path.join(dir, `${id}.txt`);
+      const transcript = fs.existsSync(transcriptPath)
+        ? fs.readFileSync(transcriptPath, "utf8").trim()
+        : "";
+      const { samples, sampleRate } = decodeWav(
+        fs.readFileSync(path.join(dir, name)),
+      );
+      return {
+        id,
+        samples: resampleLinear(samples, sampleRate, REPLAY_SAMPLE_RATE),
+        transcript,
+      };
+    });
+}
+
+/**
+ * Decode a PCM (8/16/24/32-bit int) or IEEE float WAV file, mixed to mono
+ */
+export function decodeWav(buffer: Buffer): {
+  samples: Float32Array;
+  sampleRate: number;
+} {
+  if (
+    buffer.toString("ascii", 0, 4) !== "RIFF" ||
+    buffer.toString("ascii", 8, 12) !== "WAVE"
+  ) {
+    throw new Error("Not a RIFF/WAVE file");
+  }
+
+  let format = 0;
+  let channels = 0;
+  let sampleRate = 0;
+  let bitsPerSample = 0;
+  let data: Buffer | null = null;
+
+  let offset = 12;
+  while (offset + 8 <= buffer.length) {
+    const chunkId = buffer.toString("ascii", offset, offset + 4);
+    const chunkSize = buffer.readUInt32LE(offset + 4);
+    const body = offset + 8;
+
+    if (chunkId === "fmt ") {
+      format = buffer.readUInt16LE(body);
+      channels = buffer.readUInt16LE(body + 2);
+      sampleRate = buffer.readUInt32LE(body + 4);
+      bitsPerSample = buffer.readUInt16LE(body + 14);
+      // WAVE_FORMAT_EXTENSIBLE: the real format is the sub-format GUID prefix
+      if (format === 0xfffe && chunkSize >= 26) {
+        format = buffer.readUInt16LE(body + 24);
+      }
+    } else if (chunkId === "data") {
+      data = buffer.subarray(body, Math.min(buffer.length, body + chunkSize));
+    }
+
+    // Chunks are word-aligned
+    offset = body + chunkSize + (chunkSize & 1);
+  }
+
+  if (!data || channels === 0 || sampleRate === 0) {
+    throw new Error("WAV file is missing fmt or data chunk");
+  }
+
+  const bytesPerSample = bitsPerSample / 8;
+  const frameCount = Math.floor(data.length / (bytesPerSample * channels));
+  const samples = new Float32Array(frameCount);
+
+  const read = (at: number): number => {
+    if (format === 3 && bitsPerSample === 32) return data!.readFloatLE(at);
+    if (format === 3 && bitsPerSample === 64) return data!.readDoubleLE(at);
+    if (format !== 1) throw new Error(`Unsupported WAV format: ${format}`);
+    switch (bitsPerSample) {
+      case 8:
+        return (data!.readUInt8(at) - 128) / 128;
+      case 16:
+        return data!.readInt16LE(at) / 32768;
+      case 24:
+        return data!.readIntLE(at, 3) / 8388608;
+      case 32:
+        return data!.readInt32LE(at) / 2147483648;
+      default:
+        throw new Error(`Unsupported bit depth: ${bitsPerSample}`);
+    }
+  };
+
+  for (let i = 0; i < frameCount; i++) {
+    let sum = 0;
+    for (let c = 0; c < channels; c++) {
+      sum += read((i * channels + c) * bytesPerSample);
+    }
+    samples[i] = sum / channels;
+  }
+
+  return { samples, sampleRate };
+}
+
+/**
+ * Linear-interpolation resampler; adequate for feeding a VAD and an ASR
+ * mock, not for listening tests
+ */
+export function resampleLinear(
+  input: Float32Array,
+  fromRate: number,
+  toRate: number,
+): Float32Array {
+  if (fromRate === toRate) return input;
+  const ratio = fromRate / toRate;
+  const output = new Float32Array(Math.floor(input.length / ratio));
+  for (let i = 0; i < output.length; i++) {
+    const position = i * ratio;
+    const index = Math.floor(position);
+    const frac = position - index;
+    const next = index + 1 < input.length ? input[index + 1] : input[index];
+    output[i] = input[index] * (1 - frac) + next * frac;
+  }
+  return output;
+}
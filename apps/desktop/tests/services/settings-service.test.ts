@@ -255,6 +255,82 @@ describe("SettingsService", () => {
 
       settingsService.removeListener("api-key-changed", listener);
     });
+
+    it("復号済みのキーをキャッシュして再復号しない", async () => {
+      const { safeStorage } = await import("electron");
+      const decrypt = vi.mocked(safeStorage.decryptString);
+      await settingsService.setOpenAIConfig({ apiKey: "sk-cached" });
+      decrypt.mockClear();
+
+      const configs = await Promise.all(
+        Array.from({ length: 10 }, () => settingsService.getOpenAIConfig()),
+      );
+      await settingsService.getOpenAIConfig();
+
+      expect(decrypt).toHaveBeenCalledTimes(1);
+      expect(configs.every((config) => config?.apiKey === "sk-cached")).toBe(
+        true,
+      );
+    });
+
+    it("キーの更新でキャッシュを無効化する", async () => {
+      await settingsService.setOpenAIConfig({ apiKey: "sk-old" });
+      expect((await settingsService.getOpenAIConfig())!.apiKey).toBe("sk-old");
+
+      await settingsService.setOpenAIConfig({ apiKey: "sk-new" });
+      expect((await settingsService.getOpenAIConfig())!.apiKey).toBe("sk-new");
+    });
+
+    it("dispose後は再度復号する", async () => {
+      const { safeStorage } = await import("electron");
+      const decrypt = vi.mocked(safeStorage.decryptString);
+      await settingsService.setOpenAIConfig({ apiKey: "sk-dispose" });
+      await settingsService.getOpenAIConfig();
+      decrypt.mockClear();
+
+      settingsService.dispose();
+      await settingsService.getOpenAIConfig();
+
+      expect(decrypt).toHaveBeenCalledTimes(1);
+    });
+  });
+
+  // Cached vs. uncached key retrieval; run with `pnpm bench:credentials`
+  describe.skipIf(!process.env.CREDENTIAL_BENCH)("APIキー取得ベンチ", () => {
+    beforeEach(async () => {
+      testDb = await createTestDatabase({ name: "settings-credential-bench" });
+      setTestDatabase(testDb.db);
+      await seedDatabase(testDb, "empty");
+      const result = await initializeTestServices(testDb);
+      serviceManager = result.serviceManager;
+      cleanup = result.cleanup;
+      settingsService = serviceManager.getSettingsService()!;
+    });
+
+    it("キャッシュ済みの取得は復号より十分速い", async () => {
+      await settingsService.setOpenAIConfig({ apiKey: "sk-bench" });
+      const iterations = 2000;
+
+      let start = performance.now();
+      for (let i = 0; i < iterations; i++) {
+        settingsService.invalidateCredentialCache();
+        await settingsService.getOpenAIConfig();
+      }
+      const uncachedUs = ((performance.now() - start) / iterations) * 1000;
+
+      await settingsService.getOpenAIConfig();
+      start = performance.now();
+      for (let i = 0; i < iterations; i++) {
+        await settingsService.getOpenAIConfig();
+      }
+      const cachedUs = ((performance.now() - start) / iterations) * 1000;
+
+      console.log(
+        `getOpenAIConfig: uncached ${uncachedUs.toFixed(1)}µs, ` +
+          `cached ${cachedUs.toFixed(2)}µs per call`,
+      );
+      expect(cachedUs * 10).toBeLessThan(uncachedUs);
+    });
   });
 
   // ==================== Default Speech Model ====================
@@ -283,6 +359,131 @@ describe("SettingsService", () => {
     });
   });
 
+  // ==================== Speech Upload Encoding ====================
+  describe("getSpeechUploadEncoding / setSpeechUploadEncoding", () => {
+    beforeEach(async () => {
+      testDb = await createTestDatabase({
+        name: "settings-upload-encoding-test",
+      });
+      setTestDatabase(testDb.db);
+      await seedDatabase(testDb, "empty");
+      const result = await initializeTestServices(testDb);
+      serviceManager = result.serviceManager;
+      cleanup = result.cleanup;
+      settingsService = serviceManager.getSettingsService()!;
+    });
+
+    it("未設定ならFLACを返す", async () => {
+      expect(await settingsService.getSpeechUploadEncoding()).toBe("flac");
+    });
+
+    it("WAVに切り替えても他のモデル設定を保持する", async () => {
+      await settingsService.setDefaultSpeechModel("whisper-1");
+      await settingsService.setSpeechUploadEncoding("wav");
+
+      expect(await settingsService.getSpeechUploadEncoding()).toBe("wav");
+      expect(await settingsService.getDefaultSpeechModel()).toBe("whisper-1");
+    });
+
+    it("読み出した値をキャッシュし、書き込みで無効化する", async () => {
+      expect(await settingsService.getSpeechUploadEncoding()).toBe("flac");
+      const read = vi.spyOn(settingsService, "getModelProvidersConfig");
+      expect(await settingsService.getSpeechUploadEncoding()).toBe("flac");
+      expect(read).not.toHaveBeenCalled();
+
+      await settingsService.setSpeechUploadEncoding("wav");
+      expect(await settingsService.getSpeechUploadEncoding()).toBe("wav");
+    });
+  });
+
+  // ==================== Audio Enhancement ====================
+  describe("getAudioEnhancement / setAudioEnhancement", () => {
+    beforeEach(async () => {
+      testDb = await createTestDatabase({
+        name: "settings-audio-enhancement-test",
+      });
+      setTestDatabase(testDb.db);
+      await seedDatabase(testDb, "empty");
+      const result = await initializeTestServices(testDb);
+      serviceManager = result.serviceManager;
+      cleanup = result.cleanup;
+      settingsService = serviceManager.getSettingsService()!;
+    });
+
+    it("未設定ならハイパスのみ有効にする", async () => {
+      expect(await settingsService.getAudioEnhancement()).toEqual({
+        highPass: true,
+        noiseSuppression: false,
+        autoGain: false,
+      });
+    });
+
+    it("段ごとにバイパスしても他の録音設定を保持する", async () => {
+      const recording = await settingsService.getRecordingSettings();
+      await settingsService.setRecordingSettings({
+        ...recording!,
+        preferredMicrophoneName: "USB Mic",
+      });
+      await settingsService.setAudioEnhancement({
+        highPass: false,
+        noiseSuppression: true,
+        autoGain: true,
+      });
+
+      expect(await settingsService.getAudioEnhancement()).toEqual({
+        highPass: false,
+        noiseSuppression: true,
+        autoGain: true,
+      });
+      const updated = await settingsService.getRecordingSettings();
+      expect(updated?.preferredMicrophoneName).toBe("USB Mic");
+    });
+  });
+
+  describe("getMicStandbyMs / setMicStandbyMs", () => {
+    beforeEach(async () => {
+      testDb = await createTestDatabase({ name: "settings-mic-standby-test" });
+      setTestDatabase(testDb.db);
+      await seedDatabase(testDb, "empty");
+      const result = await initializeTestServices(testDb);
+      serviceManager = result.serviceManager;
+      cleanup = result.cleanup;
+      settingsService = serviceManager.getSettingsService()!;
+    });
+
+    it("未設定なら10秒待機する", async () => {
+      expect(await settingsService.getMicStandbyMs()).toBe(10_000);
+    });
+
+    it("0を保存すると待機しない", async () => {
+      await settingsService.setMicStandbyMs(0);
+      expect(await settingsService.getMicStandbyMs()).toBe(0);
+    });
+  });
+
+  describe("getPreRollMs / setPreRollMs", () => {
+    beforeEach(async () => {
+      testDb = await createTestDatabase({ name: "settings-pre-roll-test" });
+      setTestDatabase(testDb.db);
+      await seedDatabase(testDb, "empty");
+      const result = await initializeTestServices(testDb);
+      serviceManager = result.serviceManager;
+      cleanup = result.cleanup;
+      settingsService = serviceManager.getSettingsService()!;
+    });
+
+    it("未設定ならプリロールは無効", async () => {
+      expect(await settingsService.getPreRollMs()).toBe(0);
+    });
+
+    it("保存しても待機時間の設定を保持する", async () => {
+      await settingsService.setMicStandbyMs(30_000);
+      await settingsService.setPreRollMs(400);
+      expect(await settingsService.getPreRollMs()).toBe(400);
+      expect(await settingsService.getMicStandbyMs()).toBe(30_000);
+    });
+  });
+
   // ==================== Default Language Model ====================
   describe("getDefaultLanguageModel / setDefaultLanguageModel", () => {
     beforeEach(async () => {
@@ -13,6 +13,11 @@ function createMinimalService(): TranscriptionService {
     getOpenAIConfig: vi.fn(),
     getActivePreset: vi.fn(),
     getDefaultLanguageModel: vi.fn(),
+    getAudioEnhancement: vi.fn().mockResolvedValue({
+      highPass: true,
+      noiseSuppression: false,
+      autoGain: false,
+    }),
   } as unknown as SettingsService;
   return new TranscriptionService(mockVADService, mockSettingsService, null, null);
 }
@@ -157,4 +162,40 @@ describe("TranscriptionServiceの純粋メソッド", () => {
       );
     });
   });
+
+  describe("セッション終了時の音声補正チェーン", () => {
+    // eslint-disable-next-line @typescript-eslint/no-explicit-any
+    const enhancers = () => (service as any).enhancers as Map<string, unknown>;
+
+    it("セッションがなくてもキャンセルで補正チェーンを破棄する", async () => {
+      enhancers().set("s1", Promise.resolve(null));
+
+      await service.cancelStreamingSession("s1");
+
+      expect(enhancers().has("s1")).toBe(false);
+    });
+
+    it("セッションがなくても確定で補正チェーンを破棄する", async () => {
+      enhancers().set("s1", Promise.resolve(null));
+
+      await expect(service.finalizeSession({ sessionId: "s1" })).resolves.toBe(
+        "",
+      );
+      expect(enhancers().has("s1")).toBe(false);
+    });
+
+    it("キャンセル後に届いたフレームでは補正チェーンを作り直さない", async () => {
+      // eslint-disable-next-line @typescript-eslint/no-explicit-any
+      const enhanceFrame = (service as any).enhanceFrame.bind(service);
+      const frame = new Float32Array(512).fill(0.1);
+      await enhanceFrame("s1", frame);
+      expect(enhancers().has("s1")).toBe(true);
+
+      await service.cancelStreamingSession("s1");
+      const late = await enhanceFrame("s1", frame);
+
+      expect(late).toBe(frame);
+      expect(enhancers().has("s1")).toBe(false);
+    });
+  });
 });
@@ -137,4 +137,64 @@ describe("VADServiceの音声検出ロジック", () => {
       expect((service as any).silenceFrameCount).toBe(0);
     });
   });
+
+  describe("無音ゲート", () => {
+    // Stand-in ONNX session returning a fixed speech probability
+    let probability = 0.01;
+    const run = vi.fn(async () => ({
+      output: { data: new Float32Array([probability]) },
+      stateN: { data: new Float32Array(256) },
+    }));
+
+    function attachSession(target: VADService) {
+      // eslint-disable-next-line @typescript-eslint/no-explicit-any
+      (target as any).session = { run, outputNames: ["output", "stateN"] };
+      // eslint-disable-next-line @typescript-eslint/no-explicit-any
+      (target as any).state = { initial: true };
+    }
+
+    beforeEach(() => {
+      run.mockClear();
+      probability = 0.01;
+      attachSession(service);
+    });
+
+    it("デジタル無音では推論せず、文脈バッファだけ進める", async () => {
+      const silence = new Float32Array(512);
+      silence[511] = 1e-7;
+      // eslint-disable-next-line @typescript-eslint/no-explicit-any
+      const internals = service as any;
+      const state = internals.state;
+
+      const result = await service.processAudioFrame(silence);
+      expect(result).toEqual({ probability: 0, isSpeaking: false });
+      expect(run).not.toHaveBeenCalled();
+      expect(internals.state).toBe(state);
+      expect(internals.context[63]).toBeCloseTo(1e-7);
+    });
+
+    it("発話と直後のフレームは推論する", async () => {
+      const speech = new Float32Array(512).fill(0.2);
+      const quiet = new Float32Array(512).fill(0.001);
+      // Room tone long enough to learn the floor, scored as non-speech
+      for (let i = 0; i < 6; i++) await service.processAudioFrame(quiet);
+      const warmup = run.mock.calls.length;
+      expect(warmup).toBeLessThan(6);
+
+      probability = 0.9;
+      for (let i = 0; i < 3; i++) await service.processAudioFrame(speech);
+      expect(service.getIsSpeaking()).toBe(true);
+
+      probability = 0.01;
+      await service.processAudioFrame(quiet);
+      expect(run).toHaveBeenCalledTimes(warmup + 4);
+    });
+
+    it("無効にするとすべてのフレームを推論する", async () => {
+      const ungated = new VADService({ preGate: false });
+      attachSession(ungated);
+      await ungated.processAudioFrame(new Float32Array(512));
+      expect(run).toHaveBeenCalledTimes(1);
+    });
+  });
 });
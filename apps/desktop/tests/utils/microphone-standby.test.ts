@@ -0,0 +1,50 @@
+import { describe, it, expect, vi } from "vitest";
+import { DeviceIdResolver } from "@/utils/microphone-standby";
+
+function device(
+  deviceId: string,
+  label: string,
+  kind: MediaDeviceKind = "audioinput",
+): MediaDeviceInfo {
+  return { deviceId, label, kind, groupId: "group-1", toJSON: () => ({}) };
+}
+
+describe("DeviceIdResolver", () => {
+  it("列挙結果をキャッシュして再利用する", async () => {
+    const enumerate = vi.fn().mockResolvedValue([
+      device("speaker-1", "USB Mic", "audiooutput"),
+      device("mic-1", "USB Mic"),
+      device("mic-2", "Built-in Microphone"),
+    ]);
+    const resolver = new DeviceIdResolver(enumerate);
+
+    expect(await resolver.resolve("USB Mic")).toBe("mic-1");
+    expect(await resolver.resolve("Built-in Microphone")).toBe("mic-2");
+    expect(await resolver.resolve("Unplugged Mic")).toBeUndefined();
+    expect(enumerate).toHaveBeenCalledTimes(1);
+  });
+
+  it("invalidate後は列挙し直す", async () => {
+    const enumerate = vi
+      .fn()
+      .mockResolvedValueOnce([])
+      .mockResolvedValueOnce([device("mic-3", "USB Mic")]);
+    const resolver = new DeviceIdResolver(enumerate);
+
+    expect(await resolver.resolve("USB Mic")).toBeUndefined();
+    resolver.invalidate(); // devicechange: the mic was plugged in
+    expect(await resolver.resolve("USB Mic")).toBe("mic-3");
+    expect(enumerate).toHaveBeenCalledTimes(2);
+  });
+
+  it("列挙に失敗したら次の呼び出しで再試行する", async () => {
+    const enumerate = vi
+      .fn()
+      .mockRejectedValueOnce(new Error("NotAllowedError"))
+      .mockResolvedValueOnce([device("mic-1", "USB Mic")]);
+    const resolver = new DeviceIdResolver(enumerate);
+
+    await expect(resolver.resolve("USB Mic")).rejects.toThrow();
+    expect(await resolver.resolve("USB Mic")).toBe("mic-1");
+  });
+});
@@ -0,0 +1,123 @@
+import { describe, it, expect } from "vitest";
+import { PolyphaseResampler } from "@/utils/polyphase-resampler";
+
+function sine(frequency: number, sampleRate: number, length: number) {
+  const samples = new Float32Array(length);
+  for (let i = 0; i < length; i++) {
+    samples[i] = 0.5 * Math.sin((2 * Math.PI * frequency * i) / sampleRate);
+  }
+  return samples;
+}
+
+/** Resample in capture-sized chunks, then flush */
+function resample(
+  resampler: PolyphaseResampler,
+  input: Float32Array,
+  chunkSize = 512,
+) {
+  const chunks: Float32Array[] = [];
+  for (let i = 0; i < input.length; i += chunkSize) {
+    chunks.push(resampler.process(input.subarray(i, i + chunkSize)));
+  }
+  chunks.push(resampler.flush());
+  const output = new Float32Array(chunks.reduce((n, c) => n + c.length, 0));
+  let offset = 0;
+  for (const chunk of chunks) {
+    output.set(chunk, offset);
+    offset += chunk.length;
+  }
+  return output;
+}
+
+/** Signal-to-noise ratio against the ideal 16 kHz sine, edges excluded */
+function snrDb(output: Float32Array, reference: Float32Array, edge = 200) {
+  let signal = 0;
+  let noise = 0;
+  for (let i = edge; i < output.length - edge; i++) {
+    signal += reference[i] ** 2;
+    noise += (output[i] - reference[i]) ** 2;
+  }
+  return 10 * Math.log10(signal / noise);
+}
+
+function rms(samples: Float32Array, edge = 200) {
+  let sum = 0;
+  for (let i = edge; i < samples.length - edge; i++) sum += samples[i] ** 2;
+  return Math.sqrt(sum / (samples.length - 2 * edge));
+}
+
+describe("PolyphaseResampler", () => {
+  it.each([48000, 44100, 22050])(
+    "%i Hz の正弦波を16kHzに変換してもSNR 60dB以上を保つ",
+    (inputRate) => {
+      for (const frequency of [300, 1000, 3000, 6000]) {
+        const output = resample(
+          new PolyphaseResampler(inputRate, 16000),
+          sine(frequency, inputRate, inputRate),
+        );
+        expect(output.length).toBe(16000);
+        expect(
+          snrDb(output, sine(frequency, 16000, 16000)),
+        ).toBeGreaterThan(60);
+      }
+    },
+  );
+
+  it("ナイキスト周波数を超える成分を折り返さない", () => {
+    // 12 kHz would alias to 4 kHz, right in the speech band
+    for (const frequency of [8500, 12000, 20000]) {
+      const output = resample(
+        new PolyphaseResampler(48000, 16000),
+        sine(frequency, 48000, 48000),
+      );
+      const attenuation = 20 * Math.log10(rms(output) / (0.5 / Math.SQRT2));
+      expect(attenuation).toBeLessThan(-70);
+    }
+  });
+
+  it("チャンクの区切り方によらず同じ出力になる", () => {
+    const input = sine(440, 44100, 10000);
+    const whole = resample(new PolyphaseResampler(44100, 16000), input, 10000);
+    const chunked = resample(new PolyphaseResampler(44100, 16000), input, 127);
+    expect(chunked.length).toBe(Math.ceil((10000 * 160) / 441));
+    expect(chunked).toEqual(whole);
+  });
+
+  it("遅延は数ミリ秒に収まり、flush後は再利用できる", () => {
+    const resampler = new PolyphaseResampler(48000, 16000);
+    expect(resampler.latencyMs).toBeGreaterThan(0);
+    expect(resampler.latencyMs).toBeLessThan(5);
+
+    const input = sine(1000, 48000, 4800);
+    const first = resample(resampler, input);
+    const second = resample(resampler, input);
+    expect(second).toEqual(first);
+  });
+
+  it("不正なサンプルレートはエラーにする", () => {
+    expect(() => new PolyphaseResampler(0, 16000)).toThrow();
+    expect(() => new PolyphaseResampler(44100.5, 16000)).toThrow();
+  });
+});
+
+// Throughput at the common device rates; run with `pnpm bench:resampler`
+describe.skipIf(!process.env.RESAMPLER_BENCH)("リサンプラーベンチ", () => {
+  it("1分の音声を変換する時間とSNRを計測する", () => {
+    for (const inputRate of [48000, 44100]) {
+      const input = sine(1000, inputRate, inputRate * 60);
+      const resampler = new PolyphaseResampler(inputRate, 16000);
+      const start = performance.now();
+      const output = resample(resampler, input);
+      const elapsedMs = performance.now() - start;
+      const snr = snrDb(output, sine(1000, 16000, output.length));
+      console.log(
+        `${inputRate} → 16000: ${resampler.tapsPerPhase} taps/phase, ` +
+          `latency ${resampler.latencyMs.toFixed(2)}ms, ` +
+          `60s in ${elapsedMs.toFixed(1)}ms ` +
+          `(${((60 * 1000) / elapsedMs).toFixed(0)}x realtime), ` +
+          `SNR ${snr.toFixed(1)}dB`,
+      );
+      expect(elapsedMs).toBeLessThan(60 * 1000 * 0.05);
+    }
+  });
+});
@@ -0,0 +1,47 @@
+import { describe, it, expect } from "vitest";
+import { PreRollBuffer } from "@/utils/pre-roll-buffer";
+
+// 1 kHz keeps sample times at whole milliseconds
+const RATE = 1000;
+
+function ramp(from: number, length: number) {
+  return new Float32Array(length).map((_, i) => from + i);
+}
+
+describe("PreRollBuffer", () => {
+  it("容量を超えた分は古い順に捨てる", () => {
+    const buffer = new PreRollBuffer(RATE, 300);
+    for (let t = 0; t < 1000; t += 100) {
+      buffer.write(ramp(t, 100), t + 100);
+    }
+    expect(buffer.durationMs).toBe(300);
+    expect(buffer.takeSince(0)).toEqual(ramp(700, 300));
+    expect(buffer.durationMs).toBe(0);
+  });
+
+  it("キーを押した時刻以降の音声だけを返す", () => {
+    const buffer = new PreRollBuffer(RATE, 300);
+    buffer.write(ramp(0, 250), 250);
+    // Sample n covers [n, n + 1) ms
+    expect(buffer.takeSince(120)).toEqual(ramp(120, 130));
+  });
+
+  it("キー押下が最新のサンプルより後なら何も返さない", () => {
+    const buffer = new PreRollBuffer(RATE, 300);
+    buffer.write(ramp(0, 100), 100);
+    expect(buffer.takeSince(150)).toHaveLength(0);
+  });
+
+  it("途切れた音声の前半は時刻が合わないため捨てる", () => {
+    const buffer = new PreRollBuffer(RATE, 300);
+    buffer.write(ramp(0, 100), 100);
+    buffer.write(ramp(500, 100), 600);
+    expect(buffer.takeSince(0)).toEqual(ramp(500, 100));
+  });
+
+  it("1回の書き込みが容量を超えても末尾を保持する", () => {
+    const buffer = new PreRollBuffer(RATE, 100);
+    buffer.write(ramp(0, 250), 250);
+    expect(buffer.takeSince(0)).toEqual(ramp(150, 100));
+  });
+});
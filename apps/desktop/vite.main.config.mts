@@ -6,6 +6,8 @@ export default defineConfig({
   build: {
     rollupOptions: {
       input: {
+        // bootstrap enables the V8 compile cache, then requires main.js
+        bootstrap: resolve(__dirname, "src/main/bootstrap.ts"),
         main: resolve(__dirname, "src/main/main.ts"),
       },
       output: {